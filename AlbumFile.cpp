@@ -25,21 +25,29 @@
 #include "AlbumFile.h"
 #include "./opengl_view/OpenglView.h"
 #include <GLC_FileFormatException>
-#include <GLC_Vector3d>
 #include <GLC_Exception>
 #include <GLC_Material>
 #include <QGLContext>
+#include <QBuffer>
 
 const QString AlbumFile::m_Suffix("album");
 
+// The first bytes of a binary album
+static const char binaryAlbumMagic[]= "GLCALBUM";
+static const int binaryAlbumMagicSize= 8;
+
+// The binary album format version
+static const quint32 binaryAlbumVersion= 1;
+
+// The size of the binary album header : magic, version and number of entries
+static const qint64 binaryAlbumHeaderSize= binaryAlbumMagicSize + 2 * sizeof(quint32);
+
 AlbumFile::AlbumFile()
 : m_pStreamWriter(NULL)
 , m_pStreamReader(NULL)
 , m_SessionPathDir()
 , m_AlbumVersion("2.1")
 , m_ReadedAlbumVersion()
-, m_CurrentModelAbsoluteDir()
-, m_CurrentModelRealAbsoluteDir()
 {
 }
 
@@ -57,53 +65,513 @@ AlbumFile::~AlbumFile()
  */
 QList<FileEntry> AlbumFile::loadAlbumFile(QFile* pSessionFile)
 {
-	Q_ASSERT(NULL == m_pStreamReader);
-
 	// Open the session file in read only mode
 	pSessionFile->open(QIODevice::ReadOnly);
+	QList<FileEntry> returnEntries;
+	try
+	{
+		returnEntries= loadAlbumFile(pSessionFile, QFileInfo(*pSessionFile).absoluteDir());
+	}
+	catch (GLC_Exception&)
+	{
+		pSessionFile->close();
+		throw;
+	}
+
+	// Close the session file
+	pSessionFile->close();
+
+	return returnEntries;
+}
+
+// Load an album from the given opened device
+QList<FileEntry> AlbumFile::loadAlbumFile(QIODevice* pDevice, const QDir& albumDir)
+{
 	// The Session Path Dir
+	m_SessionPathDir= albumDir;
+
+	QList<EntryRecord> records;
+	QFile* pAlbumFile= qobject_cast<QFile*>(pDevice);
+	if ((NULL != pAlbumFile) && (albumFormat(pDevice) == BinaryFormat))
+	{
+		// Only the index is read, the records are decoded when the entries are loaded
+		const QList<IndexEntry> index(readAlbumIndex(pDevice));
+		if (index.isEmpty()) throwBinaryError("The album has no model", pDevice->pos());
+		const QString albumFileName(QFileInfo(*pAlbumFile).absoluteFilePath());
+		const int size= index.size();
+		for (int i= 0; i < size; ++i)
+		{
+			EntryRecord record;
+			record.m_FileName= index.at(i).m_FileName;
+			record.m_RelativeFileName= index.at(i).m_RelativeFileName;
+			record.m_CameraIsSet= index.at(i).m_CameraIsSet;
+			record.m_Angle= 30.0;
+			record.m_AlbumFileName= albumFileName;
+			record.m_IndexEntry= index.at(i);
+			records.append(record);
+		}
+	}
+	else
+	{
+		// The album is validated while the records are read, in one pass
+		records= readAlbumRecords(pDevice);
+	}
+
+	QList<FileEntry> returnEntries;
+	const int size= records.size();
+	for (int i= 0; i < size; ++i)
+	{
+		returnEntries.append(fileEntry(records.at(i)));
+	}
+
+	return returnEntries;
+}
+
+// Save a session file
+void AlbumFile::saveAlbumFile(const QList<FileEntry>& fileEntryList, QFile* pSessionFile, AlbumFormat format)
+{
+	// The records of the entries which are not loaded can be read from the session file
 	m_SessionPathDir= QFileInfo(*pSessionFile).absoluteDir();
+	const QList<EntryRecord> records(entryRecords(fileEntryList));
+
+	// Open the Session file in write only mode
+	pSessionFile->open(QIODevice::WriteOnly);
+	writeAlbumRecords(records, pSessionFile, format);
+
+	// Close the session file
+	pSessionFile->close();
+}
 
-	m_pStreamReader= new QXmlStreamReader(pSessionFile);
-	// Check the session file validity
-	if (!checkAlbumFileValidity())
+// Save a session in the given opened device
+void AlbumFile::saveAlbumFile(const QList<FileEntry>& fileEntryList, QIODevice* pDevice, const QDir& albumDir, AlbumFormat format)
+{
+	// The Session Path Dir
+	m_SessionPathDir= albumDir;
+
+	writeAlbumRecords(entryRecords(fileEntryList), pDevice, format);
+}
+
+// Convert the given album file into the given album file of the given format
+void AlbumFile::convertAlbumFile(QFile* pSourceFile, QFile* pTargetFile, AlbumFormat format)
+{
+	if (!pSourceFile->open(QIODevice::ReadOnly))
 	{
-		QString message("Album file not valid!");
-		GLC_Exception e(message);
-		delete m_pStreamReader;
-		m_pStreamReader= NULL;
+		GLC_Exception e(QString("Unable to open ") + pSourceFile->fileName());
 		throw e;
 	}
-	// The list of FileEntry to return
-	QList<FileEntry> returnEntries;
-	while (!m_pStreamReader->atEnd())
+
+	// The target is written once converted, it can be the source
+	QByteArray targetData;
+	QBuffer targetBuffer(&targetData);
+	targetBuffer.open(QIODevice::WriteOnly);
+	try
 	{
-		if ((QXmlStreamReader::StartElement == m_pStreamReader->readNext()) && (m_pStreamReader->name() == "Model"))
+		convertAlbumFile(pSourceFile, QFileInfo(*pSourceFile).absoluteDir(), &targetBuffer, QFileInfo(*pTargetFile).absoluteDir(), format);
+	}
+	catch (GLC_Exception&)
+	{
+		pSourceFile->close();
+		throw;
+	}
+	pSourceFile->close();
+
+	if (!pTargetFile->open(QIODevice::WriteOnly) || (pTargetFile->write(targetData) != targetData.size()))
+	{
+		pTargetFile->close();
+		GLC_Exception e(QString("Unable to write ") + pTargetFile->fileName());
+		throw e;
+	}
+	pTargetFile->close();
+}
+
+// Convert the given opened album of the first directory into the given device in the given format
+void AlbumFile::convertAlbumFile(QIODevice* pSource, const QDir& sourceDir, QIODevice* pTarget, const QDir& targetDir, AlbumFormat format)
+{
+	// The state of the entries is converted without creating their materials
+	QList<EntryRecord> records(readAlbumRecords(pSource));
+
+	// The relative file names are relative to the target album
+	const int size= records.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const QString modelFileName(sourceDir.absoluteFilePath(records.at(i).m_RelativeFileName));
+		records[i].m_RelativeFileName= targetDir.relativeFilePath(modelFileName);
+	}
+
+	writeAlbumRecords(records, pTarget, format);
+}
+
+// Return the index of the given opened binary album
+QList<AlbumFile::IndexEntry> AlbumFile::readAlbumIndex(QIODevice* pDevice)
+{
+	const qint64 albumOffset= pDevice->pos();
+	QDataStream stream(pDevice);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setVersion(QDataStream::Qt_4_6);
+
+	// The header
+	char magic[binaryAlbumMagicSize];
+	if ((stream.readRawData(magic, binaryAlbumMagicSize) != binaryAlbumMagicSize) || (qstrncmp(magic, binaryAlbumMagic, binaryAlbumMagicSize) != 0))
+	{
+		throwBinaryError("Not a binary album", albumOffset);
+	}
+	quint32 version= 0;
+	quint32 numberOfEntries= 0;
+	stream >> version >> numberOfEntries;
+	if (version != binaryAlbumVersion)
+	{
+		throwBinaryError(QString("Unsupported binary album version %1").arg(version), albumOffset);
+	}
+
+	// The index
+	QList<IndexEntry> index;
+	for (quint32 i= 0; (i < numberOfEntries) && (stream.status() == QDataStream::Ok); ++i)
+	{
+		IndexEntry entry;
+		quint8 cameraIsSet;
+		quint32 numberOfMaterials, numberOfInvisibleInstances, numberOfShadingGroups;
+		quint64 offset, size;
+		stream >> entry.m_FileName >> entry.m_RelativeFileName >> cameraIsSet;
+		stream >> numberOfMaterials >> numberOfInvisibleInstances >> numberOfShadingGroups;
+		stream >> offset >> size;
+		entry.m_CameraIsSet= (cameraIsSet != 0);
+		entry.m_NumberOfMaterials= numberOfMaterials;
+		entry.m_NumberOfInvisibleInstances= numberOfInvisibleInstances;
+		entry.m_NumberOfShadingGroups= numberOfShadingGroups;
+		entry.m_Offset= albumOffset + offset;
+		entry.m_Size= size;
+		index.append(entry);
+	}
+	if (stream.status() != QDataStream::Ok)
+	{
+		throwBinaryError("Truncated index", pDevice->pos());
+	}
+
+	return index;
+}
+
+// Return the record of the given index entry of the given opened binary album
+AlbumFile::EntryRecord AlbumFile::readAlbumRecord(QIODevice* pDevice, const IndexEntry& entry)
+{
+	if ((pDevice->pos() != entry.m_Offset) && !pDevice->seek(entry.m_Offset))
+	{
+		throwBinaryError("Record not found", entry.m_Offset);
+	}
+	QDataStream stream(pDevice);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setVersion(QDataStream::Qt_4_6);
+
+	EntryRecord record;
+	record.m_FileName= entry.m_FileName;
+	record.m_RelativeFileName= entry.m_RelativeFileName;
+
+	// The camera has a fixed layout
+	quint8 cameraIsSet;
+	stream >> cameraIsSet >> record.m_Angle;
+	record.m_CameraIsSet= (cameraIsSet != 0);
+	record.m_Eye= readBinaryVector(stream);
+	record.m_Target= readBinaryVector(stream);
+	record.m_Up= readBinaryVector(stream);
+	record.m_DefaultUp= readBinaryVector(stream);
+
+	// The materials
+	quint32 numberOfMaterials= 0;
+	stream >> numberOfMaterials;
+	for (quint32 i= 0; (i < numberOfMaterials) && (stream.status() == QDataStream::Ok); ++i)
+	{
+		MaterialRecord material;
+		stream >> material.m_Name;
+		for (int j= 0; j < 4; ++j)
 		{
-			// Find Model element going to parse it
-			returnEntries.append(currentModelToFileEnty());
+			quint8 r, g, b, a;
+			stream >> r >> g >> b >> a;
+			material.m_Colors.append(QColor(r, g, b, a));
 		}
+		double shininess;
+		stream >> shininess >> material.m_TextureFileName;
+		material.m_Shininess= static_cast<float>(shininess);
+		record.m_Materials.append(material);
 	}
 
-	// Close the session file
-	pSessionFile->close();
+	// The invisible instances and the shading groups
+	record.m_InvisibleInstances= readBinaryNames(stream);
+	quint32 numberOfShadingGroups= 0;
+	stream >> numberOfShadingGroups;
+	for (quint32 i= 0; (i < numberOfShadingGroups) && (stream.status() == QDataStream::Ok); ++i)
+	{
+		QString shaderName;
+		stream >> shaderName;
+		record.m_ShadedInstances.insert(shaderName, readBinaryNames(stream));
+	}
+
+	if ((stream.status() != QDataStream::Ok) || ((pDevice->pos() - entry.m_Offset) != entry.m_Size))
+	{
+		throwBinaryError("Corrupted record of model " + entry.m_FileName, entry.m_Offset);
+	}
+
+	return record;
+}
+
+// Return the record of the given index entry of the given binary album file
+AlbumFile::EntryRecord AlbumFile::readAlbumRecord(const QString& albumFileName, const IndexEntry& entry)
+{
+	QFile albumFile(albumFileName);
+	if (!albumFile.open(QIODevice::ReadOnly))
+	{
+		GLC_Exception e(QString("Unable to open ") + albumFileName);
+		throw e;
+	}
+	// The file is closed by its destructor
+	return readAlbumRecord(&albumFile, entry);
+}
+
+// Return the given record encoded in the binary album format
+QByteArray AlbumFile::encodeRecord(const EntryRecord& record)
+{
+	QByteArray recordData;
+	QDataStream recordStream(&recordData, QIODevice::WriteOnly);
+	recordStream.setByteOrder(QDataStream::LittleEndian);
+	recordStream.setVersion(QDataStream::Qt_4_6);
+	writeBinaryRecord(recordStream, record);
+	return recordData;
+}
+
+// Return the record of the given model file name decoded from the given binary album data
+AlbumFile::EntryRecord AlbumFile::decodeRecord(const QByteArray& recordData, const QString& fileName)
+{
+	QByteArray data(recordData);
+	QBuffer recordBuffer(&data);
+	recordBuffer.open(QIODevice::ReadOnly);
+
+	IndexEntry entry;
+	entry.m_FileName= fileName;
+	entry.m_Offset= 0;
+	entry.m_Size= recordData.size();
+	return readAlbumRecord(&recordBuffer, entry);
+}
+
+// Return the camera of the given decoded record
+GLC_Camera AlbumFile::camera(const EntryRecord& record)
+{
+	GLC_Camera camera;
+	camera.setDefaultUpVector(record.m_DefaultUp);
+	camera.setCam(record.m_Eye, record.m_Target, record.m_Up);
+	return camera;
+}
+
+// Create the materials of the given decoded record of the given model file
+QSet<GLC_Material*> AlbumFile::createMaterials(const EntryRecord& record, const QString& modelFileName)
+{
+	// The saved model path and the real model path
+	const QDir modelAbsoluteDir(QFileInfo(record.m_FileName).absolutePath());
+	const QDir modelRealAbsoluteDir(QFileInfo(modelFileName).absolutePath());
+
+	QSet<GLC_Material*> materialSet;
+	const int size= record.m_Materials.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const MaterialRecord& material= record.m_Materials.at(i);
+		GLC_Material* pMaterial= new GLC_Material();
+		pMaterial->setName(material.m_Name);
+		pMaterial->setAmbientColor(material.m_Colors[0]);
+		pMaterial->setDiffuseColor(material.m_Colors[1]);
+		pMaterial->setSpecularColor(material.m_Colors[2]);
+		pMaterial->setEmissiveColor(material.m_Colors[3]);
+		pMaterial->setShininess(material.m_Shininess);
+		pMaterial->setOpacity(material.m_Colors[1].alphaF());
+
+		QString textureFileName(material.m_TextureFileName);
+		if (!textureFileName.isEmpty())
+		{
+			// The texture is searched relatively to the real model path
+			textureFileName= modelAbsoluteDir.relativeFilePath(textureFileName);
+			textureFileName= modelRealAbsoluteDir.absoluteFilePath(textureFileName);
+			if (QFileInfo(textureFileName).exists())
+			{
+				pMaterial->setTexture(new GLC_Texture(textureFileName));
+			}
+		}
+		materialSet.insert(pMaterial);
+	}
+
+	return materialSet;
+}
+
+// Return the format of the given opened album
+AlbumFile::AlbumFormat AlbumFile::albumFormat(QIODevice* pDevice)
+{
+	if (pDevice->peek(binaryAlbumMagicSize) == QByteArray(binaryAlbumMagic, binaryAlbumMagicSize))
+	{
+		return BinaryFormat;
+	}
+	else
+	{
+		return XmlFormat;
+	}
+}
+
+// Return the format of the given album file
+AlbumFile::AlbumFormat AlbumFile::albumFormat(const QString& fileName)
+{
+	QFile albumFile(fileName);
+	AlbumFormat format= XmlFormat;
+	if (albumFile.open(QIODevice::ReadOnly))
+	{
+		format= albumFormat(&albumFile);
+		albumFile.close();
+	}
+	return format;
+}
+
+// Return album suffix
+QString AlbumFile::suffix()
+{
+	return m_Suffix;
+}
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+// Return the record of the given file entry
+AlbumFile::EntryRecord AlbumFile::entryRecord(const FileEntry& fileEntry) const
+{
+	// The album state of an entry which is not loaded is saved as it was read
+	const AlbumEntryRecord* pAlbumRecord= fileEntry.albumRecord();
+	if (NULL != pAlbumRecord)
+	{
+		EntryRecord record(*pAlbumRecord);
+		record.m_FileName= fileEntry.getFileName();
+		record.m_RelativeFileName= m_SessionPathDir.relativeFilePath(fileEntry.getFileName());
+		if (fileEntry.cameraIsSet())
+		{
+			record.m_CameraIsSet= true;
+			record.m_Angle= fileEntry.getViewAngle();
+			record.m_Eye= fileEntry.getCamera().eye();
+			record.m_Target= fileEntry.getCamera().target();
+			record.m_Up= fileEntry.getCamera().upVector();
+			record.m_DefaultUp= fileEntry.getCamera().defaultUpVector();
+		}
+		return record;
+	}
+
+	EntryRecord record;
+	record.m_FileName= fileEntry.getFileName();
+	record.m_RelativeFileName= m_SessionPathDir.relativeFilePath(fileEntry.getFileName());
+
+	// The camera is saved only if the file entry camera have been set
+	record.m_CameraIsSet= fileEntry.cameraIsSet();
+	record.m_Angle= fileEntry.getViewAngle();
+	record.m_Eye= fileEntry.getCamera().eye();
+	record.m_Target= fileEntry.getCamera().target();
+	record.m_Up= fileEntry.getCamera().upVector();
+	record.m_DefaultUp= fileEntry.getCamera().defaultUpVector();
+
+	// The modified materials
+	QSet<GLC_Material*> materialsSet(fileEntry.modifiedMaterialSet());
+	QSet<GLC_Material *>::const_iterator iMaterial= materialsSet.constBegin();
+	while (iMaterial != materialsSet.constEnd())
+	{
+		MaterialRecord material;
+		material.m_Name= (*iMaterial)->name();
+		material.m_Colors << (*iMaterial)->ambientColor() << (*iMaterial)->diffuseColor();
+		material.m_Colors << (*iMaterial)->specularColor() << (*iMaterial)->emissiveColor();
+		material.m_Shininess= (*iMaterial)->shininess();
+		material.m_TextureFileName= (*iMaterial)->textureFileName();
+		record.m_Materials.append(material);
+		++iMaterial;
+	}
+
+	record.m_InvisibleInstances= fileEntry.listOfInvisibleInstanceName();
+
+	// The shaded instances by shader name
+	QList<GLC_Shader*> shaderList= OpenglView::shaderList();
+	const int size= shaderList.size();
+	for (int i= 0; i < size; ++i)
+	{
+		QList<QString> listOfShadedInstanceName(fileEntry.instanceNamesFromShadingGroup(shaderList[i]->id()));
+		if (!listOfShadedInstanceName.isEmpty())
+		{
+			record.m_ShadedInstances.insert(shaderList[i]->name(), listOfShadedInstanceName);
+		}
+	}
+
+	return record;
+}
+
+// Return the records of the given file entries
+QList<AlbumFile::EntryRecord> AlbumFile::entryRecords(const QList<FileEntry>& fileEntryList) const
+{
+	QList<EntryRecord> records;
+	const int max= fileEntryList.size();
+	for (int i = 0; i < max; ++i)
+	{
+		records.append(entryRecord(fileEntryList[i]));
+	}
+	return records;
+}
+
+// Return the file entry of the given record
+FileEntry AlbumFile::fileEntry(const EntryRecord& record) const
+{
+	// The model file name
+	QString fileName(record.m_FileName);
+
+	// Check if the file exists
+	if (!QFile::exists(fileName))
+	{
+		fileName= m_SessionPathDir.absoluteFilePath(record.m_RelativeFileName);
+	}
+
+	// The materials and their textures are created when the entry is loaded
+	return FileEntry(fileName, record);
+}
+
+// Read the records of the given opened album of any format
+QList<AlbumFile::EntryRecord> AlbumFile::readAlbumRecords(QIODevice* pDevice)
+{
+	if (albumFormat(pDevice) == BinaryFormat)
+	{
+		return readBinaryAlbum(pDevice);
+	}
+
+	Q_ASSERT(NULL == m_pStreamReader);
+	m_pStreamReader= new QXmlStreamReader(pDevice);
+	QList<EntryRecord> records;
+	try
+	{
+		records= readAlbum();
+	}
+	catch (GLC_Exception&)
+	{
+		delete m_pStreamReader;
+		m_pStreamReader= NULL;
+		throw;
+	}
 
 	delete m_pStreamReader;
 	m_pStreamReader= NULL;
 
-	return returnEntries;
+	return records;
 }
 
-// Save a session file
-void AlbumFile::saveAlbumFile(const QList<FileEntry>& fileEntryList, QFile* pSessionFile)
+// Write the given records in the given opened device in the given format
+void AlbumFile::writeAlbumRecords(const QList<EntryRecord>& records, QIODevice* pDevice, AlbumFormat format)
 {
-	Q_ASSERT(NULL == m_pStreamWriter);
-	// Open the Session file in write only mode
-	pSessionFile->open(QIODevice::WriteOnly);
-	// The Session Path Dir
-	m_SessionPathDir= QFileInfo(*pSessionFile).absoluteDir();
+	if (BinaryFormat == format)
+	{
+		writeBinaryAlbum(records, pDevice);
+	}
+	else
+	{
+		writeXmlAlbum(records, pDevice);
+	}
+}
 
-	m_pStreamWriter= new QXmlStreamWriter(pSessionFile);
+// Write the given records as an xml document
+void AlbumFile::writeXmlAlbum(const QList<EntryRecord>& records, QIODevice* pDevice)
+{
+	Q_ASSERT(NULL == m_pStreamWriter);
+	m_pStreamWriter= new QXmlStreamWriter(pDevice);
 	m_pStreamWriter->setAutoFormatting(true);
 	// Begin to write the xml document
 	m_pStreamWriter->writeStartDocument();
@@ -111,11 +579,10 @@ void AlbumFile::saveAlbumFile(const QList<FileEntry>& fileEntryList, QFile* pSes
 	writeHeader();
 	m_pStreamWriter->writeStartElement("Root");
 
-	// File Entry list processing
-	const int max= fileEntryList.size();
+	const int max= records.size();
 	for (int i = 0; i < max; ++i)
 	{
-		writeModel(fileEntryList[i]);
+		writeModel(records[i]);
 	}
 
 	// Finish the writing of document
@@ -123,22 +590,10 @@ void AlbumFile::saveAlbumFile(const QList<FileEntry>& fileEntryList, QFile* pSes
 	m_pStreamWriter->writeEndElement(); // Session
 	m_pStreamWriter->writeEndDocument();
 
-	// Close the session file
-	pSessionFile->close();
-
 	delete m_pStreamWriter;
 	m_pStreamWriter= NULL;
 }
 
-// Return album suffix
-QString AlbumFile::suffix()
-{
-	return m_Suffix;
-}
-
-//////////////////////////////////////////////////////////////////////
-// private member
-//////////////////////////////////////////////////////////////////////
 // Write the header of xml document
 void AlbumFile::writeHeader() const
 {
@@ -151,621 +606,608 @@ void AlbumFile::writeHeader() const
 }
 
 // Write a model in the current xml document
-void AlbumFile::writeModel(const FileEntry& fileEntry)
+void AlbumFile::writeModel(const EntryRecord& record)
 {
 	m_pStreamWriter->writeStartElement("Model");
-	m_pStreamWriter->writeAttribute("AFileName", fileEntry.getFileName());
-	m_pStreamWriter->writeAttribute("RFileName", m_SessionPathDir.relativeFilePath(fileEntry.getFileName()));
+	m_pStreamWriter->writeAttribute("AFileName", record.m_FileName);
+	m_pStreamWriter->writeAttribute("RFileName", record.m_RelativeFileName);
 
 	// Write camera element only if the file entry camera have been set
-	if (fileEntry.cameraIsSet())
+	if (record.m_CameraIsSet)
 	{
 		m_pStreamWriter->writeStartElement("Camera");
-		double angle= fileEntry.getViewAngle();
-		m_pStreamWriter->writeAttribute("Angle", QString::number(angle));
-
-		m_pStreamWriter->writeStartElement("Eye");
-		double x= fileEntry.getCamera().eye().x();
-		m_pStreamWriter->writeAttribute("x", QString::number(x));
-		double y= fileEntry.getCamera().eye().y();
-		m_pStreamWriter->writeAttribute("y", QString::number(y));
-		double z= fileEntry.getCamera().eye().z();
-		m_pStreamWriter->writeAttribute("z", QString::number(z));
-		m_pStreamWriter->writeEndElement(); // Eye
-
-		m_pStreamWriter->writeStartElement("Target");
-		x= fileEntry.getCamera().target().x();
-		m_pStreamWriter->writeAttribute("x", QString::number(x));
-		y= fileEntry.getCamera().target().y();
-		m_pStreamWriter->writeAttribute("y", QString::number(y));
-		z= fileEntry.getCamera().target().z();
-		m_pStreamWriter->writeAttribute("z", QString::number(z));
-		m_pStreamWriter->writeEndElement(); // Target
-
-		m_pStreamWriter->writeStartElement("Up");
-		x= fileEntry.getCamera().upVector().x();
-		m_pStreamWriter->writeAttribute("x", QString::number(x));
-		y= fileEntry.getCamera().upVector().y();
-		m_pStreamWriter->writeAttribute("y", QString::number(y));
-		z= fileEntry.getCamera().upVector().z();
-		m_pStreamWriter->writeAttribute("z", QString::number(z));
-		m_pStreamWriter->writeEndElement(); // Up
-
-		m_pStreamWriter->writeStartElement("DefaultUp");
-		x= fileEntry.getCamera().defaultUpVector().x();
-		m_pStreamWriter->writeAttribute("x", QString::number(x));
-		y= fileEntry.getCamera().defaultUpVector().y();
-		m_pStreamWriter->writeAttribute("y", QString::number(y));
-		z= fileEntry.getCamera().defaultUpVector().z();
-		m_pStreamWriter->writeAttribute("z", QString::number(z));
-		m_pStreamWriter->writeEndElement(); // Up
-
+		m_pStreamWriter->writeAttribute("Angle", QString::number(record.m_Angle));
+		writeVector("Eye", record.m_Eye);
+		writeVector("Target", record.m_Target);
+		writeVector("Up", record.m_Up);
+		writeVector("DefaultUp", record.m_DefaultUp);
 		m_pStreamWriter->writeEndElement(); // Camera
 	}
 
-	writeSetOfMaterials(fileEntry);
+	writeSetOfMaterials(record);
 
-	writeTheListOfInvisibleInstance(fileEntry);
+	writeTheListOfInvisibleInstance(record);
 
-	writeTheListOfShadedInstance(fileEntry);
+	writeTheListOfShadedInstance(record);
 
 	m_pStreamWriter->writeEndElement(); // Model
 
 }
 
-// Check if the session file is valid
-bool AlbumFile::checkAlbumFileValidity()
+// Write a vector element in the current xml document
+void AlbumFile::writeVector(const QString& name, const GLC_Vector3d& vector)
 {
-	// trying to find start Document of the xml file
-	goToElement("Album");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
+	m_pStreamWriter->writeStartElement(name);
+	m_pStreamWriter->writeAttribute("x", QString::number(vector.x()));
+	m_pStreamWriter->writeAttribute("y", QString::number(vector.y()));
+	m_pStreamWriter->writeAttribute("z", QString::number(vector.z()));
+	m_pStreamWriter->writeEndElement();
+}
 
-	// Trying to find the header of the album
-	goToElement("Header");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
+// Write the set of material
+void AlbumFile::writeSetOfMaterials(const EntryRecord& record)
+{
+	const int size= record.m_Materials.size();
+	m_pStreamWriter->writeStartElement("Materials");
+	m_pStreamWriter->writeAttribute("size", QString::number(size));
+	QList<QString> colorNameList;
+	colorNameList << "Ambiant" << "Diffuse" << "Specular" << "LightEmission";
+	for (int i= 0; i < size; ++i)
+	{
+		const MaterialRecord& material= record.m_Materials.at(i);
+		m_pStreamWriter->writeStartElement("Material");
+		m_pStreamWriter->writeAttribute("name", material.m_Name);
+
+		for (int j= 0; j < 4; ++j)
+		{
+			QColor currentColor(material.m_Colors[j]);
+			m_pStreamWriter->writeStartElement(colorNameList[j]);
+			m_pStreamWriter->writeAttribute("r", QString::number(currentColor.red()));
+			m_pStreamWriter->writeAttribute("g", QString::number(currentColor.green()));
+			m_pStreamWriter->writeAttribute("b", QString::number(currentColor.blue()));
+			m_pStreamWriter->writeAttribute("a", QString::number(currentColor.alpha()));
+			m_pStreamWriter->writeEndElement();
+		}
+		// Write material Shininess
+		m_pStreamWriter->writeStartElement("Shininess");
+		m_pStreamWriter->writeAttribute("value", QString::number(material.m_Shininess));
+		m_pStreamWriter->writeEndElement(); // Shininess
+
+		// Write material texture
+		m_pStreamWriter->writeStartElement("Texture");
+		m_pStreamWriter->writeAttribute("fileName", material.m_TextureFileName);
+		m_pStreamWriter->writeEndElement(); // Texture
+
+		m_pStreamWriter->writeEndElement(); // Material
+	}
+	m_pStreamWriter->writeEndElement(); // Materials
+}
 
-	// Cheking the validity of the header
-	// Trying to find application element
-	goToElement("Application");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
-	// Get Album version and check it
-	m_ReadedAlbumVersion= m_pStreamReader->attributes().value("Version").toString();
-	if ((m_ReadedAlbumVersion != "1.5") && (m_ReadedAlbumVersion != "2.0") && m_ReadedAlbumVersion != m_AlbumVersion) return false;
-	if (m_pStreamReader->hasError()) return false;
+// Write the list of invisible instance
+void AlbumFile::writeTheListOfInvisibleInstance(const EntryRecord& record)
+{
+	const int size= record.m_InvisibleInstances.size();
+	m_pStreamWriter->writeStartElement("InvisibleInstances");
+	m_pStreamWriter->writeAttribute("size", QString::number(size));
+	for (int i= 0; i < size; ++i)
+	{
+		m_pStreamWriter->writeStartElement("Instance");
+		m_pStreamWriter->writeAttribute("name", record.m_InvisibleInstances[i]);
+		m_pStreamWriter->writeEndElement(); // Instance
+	}
+	m_pStreamWriter->writeEndElement(); // InvisibleInstances
 
-	//Trying to find root element
-	goToElement("Root");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
+}
 
-	int NumberOfModels= 0;
-	// Trying to find model elements
-	while(!m_pStreamReader->atEnd())
+// Write the list of shaded instance
+void AlbumFile::writeTheListOfShadedInstance(const EntryRecord& record)
+{
+	m_pStreamWriter->writeStartElement("Shaders");
+	m_pStreamWriter->writeAttribute("size", QString::number(record.m_ShadedInstances.size()));
+	QHash<QString, QList<QString> >::const_iterator iShader= record.m_ShadedInstances.constBegin();
+	while (iShader != record.m_ShadedInstances.constEnd())
 	{
-		if ((QXmlStreamReader::StartElement == m_pStreamReader->readNext()) && (m_pStreamReader->name() == "Model"))
+		const QList<QString>& listOfShadedInstanceName= iShader.value();
+		const int shaderSize= listOfShadedInstanceName.size();
+		m_pStreamWriter->writeStartElement("Shader");
+		m_pStreamWriter->writeAttribute("name", iShader.key());
+		m_pStreamWriter->writeAttribute("size", QString::number(shaderSize));
+		for (int j= 0; j < shaderSize; ++j)
 		{
-			++NumberOfModels;
-			if (m_pStreamReader->attributes().value("AFileName").isEmpty()) return false;
-			if (m_pStreamReader->attributes().value("RFileName").isEmpty()) return false;
+			m_pStreamWriter->writeStartElement("Instance");
+			m_pStreamWriter->writeAttribute("name", listOfShadedInstanceName[j]);
+			m_pStreamWriter->writeEndElement(); // Instance
+		}
+		m_pStreamWriter->writeEndElement(); // Shader
+		++iShader;
+	}
+	m_pStreamWriter->writeEndElement(); // ShadedInstances
+}
 
-			//Trying to find Camera element
-			if (!checkCameraElementValidity())
-			{
-				qDebug() << "Camera invalid";
-				return false;
-			}
+// Read the album element and return its records
+QList<AlbumFile::EntryRecord> AlbumFile::readAlbum()
+{
+	if (!readNextChildElement() || (m_pStreamReader->name() != "Album"))
+	{
+		throwError("Album element not found");
+	}
 
-			if ((m_ReadedAlbumVersion == "2.0") || (m_ReadedAlbumVersion == m_AlbumVersion))
+	QList<EntryRecord> records;
+	bool hasHeader= false;
+	while (readNextChildElement())
+	{
+		if (m_pStreamReader->name() == "Header")
+		{
+			readHeader();
+			hasHeader= true;
+		}
+		else if (m_pStreamReader->name() == "Root")
+		{
+			// The version of the album is needed to read the models
+			if (!hasHeader) throwError("Header element not found");
+			while (readNextChildElement())
 			{
-				if (!checkMaterialsElementValidity())
+				if (m_pStreamReader->name() == "Model")
 				{
-					qDebug() << "Materials invalid";
-					return false;
+					records.append(readModel());
 				}
-
-				if (!checkInvisibleInstanceElementValidity())
+				else
 				{
-					qDebug() << "InvisibleInstances invalid";
-					return false;
+					skipCurrentElement();
 				}
-
-				if (!checkShadedInstanceElementValidity())
-				{
-					qDebug() << "ShadedInstances invalid";
-					return false;
-				}
-
 			}
 		}
-		if (m_pStreamReader->hasError()) return false;
+		else
+		{
+			skipCurrentElement();
+		}
 	}
-	if (0 == NumberOfModels) return false;
-
-	// Reset the xml stream reader to the begining
-	QIODevice* pDevice= m_pStreamReader->device();
-	pDevice->reset();
-	m_pStreamReader->setDevice(pDevice);
-
-	return true;
+	if (records.isEmpty()) throwError("The album has no model");
 
+	return records;
 }
 
-// Convert current model xml element to a FileEntry object
-FileEntry AlbumFile::currentModelToFileEnty()
+// Read the header element and check the album version
+void AlbumFile::readHeader()
 {
-	// The model file name
-	QString fileName(m_pStreamReader->attributes().value("AFileName").toString());
-
-	// Store the obsolute fileName in order to find image fullFilePath
-	m_CurrentModelAbsoluteDir= QFileInfo(fileName).absolutePath();
-
-	// Check if the file exists
-	if (!QFile::exists(fileName))
+	bool hasApplication= false;
+	while (readNextChildElement())
 	{
-		fileName= m_pStreamReader->attributes().value("RFileName").toString();
-		fileName= m_SessionPathDir.absoluteFilePath(fileName);
-	}
-
-	m_CurrentModelRealAbsoluteDir= QFileInfo(fileName).absolutePath();
-
-	// Go to camera element
-	bool modelHaveCamera= true;
-	if ((m_ReadedAlbumVersion == "2.0") || (m_ReadedAlbumVersion == m_AlbumVersion))
-	{
-		bool continu= true;
-		while(continu && !m_pStreamReader->atEnd() && !((QXmlStreamReader::StartElement == m_pStreamReader->tokenType()) && (m_pStreamReader->name() == "Camera")))
+		if (m_pStreamReader->name() == "Application")
 		{
-			if ((m_pStreamReader->name() == "Materials") && (QXmlStreamReader::StartElement == m_pStreamReader->tokenType()))
+			// Get Album version and check it
+			m_ReadedAlbumVersion= attribute("Version");
+			if ((m_ReadedAlbumVersion != "1.5") && (m_ReadedAlbumVersion != "2.0") && (m_ReadedAlbumVersion != m_AlbumVersion))
 			{
-				continu= false;
-				modelHaveCamera= false;
-			}
-			else
-			{
-				m_pStreamReader->readNext();
+				throwError(QString("Unsupported album version %1").arg(m_ReadedAlbumVersion));
 			}
+			hasApplication= true;
 		}
+		skipCurrentElement();
 	}
-	else
-	{
-		goToElement("Camera");
-	}
+	if (!hasApplication) throwError("Application element not found");
+}
 
-	GLC_Camera camera;
-	double angle= 30.0;
-	if (true == modelHaveCamera)
-	{
-		Q_ASSERT(!m_pStreamReader->atEnd());
-		// Camera Angle of view
-		angle= m_pStreamReader->attributes().value("Angle").toString().toDouble();
-
-		double x, y, z; // Tempory vector coordinate
-		// Go to camera Eye vector element
-		goToElement("Eye");
-		Q_ASSERT(!m_pStreamReader->atEnd());
-		x= m_pStreamReader->attributes().value("x").toString().toDouble();
-		y= m_pStreamReader->attributes().value("y").toString().toDouble();
-		z= m_pStreamReader->attributes().value("z").toString().toDouble();
-		GLC_Vector3d eye(x, y, z);
-
-		// Go to camera Target vector element
-		goToElement("Target");
-		Q_ASSERT(!m_pStreamReader->atEnd());
-		x= m_pStreamReader->attributes().value("x").toString().toDouble();
-		y= m_pStreamReader->attributes().value("y").toString().toDouble();
-		z= m_pStreamReader->attributes().value("z").toString().toDouble();
-		GLC_Vector3d target(x, y, z);
-
-		// Go to camera Up vector element
-		goToElement("Up");
-		Q_ASSERT(!m_pStreamReader->atEnd());
-		x= m_pStreamReader->attributes().value("x").toString().toDouble();
-		y= m_pStreamReader->attributes().value("y").toString().toDouble();
-		z= m_pStreamReader->attributes().value("z").toString().toDouble();
-		GLC_Vector3d up(x, y, z);
-
-		if (m_AlbumVersion == m_ReadedAlbumVersion)
+// Read the current model element and return its record
+AlbumFile::EntryRecord AlbumFile::readModel()
+{
+	// The model file names
+	EntryRecord record;
+	record.m_FileName= attribute("AFileName");
+	record.m_RelativeFileName= attribute("RFileName");
+	record.m_CameraIsSet= false;
+	record.m_Angle= 30.0;
+
+	bool hasMaterials= false;
+	bool hasInvisibleInstances= false;
+	bool hasShaders= false;
+	while (readNextChildElement())
+	{
+		if (m_pStreamReader->name() == "Camera")
+		{
+			readCamera(&record);
+		}
+		else if (m_pStreamReader->name() == "Materials")
+		{
+			record.m_Materials+= readSetOfMaterials();
+			hasMaterials= true;
+		}
+		else if (m_pStreamReader->name() == "InvisibleInstances")
+		{
+			record.m_InvisibleInstances= readTheListOfInvisibleInstance();
+			hasInvisibleInstances= true;
+		}
+		else if (m_pStreamReader->name() == "Shaders")
 		{
-			// Go to camera Default Up vector element
-			goToElement("DefaultUp");
-			Q_ASSERT(!m_pStreamReader->atEnd());
-			x= m_pStreamReader->attributes().value("x").toString().toDouble();
-			y= m_pStreamReader->attributes().value("y").toString().toDouble();
-			z= m_pStreamReader->attributes().value("z").toString().toDouble();
-			GLC_Vector3d defaultUp(x, y, z);
-			camera.setDefaultUpVector(defaultUp);
+			record.m_ShadedInstances= readTheListOfShadedInstance();
+			hasShaders= true;
 		}
 		else
 		{
-			camera.setDefaultUpVector(glc::Z_AXIS);
+			skipCurrentElement();
 		}
-
-		// The model camera
-		camera.setCam(eye, target, up);
 	}
 
-
-	QSet<GLC_Material*> materialSet;
-	QList<QString> invisibleInstanceName;
-	QHash<QString, QList<QString> > listOfShadedInstance;
-	if ((m_ReadedAlbumVersion == "2.0") || (m_ReadedAlbumVersion == m_AlbumVersion))
+	// The camera is optional since the version 2.0 which adds the materials and instances lists
+	if (m_ReadedAlbumVersion == "1.5")
 	{
-		materialSet= readSetOfMaterials();
-		invisibleInstanceName= readTheListOfInvisibleInstance();
-		listOfShadedInstance= readTheListOfShadedInstance();
+		if (!record.m_CameraIsSet) throwError("Camera element not found in model " + record.m_FileName);
+	}
+	else if (!(hasMaterials && hasInvisibleInstances && hasShaders))
+	{
+		throwError("Materials, InvisibleInstances or Shaders element not found in model " + record.m_FileName);
 	}
 
-	return FileEntry(fileName, camera, angle, materialSet, invisibleInstanceName, listOfShadedInstance);
+	return record;
 }
 
-// Return a Set of GLC_Material
-QSet<GLC_Material*> AlbumFile::readSetOfMaterials()
+// Read the current camera element in the given record
+void AlbumFile::readCamera(EntryRecord* pRecord)
 {
-	QSet<GLC_Material*> materialSet;
-
-	// Go to camera Materials element
-	goToElement("Materials");
-	Q_ASSERT(!m_pStreamReader->atEnd());
-	int materialsSize= m_pStreamReader->attributes().value("size").toString().toInt();
-	for (int i= 0; i < materialsSize; ++i)
+	// Camera Angle of view
+	pRecord->m_Angle= doubleAttribute("Angle");
+
+	pRecord->m_DefaultUp= GLC_Vector3d(glc::Z_AXIS);
+	bool hasEye= false;
+	bool hasTarget= false;
+	bool hasUp= false;
+	while (readNextChildElement())
 	{
-		goToElement("Material");
-		Q_ASSERT(!m_pStreamReader->atEnd());
-		// Create the material
-		GLC_Material* pMaterial= new GLC_Material();
-
-		QString materialName(m_pStreamReader->attributes().value("name").toString());
-		pMaterial->setName(materialName);
-
-		// Go Material Color Element
-		QVector<QColor> materialColors;
-		QVector<QString> materialColorsName;
-		materialColorsName << "Ambiant" << "Diffuse" << "Specular" << "LightEmission";
-		for (int j= 0; j < 4; ++j)
+		if (m_pStreamReader->name() == "Eye")
+		{
+			pRecord->m_Eye= readVector();
+			hasEye= true;
+		}
+		else if (m_pStreamReader->name() == "Target")
+		{
+			pRecord->m_Target= readVector();
+			hasTarget= true;
+		}
+		else if (m_pStreamReader->name() == "Up")
+		{
+			pRecord->m_Up= readVector();
+			hasUp= true;
+		}
+		else if (m_pStreamReader->name() == "DefaultUp")
 		{
-			goToElement(materialColorsName[j]);
-			Q_ASSERT(!m_pStreamReader->atEnd());
-			QColor currentColor;
-			currentColor.setRed(m_pStreamReader->attributes().value("r").toString().toInt());
-			currentColor.setGreen(m_pStreamReader->attributes().value("g").toString().toInt());
-			currentColor.setBlue(m_pStreamReader->attributes().value("b").toString().toInt());
-			currentColor.setAlpha(m_pStreamReader->attributes().value("a").toString().toInt());
-			materialColors << currentColor;
+			// Since album version 2.1
+			pRecord->m_DefaultUp= readVector();
 		}
+		else
+		{
+			skipCurrentElement();
+		}
+	}
+	if (!(hasEye && hasTarget && hasUp)) throwError("Eye, Target or Up element not found in camera");
 
-		// Go to Material shininess element
-		goToElement("Shininess");
-		Q_ASSERT(!m_pStreamReader->atEnd());
-		float materialShininess= m_pStreamReader->attributes().value("value").toString().toFloat();
+	pRecord->m_CameraIsSet= true;
+}
 
-		// Go to Material Texture element
-		goToElement("Texture");
-		Q_ASSERT(!m_pStreamReader->atEnd());
-		QString textureFileName(m_pStreamReader->attributes().value("fileName").toString());
+// Read the current vector element
+GLC_Vector3d AlbumFile::readVector()
+{
+	const double x= doubleAttribute("x");
+	const double y= doubleAttribute("y");
+	const double z= doubleAttribute("z");
+	skipCurrentElement();
 
-		// Set the material color attributes
-		pMaterial->setAmbientColor(materialColors[0]);
-		pMaterial->setDiffuseColor(materialColors[1]);
-		pMaterial->setSpecularColor(materialColors[2]);
-		pMaterial->setEmissiveColor(materialColors[3]);
-		pMaterial->setShininess(materialShininess);
-		pMaterial->setOpacity(materialColors[1].alphaF());
+	return GLC_Vector3d(x, y, z);
+}
 
-		if (!textureFileName.isEmpty())
+// Return the list of material records
+QList<AlbumFile::MaterialRecord> AlbumFile::readSetOfMaterials()
+{
+	const int size= intAttribute("size");
+	QList<MaterialRecord> materials;
+	while (readNextChildElement())
+	{
+		if (m_pStreamReader->name() == "Material")
 		{
-			qDebug() << "Texture File Name Before : " << textureFileName;
-			qDebug() << "Current model path : " << m_CurrentModelAbsoluteDir.absolutePath();
-			//if (not QFileInfo(textureFileName).exists())
-			{
-				textureFileName= m_CurrentModelAbsoluteDir.relativeFilePath(textureFileName);
-				qDebug() << "Relative texture file path : " << textureFileName;
-				textureFileName= m_CurrentModelRealAbsoluteDir.absoluteFilePath(textureFileName);
-				qDebug() << "Texture File Name " << textureFileName;
-
-			}
-			if (QFileInfo(textureFileName).exists())
-			{
-				pMaterial->setTexture(new GLC_Texture(textureFileName));
-			}
+			materials.append(readMaterial());
 		}
+		else
+		{
+			skipCurrentElement();
+		}
+	}
+	checkSize(size, materials.size(), "Materials");
 
-		// Add the material to the list
-		materialSet.insert(pMaterial);
+	return materials;
+}
+
+// Read the current material element and return its record
+AlbumFile::MaterialRecord AlbumFile::readMaterial()
+{
+	MaterialRecord material;
+	material.m_Name= attribute("name");
+
+	// The material colors, shininess and texture
+	QStringList materialColorsName;
+	materialColorsName << "Ambiant" << "Diffuse" << "Specular" << "LightEmission";
+	material.m_Colors.resize(materialColorsName.size());
+	QVector<bool> materialColorsRead(materialColorsName.size(), false);
+	material.m_Shininess= 0.0f;
+	while (readNextChildElement())
+	{
+		const int colorIndex= materialColorsName.indexOf(m_pStreamReader->name().toString());
+		if (colorIndex >= 0)
+		{
+			material.m_Colors[colorIndex]= QColor(intAttribute("r"), intAttribute("g"), intAttribute("b"), intAttribute("a"));
+			materialColorsRead[colorIndex]= true;
+		}
+		else if (m_pStreamReader->name() == "Shininess")
+		{
+			material.m_Shininess= static_cast<float>(doubleAttribute("value"));
+		}
+		else if (m_pStreamReader->name() == "Texture")
+		{
+			material.m_TextureFileName= m_pStreamReader->attributes().value("fileName").toString();
+		}
+		skipCurrentElement();
 	}
+	if (materialColorsRead.contains(false)) throwError("Color element not found in material " + material.m_Name);
 
-	return materialSet;
+	return material;
 }
 
 // Read the list of invisible instance
 QList<QString> AlbumFile::readTheListOfInvisibleInstance()
 {
-
-	QList<QString> listOfInvisibleInstanceName;
-
-	// Go to InvisibleInstances element
-	goToElement("InvisibleInstances");
-	Q_ASSERT(!m_pStreamReader->atEnd());
-	int size= m_pStreamReader->attributes().value("size").toString().toInt();
-	for (int i= 0; i < size; ++i)
-	{
-		goToElement("Instance");
-		Q_ASSERT(!m_pStreamReader->atEnd());
-		QString instanceName(m_pStreamReader->attributes().value("name").toString());
-		listOfInvisibleInstanceName << instanceName;
-		m_pStreamReader->readNext();
-	}
-	return listOfInvisibleInstanceName;
+	return readInstanceNames();
 }
+
 // Read the list of shaded instance
 QHash<QString, QList<QString> > AlbumFile::readTheListOfShadedInstance()
 {
+	const int size= intAttribute("size");
 	QHash<QString, QList<QString> > result;
-	// Go to shader element
-	goToElement("Shaders");
-	Q_ASSERT(!m_pStreamReader->atEnd());
-	const int size= m_pStreamReader->attributes().value("size").toString().toInt();
-	for (int i= 0; i < size; ++i)
+	while (readNextChildElement())
 	{
-		goToElement("Shader");
-		Q_ASSERT(!m_pStreamReader->atEnd());
-		QString shaderName(m_pStreamReader->attributes().value("name").toString());
-		const int shaderSize= m_pStreamReader->attributes().value("size").toString().toInt();
-		QList<QString> instanceList;
-		for (int j= 0; j < shaderSize; ++j)
+		if (m_pStreamReader->name() == "Shader")
+		{
+			const QString shaderName(attribute("name"));
+			result.insert(shaderName, readInstanceNames());
+		}
+		else
 		{
-			goToElement("Instance");
-			Q_ASSERT(!m_pStreamReader->atEnd());
-			QString instanceName(m_pStreamReader->attributes().value("name").toString());
-			instanceList << instanceName;
-			m_pStreamReader->readNext();
+			skipCurrentElement();
 		}
-		result.insert(shaderName, instanceList);
-		m_pStreamReader->readNext();
 	}
+	checkSize(size, result.size(), "Shaders");
 
 	return result;
 }
 
-// Write the set of material
-void AlbumFile::writeSetOfMaterials(const FileEntry& fileEntry)
+// Read the names of the instance elements of the current element, their number must match its size attribute
+QList<QString> AlbumFile::readInstanceNames()
 {
-	QSet<GLC_Material*> materialsSet(fileEntry.modifiedMaterialSet());
+	const QString elementName(m_pStreamReader->name().toString());
+	const int size= intAttribute("size");
+	QList<QString> instanceNames;
+	while (readNextChildElement())
+	{
+		if (m_pStreamReader->name() == "Instance")
+		{
+			instanceNames << attribute("name");
+		}
+		skipCurrentElement();
+	}
+	checkSize(size, instanceNames.size(), elementName);
 
-	const int size= materialsSet.size();
-	m_pStreamWriter->writeStartElement("Materials");
-	m_pStreamWriter->writeAttribute("size", QString::number(size));
-	if (!materialsSet.isEmpty())
-	{
-        QSet<GLC_Material *>::const_iterator i = materialsSet.constBegin();
-        while (i != materialsSet.constEnd())
-        {
-			m_pStreamWriter->writeStartElement("Material");
-			m_pStreamWriter->writeAttribute("name", (*i)->name());
-
-			QList<QColor> colorList;
-			colorList.append((*i)->ambientColor());
-			colorList.append((*i)->diffuseColor());
-			colorList.append((*i)->specularColor());
-			colorList.append((*i)->emissiveColor());
-			QList<QString> colorNameList;
-			colorNameList << "Ambiant" << "Diffuse" << "Specular" << "LightEmission";
-			for (int j= 0; j < 4; ++j)
-			{
-				QColor currentColor(colorList[j]);
-				m_pStreamWriter->writeStartElement(colorNameList[j]);
-				m_pStreamWriter->writeAttribute("r", QString::number(currentColor.red()));
-				m_pStreamWriter->writeAttribute("g", QString::number(currentColor.green()));
-				m_pStreamWriter->writeAttribute("b", QString::number(currentColor.blue()));
-				m_pStreamWriter->writeAttribute("a", QString::number(currentColor.alpha()));
-				m_pStreamWriter->writeEndElement();
-			}
-			// Write material Shininess
-			m_pStreamWriter->writeStartElement("Shininess");
-			m_pStreamWriter->writeAttribute("value", QString::number((*i)->shininess()));
-			m_pStreamWriter->writeEndElement(); // Shininess
+	return instanceNames;
+}
 
-			// Write material texture
-			m_pStreamWriter->writeStartElement("Texture");
-			m_pStreamWriter->writeAttribute("fileName", (*i)->textureFileName());
-			m_pStreamWriter->writeEndElement(); // Texture
+// Go to the next child element of the current element, return false at the end of the current element
+bool AlbumFile::readNextChildElement()
+{
+	while (!m_pStreamReader->atEnd())
+	{
+		const QXmlStreamReader::TokenType tokenType= m_pStreamReader->readNext();
+		if (QXmlStreamReader::StartElement == tokenType) return true;
+		if (QXmlStreamReader::EndElement == tokenType) return false;
+	}
+	throwError("Unexpected end of document");
+	return false;
+}
 
-			m_pStreamWriter->writeEndElement(); // Material
-            ++i;
-        }
+// Go to the end of the current element
+void AlbumFile::skipCurrentElement()
+{
+	while (readNextChildElement())
+	{
+		skipCurrentElement();
 	}
-	m_pStreamWriter->writeEndElement(); // Materials
 }
 
-// Write the list of invisible instance
-void AlbumFile::writeTheListOfInvisibleInstance(const FileEntry& fileEntry)
+// Return the given attribute of the current element, throw an exception if it is empty
+QString AlbumFile::attribute(const QString& name)
 {
-	QList<QString> listOfInvisibleInstance(fileEntry.listOfInvisibleInstanceName());
-	const int size= listOfInvisibleInstance.size();
-	m_pStreamWriter->writeStartElement("InvisibleInstances");
-	m_pStreamWriter->writeAttribute("size", QString::number(size));
+	const QString value(m_pStreamReader->attributes().value(name).toString());
+	if (value.isEmpty())
+	{
+		throwError(QString("Attribute %1 not found in %2 element").arg(name).arg(m_pStreamReader->name().toString()));
+	}
+	return value;
+}
+
+// Return the given real attribute of the current element, throw an exception if it is not valid
+double AlbumFile::doubleAttribute(const QString& name)
+{
+	bool ok= false;
+	const double value= attribute(name).toDouble(&ok);
+	if (!ok) throwError(QString("Attribute %1 of %2 element is not a number").arg(name).arg(m_pStreamReader->name().toString()));
+	return value;
+}
+
+// Return the given integer attribute of the current element, throw an exception if it is not valid
+int AlbumFile::intAttribute(const QString& name)
+{
+	bool ok= false;
+	const int value= attribute(name).toInt(&ok);
+	if (!ok) throwError(QString("Attribute %1 of %2 element is not an integer").arg(name).arg(m_pStreamReader->name().toString()));
+	return value;
+}
+
+// Throw an exception if the given number of read elements does not match the given size attribute
+void AlbumFile::checkSize(int size, int count, const QString& elementName)
+{
+	if (size != count)
+	{
+		throwError(QString("%1 element has %2 children instead of its size %3").arg(elementName).arg(count).arg(size));
+	}
+}
+
+// Throw an exception with the given message and the current line number
+void AlbumFile::throwError(const QString& message)
+{
+	QString errorMessage("Album file not valid! Line ");
+	errorMessage+= QString::number(m_pStreamReader->lineNumber()) + QString(" : ");
+	// An XML error prevails
+	errorMessage+= m_pStreamReader->hasError() ? m_pStreamReader->errorString() : message;
+	GLC_Exception e(errorMessage);
+	throw e;
+}
+
+// Write the given records as a binary album
+void AlbumFile::writeBinaryAlbum(const QList<EntryRecord>& records, QIODevice* pDevice)
+{
+	// The records are serialized first, the index gives their location
+	QList<QByteArray> recordsData;
+	const int size= records.size();
 	for (int i= 0; i < size; ++i)
 	{
-		m_pStreamWriter->writeStartElement("Instance");
-		m_pStreamWriter->writeAttribute("name", listOfInvisibleInstance[i]);
-		m_pStreamWriter->writeEndElement(); // Instance
+		recordsData.append(encodeRecord(records.at(i)));
 	}
-	m_pStreamWriter->writeEndElement(); // InvisibleInstances
 
+	// The index size doesn't depend on the record offsets
+	const qint64 recordsOffset= binaryAlbumHeaderSize + binaryIndex(records, recordsData, 0).size();
+	const QByteArray indexData(binaryIndex(records, recordsData, recordsOffset));
+
+	QDataStream stream(pDevice);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream.writeRawData(binaryAlbumMagic, binaryAlbumMagicSize);
+	stream << binaryAlbumVersion << static_cast<quint32>(size);
+	stream.writeRawData(indexData.constData(), indexData.size());
+	for (int i= 0; i < size; ++i)
+	{
+		stream.writeRawData(recordsData.at(i).constData(), recordsData.at(i).size());
+	}
 }
 
-// Write the list of shaded instance
-void AlbumFile::writeTheListOfShadedInstance(const FileEntry& fileEntry)
+// Return the binary index of the given records and their data starting at the given offset
+QByteArray AlbumFile::binaryIndex(const QList<EntryRecord>& records, const QList<QByteArray>& recordsData, qint64 offset)
 {
-	QList<GLC_Shader*> shaderList= OpenglView::shaderList();
-	const int size= shaderList.size();
-	m_pStreamWriter->writeStartElement("Shaders");
-	m_pStreamWriter->writeAttribute("size", QString::number(fileEntry.numberOfUsedShadingGroup()));
+	QByteArray indexData;
+	QDataStream stream(&indexData, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setVersion(QDataStream::Qt_4_6);
+	const int size= records.size();
 	for (int i= 0; i < size; ++i)
 	{
-		QList<QString> listOfShadedInstanceName(fileEntry.instanceNamesFromShadingGroup(shaderList[i]->id()));
-		if (!listOfShadedInstanceName.isEmpty())
-		{
-			const int shaderSize= listOfShadedInstanceName.size();
-			m_pStreamWriter->writeStartElement("Shader");
-			m_pStreamWriter->writeAttribute("name", shaderList[i]->name());
-			m_pStreamWriter->writeAttribute("size", QString::number(shaderSize));
-			for (int j= 0; j < shaderSize; ++j)
-			{
-				m_pStreamWriter->writeStartElement("Instance");
-				m_pStreamWriter->writeAttribute("name", listOfShadedInstanceName[j]);
-				m_pStreamWriter->writeEndElement(); // Instance
-			}
-			m_pStreamWriter->writeEndElement(); // Shader
-		}
+		const EntryRecord& record= records.at(i);
+		stream << record.m_FileName << record.m_RelativeFileName << static_cast<quint8>(record.m_CameraIsSet);
+		stream << static_cast<quint32>(record.m_Materials.size());
+		stream << static_cast<quint32>(record.m_InvisibleInstances.size());
+		stream << static_cast<quint32>(record.m_ShadedInstances.size());
+		stream << static_cast<quint64>(offset) << static_cast<quint64>(recordsData.at(i).size());
+		offset+= recordsData.at(i).size();
 	}
-	m_pStreamWriter->writeEndElement(); // ShadedInstances
+	return indexData;
 }
 
-// Check validity of camera element
-bool AlbumFile::checkCameraElementValidity()
+// Write the given record in the given binary stream
+void AlbumFile::writeBinaryRecord(QDataStream& stream, const EntryRecord& record)
 {
-	//Trying to find Camera element
-	if ((m_ReadedAlbumVersion == "2.0") || (m_ReadedAlbumVersion == m_AlbumVersion))
+	// The camera has a fixed layout, even if it is not set
+	stream << static_cast<quint8>(record.m_CameraIsSet) << record.m_Angle;
+	QList<GLC_Vector3d> vectors;
+	vectors << record.m_Eye << record.m_Target << record.m_Up << record.m_DefaultUp;
+	for (int i= 0; i < vectors.size(); ++i)
 	{
-		while(!m_pStreamReader->atEnd() && !((QXmlStreamReader::StartElement == m_pStreamReader->tokenType()) && (m_pStreamReader->name() == "Camera")))
-		{
-			if ((m_pStreamReader->name() == "Materials") && (QXmlStreamReader::StartElement == m_pStreamReader->tokenType()))
-			{
-				qDebug() << m_pStreamReader->name().toString();
-				// the camera of model has not been set
-				return true;
-			}
-			m_pStreamReader->readNext();
-		}
+		stream << vectors.at(i).x() << vectors.at(i).y() << vectors.at(i).z();
 	}
-	else
+
+	// The materials
+	stream << static_cast<quint32>(record.m_Materials.size());
+	for (int i= 0; i < record.m_Materials.size(); ++i)
 	{
-		goToElement("Camera");
-	}
-
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
-	if (m_pStreamReader->attributes().value("Angle").isEmpty()) return false;
-
-	//Trying to find Eye element
-	goToElement("Eye");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
-	if (m_pStreamReader->attributes().value("x").isEmpty()) return false;
-	if (m_pStreamReader->attributes().value("y").isEmpty()) return false;
-	if (m_pStreamReader->attributes().value("z").isEmpty()) return false;
-
-	//Trying to find Target element
-	goToElement("Target");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
-	if (m_pStreamReader->attributes().value("x").isEmpty()) return false;
-	if (m_pStreamReader->attributes().value("y").isEmpty()) return false;
-	if (m_pStreamReader->attributes().value("z").isEmpty()) return false;
-
-	//Trying to find Up element
-	goToElement("Up");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
-	if (m_pStreamReader->attributes().value("x").isEmpty()) return false;
-	if (m_pStreamReader->attributes().value("y").isEmpty()) return false;
-	if (m_pStreamReader->attributes().value("z").isEmpty()) return false;
-
-	return true;
-
-}
-// Check validity of materials element
-bool AlbumFile::checkMaterialsElementValidity()
-{
-	goToElement("Materials");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
-	if (m_pStreamReader->attributes().value("size").isEmpty()) return false;
-	const int size= m_pStreamReader->attributes().value("size").toString().toInt();
-	int i= 0;
-	for (i= 0; i < size; ++i)
-	{
-		goToElement("Material");
-		if (m_pStreamReader->atEnd()) return false;
-		if (m_pStreamReader->hasError()) return false;
-		if (m_pStreamReader->attributes().value("name").isEmpty()) return false;
-		QVector<QString> materialColorsName;
-		materialColorsName << "Ambiant" << "Diffuse" << "Specular" << "LightEmission";
+		const MaterialRecord& material= record.m_Materials.at(i);
+		stream << material.m_Name;
 		for (int j= 0; j < 4; ++j)
 		{
-			goToElement(materialColorsName[j]);
-			if (m_pStreamReader->atEnd()) return false;
-			if (m_pStreamReader->hasError()) return false;
-			QColor currentColor;
-			if (m_pStreamReader->attributes().value("r").isEmpty()) return false;
-			if (m_pStreamReader->attributes().value("g").isEmpty()) return false;
-			if (m_pStreamReader->attributes().value("b").isEmpty()) return false;
-			if (m_pStreamReader->attributes().value("a").isEmpty()) return false;
+			const QColor& color= material.m_Colors.at(j);
+			stream << static_cast<quint8>(color.red()) << static_cast<quint8>(color.green());
+			stream << static_cast<quint8>(color.blue()) << static_cast<quint8>(color.alpha());
 		}
+		stream << static_cast<double>(material.m_Shininess) << material.m_TextureFileName;
 	}
-	return true;
-}
 
-// Check validity of Invisible Instance element
-bool AlbumFile::checkInvisibleInstanceElementValidity()
-{
-	goToElement("InvisibleInstances");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
-	if (m_pStreamReader->attributes().value("size").isEmpty()) return false;
-	const int size= m_pStreamReader->attributes().value("size").toString().toInt();
-	int i= 0;
-	for (i= 0; i < size; ++i)
+	// The invisible instances
+	stream << static_cast<quint32>(record.m_InvisibleInstances.size());
+	for (int i= 0; i < record.m_InvisibleInstances.size(); ++i)
 	{
-		goToElement("Instance");
-		if (m_pStreamReader->atEnd()) return false;
-		if (m_pStreamReader->hasError()) return false;
-		if (m_pStreamReader->attributes().value("name").isEmpty()) return false;
-		m_pStreamReader->readNext();
+		stream << record.m_InvisibleInstances.at(i);
+	}
+
+	// The shading groups
+	stream << static_cast<quint32>(record.m_ShadedInstances.size());
+	QHash<QString, QList<QString> >::const_iterator iShader= record.m_ShadedInstances.constBegin();
+	while (iShader != record.m_ShadedInstances.constEnd())
+	{
+		stream << iShader.key() << static_cast<quint32>(iShader.value().size());
+		for (int i= 0; i < iShader.value().size(); ++i)
+		{
+			stream << iShader.value().at(i);
+		}
+		++iShader;
 	}
-	return true;
 }
 
-// Check validity of Shaded Instance element
-bool AlbumFile::checkShadedInstanceElementValidity()
+// Read the records of the given opened binary album
+QList<AlbumFile::EntryRecord> AlbumFile::readBinaryAlbum(QIODevice* pDevice)
 {
-	// Go to shader element
-	goToElement("Shaders");
-	if (m_pStreamReader->atEnd()) return false;
-	if (m_pStreamReader->hasError()) return false;
-	if (m_pStreamReader->attributes().value("size").isEmpty()) return false;
-	const int size= m_pStreamReader->attributes().value("size").toString().toInt();
+	const QList<IndexEntry> index(readAlbumIndex(pDevice));
+	if (index.isEmpty()) throwBinaryError("The album has no model", pDevice->pos());
+
+	// The records follow the index in the same order
+	QList<EntryRecord> records;
+	const int size= index.size();
 	for (int i= 0; i < size; ++i)
 	{
-		goToElement("Shader");
-		if (m_pStreamReader->atEnd()) return false;
-		if (m_pStreamReader->hasError()) return false;
-		if (m_pStreamReader->attributes().value("name").isEmpty()) return false;
-		if (m_pStreamReader->attributes().value("size").isEmpty()) return false;
-		QString shaderName(m_pStreamReader->attributes().value("name").toString());
-		const int shaderSize= m_pStreamReader->attributes().value("size").toString().toInt();
-		for (int j= 0; j < shaderSize; ++j)
-		{
-			goToElement("Instance");
-			if (m_pStreamReader->atEnd()) return false;
-			if (m_pStreamReader->hasError()) return false;
-			if (m_pStreamReader->attributes().value("name").isEmpty()) return false;
-			m_pStreamReader->readNext();
-		}
-		m_pStreamReader->readNext();
+		records.append(readAlbumRecord(pDevice, index.at(i)));
 	}
-	return true;
+	return records;
 }
 
-// Go to Element
-void AlbumFile::goToElement(const QString& elementName)
+// Read a vector from the given binary stream
+GLC_Vector3d AlbumFile::readBinaryVector(QDataStream& stream)
 {
-	while(!m_pStreamReader->atEnd() && !((QXmlStreamReader::StartElement == m_pStreamReader->tokenType()) && (m_pStreamReader->name() == elementName)))
+	double x, y, z;
+	stream >> x >> y >> z;
+	return GLC_Vector3d(x, y, z);
+}
+
+// Read a list of names from the given binary stream
+QList<QString> AlbumFile::readBinaryNames(QDataStream& stream)
+{
+	quint32 size= 0;
+	stream >> size;
+	QList<QString> names;
+	for (quint32 i= 0; (i < size) && (stream.status() == QDataStream::Ok); ++i)
 	{
-		m_pStreamReader->readNext();
+		QString name;
+		stream >> name;
+		names.append(name);
 	}
+	return names;
 }
 
+// Throw an exception with the given message and the given binary album offset
+void AlbumFile::throwBinaryError(const QString& message, qint64 offset)
+{
+	QString errorMessage("Binary album file not valid! Offset ");
+	errorMessage+= QString::number(offset) + QString(" : ") + message;
+	GLC_Exception e(errorMessage);
+	throw e;
+}
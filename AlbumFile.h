@@ -26,18 +26,39 @@
 #define SESSIONFILE_H_
 
 #include "FileEntry.h"
+#include "AlbumRecord.h"
 #include <QFile>
 #include <QList>
 #include <QString>
+#include <QDataStream>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 
 //////////////////////////////////////////////////////////////////////
 //! \class Sessionfile
 /*! \brief SessionFile : The session file reader and loader*/
+
+/*! An album is saved in XML or in a compact binary format.\n
+ *  The binary album starts with an index of its entries giving their file names,
+ *  their counts of materials and instances and the location of their record.
+ *  The entries can be listed from the index without decoding their state.
+ *  Both formats are read and written through EntryRecord, which allows lossless
+ *  conversion between them.*/
 //////////////////////////////////////////////////////////////////////
 class AlbumFile
 {
+public:
+	//! The album file formats
+	enum AlbumFormat
+	{
+		XmlFormat,
+		BinaryFormat
+	};
+
+	typedef AlbumMaterialRecord MaterialRecord;
+	typedef AlbumEntryRecord EntryRecord;
+	typedef AlbumIndexEntry IndexEntry;
+
 //////////////////////////////////////////////////////////////////////
 /*! @name Constructor / Destructor */
 //@{
@@ -59,11 +80,75 @@ public:
 	 */
 	QList<FileEntry> loadAlbumFile(QFile*);
 
+	//! Load an album of any format from the given opened device
+	/* The relative model file names are relative to the given album directory.
+	 * The album is validated while it is read, an exception with the line
+	 * number is thrown if it is not valid.
+	 * The state of the entries is applied when they are loaded, only the index
+	 * of a binary album file is read
+	 */
+	QList<FileEntry> loadAlbumFile(QIODevice*, const QDir&);
+
 	//! Save a session file
 	/*
 	 * The file must exist and be in write mode
 	 */
-	void saveAlbumFile(const QList<FileEntry>&, QFile*);
+	void saveAlbumFile(const QList<FileEntry>&, QFile*, AlbumFormat format= XmlFormat);
+
+	//! Save a session in the given opened device
+	/*
+	 * The model file names are relative to the given album directory
+	 */
+	void saveAlbumFile(const QList<FileEntry>&, QIODevice*, const QDir&, AlbumFormat format= XmlFormat);
+
+	//! Convert the given album file into the given album file of the given format
+	/* The relative model file names are updated to the target album directory.
+	 * An exception is thrown if the source album is not valid
+	 */
+	void convertAlbumFile(QFile*, QFile*, AlbumFormat);
+
+	//! Convert the given opened album of the first directory into the given device in the given format
+	/* The relative model file names are updated from the first directory to the second one
+	 */
+	void convertAlbumFile(QIODevice*, const QDir&, QIODevice*, const QDir&, AlbumFormat);
+
+	//! Return the index of the given opened binary album
+	/* An exception is thrown if the device is not a valid binary album
+	 */
+	static QList<IndexEntry> readAlbumIndex(QIODevice*);
+
+	//! Return the record of the given index entry of the given opened binary album
+	static EntryRecord readAlbumRecord(QIODevice*, const IndexEntry&);
+
+	//! Return the record of the given index entry of the given binary album file
+	static EntryRecord readAlbumRecord(const QString&, const IndexEntry&);
+
+	//! Return the record of the given file entry
+	/* The model file name is made relative to the directory of the last loaded or saved album
+	 */
+	EntryRecord entryRecord(const FileEntry&) const;
+
+	//! Return the given record encoded in the binary album format
+	static QByteArray encodeRecord(const EntryRecord&);
+
+	//! Return the record of the given model file name decoded from the given binary album data
+	/* An exception is thrown if the data is not valid
+	 */
+	static EntryRecord decodeRecord(const QByteArray&, const QString&);
+
+	//! Return the camera of the given decoded record
+	static GLC_Camera camera(const EntryRecord&);
+
+	//! Create the materials of the given decoded record of the given model file
+	/* The textures are searched relatively to the model file
+	 */
+	static QSet<GLC_Material*> createMaterials(const EntryRecord&, const QString&);
+
+	//! Return the format of the given opened album
+	static AlbumFormat albumFormat(QIODevice*);
+
+	//! Return the format of the given album file
+	static AlbumFormat albumFormat(const QString&);
 
 	//! Return album suffix
 	static QString suffix();
@@ -75,17 +160,56 @@ private:
 	//! Write the header of xml document
 	void writeHeader() const;
 
+	//! Return the records of the given file entries
+	QList<EntryRecord> entryRecords(const QList<FileEntry>&) const;
+
+	//! Return the file entry of the given record
+	FileEntry fileEntry(const EntryRecord&) const;
+
+	//! Read the records of the given opened album of any format
+	QList<EntryRecord> readAlbumRecords(QIODevice*);
+
+	//! Write the given records in the given opened device in the given format
+	void writeAlbumRecords(const QList<EntryRecord>&, QIODevice*, AlbumFormat);
+
+	//! Write the given records as an xml document
+	void writeXmlAlbum(const QList<EntryRecord>&, QIODevice*);
+
 	//! Write a model in the current xml document
-	void writeModel(const FileEntry&);
+	void writeModel(const EntryRecord&);
+
+	//! Write a vector element in the current xml document
+	void writeVector(const QString&, const GLC_Vector3d&);
+
+	//! Write the set of material
+	void writeSetOfMaterials(const EntryRecord&);
+
+	//! Write the list of invisible instance
+	void writeTheListOfInvisibleInstance(const EntryRecord&);
+
+	//! Write the list of shaded instance
+	void writeTheListOfShadedInstance(const EntryRecord&);
+
+	//! Read the album element and return its records
+	QList<EntryRecord> readAlbum();
+
+	//! Read the header element and check the album version
+	void readHeader();
 
-	//! Check if the Album file is valid
-	bool checkAlbumFileValidity();
+	//! Read the current model element and return its record
+	EntryRecord readModel();
 
-	//! Convert current model xml element to a FileEntry object
-	FileEntry currentModelToFileEnty();
+	//! Read the current camera element in the given record
+	void readCamera(EntryRecord*);
 
-	//! Return a Set of GLC_Material
-	QSet<GLC_Material*> readSetOfMaterials();
+	//! Read the current vector element
+	GLC_Vector3d readVector();
+
+	//! Return the list of material records
+	QList<MaterialRecord> readSetOfMaterials();
+
+	//! Read the current material element and return its record
+	MaterialRecord readMaterial();
 
 	//! Read the list of invisible instance
 	QList<QString> readTheListOfInvisibleInstance();
@@ -93,33 +217,50 @@ private:
 	//! Read the list of shaded instance
 	QHash<QString, QList<QString> > readTheListOfShadedInstance();
 
-	//! Write the set of material
-	void writeSetOfMaterials(const FileEntry&);
+	//! Read the names of the instance elements of the current element, their number must match its size attribute
+	QList<QString> readInstanceNames();
 
-	//! Write the list of invisible instance
-	void writeTheListOfInvisibleInstance(const FileEntry&);
+	//! Throw an exception if the given number of read elements does not match the given size attribute
+	void checkSize(int size, int count, const QString&);
 
-	//! Write the list of shaded instance
-	void writeTheListOfShadedInstance(const FileEntry&);
+	//! Go to the next child element of the current element, return false at the end of the current element
+	bool readNextChildElement();
+
+	//! Go to the end of the current element
+	void skipCurrentElement();
+
+	//! Return the given attribute of the current element, throw an exception if it is empty
+	QString attribute(const QString&);
 
-	//! Check validity of camera element
-	bool checkCameraElementValidity();
+	//! Return the given real attribute of the current element, throw an exception if it is not valid
+	double doubleAttribute(const QString&);
 
-	//! Check validity of materials element
-	bool checkMaterialsElementValidity();
+	//! Return the given integer attribute of the current element, throw an exception if it is not valid
+	int intAttribute(const QString&);
 
-	//! Check validity of Invisible Instance element
-	bool checkInvisibleInstanceElementValidity();
+	//! Throw an exception with the given message and the current line number
+	void throwError(const QString&);
 
-	//! Check validity of Shaded Instance element
-	bool checkShadedInstanceElementValidity();
+	//! Write the given records as a binary album
+	static void writeBinaryAlbum(const QList<EntryRecord>&, QIODevice*);
 
-	//! Go to Element
-	void goToElement(const QString&);
+	//! Return the binary index of the given records and their data starting at the given offset
+	static QByteArray binaryIndex(const QList<EntryRecord>&, const QList<QByteArray>&, qint64);
 
-	//! Return true if the end of specified element is not reached
-	inline bool endElementNotReached(const QString& element)
-	{return !m_pStreamReader->atEnd() && !(m_pStreamReader->isEndElement() && (m_pStreamReader->name() == element));}
+	//! Write the given record in the given binary stream
+	static void writeBinaryRecord(QDataStream&, const EntryRecord&);
+
+	//! Read the records of the given opened binary album
+	static QList<EntryRecord> readBinaryAlbum(QIODevice*);
+
+	//! Read a vector from the given binary stream
+	static GLC_Vector3d readBinaryVector(QDataStream&);
+
+	//! Read a list of names from the given binary stream
+	static QList<QString> readBinaryNames(QDataStream&);
+
+	//! Throw an exception with the given message and the given binary album offset
+	static void throwBinaryError(const QString&, qint64);
 
 
 //////////////////////////////////////////////////////////////////////
@@ -144,12 +285,6 @@ private:
 	//! The Readed Album Version
 	QString m_ReadedAlbumVersion;
 
-	//! The current model absolute Dir
-	QDir m_CurrentModelAbsoluteDir;
-
-	//! The current model real absolute Dir
-	QDir m_CurrentModelRealAbsoluteDir;
-
 };
 
 #endif /*SESSIONFILE_H_*/
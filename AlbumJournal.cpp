@@ -0,0 +1,368 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+#include "AlbumJournal.h"
+#include "AlbumFile.h"
+#include <GLC_Exception>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QObject>
+
+// The first bytes of an album journal
+static const char journalMagic[]= "GLCJOURN";
+static const int journalMagicSize= 8;
+
+// The album journal format version
+static const quint32 journalVersion= 1;
+
+// The size of the journal header : magic and version
+static const qint64 journalHeaderSize= journalMagicSize + sizeof(quint32);
+
+// The suffix of the journal file name
+static const QString journalSuffix(".journal");
+
+AlbumJournal::AlbumJournal()
+: m_JournalFile()
+, m_JournaledRecords()
+, m_ModifiedEntries()
+, m_CompactSize(0)
+, m_ErrorString()
+{
+
+}
+
+AlbumJournal::~AlbumJournal()
+{
+	close();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+// Return the journal file name of the given album file
+QString AlbumJournal::journalFileName(const QString& albumFileName)
+{
+	return albumFileName + journalSuffix;
+}
+
+// Return true if the given album file has a journal of changes
+bool AlbumJournal::hasChanges(const QString& albumFileName)
+{
+	return QFileInfo(journalFileName(albumFileName)).size() > journalHeaderSize;
+}
+
+// Return the last journaled record of each model file name of the given album file
+QHash<QString, AlbumEntryRecord> AlbumJournal::readChanges(const QString& albumFileName, QString* pError)
+{
+	QHash<QString, AlbumEntryRecord> records;
+	QFile journalFile(journalFileName(albumFileName));
+	if (!journalFile.open(QIODevice::ReadOnly))
+	{
+		*pError= QObject::tr("Failed to read the album journal :") + QString("\n") + journalFile.fileName() + QString("\n") + journalFile.errorString();
+		return records;
+	}
+	readJournal(&journalFile, &records, pError);
+	journalFile.close();
+
+	return records;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+// Open the journal of the given album file, return false on error
+bool AlbumJournal::open(const QString& albumFileName, bool discardInvalid)
+{
+	close();
+	m_ErrorString.clear();
+	m_JournalFile.setFileName(journalFileName(albumFileName));
+
+	// The changes are appended to the valid part of a journal, a torn or corrupted end is dropped
+	qint64 validSize= 0;
+	if (hasChanges(albumFileName))
+	{
+		QString error;
+		if (m_JournalFile.open(QIODevice::ReadOnly))
+		{
+			QHash<QString, AlbumEntryRecord> records;
+			validSize= readJournal(&m_JournalFile, &records, &error);
+			m_JournalFile.close();
+		}
+		else
+		{
+			error= m_JournalFile.errorString();
+		}
+
+		// The changes of a journal which can not be read are only lost with the agreement of the user
+		if ((0 == validSize) && !discardInvalid)
+		{
+			m_ErrorString= QObject::tr("The album journal can not be read :") + QString("\n") + m_JournalFile.fileName() + QString("\n") + error;
+			return false;
+		}
+	}
+
+	bool success= false;
+	if (validSize > 0)
+	{
+		success= m_JournalFile.resize(validSize) && m_JournalFile.open(QIODevice::WriteOnly | QIODevice::Append);
+	}
+	else if (m_JournalFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		QDataStream stream(&m_JournalFile);
+		stream.setByteOrder(QDataStream::LittleEndian);
+		stream.setVersion(QDataStream::Qt_4_6);
+		writeHeader(stream);
+		success= m_JournalFile.flush();
+	}
+
+	if (!success)
+	{
+		m_ErrorString= QObject::tr("Failed to open the album journal :") + QString("\n") + m_JournalFile.fileName() + QString("\n") + m_JournalFile.errorString();
+		m_JournalFile.close();
+	}
+	m_CompactSize= m_JournalFile.size();
+	return success;
+}
+
+// Close the journal, the journal file is kept for the recovery
+void AlbumJournal::close()
+{
+	if (m_JournalFile.isOpen())
+	{
+		m_JournalFile.close();
+	}
+	m_JournaledRecords.clear();
+	m_ModifiedEntries.clear();
+}
+
+// Append the changes of the modified entries of the given album, return the number of appended changes
+int AlbumJournal::append(const FileEntryHash& fileEntryHash)
+{
+	if (!m_JournalFile.isOpen()) return 0;
+
+	QDataStream stream(&m_JournalFile);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setVersion(QDataStream::Qt_4_6);
+	int numberOfChanges= 0;
+
+	// Only the modified entries are encoded, an album state which can not be read is not replaced
+	QSet<GLC_uint>::const_iterator iId= m_ModifiedEntries.constBegin();
+	while (iId != m_ModifiedEntries.constEnd())
+	{
+		FileEntryHash::const_iterator iEntry= fileEntryHash.constFind(*iId);
+		if ((iEntry != fileEntryHash.constEnd()) && iEntry.value().isLoaded() && iEntry.value().albumRecordError().isEmpty())
+		{
+			const QByteArray recordData(encodedRecord(iEntry.value()));
+			if (m_JournaledRecords.value(*iId) != recordData)
+			{
+				writeChange(stream, iEntry.value().getFileName(), recordData);
+				m_JournaledRecords.insert(*iId, recordData);
+				++numberOfChanges;
+			}
+		}
+		++iId;
+	}
+	m_ModifiedEntries.clear();
+
+	if (numberOfChanges > 0)
+	{
+		m_JournalFile.flush();
+	}
+	return numberOfChanges;
+}
+
+// Rewrite the journal with the last change of each entry, return false on error
+bool AlbumJournal::compact()
+{
+	if (!m_JournalFile.isOpen()) return false;
+	m_JournalFile.flush();
+
+	// The last change of each model file name is read back from the journal
+	QHash<QString, AlbumEntryRecord> records;
+	QString error;
+	QFile journalFile(m_JournalFile.fileName());
+	if (journalFile.open(QIODevice::ReadOnly))
+	{
+		readJournal(&journalFile, &records, &error);
+		journalFile.close();
+	}
+	else
+	{
+		error= journalFile.errorString();
+	}
+	if (!error.isEmpty())
+	{
+		m_ErrorString= QObject::tr("Failed to compact the album journal :") + QString("\n") + error;
+		return false;
+	}
+
+	QByteArray changes;
+	QDataStream changesStream(&changes, QIODevice::WriteOnly);
+	changesStream.setByteOrder(QDataStream::LittleEndian);
+	changesStream.setVersion(QDataStream::Qt_4_6);
+	QHash<QString, AlbumEntryRecord>::const_iterator iRecord= records.constBegin();
+	while (iRecord != records.constEnd())
+	{
+		writeChange(changesStream, iRecord.key(), AlbumFile::encodeRecord(iRecord.value()));
+		++iRecord;
+	}
+
+	// The changes are written back in one block after the header, the album file is not modified
+	const bool success= m_JournalFile.resize(journalHeaderSize) && m_JournalFile.seek(journalHeaderSize)
+			&& (m_JournalFile.write(changes) == changes.size()) && m_JournalFile.flush();
+	if (!success)
+	{
+		m_ErrorString= QObject::tr("Failed to compact the album journal :") + QString("\n") + m_JournalFile.errorString();
+	}
+	m_CompactSize= m_JournalFile.size();
+	return success;
+}
+
+// Set the state of the given entry just loaded as the reference of its next changes
+void AlbumJournal::setReference(const FileEntry& fileEntry)
+{
+	// The reference of an entry loaded again is its last journaled state
+	if (m_JournalFile.isOpen() && !m_JournaledRecords.contains(fileEntry.id()))
+	{
+		m_JournaledRecords.insert(fileEntry.id(), encodedRecord(fileEntry));
+	}
+}
+
+// Clear the journal, the given album entries are saved in the album file
+void AlbumJournal::clear(const FileEntryHash& fileEntryHash)
+{
+	if (!m_JournalFile.isOpen()) return;
+
+	m_JournalFile.resize(journalHeaderSize);
+	m_JournalFile.seek(journalHeaderSize);
+	m_CompactSize= journalHeaderSize;
+
+	// The saved state of the loaded entries is the reference of their next changes
+	m_JournaledRecords.clear();
+	m_ModifiedEntries.clear();
+	FileEntryHash::const_iterator iEntry= fileEntryHash.constBegin();
+	while (iEntry != fileEntryHash.constEnd())
+	{
+		if (iEntry.value().isLoaded())
+		{
+			m_JournaledRecords.insert(iEntry.key(), encodedRecord(iEntry.value()));
+		}
+		++iEntry;
+	}
+}
+
+// Remove the journal of the given album file
+void AlbumJournal::remove(const QString& albumFileName)
+{
+	QFile::remove(journalFileName(albumFileName));
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+// Write the journal header in the given stream
+void AlbumJournal::writeHeader(QDataStream& stream)
+{
+	stream.writeRawData(journalMagic, journalMagicSize);
+	stream << journalVersion;
+}
+
+// Write the change of the given model file name and encoded record in the given stream
+void AlbumJournal::writeChange(QDataStream& stream, const QString& fileName, const QByteArray& recordData)
+{
+	QByteArray change;
+	QDataStream changeStream(&change, QIODevice::WriteOnly);
+	changeStream.setByteOrder(QDataStream::LittleEndian);
+	changeStream.setVersion(QDataStream::Qt_4_6);
+	changeStream << fileName << recordData;
+
+	stream << static_cast<quint32>(change.size()) << qChecksum(change.constData(), change.size());
+	stream.writeRawData(change.constData(), change.size());
+}
+
+// Read the changes of the given open journal file in the given hash, return the size of its valid part
+qint64 AlbumJournal::readJournal(QFile* pJournalFile, QHash<QString, AlbumEntryRecord>* pRecords, QString* pError)
+{
+	QDataStream stream(pJournalFile);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setVersion(QDataStream::Qt_4_6);
+	char magic[journalMagicSize];
+	quint32 version= 0;
+	if ((stream.readRawData(magic, journalMagicSize) != journalMagicSize) || (qstrncmp(magic, journalMagic, journalMagicSize) != 0))
+	{
+		*pError= QObject::tr("Not an album journal :") + QString("\n") + pJournalFile->fileName();
+		return 0;
+	}
+	stream >> version;
+	if (version != journalVersion)
+	{
+		*pError= QObject::tr("Unsupported album journal version : %1").arg(version);
+		return 0;
+	}
+
+	// The changes are read up to the first incomplete one, which is the torn end of the journal
+	qint64 validSize= journalHeaderSize;
+	int numberOfChanges= 0;
+	while (!stream.atEnd())
+	{
+		quint32 changeSize= 0;
+		quint16 checksum= 0;
+		stream >> changeSize >> checksum;
+		if ((stream.status() != QDataStream::Ok) || (changeSize > (pJournalFile->size() - pJournalFile->pos()))) break;
+		QByteArray change(changeSize, '\0');
+		if (stream.readRawData(change.data(), changeSize) != static_cast<int>(changeSize)) break;
+		if (qChecksum(change.constData(), change.size()) != checksum)
+		{
+			*pError= QObject::tr("The album journal is corrupted after %1 changes").arg(numberOfChanges);
+			break;
+		}
+
+		QDataStream changeStream(change);
+		changeStream.setByteOrder(QDataStream::LittleEndian);
+		changeStream.setVersion(QDataStream::Qt_4_6);
+		QString fileName;
+		QByteArray recordData;
+		changeStream >> fileName >> recordData;
+		try
+		{
+			pRecords->insert(fileName, AlbumFile::decodeRecord(recordData, fileName));
+		}
+		catch (GLC_Exception& e)
+		{
+			*pError= QObject::tr("The album journal change of %1 is not valid :").arg(fileName) + QString("\n") + QString(e.what());
+			break;
+		}
+		validSize= pJournalFile->pos();
+		++numberOfChanges;
+	}
+
+	return validSize;
+}
+
+// Return the encoded state of the given file entry
+QByteArray AlbumJournal::encodedRecord(const FileEntry& fileEntry)
+{
+	return AlbumFile::encodeRecord(AlbumFile().entryRecord(fileEntry));
+}
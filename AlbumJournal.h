@@ -0,0 +1,176 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+#ifndef ALBUMJOURNAL_H_
+#define ALBUMJOURNAL_H_
+
+#include "FileEntry.h"
+#include "AlbumRecord.h"
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QByteArray>
+#include <QDataStream>
+
+//////////////////////////////////////////////////////////////////////
+//! \class AlbumJournal
+/*! \brief AlbumJournal : The append only journal of the album changes*/
+
+/*! The journal is a file next to the album where the state of the
+ *  entries modified by the user (camera, materials, visibility and shading)
+ *  is appended when it changes since its last journaled state, so the
+ *  successive changes of an entry between two appends are coalesced.
+ *  Each change is a record of the binary album format with its size and
+ *  checksum : a journal torn by a crash is read up to its last complete
+ *  change.
+ *  The journal is compacted to the last change of each entry when it grows,
+ *  it is cleared when the album is saved, and it is replayed when an album
+ *  which was not saved is opened again.*/
+//////////////////////////////////////////////////////////////////////
+class AlbumJournal
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Default constructor
+	AlbumJournal();
+
+	//! Destructor
+	virtual ~AlbumJournal();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*!\name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if the journal is open
+	inline bool isOpen() const
+	{return m_JournalFile.isOpen();}
+
+	//! Return the size of the journal file
+	inline qint64 size() const
+	{return m_JournalFile.size();}
+
+	//! Return the size of the journal file when it was opened or compacted
+	inline qint64 compactSize() const
+	{return m_CompactSize;}
+
+	//! Return the error of the last open or compaction
+	inline QString errorString() const
+	{return m_ErrorString;}
+
+	//! Return the journal file name of the given album file
+	static QString journalFileName(const QString&);
+
+	//! Return true if the given album file has a journal of changes
+	static bool hasChanges(const QString&);
+
+	//! Return the last journaled record of each model file name of the given album file
+	/* The end of a torn journal is ignored, the given error is set if the journal
+	 * is not valid or if its changes are only partly read
+	 */
+	static QHash<QString, AlbumEntryRecord> readChanges(const QString&, QString* pError);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*!\name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Open the journal of the given album file, return false on error
+	/* The changes already journaled are kept. A journal which can not be read
+	 * is only replaced if the given flag is true, else the error string is set
+	 */
+	bool open(const QString&, bool discardInvalid= false);
+
+	//! Close the journal, the journal file is kept for the recovery
+	void close();
+
+	//! Mark the entry of the given id as modified, its state is encoded on the next append
+	inline void setModified(GLC_uint id)
+	{m_ModifiedEntries.insert(id);}
+
+	//! Append the changes of the modified entries of the given album, return the number of appended changes
+	int append(const FileEntryHash&);
+
+	//! Rewrite the journal with the last change of each entry, return false on error
+	bool compact();
+
+	//! Set the state of the given entry just loaded as the reference of its next changes
+	void setReference(const FileEntry&);
+
+	//! Clear the journal, the given album entries are saved in the album file
+	void clear(const FileEntryHash&);
+
+	//! Remove the journal of the given album file
+	static void remove(const QString&);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Write the journal header in the given stream
+	static void writeHeader(QDataStream&);
+
+	//! Write the change of the given model file name and encoded record in the given stream
+	static void writeChange(QDataStream&, const QString&, const QByteArray&);
+
+	//! Read the changes of the given open journal file in the given hash, return the size of its valid part
+	/* Return 0 if the file is not a journal of this version, the given error is set
+	 * if the journal is not valid or if its changes are only partly read
+	 */
+	static qint64 readJournal(QFile*, QHash<QString, AlbumEntryRecord>*, QString* pError);
+
+	//! Return the encoded state of the given file entry
+	static QByteArray encodedRecord(const FileEntry&);
+
+//////////////////////////////////////////////////////////////////////
+// private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The journal file
+	QFile m_JournalFile;
+
+	//! The last journaled state of each entry id
+	QHash<GLC_uint, QByteArray> m_JournaledRecords;
+
+	//! The id of the entries modified since the last append
+	QSet<GLC_uint> m_ModifiedEntries;
+
+	//! The size of the journal file when it was opened or compacted
+	qint64 m_CompactSize;
+
+	//! The error of the last open or compaction
+	QString m_ErrorString;
+};
+
+#endif /* ALBUMJOURNAL_H_ */
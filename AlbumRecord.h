@@ -0,0 +1,89 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+#ifndef ALBUMRECORD_H_
+#define ALBUMRECORD_H_
+
+#include <GLC_Vector3d>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <QColor>
+
+//! The saved state of a material of an album entry
+struct AlbumMaterialRecord
+{
+	QString m_Name;
+	//! Ambient, diffuse, specular and emissive colors
+	QVector<QColor> m_Colors;
+	float m_Shininess;
+	QString m_TextureFileName;
+};
+
+//! The index entry of an entry of a binary album
+struct AlbumIndexEntry
+{
+	QString m_FileName;
+	QString m_RelativeFileName;
+	bool m_CameraIsSet;
+	int m_NumberOfMaterials;
+	int m_NumberOfInvisibleInstances;
+	int m_NumberOfShadingGroups;
+	//! The record location from the beginning of the album
+	qint64 m_Offset;
+	qint64 m_Size;
+};
+
+//! The saved state of an album entry
+/*! The record of a binary album entry can be listed from the index only,
+ *  its state is then decoded on demand from the album file.*/
+struct AlbumEntryRecord
+{
+	//! Return true if the state of this record is decoded
+	inline bool isDecoded() const
+	{return m_AlbumFileName.isEmpty();}
+
+	QString m_FileName;
+	QString m_RelativeFileName;
+	bool m_CameraIsSet;
+	double m_Angle;
+	GLC_Vector3d m_Eye;
+	GLC_Vector3d m_Target;
+	GLC_Vector3d m_Up;
+	GLC_Vector3d m_DefaultUp;
+	QList<AlbumMaterialRecord> m_Materials;
+	QList<QString> m_InvisibleInstances;
+	QHash<QString, QList<QString> > m_ShadedInstances;
+
+	//! The binary album of the record while its state is not decoded
+	QString m_AlbumFileName;
+	//! The index entry of the record in its binary album
+	AlbumIndexEntry m_IndexEntry;
+	//! The error of the decoding of the record, which is then kept undecoded
+	QString m_DecodeError;
+};
+
+#endif /* ALBUMRECORD_H_ */
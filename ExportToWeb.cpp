@@ -25,8 +25,11 @@
 #include "ExportToWeb.h"
 #include "opengl_view/OpenglView.h"
 #include "AlbumFile.h"
+#include "opengl_view/CapturePipeline.h"
+#include "FileCopyEngine.h"
 #include <QXmlStreamWriter>
 #include <QFile>
+#include <QTime>
 
 ExportToWeb::ExportToWeb(QList<FileEntry>& fileEntrySortedList, OpenglView* pOpenglView)
 : m_FileEntrySortedList(fileEntrySortedList)
@@ -42,6 +45,7 @@ ExportToWeb::ExportToWeb(QList<FileEntry>& fileEntrySortedList, OpenglView* pOpe
 , m_LinkThumbnailToModel(false)
 , m_ViewImageModelInformations(true)
 , m_LinkImageToModel(true)
+, m_Incremental(false)
 , m_TargetPath()
 , m_pHtmlWriter(NULL)
 , m_QProgressDialog(tr("Exporting to Web, Please Wait...  "), tr("Cancel"), 0, 10)
@@ -51,6 +55,16 @@ ExportToWeb::ExportToWeb(QList<FileEntry>& fileEntrySortedList, OpenglView* pOpe
 , m_HtmlImagePagePathName("Images_Pages")
 , m_3dModelPathName("3dModels")
 , m_BackgroundColor()
+, m_ImageQuality(100)
+, m_RenderingTime(0)
+, m_EncodingTime(0)
+, m_WritingTime(0)
+, m_WaitingTime(0)
+, m_CopyTime(0)
+, m_ExportTime(0)
+, m_CopiedSize(0)
+, m_CopyMethods()
+, m_RemovedOrphans(0)
 {
 
 }
@@ -60,6 +74,31 @@ ExportToWeb::~ExportToWeb()
 	delete m_pHtmlWriter;
 }
 
+//////////////////////////////////////////////////////////////////////
+// Public Get function
+//////////////////////////////////////////////////////////////////////
+// Return the time spent by each stage of the last export
+QString ExportToWeb::summary() const
+{
+	QString summary(tr("Rendering : %1 s").arg(m_RenderingTime / 1000.0, 0, 'f', 1));
+	summary+= QString("\n") + tr("Encoding (worker threads) : %1 s").arg(m_EncodingTime / 1000.0, 0, 'f', 1);
+	summary+= QString("\n") + tr("Writing (worker threads) : %1 s").arg(m_WritingTime / 1000.0, 0, 'f', 1);
+	summary+= QString("\n") + tr("Waiting for worker threads : %1 s").arg(m_WaitingTime / 1000.0, 0, 'f', 1);
+	if (m_CopiedSize > 0)
+	{
+		const double copyTime= qMax(1, m_CopyTime) / 1000.0;
+		summary+= QString("\n") + tr("Copying models : %1 s (%2/s)").arg(m_CopyTime / 1000.0, 0, 'f', 1).arg(FileCopyEngine::sizeToString(static_cast<qint64>(m_CopiedSize / copyTime)));
+		summary+= QString("\n") + m_CopyMethods;
+	}
+	if (m_RemovedOrphans > 0)
+	{
+		summary+= QString("\n") + tr("Removed models files : %1").arg(m_RemovedOrphans);
+	}
+	summary+= QString("\n") + tr("Total : %1 s").arg(m_ExportTime / 1000.0, 0, 'f', 1);
+
+	return summary;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Public Set function
 //////////////////////////////////////////////////////////////////////
@@ -80,6 +119,9 @@ void ExportToWeb::setImageSize(const QSize& size)
 // Export Album to web
 bool ExportToWeb::exportToWeb(const QString& targetPath, const QString& albumName)
 {
+	QTime exportTime;
+	exportTime.start();
+
 	// Update progress dailog parameters
 	int maxProgress= m_FileEntrySortedList.size();
 	if (m_ExportAlbumAndModel)
@@ -123,6 +165,7 @@ bool ExportToWeb::exportToWeb(const QString& targetPath, const QString& albumNam
 		return false;
 	}
 
+	m_ExportTime= exportTime.elapsed();
 
 	m_QProgressDialog.cancel();
 	return true;
@@ -138,6 +181,12 @@ void ExportToWeb::exportAlbumAndModel(const bool exportAlbumAndModel)
 	m_ExportAlbumAndModel= exportAlbumAndModel;
 }
 
+// Export only the new and changed models
+void ExportToWeb::incrementalExport(bool incremental)
+{
+	m_Incremental= incremental;
+}
+
 // View Thumbnail model name
 void ExportToWeb::viewThumbnailModelName(bool view)
 {
@@ -174,24 +223,34 @@ bool ExportToWeb::createSubDirectories()
 	Q_ASSERT(QFileInfo(m_TargetPath).isDir());
 	QDir baseDir(m_TargetPath);
 	// Create thumbnail subDir
-	result= result && baseDir.mkdir(m_ThumbnailPathName);
+	result= result && createSubDirectory(baseDir, m_ThumbnailPathName);
 
 	// Test if images must be exported
 	if (!(m_ExportAlbumAndModel && m_LinkThumbnailToModel))
 	{
-		result= result && baseDir.mkdir(m_ImagePathName);
-		result= result && baseDir.mkdir(m_HtmlImagePagePathName);
+		result= result && createSubDirectory(baseDir, m_ImagePathName);
+		result= result && createSubDirectory(baseDir, m_HtmlImagePagePathName);
 	}
 
 	// Test if album and images must be exported
 	if (m_ExportAlbumAndModel)
 	{
-		result= result && baseDir.mkdir(m_3dModelPathName);
+		result= result && createSubDirectory(baseDir, m_3dModelPathName);
 	}
 
 	return result;
 }
 
+// Create the given sub directory of the given directory, an existing one is reused by incremental export
+bool ExportToWeb::createSubDirectory(const QDir& baseDir, const QString& name) const
+{
+	if (m_Incremental && QFileInfo(baseDir.filePath(name)).isDir())
+	{
+		return true;
+	}
+	return baseDir.mkdir(name);
+}
+
 // Make SnapShots
 bool ExportToWeb::makeSnapShots()
 {
@@ -209,16 +268,33 @@ bool ExportToWeb::makeSnapShots()
 	double savAngle= m_pOpenglView->getViewAngle();
 	GLC_World savWorld(m_pOpenglView->getWorld());
 
+	// Thumbnails are derived from the images if they are exported : one render by model
+	const QSize renderSize(saveImage ? m_ImageSize : m_ThumbnailSize);
+
 	// Go to snapshot mode
-	m_pOpenglView->captureMode(m_ThumbnailSize, true, m_BackgroundColor);
-	m_QProgressDialog.setLabelText(tr("Creating thumbnails, Please Wait...  "));
-	// Save thumbnails
+	m_pOpenglView->captureMode(renderSize, !saveImage, m_BackgroundColor);
+	if (saveImage)
+	{
+		m_QProgressDialog.setLabelText(tr("Creating images, Please Wait...  "));
+	}
+	else
+	{
+		m_QProgressDialog.setLabelText(tr("Creating thumbnails, Please Wait...  "));
+	}
+
+	// Images are encoded and saved and thumbnails downscaled by worker threads
+	m_pOpenglView->makeCurrent();
+	CapturePipeline capturePipeline(m_pOpenglView->frameBufferPoolHandle(), "JPG", m_ImageQuality);
+	m_RenderingTime= 0;
+	QTime renderingTime;
+
 	QList<FileEntry>::iterator iEntry= m_FileEntrySortedList.begin();
 	int currentEntryIndex= 0;
 	while (iEntry != m_FileEntrySortedList.constEnd())
 	{
 		// Update Progress dialog and chek fo cancellation
-		m_QProgressDialog.setValue(++m_CurrentProgressDialog);
+		m_CurrentProgressDialog+= saveImage ? 2 : 1;
+		m_QProgressDialog.setValue(m_CurrentProgressDialog);
 		QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
 		if (m_QProgressDialog.wasCanceled())
 		{
@@ -226,60 +302,38 @@ bool ExportToWeb::makeSnapShots()
 		}
 
 		// Load current entry world into the view
+		renderingTime.start();
 		m_pOpenglView->clear();
 		GLC_World newWorld((*iEntry).getWorld());
 		m_pOpenglView->add(newWorld);
 
 		// Set view camera and view angle
-		m_pOpenglView->setCameraAndAngle((*iEntry).getCamera(), (*iEntry).getViewAngle());
+		m_pOpenglView->setEntryCamera(*iEntry);
 
 		// Take ScreenShot
 		QImage currentImage(m_pOpenglView->takeScreenshot());
+		m_RenderingTime+= renderingTime.elapsed();
 
-		// Built thumbnail file name
-		QString currentImageFileName= thumbnailPathName + createImageName(currentEntryIndex);
-		result= result && currentImage.save(currentImageFileName, "JPG", 100);
+		// Built thumbnail and image file name
+		const QString currentImageName(createImageName(currentEntryIndex));
+		if (saveImage)
+		{
+			capturePipeline.save(currentImage, imagePathName + currentImageName);
+			capturePipeline.saveScaled(currentImage, thumbnailPathName + currentImageName, m_ThumbnailSize);
+		}
+		else
+		{
+			capturePipeline.save(currentImage, thumbnailPathName + currentImageName);
+		}
 
 		++currentEntryIndex;
 		++iEntry;
 	}
-	if (saveImage)
-	{
-		m_QProgressDialog.setLabelText(tr("Creating images, Please Wait...  "));
-		m_pOpenglView->captureMode(m_ImageSize, false, m_BackgroundColor);
-		iEntry= m_FileEntrySortedList.begin();
-		currentEntryIndex= 0;
-
-		while (iEntry != m_FileEntrySortedList.constEnd())
-		{
-			// Update Progress dialog and chek fo cancellation
-			m_QProgressDialog.setValue(++m_CurrentProgressDialog);
-			QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-			if (m_QProgressDialog.wasCanceled())
-			{
-				return false;
-			}
-
-			// Load current entry world into the view
-			m_pOpenglView->clear();
-			GLC_World newWorld((*iEntry).getWorld());
-			m_pOpenglView->add(newWorld);
-
-			// Set view camera and view angle
-			m_pOpenglView->setCameraAndAngle((*iEntry).getCamera(), (*iEntry).getViewAngle());
-
-			// Take ScreenShot
-			QImage currentImage(m_pOpenglView->takeScreenshot());
-
-			// Built Image file name
-			QString currentImageFileName= imagePathName + createImageName(currentEntryIndex);
-
-			result= result && currentImage.save(currentImageFileName, "JPG", 100);
-
-			++currentEntryIndex;
-			++iEntry;
-		}
-	}
+	m_pOpenglView->makeCurrent();
+	result= capturePipeline.finish() && result;
+	m_EncodingTime= capturePipeline.encodingTime();
+	m_WritingTime= capturePipeline.writingTime();
+	m_WaitingTime= capturePipeline.waitingTime();
 
 	// Retore view world
 	m_pOpenglView->clear();
@@ -326,7 +380,7 @@ bool ExportToWeb::exportAlbumAndModels()
 
 				// Create new Base Path
 				const QString newBasePath(targetPath + QDir::separator() + QFileInfo(entryFileName).baseName());
-				if (!baseDir.mkdir(QFileInfo(entryFileName).baseName()))
+				if (!createSubDirectory(baseDir, QFileInfo(entryFileName).baseName()))
 				{
 					QString message(tr("Unable to create directory :") + QString("\n"));
 					message+= newBasePath;
@@ -376,51 +430,54 @@ bool ExportToWeb::exportAlbumAndModels()
 			++iEntry;
 		}
 		const int numberOfFileToCopy= listOfFilesToSend.size();
-
 		Q_ASSERT(listOfFilesToSend.size() == listOfDestinationFile.size());
-		// Check if source files exist
+
+		// The files are copied by worker threads, the identical files attached to several models are copied once
+		FileCopyEngine fileCopyEngine;
+		fileCopyEngine.setDeduplicate(true);
 		for (int i= 0; i < numberOfFileToCopy; ++i)
 		{
-			if (!QFile::exists(listOfFilesToSend[i]))
+			fileCopyEngine.addFile(listOfFilesToSend[i], listOfDestinationFile[i]);
+		}
+
+		// An incremental export copies only the new and changed models and removes the models not exported anymore
+		if (m_Incremental)
+		{
+			fileCopyEngine.setIncremental(true);
+			fileCopyEngine.setRemoveOrphans(true);
+			if (!fileCopyEngine.setManifest(targetPath))
 			{
 				m_QProgressDialog.cancel();
-				QString message(tr("Source file not found :") + QString("\n"));
-				message+= listOfFilesToSend[i];
-				QMessageBox::critical(NULL, tr("Send Files"), message);
+				QMessageBox::critical(NULL, tr("Send Files"), fileCopyEngine.errorString());
 				return false;
 			}
 		}
-		// All source files exists
-		// Copying the Files
-		m_QProgressDialog.setLabelText(tr("Copying Files, Please Wait...  "));
-		for (int i= 0; i < numberOfFileToCopy; ++i)
+
+		// Check if source files exist and if there is enough free space
+		if (!fileCopyEngine.check(targetPath))
 		{
-			// Update Progress dialog and chek fo cancellation
-			m_QProgressDialog.setValue(++m_CurrentProgressDialog);
-			QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-			if (m_QProgressDialog.wasCanceled())
-			{
-				return false;
-			}
+			m_QProgressDialog.cancel();
+			QMessageBox::critical(NULL, tr("Send Files"), fileCopyEngine.errorString());
+			return false;
+		}
 
-			const QString targetFile= listOfDestinationFile[i];
-			// Test if the destination file already exist
-			if (QFile::exists(listOfDestinationFile[i]))
-			{
-				// The destination file exists, delete it
-				QFile::remove(listOfDestinationFile[i]);
-			}
-			if (!QFile::copy(listOfFilesToSend[i], listOfDestinationFile[i]))
+		// Copying the Files, one progress step by model
+		m_QProgressDialog.setLabelText(tr("Copying Files, Please Wait...  "));
+		const bool copied= fileCopyEngine.exec(&m_QProgressDialog, m_CurrentProgressDialog, m_FileEntrySortedList.size());
+		m_CopyTime= fileCopyEngine.copyTime();
+		m_CopiedSize= fileCopyEngine.copiedSize();
+		m_CopyMethods= fileCopyEngine.methodsSummary();
+		m_RemovedOrphans= fileCopyEngine.removedOrphans();
+		if (!copied)
+		{
+			m_QProgressDialog.cancel();
+			if (!fileCopyEngine.wasCanceled())
 			{
-				m_QProgressDialog.cancel();
-				QString message(tr("Failed to copy file :") + QString("\n"));
-				message+= listOfFilesToSend[i];
-				message+= QString("\n") + QString("To") + QString("\n");
-				message+= listOfDestinationFile[i];
-				QMessageBox::critical(NULL, tr("Send Files"), message);
-				return false;
+				QMessageBox::critical(NULL, tr("Send Files"), fileCopyEngine.errorString());
 			}
+			return false;
 		}
+		m_CurrentProgressDialog+= m_FileEntrySortedList.size();
 
 		// Create New FileEntry Hash table
 		FileEntryHash* pNewFileEntryHash= new FileEntryHash();
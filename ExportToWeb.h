@@ -52,6 +52,9 @@ public:
 	//! Return the Index Path Name
 	inline QString indexPathName() const {return m_TargetPath + QDir::separator() + QString("index.html");}
 
+	//! Return the time spent by each stage of the last export
+	QString summary() const;
+
 //////////////////////////////////////////////////////////////////////
 // Public Set function
 //////////////////////////////////////////////////////////////////////
@@ -65,6 +68,9 @@ public:
 	//! Set Image size
 	void setImageSize(const QSize&);
 
+	//! Set the JPEG quality of thumbnails and images
+	inline void setImageQuality(int quality) {m_ImageQuality= quality;}
+
 	//! Export Album to web
 	bool exportToWeb(const QString&, const QString&);
 
@@ -100,6 +106,9 @@ public slots:
 	//! Link Image to model
 	void linkImageToModel(bool);
 
+	//! Export only the new and changed models
+	void incrementalExport(bool);
+
 //////////////////////////////////////////////////////////////////////
 // private services function
 //////////////////////////////////////////////////////////////////////
@@ -108,6 +117,9 @@ private:
 	//! Create sub directories structure
 	bool createSubDirectories();
 
+	//! Create the given sub directory of the given directory, an existing one is reused by incremental export
+	bool createSubDirectory(const QDir&, const QString&) const;
+
 	//! Make SnapShots
 	bool makeSnapShots();
 
@@ -194,6 +206,9 @@ private:
 	//! Link image to model
 	bool m_LinkImageToModel;
 
+	//! Export only the new and changed models
+	bool m_Incremental;
+
 	//! The target Path
 	QString m_TargetPath;
 
@@ -221,6 +236,25 @@ private:
 	//! Background Color
 	QColor m_BackgroundColor;
 
+	//! The JPEG quality of thumbnails and images
+	int m_ImageQuality;
+
+	//! Time spent by the export stages in ms
+	int m_RenderingTime;
+	int m_EncodingTime;
+	int m_WritingTime;
+	int m_WaitingTime;
+	int m_CopyTime;
+	int m_ExportTime;
+
+	//! The size of the copied models and attached files
+	qint64 m_CopiedSize;
+
+	//! The number of models and attached files copied with each method
+	QString m_CopyMethods;
+
+	//! The number of models and attached files removed from the previous export
+	int m_RemovedOrphans;
 
 };
 
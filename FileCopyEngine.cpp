@@ -0,0 +1,915 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include "FileCopyEngine.h"
+#include <QObject>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTime>
+#include <QTimer>
+#include <QEventLoop>
+#include <QMutexLocker>
+#include <QProgressDialog>
+#include <QStringList>
+#include <QSet>
+#include <QTextStream>
+#include <QCryptographicHash>
+#include <QtConcurrentRun>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <sys/statvfs.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
+
+// Size of the chunks read and written by the worker threads
+static const int copyChunkSize= 1024 * 1024;
+
+// Interval between two progress updates in ms
+static const int progressInterval= 100;
+
+// Size of the chunks copied in the kernel
+static const qint64 kernelChunkSize= 16 * 1024 * 1024;
+
+// File name of the manifest of the copied files
+static const char manifestName[]= ".glc_player_manifest";
+
+// First line of the manifest
+static const char manifestHeader[]= "GLC_Player manifest 1";
+
+FileCopyEngine::FileCopyEngine(int maxFilesInFlight)
+: m_Jobs()
+, m_TotalSize(0)
+, m_HardLinkAllowed(false)
+, m_Methods()
+, m_Incremental(false)
+, m_ContentHash(false)
+, m_RemoveOrphans(false)
+, m_RemovedOrphans(0)
+, m_ManifestFileName()
+, m_ManifestRoot()
+, m_Manifest()
+, m_Hashes()
+, m_Deduplicate(false)
+, m_DuplicateOf()
+, m_LinkDuplicates(false)
+, m_MaxFilesInFlight(qMax(1, maxFilesInFlight))
+, m_Workers()
+, m_Mutex()
+, m_NextJob(0)
+, m_CopiedSize(0)
+, m_SkippedSize(0)
+, m_Interrupt(false)
+, m_Canceled(false)
+, m_CopyTime(0)
+, m_ErrorString()
+{
+
+}
+
+FileCopyEngine::~FileCopyEngine()
+{
+	m_Mutex.lock();
+	m_Interrupt= true;
+	m_Mutex.unlock();
+
+	const int size= m_Workers.size();
+	for (int i= 0; i < size; ++i)
+	{
+		m_Workers[i].waitForFinished();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+
+// Add the copy of the given source file to the given target file
+void FileCopyEngine::addFile(const QString& source, const QString& target)
+{
+	CopyJob job;
+	job.m_Index= m_Jobs.size();
+	job.m_Source= source;
+	job.m_Target= target;
+	job.m_Size= QFileInfo(source).size();
+	m_Jobs.append(job);
+	m_Methods.append(NotCopied);
+	m_TotalSize+= job.m_Size;
+}
+
+// Return the number of files copied with each method
+QString FileCopyEngine::methodsSummary() const
+{
+	QStringList summary;
+	for (int method= ReflinkClone; method <= Deduplicated; ++method)
+	{
+		const int count= m_Methods.count(static_cast<CopyMethod>(method));
+		if (count > 0)
+		{
+			summary << QObject::tr("%1 : %2 files").arg(methodName(static_cast<CopyMethod>(method))).arg(count);
+		}
+	}
+	return summary.join(QString("\n"));
+}
+
+// Return the method used to copy each file
+QString FileCopyEngine::methodsReport() const
+{
+	QString report;
+	const int size= m_Jobs.size();
+	for (int i= 0; i < size; ++i)
+	{
+		report+= m_Jobs.at(i).m_Source + QString(" : ") + methodName(m_Methods.at(i)) + QString("\n");
+	}
+	return report;
+}
+
+// Return the name of the given copy method
+QString FileCopyEngine::methodName(CopyMethod method)
+{
+	switch (method)
+	{
+	case ReflinkClone:
+		return QObject::tr("Reflink clone");
+	case HardLink:
+		return QObject::tr("Hard link");
+	case KernelCopy:
+		return QObject::tr("In kernel copy");
+	case BufferedCopy:
+		return QObject::tr("Buffered copy");
+	case Unchanged:
+		return QObject::tr("Skipped (unchanged)");
+	case Deduplicated:
+		return QObject::tr("Linked to an identical file");
+	default:
+		return QObject::tr("Not copied");
+	}
+}
+
+// Use a manifest of the copied files in the given root path
+bool FileCopyEngine::setManifest(const QString& rootPath)
+{
+	m_ManifestRoot= rootPath;
+	m_ManifestFileName= rootPath + QDir::separator() + QString(manifestName);
+	m_Manifest.clear();
+
+	QFile manifestFile(m_ManifestFileName);
+	if (!manifestFile.exists()) return true;
+	if (!manifestFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		m_ErrorString= QObject::tr("Failed to read the manifest :") + QString("\n") + m_ManifestFileName;
+		return false;
+	}
+	QTextStream stream(&manifestFile);
+	stream.setCodec("UTF-8");
+	if (stream.readLine() != QString(manifestHeader))
+	{
+		// Unknown manifest version, all the files are compared without it
+		return true;
+	}
+	while (!stream.atEnd())
+	{
+		// Size, source modification time, source hash and relative file name separated by tabs
+		const QString line(stream.readLine());
+		const QString key(line.section('\t', 3));
+		if (key.isEmpty()) continue;
+		ManifestEntry entry;
+		entry.m_Size= line.section('\t', 0, 0).toLongLong();
+		entry.m_ModificationTime= line.section('\t', 1, 1).toUInt();
+		entry.m_Hash= QByteArray::fromHex(line.section('\t', 2, 2).toAscii());
+		m_Manifest.insert(key, entry);
+	}
+	return true;
+}
+
+// Check that the source files exist and that the target volume of the given path has enough free space
+bool FileCopyEngine::check(const QString& targetPath)
+{
+	// The replaced target files free their space
+	qint64 neededSize= m_TotalSize;
+	const int size= m_Jobs.size();
+	for (int i= 0; i < size; ++i)
+	{
+		if (!QFile::exists(m_Jobs.at(i).m_Source))
+		{
+			m_ErrorString= QObject::tr("Source file not found :") + QString("\n") + m_Jobs.at(i).m_Source;
+			return false;
+		}
+		const QFileInfo targetInfo(m_Jobs.at(i).m_Target);
+		if (targetInfo.exists())
+		{
+			neededSize-= targetInfo.size();
+		}
+	}
+
+	const qint64 availableSize= freeSpace(targetPath);
+	if ((availableSize >= 0) && (neededSize > availableSize))
+	{
+		m_ErrorString= QObject::tr("Not enough free space in :") + QString("\n") + targetPath;
+		m_ErrorString+= QString("\n") + QObject::tr("Needed : %1, Available : %2").arg(sizeToString(neededSize)).arg(sizeToString(availableSize));
+		return false;
+	}
+	return true;
+}
+
+// Copy the files and update the given progress dialog from the given value in the given range
+bool FileCopyEngine::exec(QProgressDialog* pProgress, int firstValue, int valueRange)
+{
+	Q_ASSERT(m_Workers.isEmpty());
+	m_NextJob= 0;
+	m_CopiedSize= 0;
+	m_SkippedSize= 0;
+	m_RemovedOrphans= 0;
+	m_Interrupt= false;
+	m_Canceled= false;
+	m_ErrorString.clear();
+	m_Hashes.clear();
+	m_DuplicateOf.clear();
+	const int jobCount= m_Methods.size();
+	for (int i= 0; i < jobCount; ++i)
+	{
+		m_Methods[i]= NotCopied;
+		m_Hashes.append(QByteArray());
+		m_DuplicateOf.append(-1);
+	}
+
+	QTime copyTime;
+	copyTime.start();
+	const QString labelText(pProgress->labelText());
+
+	// The identical sources are found by a worker thread before the copy
+	if (m_Deduplicate && (jobCount > 1))
+	{
+		m_Workers.append(QtConcurrent::run(&FileCopyEngine::findDuplicates, this));
+		waitForWorkers(pProgress, labelText + QString("\n") + QObject::tr("Looking for identical files..."), firstValue, 0, copyTime);
+	}
+
+	// The original files are copied, then their duplicates are linked
+	const int waveCount= (m_DuplicateOf.count(-1) < jobCount) ? 2 : 1;
+	for (int wave= 0; (wave < waveCount) && m_ErrorString.isEmpty() && !m_Canceled; ++wave)
+	{
+		m_NextJob= 0;
+		m_LinkDuplicates= (1 == wave);
+		const int workerCount= qMin(m_MaxFilesInFlight, jobCount);
+		for (int i= 0; i < workerCount; ++i)
+		{
+			m_Workers.append(QtConcurrent::run(&FileCopyEngine::copyFiles, this));
+		}
+		waitForWorkers(pProgress, labelText, firstValue, valueRange, copyTime);
+	}
+
+	// The orphans are only removed if all the files are up to date
+	if (!m_ManifestFileName.isEmpty())
+	{
+		if (m_RemoveOrphans && m_ErrorString.isEmpty() && !m_Canceled)
+		{
+			removeOrphans();
+		}
+		if (!writeManifest() && m_ErrorString.isEmpty())
+		{
+			m_ErrorString= QObject::tr("Failed to write the manifest :") + QString("\n") + m_ManifestFileName;
+		}
+	}
+	m_CopyTime= copyTime.elapsed();
+	pProgress->setLabelText(labelText);
+
+	return m_ErrorString.isEmpty() && !m_Canceled;
+}
+
+// Return the number of bytes copied
+qint64 FileCopyEngine::copiedSize()
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_CopiedSize;
+}
+
+// Return the free space in bytes of the volume of the given path (-1 if unknown)
+qint64 FileCopyEngine::freeSpace(const QString& path)
+{
+#if defined(Q_OS_WIN)
+	ULARGE_INTEGER availableBytes;
+	if (GetDiskFreeSpaceExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(path).utf16()), &availableBytes, NULL, NULL))
+	{
+		return static_cast<qint64>(availableBytes.QuadPart);
+	}
+#else
+	struct statvfs volumeStats;
+	if (0 == statvfs(QFile::encodeName(path).constData(), &volumeStats))
+	{
+		return static_cast<qint64>(volumeStats.f_bavail) * static_cast<qint64>(volumeStats.f_frsize);
+	}
+#endif
+	return -1;
+}
+
+// Return the given size as a string
+QString FileCopyEngine::sizeToString(qint64 size)
+{
+	const double doubleSize= static_cast<double>(size);
+	QString stringSize;
+	if (doubleSize > 1024.0 * 1024.0 * 1024.0)
+	{
+		stringSize= QString::number(doubleSize / (1024.0 * 1024.0 * 1024.0), 'f', 2) + QObject::tr(" Go");
+	}
+	else if (doubleSize > 1024.0 * 1024.0)
+	{
+		stringSize= QString::number(doubleSize / (1024.0 * 1024.0), 'f', 2) + QObject::tr(" Mo");
+	}
+	else if (doubleSize > 1024.0)
+	{
+		stringSize= QString::number(doubleSize / 1024.0, 'f', 2) + QObject::tr(" Ko");
+	}
+	else
+	{
+		stringSize= QString::number(size) + QObject::tr(" Bytes");
+	}
+	return stringSize;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Wait for the worker threads while updating the given progress dialog from the given value in the given range
+void FileCopyEngine::waitForWorkers(QProgressDialog* pProgress, const QString& labelText, int firstValue, int valueRange, const QTime& copyTime)
+{
+	// The GUI thread waits for the workers by periods of progressInterval
+	QEventLoop eventLoop;
+	QTimer timer;
+	timer.setInterval(progressInterval);
+	QObject::connect(&timer, SIGNAL(timeout()), &eventLoop, SLOT(quit()));
+	timer.start();
+
+	const int workerCount= m_Workers.size();
+	bool finished= false;
+	while (!finished)
+	{
+		finished= true;
+		for (int i= 0; i < workerCount; ++i)
+		{
+			finished= finished && m_Workers.at(i).isFinished();
+		}
+
+		// Update Progress dialog and chek fo cancellation
+		m_Mutex.lock();
+		const qint64 copied= m_CopiedSize;
+		const qint64 processed= m_CopiedSize + m_SkippedSize;
+		m_Mutex.unlock();
+		const double elapsed= qMax(1, copyTime.elapsed()) / 1000.0;
+		QString progressText(labelText + QString("\n"));
+		progressText+= QObject::tr("%1 of %2 (%3/s)").arg(sizeToString(processed)).arg(sizeToString(m_TotalSize)).arg(sizeToString(static_cast<qint64>(copied / elapsed)));
+		pProgress->setLabelText(progressText);
+		const double ratio= (m_TotalSize > 0) ? (static_cast<double>(processed) / static_cast<double>(m_TotalSize)) : 1.0;
+		pProgress->setValue(firstValue + static_cast<int>(ratio * valueRange));
+		if (!finished && !m_Canceled && pProgress->wasCanceled())
+		{
+			// The files being copied are removed by the workers
+			m_Canceled= true;
+			m_Mutex.lock();
+			m_Interrupt= true;
+			m_Mutex.unlock();
+		}
+
+		if (!finished) eventLoop.exec(QEventLoop::ExcludeUserInputEvents);
+	}
+	m_Workers.clear();
+}
+
+// Return the next job to copy, false if there is no more job (Called by worker threads)
+bool FileCopyEngine::nextJob(CopyJob* pJob)
+{
+	QMutexLocker locker(&m_Mutex);
+	while (!m_Interrupt && (m_NextJob < m_Jobs.size()))
+	{
+		// The jobs of the other wave are skipped
+		const int index= m_NextJob++;
+		if ((m_DuplicateOf.at(index) >= 0) == m_LinkDuplicates)
+		{
+			*pJob= m_Jobs.at(index);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Copy the given job, return false on error (Called by worker threads)
+bool FileCopyEngine::copyFile(const CopyJob& job)
+{
+	QString message(QObject::tr("Failed to copy file :") + QString("\n"));
+	message+= job.m_Source;
+	message+= QString("\n") + QObject::tr("To") + QString("\n");
+	message+= job.m_Target;
+
+	if (m_Incremental)
+	{
+		QByteArray hash;
+		const bool unchanged= isUnchanged(job, &hash);
+		QMutexLocker locker(&m_Mutex);
+		m_Hashes[job.m_Index]= hash;
+		if (unchanged)
+		{
+			m_Methods[job.m_Index]= Unchanged;
+			m_SkippedSize+= job.m_Size;
+			return true;
+		}
+	}
+
+	// The target of a duplicated source is linked to the copy of its original
+	if (m_LinkDuplicates && linkDuplicate(job))
+	{
+		return true;
+	}
+
+	QFile source(job.m_Source);
+	if (!source.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+	{
+		setError(message + QString("\n") + source.errorString());
+		return false;
+	}
+
+	// The destination file exists, delete it
+	if (QFile::exists(job.m_Target))
+	{
+		QFile::remove(job.m_Target);
+	}
+	QFile target(job.m_Target);
+	if (!target.open(QIODevice::WriteOnly | QIODevice::Unbuffered))
+	{
+		setError(message + QString("\n") + target.errorString());
+		return false;
+	}
+
+	CopyMethod method= NotCopied;
+	bool success= true;
+	if (reflinkClone(source, target))
+	{
+		method= ReflinkClone;
+	}
+	else if (m_HardLinkAllowed && target.remove() && hardLink(job.m_Source, job.m_Target))
+	{
+		method= HardLink;
+	}
+	else
+	{
+		// The target may have been removed by the hard link attempt
+		if (!target.isOpen() && !target.open(QIODevice::WriteOnly | QIODevice::Unbuffered))
+		{
+			setError(message + QString("\n") + target.errorString());
+			return false;
+		}
+		const KernelCopyResult kernelCopyResult= kernelCopy(source, target);
+		if (KernelCopyDone == kernelCopyResult)
+		{
+			method= KernelCopy;
+		}
+		else if (KernelCopyUnsupported == kernelCopyResult)
+		{
+			method= BufferedCopy;
+			success= bufferedCopy(source, target);
+		}
+		else
+		{
+			success= false;
+		}
+	}
+
+	if (target.isOpen())
+	{
+		target.close();
+		success= success && (QFile::NoError == target.error());
+	}
+
+	if (!success)
+	{
+		// Remove the partial file
+		const QString errorString(target.error() != QFile::NoError ? target.errorString() : source.errorString());
+		target.remove();
+		if (!isInterrupted())
+		{
+			setError(message + QString("\n") + errorString);
+		}
+		return false;
+	}
+
+	if ((ReflinkClone == method) || (HardLink == method))
+	{
+		addCopiedSize(job.m_Size);
+	}
+	if (HardLink != method)
+	{
+		target.setPermissions(source.permissions());
+	}
+
+	QMutexLocker locker(&m_Mutex);
+	m_Methods[job.m_Index]= method;
+	return true;
+}
+
+// Link the target of the given duplicated job to the target of its original, return false on error (Called by worker threads)
+bool FileCopyEngine::linkDuplicate(const CopyJob& job)
+{
+	const int originalIndex= m_DuplicateOf.at(job.m_Index);
+	const QString originalTarget(m_Jobs.at(originalIndex).m_Target);
+
+	// A duplicate with the same target as its original is already copied
+	if (QDir::cleanPath(job.m_Target) != QDir::cleanPath(originalTarget))
+	{
+		// The destination file exists, delete it
+		if (QFile::exists(job.m_Target))
+		{
+			QFile::remove(job.m_Target);
+		}
+		// The other targets share the content of the original copy : hard link if allowed, else reflink clone
+		if (!m_HardLinkAllowed || !hardLink(originalTarget, job.m_Target))
+		{
+			QFile original(originalTarget);
+			QFile target(job.m_Target);
+			const bool cloned= original.open(QIODevice::ReadOnly | QIODevice::Unbuffered)
+					&& target.open(QIODevice::WriteOnly | QIODevice::Unbuffered) && reflinkClone(original, target);
+			target.close();
+			// If the target volume can't share the content the file is copied
+			if (!cloned || (QFile::NoError != target.error()))
+			{
+				target.remove();
+				return false;
+			}
+			target.setPermissions(original.permissions());
+		}
+	}
+
+	QMutexLocker locker(&m_Mutex);
+	m_Methods[job.m_Index]= Deduplicated;
+	if (m_Hashes.at(job.m_Index).isEmpty())
+	{
+		m_Hashes[job.m_Index]= m_Hashes.at(originalIndex);
+	}
+	m_SkippedSize+= job.m_Size;
+	return true;
+}
+
+// Return true if the target of the given job is up to date and set the source hash if needed (Called by worker threads)
+bool FileCopyEngine::isUnchanged(const CopyJob& job, QByteArray* pHash)
+{
+	const QFileInfo targetInfo(job.m_Target);
+	if (!targetInfo.exists() || (targetInfo.size() != job.m_Size))
+	{
+		// The hash of the copied file is recorded in the manifest
+		if (m_ContentHash && !m_ManifestFileName.isEmpty())
+		{
+			*pHash= fileHash(job.m_Source);
+		}
+		return false;
+	}
+
+	// The manifest is only read by the worker threads during the copy
+	const QFileInfo sourceInfo(job.m_Source);
+	const QString key(manifestKey(job.m_Target));
+	const bool inManifest= m_Manifest.contains(key);
+	const ManifestEntry entry(m_Manifest.value(key));
+	const bool sameAsManifest= inManifest && (entry.m_Size == job.m_Size) && (entry.m_ModificationTime == sourceInfo.lastModified().toTime_t());
+
+	if (!m_ContentHash)
+	{
+		// Without manifest entry, the target must be newer than the source
+		if (inManifest) return sameAsManifest;
+		else return targetInfo.lastModified() >= sourceInfo.lastModified();
+	}
+
+	*pHash= fileHash(job.m_Source);
+	if (pHash->isEmpty()) return false;
+	if (sameAsManifest && !entry.m_Hash.isEmpty())
+	{
+		return *pHash == entry.m_Hash;
+	}
+	return *pHash == fileHash(job.m_Target);
+}
+
+// Return the hash of the given file content, empty on error
+QByteArray FileCopyEngine::fileHash(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	QByteArray buffer(copyChunkSize, 0);
+	qint64 readSize;
+	while ((readSize= file.read(buffer.data(), buffer.size())) > 0)
+	{
+		hash.addData(buffer.constData(), static_cast<int>(readSize));
+	}
+	if (readSize < 0) return QByteArray();
+	return hash.result();
+}
+
+// Return the manifest key of the given target file
+QString FileCopyEngine::manifestKey(const QString& target) const
+{
+	return QDir(m_ManifestRoot).relativeFilePath(target);
+}
+
+// Remove the files of the manifest which are not copied anymore
+void FileCopyEngine::removeOrphans()
+{
+	QSet<QString> copiedKeys;
+	const int size= m_Jobs.size();
+	for (int i= 0; i < size; ++i)
+	{
+		copiedKeys.insert(manifestKey(m_Jobs.at(i).m_Target));
+	}
+
+	const QDir rootDir(m_ManifestRoot);
+	QHash<QString, ManifestEntry>::iterator iEntry= m_Manifest.begin();
+	while (iEntry != m_Manifest.end())
+	{
+		if (copiedKeys.contains(iEntry.key()))
+		{
+			++iEntry;
+		}
+		else
+		{
+			// Only the files written by a previous copy are removed, with their empty folders
+			const QString fileName(rootDir.filePath(iEntry.key()));
+			if (!QFile::exists(fileName) || QFile::remove(fileName))
+			{
+				const QString relativePath(QFileInfo(iEntry.key()).path());
+				if (relativePath != QString(".")) rootDir.rmpath(relativePath);
+				++m_RemovedOrphans;
+				iEntry= m_Manifest.erase(iEntry);
+			}
+			else
+			{
+				++iEntry;
+			}
+		}
+	}
+}
+
+// Write the manifest of the copied files, return false on error
+bool FileCopyEngine::writeManifest()
+{
+	// Update the entries of the files copied or unchanged
+	const int size= m_Jobs.size();
+	for (int i= 0; i < size; ++i)
+	{
+		if (NotCopied == m_Methods.at(i)) continue;
+		const CopyJob& job= m_Jobs.at(i);
+		ManifestEntry entry;
+		entry.m_Size= job.m_Size;
+		entry.m_ModificationTime= QFileInfo(job.m_Source).lastModified().toTime_t();
+		entry.m_Hash= m_Hashes.at(i);
+		m_Manifest.insert(manifestKey(job.m_Target), entry);
+	}
+
+	// The manifest is replaced only when completely written
+	const QString newFileName(m_ManifestFileName + QString(".new"));
+	QFile manifestFile(newFileName);
+	if (!manifestFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+	{
+		QTextStream stream(&manifestFile);
+		stream.setCodec("UTF-8");
+		stream << QString(manifestHeader) << '\n';
+		QHash<QString, ManifestEntry>::const_iterator iEntry= m_Manifest.constBegin();
+		while (iEntry != m_Manifest.constEnd())
+		{
+			stream << iEntry.value().m_Size << '\t' << iEntry.value().m_ModificationTime << '\t';
+			stream << QString(iEntry.value().m_Hash.toHex()) << '\t' << iEntry.key() << '\n';
+			++iEntry;
+		}
+	}
+	manifestFile.close();
+	if (QFile::NoError != manifestFile.error())
+	{
+		QFile::remove(newFileName);
+		return false;
+	}
+	QFile::remove(m_ManifestFileName);
+	return QFile::rename(newFileName, m_ManifestFileName);
+}
+
+// Copy the given opened source file in the given opened target file by chunks, return false on error
+bool FileCopyEngine::bufferedCopy(QFile& source, QFile& target)
+{
+	QByteArray buffer(copyChunkSize, 0);
+	bool success= true;
+	bool complete= false;
+	while (success && !complete && !isInterrupted())
+	{
+		const qint64 readSize= source.read(buffer.data(), buffer.size());
+		if (readSize > 0)
+		{
+			success= (target.write(buffer.constData(), readSize) == readSize);
+			addCopiedSize(readSize);
+		}
+		else
+		{
+			complete= true;
+			success= (0 == readSize);
+		}
+	}
+	return complete && success;
+}
+
+// Copy the given opened source file in the given opened target file in the kernel
+FileCopyEngine::KernelCopyResult FileCopyEngine::kernelCopy(QFile& source, QFile& target)
+{
+#if defined(Q_OS_LINUX)
+	const int sourceHandle= source.handle();
+	const int targetHandle= target.handle();
+	bool useCopyFileRange= true;
+	qint64 copiedSize= 0;
+	while (!isInterrupted())
+	{
+		ssize_t size= -1;
+#if defined(SYS_copy_file_range)
+		if (useCopyFileRange)
+		{
+			size= syscall(SYS_copy_file_range, sourceHandle, NULL, targetHandle, NULL, static_cast<size_t>(kernelChunkSize), 0);
+			if ((size < 0) && (0 == copiedSize) && ((ENOSYS == errno) || (EXDEV == errno) || (EINVAL == errno) || (EOPNOTSUPP == errno)))
+			{
+				// Try sendfile
+				useCopyFileRange= false;
+				continue;
+			}
+		}
+		else
+#endif
+		{
+			size= sendfile(targetHandle, sourceHandle, NULL, static_cast<size_t>(kernelChunkSize));
+			if ((size < 0) && (0 == copiedSize) && ((ENOSYS == errno) || (EINVAL == errno)))
+			{
+				return KernelCopyUnsupported;
+			}
+		}
+
+		if (size < 0)
+		{
+			if (EINTR != errno) return KernelCopyFailed;
+		}
+		else if (0 == size)
+		{
+			return KernelCopyDone;
+		}
+		else
+		{
+			copiedSize+= size;
+			addCopiedSize(size);
+		}
+	}
+	return KernelCopyFailed;
+#else
+	Q_UNUSED(source);
+	Q_UNUSED(target);
+	return KernelCopyUnsupported;
+#endif
+}
+
+// Clone the given opened source file in the given opened target file, return true on success
+bool FileCopyEngine::reflinkClone(QFile& source, QFile& target)
+{
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+	return 0 == ioctl(target.handle(), FICLONE, source.handle());
+#else
+	Q_UNUSED(source);
+	Q_UNUSED(target);
+	return false;
+#endif
+}
+
+// Create a hard link of the given source file, return true on success
+bool FileCopyEngine::hardLink(const QString& source, const QString& target)
+{
+#if defined(Q_OS_WIN)
+	const QString nativeSource(QDir::toNativeSeparators(source));
+	const QString nativeTarget(QDir::toNativeSeparators(target));
+	return 0 != CreateHardLinkW(reinterpret_cast<LPCWSTR>(nativeTarget.utf16()), reinterpret_cast<LPCWSTR>(nativeSource.utf16()), NULL);
+#else
+	return 0 == link(QFile::encodeName(source).constData(), QFile::encodeName(target).constData());
+#endif
+}
+
+// Account the given number of copied bytes
+void FileCopyEngine::addCopiedSize(qint64 size)
+{
+	QMutexLocker locker(&m_Mutex);
+	m_CopiedSize+= size;
+}
+
+// Stop the copies with the given error message (Called by worker threads)
+void FileCopyEngine::setError(const QString& message)
+{
+	QMutexLocker locker(&m_Mutex);
+	if (m_ErrorString.isEmpty())
+	{
+		m_ErrorString= message;
+	}
+	m_Interrupt= true;
+}
+
+// Return true if the copies must stop
+bool FileCopyEngine::isInterrupted()
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_Interrupt;
+}
+
+// Copy jobs until there is no more job (Run by worker threads)
+void FileCopyEngine::copyFiles(FileCopyEngine* pEngine)
+{
+	CopyJob job;
+	bool success= true;
+	while (success && pEngine->nextJob(&job))
+	{
+		success= pEngine->copyFile(job);
+	}
+}
+
+// Find the jobs which have the same source path or content than a previous job (Run by a worker thread)
+void FileCopyEngine::findDuplicates(FileCopyEngine* pEngine)
+{
+	const QList<CopyJob>& jobs= pEngine->m_Jobs;
+	const int size= jobs.size();
+	QList<int> duplicateOf;
+
+	// The sources with the same path
+	QHash<QString, int> originalByPath;
+	QHash<qint64, QList<int> > originalsBySize;
+	for (int i= 0; i < size; ++i)
+	{
+		const QString sourcePath(QFileInfo(jobs.at(i).m_Source).canonicalFilePath());
+		const int original= originalByPath.value(sourcePath, -1);
+		duplicateOf.append(original);
+		if ((original < 0) && !sourcePath.isEmpty())
+		{
+			originalByPath.insert(sourcePath, i);
+			if (jobs.at(i).m_Size > 0) originalsBySize[jobs.at(i).m_Size].append(i);
+		}
+	}
+
+	// The sources with the same content, only the sources of the same size are read
+	QHash<qint64, QList<int> >::const_iterator iSize= originalsBySize.constBegin();
+	while ((iSize != originalsBySize.constEnd()) && !pEngine->isInterrupted())
+	{
+		const QList<int>& candidates= iSize.value();
+		const int count= (candidates.size() > 1) ? candidates.size() : 0;
+		QHash<QByteArray, int> originalByHash;
+		for (int i= 0; (i < count) && !pEngine->isInterrupted(); ++i)
+		{
+			const int index= candidates.at(i);
+			const QByteArray hash(fileHash(jobs.at(index).m_Source));
+			if (hash.isEmpty()) continue;
+			if (originalByHash.contains(hash))
+			{
+				duplicateOf[index]= originalByHash.value(hash);
+			}
+			else
+			{
+				originalByHash.insert(hash, index);
+			}
+		}
+		++iSize;
+	}
+
+	// An original always precedes its duplicates : the duplicates of a duplicate are attached to the first original
+	for (int i= 0; i < size; ++i)
+	{
+		const int original= duplicateOf.at(i);
+		if ((original >= 0) && (duplicateOf.at(original) >= 0))
+		{
+			duplicateOf[i]= duplicateOf.at(original);
+		}
+	}
+
+	QMutexLocker locker(&pEngine->m_Mutex);
+	pEngine->m_DuplicateOf= duplicateOf;
+}
@@ -0,0 +1,347 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef FILECOPYENGINE_H_
+#define FILECOPYENGINE_H_
+
+#include <QList>
+#include <QString>
+#include <QMutex>
+#include <QFuture>
+#include <QFile>
+#include <QHash>
+#include <QDateTime>
+
+class QProgressDialog;
+class QTime;
+
+//////////////////////////////////////////////////////////////////////
+//! \class FileCopyEngine
+/*! \brief FileCopyEngine : Copy a list of files with worker threads*/
+
+/*! Several files are copied at the same time by worker threads, by
+ *  chunks, so the progress is known to the byte. The GUI thread only
+ *  updates the progress dialog with the copied size and the throughput.
+ *  On cancellation or error the files being copied are removed, the
+ *  files already copied are kept.
+ *  Each file is copied with the first method which works : reflink
+ *  clone, hard link if allowed, in kernel copy and buffered copy.
+ *  In incremental mode the target files which have the size and the
+ *  modification time (or the content) of their source are kept, and a
+ *  manifest of the copied files is written for the next comparison.
+ *  When deduplication is enabled, the sources which have the same path
+ *  or the same content are copied once. Their other targets share the
+ *  content of this copy with a hard link if allowed, else with a reflink
+ *  clone, so the layout of each target folder is kept. On volumes which
+ *  can't share content they are copied*/
+//////////////////////////////////////////////////////////////////////
+class FileCopyEngine
+{
+public:
+	//! The methods used to copy a file
+	enum CopyMethod
+	{
+		NotCopied,
+		ReflinkClone,
+		HardLink,
+		KernelCopy,
+		BufferedCopy,
+		Unchanged,
+		Deduplicated
+	};
+
+private:
+	//! A file to copy
+	struct CopyJob
+	{
+		int m_Index;
+		QString m_Source;
+		QString m_Target;
+		qint64 m_Size;
+	};
+
+	//! A file recorded in the manifest
+	struct ManifestEntry
+	{
+		qint64 m_Size;
+		uint m_ModificationTime;
+		QByteArray m_Hash;
+	};
+
+	//! The result of an in kernel copy
+	enum KernelCopyResult
+	{
+		KernelCopyDone,
+		KernelCopyUnsupported,
+		KernelCopyFailed
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct an engine which copies at most the given number of files at the same time
+	FileCopyEngine(int maxFilesInFlight= 4);
+
+	//! Cancel and wait the end of the copies
+	~FileCopyEngine();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Add the copy of the given source file to the given target file
+	void addFile(const QString&, const QString&);
+
+	//! Return the number of files to copy
+	inline int numberOfFiles() const
+	{return m_Jobs.size();}
+
+	//! Return the size of the files to copy
+	inline qint64 totalSize() const
+	{return m_TotalSize;}
+
+	//! Allow the files to be hard linked if they are on the same volume
+	/*! The target files then share their content with the source files*/
+	inline void setHardLinkAllowed(bool allowed)
+	{m_HardLinkAllowed= allowed;}
+
+	//! Copy only the new and the changed files
+	inline void setIncremental(bool incremental)
+	{m_Incremental= incremental;}
+
+	//! Compare the content of the files in incremental mode
+	inline void setContentHash(bool hash)
+	{m_ContentHash= hash;}
+
+	//! Use a manifest of the copied files in the given root path
+	/*! Return false if the manifest exists and cannot be read*/
+	bool setManifest(const QString&);
+
+	//! Remove the files of the manifest which are not copied anymore
+	inline void setRemoveOrphans(bool remove)
+	{m_RemoveOrphans= remove;}
+
+	//! Return the number of files removed because they are not copied anymore
+	inline int removedOrphans() const
+	{return m_RemovedOrphans;}
+
+	//! Return the number of files not copied because they are unchanged
+	inline int unchangedFiles() const
+	{return m_Methods.count(Unchanged);}
+
+	//! Return the number of files copied without any of the fast copy methods
+	inline int bufferedCopies() const
+	{return m_Methods.count(BufferedCopy);}
+
+	//! Copy once the identical source files, their other targets share the content of this copy when the volume allows it
+	inline void setDeduplicate(bool deduplicate)
+	{m_Deduplicate= deduplicate;}
+
+	//! Return the number of files linked to an identical file
+	inline int deduplicatedFiles() const
+	{return m_Methods.count(Deduplicated);}
+
+	//! Return the method used to copy the file of the given index
+	inline CopyMethod copyMethod(int index) const
+	{return m_Methods.at(index);}
+
+	//! Return the number of files copied with each method
+	QString methodsSummary() const;
+
+	//! Return the method used to copy each file
+	QString methodsReport() const;
+
+	//! Return the name of the given copy method
+	static QString methodName(CopyMethod);
+
+	//! Check that the source files exist and that the target volume of the given path has enough free space
+	bool check(const QString&);
+
+	//! Copy the files and update the given progress dialog from the given value in the given range
+	/*! Return false on error or if the copy is canceled*/
+	bool exec(QProgressDialog*, int firstValue, int valueRange);
+
+	//! Return true if the copy has been canceled by the user
+	inline bool wasCanceled() const
+	{return m_Canceled;}
+
+	//! Return the time spent to copy the files in ms
+	inline int copyTime() const
+	{return m_CopyTime;}
+
+	//! Return the number of bytes copied
+	qint64 copiedSize();
+
+	//! Return the last error message
+	inline QString errorString() const
+	{return m_ErrorString;}
+
+	//! Return the free space in bytes of the volume of the given path (-1 if unknown)
+	static qint64 freeSpace(const QString&);
+
+	//! Return the given size as a string
+	static QString sizeToString(qint64);
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Wait for the worker threads while updating the given progress dialog from the given value in the given range
+	void waitForWorkers(QProgressDialog*, const QString&, int firstValue, int valueRange, const QTime&);
+
+	//! Return the next job to copy, false if there is no more job (Called by worker threads)
+	bool nextJob(CopyJob*);
+
+	//! Link the target of the given duplicated job to the target of its original, return false on error (Called by worker threads)
+	bool linkDuplicate(const CopyJob&);
+
+	//! Copy the given job, return false on error (Called by worker threads)
+	bool copyFile(const CopyJob&);
+
+	//! Return true if the target of the given job is up to date and set the source hash if needed (Called by worker threads)
+	bool isUnchanged(const CopyJob&, QByteArray*);
+
+	//! Return the hash of the given file content, empty on error
+	static QByteArray fileHash(const QString&);
+
+	//! Return the manifest key of the given target file
+	QString manifestKey(const QString&) const;
+
+	//! Remove the files of the manifest which are not copied anymore
+	void removeOrphans();
+
+	//! Write the manifest of the copied files, return false on error
+	bool writeManifest();
+
+	//! Copy the given opened source file in the given opened target file by chunks, return false on error
+	bool bufferedCopy(QFile&, QFile&);
+
+	//! Copy the given opened source file in the given opened target file in the kernel
+	KernelCopyResult kernelCopy(QFile&, QFile&);
+
+	//! Clone the given opened source file in the given opened target file, return true on success
+	static bool reflinkClone(QFile&, QFile&);
+
+	//! Create a hard link of the given source file, return true on success
+	static bool hardLink(const QString&, const QString&);
+
+	//! Account the given number of copied bytes
+	void addCopiedSize(qint64);
+
+	//! Stop the copies with the given error message (Called by worker threads)
+	void setError(const QString&);
+
+	//! Return true if the copies must stop
+	bool isInterrupted();
+
+	//! Copy jobs until there is no more job (Run by worker threads)
+	static void copyFiles(FileCopyEngine*);
+
+	//! Find the jobs which have the same source path or content than a previous job (Run by a worker thread)
+	static void findDuplicates(FileCopyEngine*);
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The files to copy
+	QList<CopyJob> m_Jobs;
+
+	//! The size of the files to copy
+	qint64 m_TotalSize;
+
+	//! True if files can be hard linked
+	bool m_HardLinkAllowed;
+
+	//! The method used to copy each file
+	QList<CopyMethod> m_Methods;
+
+	//! True if only new and changed files are copied
+	bool m_Incremental;
+
+	//! True if the content of the files is compared
+	bool m_ContentHash;
+
+	//! True if the files of the manifest not copied anymore are removed
+	bool m_RemoveOrphans;
+
+	//! The number of removed orphan files
+	int m_RemovedOrphans;
+
+	//! The manifest file name, empty if there is no manifest
+	QString m_ManifestFileName;
+
+	//! The root path of the files of the manifest
+	QString m_ManifestRoot;
+
+	//! The entries of the manifest by relative target file name
+	QHash<QString, ManifestEntry> m_Manifest;
+
+	//! The source hash of each file, if computed
+	QList<QByteArray> m_Hashes;
+
+	//! True if the identical source files are copied once
+	bool m_Deduplicate;
+
+	//! The index of the original job of each job, -1 if the job is an original
+	QList<int> m_DuplicateOf;
+
+	//! True if the duplicated jobs are linked, false if the original jobs are copied
+	bool m_LinkDuplicates;
+
+	//! The maximum number of files copied at the same time
+	int m_MaxFilesInFlight;
+
+	//! The worker threads copies
+	QList<QFuture<void> > m_Workers;
+
+	//! Mutex of the members shared with worker threads
+	QMutex m_Mutex;
+
+	//! The index of the next job to copy
+	int m_NextJob;
+
+	//! The number of bytes copied
+	qint64 m_CopiedSize;
+
+	//! The size of the files not copied because they are unchanged or linked
+	qint64 m_SkippedSize;
+
+	//! Interrupt flag
+	bool m_Interrupt;
+
+	//! True if the copy has been canceled
+	bool m_Canceled;
+
+	//! The time spent to copy the files in ms
+	int m_CopyTime;
+
+	//! The last error message
+	QString m_ErrorString;
+};
+
+#endif /* FILECOPYENGINE_H_ */
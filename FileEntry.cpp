@@ -23,8 +23,10 @@
 *****************************************************************************/
 
 #include "FileEntry.h"
+#include "AlbumFile.h"
 #include "./opengl_view/OpenglView.h"
 #include <GLC_Octree>
+#include <GLC_Exception>
 
 // Default constructor
 FileEntry::FileEntry(const QString& fileName)
@@ -44,36 +46,36 @@ FileEntry::FileEntry(const QString& fileName)
 , m_AttachedFileNames()
 , m_ModifiedMaterials()
 , m_pNumberOfEntry(new int(1))
-, m_pInvisibleListOfInstanceName(NULL)
-, m_pShadedInstanceList(NULL)
+, m_pAlbumRecord(NULL)
 {
 	m_Camera.setDefaultUpVector(glc::Z_AXIS);
 }
 
-// Construct from fileName and camera
-FileEntry::FileEntry(const QString& fileName, const GLC_Camera& cam, const double& angle
-		, QSet<GLC_Material*> materialsSet, const QList<QString>& invisibleInstance
-		, const QHash<QString, QList<QString> >& shadedInstance)
+// Construct from fileName and album record
+FileEntry::FileEntry(const QString& fileName, const AlbumEntryRecord& record)
 : m_Id(glc::GLC_GenUserID())
 , m_FileName(fileName)
 , m_IsLoading(false)
 , m_pIsLoaded(new bool(false))
 , m_World()
 , m_Error()
-, m_Camera(cam)
-, m_CameraIsSet(!(cam == GLC_Camera()))
+, m_Camera()
+, m_CameraIsSet(false)
 , m_PolyMode(GL_FILL)
 , m_NumberOfFaces()
 , m_NumberOfVertex()
 , m_NumberOfMaterials()
-, m_AngleOfView(angle)
+, m_AngleOfView(30.0)
 , m_AttachedFileNames()
-, m_ModifiedMaterials(materialsSet)
+, m_ModifiedMaterials()
 , m_pNumberOfEntry(new int(1))
-, m_pInvisibleListOfInstanceName(new QList<QString>(invisibleInstance))
-, m_pShadedInstanceList(new QHash<QString, QList<QString> >(shadedInstance))
+, m_pAlbumRecord(new AlbumEntryRecord(record))
 {
-
+	// The materials are created when the world is set
+	if (record.isDecoded() && record.m_CameraIsSet)
+	{
+		setCameraAndAngle(AlbumFile::camera(record), record.m_Angle);
+	}
 }
 
 // Copy constructor
@@ -93,8 +95,7 @@ FileEntry::FileEntry(const FileEntry& entry)
 , m_AttachedFileNames(entry.m_AttachedFileNames)
 , m_ModifiedMaterials(entry.m_ModifiedMaterials)
 , m_pNumberOfEntry(entry.m_pNumberOfEntry)
-, m_pInvisibleListOfInstanceName(entry.m_pInvisibleListOfInstanceName)
-, m_pShadedInstanceList(entry.m_pShadedInstanceList)
+, m_pAlbumRecord(entry.m_pAlbumRecord)
 {
 	// Increment the number of entry
 	++(*m_pNumberOfEntry);
@@ -119,8 +120,7 @@ FileEntry::~FileEntry()
 			}
 		}
 		delete m_pNumberOfEntry;
-		delete m_pInvisibleListOfInstanceName;
-		delete m_pShadedInstanceList;
+		delete m_pAlbumRecord;
 		delete m_pIsLoaded;
 	}
 
@@ -152,8 +152,7 @@ FileEntry& FileEntry::operator=(const FileEntry& fileEntry)
 		m_AttachedFileNames= fileEntry.m_AttachedFileNames;
 		m_ModifiedMaterials= fileEntry.m_ModifiedMaterials;
 		m_pNumberOfEntry= fileEntry.m_pNumberOfEntry;
-		m_pInvisibleListOfInstanceName= fileEntry.m_pInvisibleListOfInstanceName;
-		m_pShadedInstanceList= fileEntry.m_pShadedInstanceList;
+		m_pAlbumRecord= fileEntry.m_pAlbumRecord;
 		// Increment the number of entry
 		++(*m_pNumberOfEntry);
 	}
@@ -182,6 +181,17 @@ void FileEntry::setWorld(GLC_World& world)
 	m_NumberOfMaterials= m_World.numberOfMaterials();
 	m_AttachedFileNames.clear();
 
+	// Create the album camera and materials
+	decodeAlbumRecord();
+	if (NULL != m_pAlbumRecord)
+	{
+		if (m_pAlbumRecord->m_CameraIsSet && !m_CameraIsSet)
+		{
+			setCameraAndAngle(AlbumFile::camera(*m_pAlbumRecord), m_pAlbumRecord->m_Angle);
+		}
+		m_ModifiedMaterials.unite(AlbumFile::createMaterials(*m_pAlbumRecord, m_FileName));
+	}
+
 	// Set camera default up vector
 	if (!m_CameraIsSet)
 	{
@@ -231,36 +241,36 @@ void FileEntry::setWorld(GLC_World& world)
 	}
 
 	// Search invisible instance
-	if (NULL != m_pInvisibleListOfInstanceName)
+	if (NULL != m_pAlbumRecord)
 	{
-		size= m_pInvisibleListOfInstanceName->size();
+		const QList<QString>& invisibleListOfInstanceName= m_pAlbumRecord->m_InvisibleInstances;
+		size= invisibleListOfInstanceName.size();
 		for (int i= 0; i < size; ++i)
 		{
-			const QString instanceName= (*m_pInvisibleListOfInstanceName)[i];
+			const QString instanceName= invisibleListOfInstanceName[i];
 			if (instanceHash.contains(instanceName))
 			{
 				instanceHash.value(instanceName)->setVisibility(false);
 			}
 		}
-		delete m_pInvisibleListOfInstanceName;
-		m_pInvisibleListOfInstanceName= NULL;
 	}
 
 
 	// Search shaded instance
-	if (NULL != m_pShadedInstanceList)
+	if (NULL != m_pAlbumRecord)
 	{
+		const QHash<QString, QList<QString> >& shadedInstanceList= m_pAlbumRecord->m_ShadedInstances;
 		// get the shader list
 		ShaderList listOfShader= OpenglView::shaderList();
 		for (ShaderList::const_iterator iShader= listOfShader.constBegin(); iShader != listOfShader.constEnd(); ++iShader)
 		{
-			if (m_pShadedInstanceList->contains((*iShader)->name()))
+			if (shadedInstanceList.contains((*iShader)->name()))
 			{
 				// Bind the shader
 				const GLuint currentShaderId= (*iShader)->id();
 				m_World.collection()->bindShader(currentShaderId);
 
-				QList<QString> instanceNameList= m_pShadedInstanceList->value((*iShader)->name());
+				QList<QString> instanceNameList= shadedInstanceList.value((*iShader)->name());
 
 				for (QList<QString>::const_iterator iInstanceName= instanceNameList.constBegin(); iInstanceName != instanceNameList.constEnd(); ++iInstanceName)
 				{
@@ -271,8 +281,11 @@ void FileEntry::setWorld(GLC_World& world)
 				}
 			}
 		}
-		delete m_pShadedInstanceList;
-		m_pShadedInstanceList= NULL;
+		// The album record is applied, it is shared with the copies of this entry
+		m_pAlbumRecord->m_CameraIsSet= false;
+		m_pAlbumRecord->m_Materials.clear();
+		m_pAlbumRecord->m_InvisibleInstances.clear();
+		m_pAlbumRecord->m_ShadedInstances.clear();
 	}
 
 	*m_pIsLoaded= true;
@@ -402,3 +415,59 @@ void FileEntry::setVboUsage(bool usage)
 {
 	m_World.collection()->setVboUsage(usage);
 }
+
+// Return the decoded album record of this entry which is not loaded, NULL if there is none
+const AlbumEntryRecord* FileEntry::albumRecord() const
+{
+	if (isLoaded()) return NULL;
+
+	decodeAlbumRecord();
+	return m_pAlbumRecord;
+}
+
+// Return the error of the decoding of the album record of this entry, empty if it is decoded
+QString FileEntry::albumRecordError() const
+{
+	decodeAlbumRecord();
+	return (NULL != m_pAlbumRecord) ? m_pAlbumRecord->m_DecodeError : QString();
+}
+
+// Set the album record applied when this entry is loaded
+void FileEntry::setAlbumRecord(const AlbumEntryRecord& record)
+{
+	Q_ASSERT(!isLoaded());
+	if (NULL == m_pAlbumRecord)
+	{
+		m_pAlbumRecord= new AlbumEntryRecord(record);
+	}
+	else
+	{
+		*m_pAlbumRecord= record;
+	}
+
+	if (record.isDecoded() && record.m_CameraIsSet)
+	{
+		setCameraAndAngle(AlbumFile::camera(record), record.m_Angle);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+// Decode the album record of this entry if it is not decoded yet
+void FileEntry::decodeAlbumRecord() const
+{
+	// The record of a binary album entry is decoded when the entry is loaded, it is decoded once
+	if ((NULL != m_pAlbumRecord) && !m_pAlbumRecord->isDecoded() && m_pAlbumRecord->m_DecodeError.isEmpty())
+	{
+		try
+		{
+			*m_pAlbumRecord= AlbumFile::readAlbumRecord(m_pAlbumRecord->m_AlbumFileName, m_pAlbumRecord->m_IndexEntry);
+		}
+		catch (GLC_Exception& e)
+		{
+			// The entry is shown without its album state, the record stays undecoded
+			m_pAlbumRecord->m_DecodeError= QString(e.what());
+		}
+	}
+}
@@ -25,6 +25,7 @@
 #ifndef FILEENTRY_H_
 #define FILEENTRY_H_
 
+#include "AlbumRecord.h"
 #include <GLC_World>
 #include <GLC_Camera>
 
@@ -47,8 +48,10 @@ public:
 	//! Default constructor
 	FileEntry(const QString& fileName= QString());
 
-	//! Construct from fileName and camera
-	FileEntry(const QString&, const GLC_Camera&, const double&, QSet<GLC_Material*>, const QList<QString>&, const QHash<QString, QList<QString> >&);
+	//! Construct from fileName and album record
+	/* The album state of the entry is applied when its world is set
+	 */
+	FileEntry(const QString&, const AlbumEntryRecord&);
 
 	//! Copy constructor
 	FileEntry(const FileEntry&);
@@ -200,6 +203,15 @@ public:
 	//! Get the list of invisible instance name
 	QList<QString> listOfInvisibleInstanceName() const;
 
+	//! Return the decoded album record of this entry which is not loaded, NULL if there is none
+	const AlbumEntryRecord* albumRecord() const;
+
+	//! Return the error of the decoding of the album record of this entry, empty if it is decoded
+	QString albumRecordError() const;
+
+	//! Set the album record applied when this entry is loaded
+	void setAlbumRecord(const AlbumEntryRecord&);
+
 	//! Return instances handle from the specified shading group
 	inline QList<QString> instanceNamesFromShadingGroup(GLuint id) const
 	{return m_World.instanceNamesFromShadingGroup(id);}
@@ -224,6 +236,14 @@ public:
 
 	//! set VBO usage
 	void setVboUsage(bool usage);
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Decode the album record of this entry if it is not decoded yet
+	void decodeAlbumRecord() const;
+
 //////////////////////////////////////////////////////////////////////
 // private member
 //////////////////////////////////////////////////////////////////////
@@ -276,11 +296,8 @@ private:
 	//! Number of this Entry
 	int* m_pNumberOfEntry;
 
-	//! The loading invisibility list of instance name
-	QList<QString>* m_pInvisibleListOfInstanceName;
-
-	//! The Qhash containing shaded instance list
-	QHash<QString, QList<QString> >* m_pShadedInstanceList;
+	//! The album record applied when the world is set
+	AlbumEntryRecord* m_pAlbumRecord;
 
 };
 
@@ -0,0 +1,421 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include "HeadlessRenderer.h"
+#include "AlbumFile.h"
+#include "OpenFileThread.h"
+#include "opengl_view/CapturePipeline.h"
+#include <GLC_State>
+#include <GLC_Exception>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
+#include <QTextStream>
+
+// Return the size of the given "WidthxHeight" string (Invalid size on error)
+static QSize sizeFromString(const QString& sizeString)
+{
+	const QStringList values(sizeString.split('x'));
+	bool widthOk= false;
+	bool heightOk= false;
+	if (values.size() == 2)
+	{
+		const QSize size(values.at(0).toInt(&widthOk), values.at(1).toInt(&heightOk));
+		if (widthOk && heightOk && (size.width() >= 0) && (size.height() >= 0)) return size;
+	}
+	return QSize();
+}
+
+HeadlessRenderer::HeadlessRenderer()
+: QObject()
+, m_OpenglView(NULL)
+, m_ThumbnailSize(128, 128)
+, m_ImageSize(800, 600)
+, m_BackgroundColor()
+, m_ErrorString()
+{
+	if (m_OpenglView.isValid())
+	{
+		// Initialize OpenGL without showing the view
+		m_OpenglView.updateGL();
+
+		// Software contexts are the target : no shaders and no VBO
+		GLC_State::setGlslUsage(false);
+		GLC_State::setVboUsage(false);
+	}
+}
+
+HeadlessRenderer::~HeadlessRenderer()
+{
+
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Static Interface
+//////////////////////////////////////////////////////////////////////
+
+// Return true if the given command line arguments ask for headless rendering
+bool HeadlessRenderer::isRequested(const QStringList& arguments)
+{
+	return arguments.contains("--headless");
+}
+
+// Run the headless rendering of the given command line arguments and return the exit code
+int HeadlessRenderer::exec(const QStringList& arguments)
+{
+	QStringList fileNames;
+	QSize thumbnailSize(128, 128);
+	QSize imageSize(800, 600);
+	QColor backgroundColor;
+	bool turntable= false;
+	bool albumConvert= false;
+	AlbumFile::AlbumFormat albumFormat= AlbumFile::XmlFormat;
+	int frames= 90;
+	int framesPerSecond= 25;
+	FrameStreamWriter::StreamFormat streamFormat= FrameStreamWriter::MjpegAvi;
+	bool argumentsOk= true;
+
+	const int count= arguments.size();
+	for (int i= 1; argumentsOk && (i < count); ++i)
+	{
+		const QString argument(arguments.at(i));
+		const bool hasValue= (i + 1) < count;
+		if (argument == "--headless")
+		{
+			continue;
+		}
+		else if (argument == "--turntable")
+		{
+			turntable= true;
+		}
+		else if (argument == "--raw")
+		{
+			streamFormat= FrameStreamWriter::RawFrames;
+		}
+		else if (argument == "--album-convert")
+		{
+			albumConvert= true;
+		}
+		else if (argument == "--binary")
+		{
+			albumFormat= AlbumFile::BinaryFormat;
+		}
+		else if ((argument == "--frames") && hasValue)
+		{
+			frames= arguments.at(++i).toInt(&argumentsOk);
+			argumentsOk= argumentsOk && (frames > 0);
+		}
+		else if ((argument == "--fps") && hasValue)
+		{
+			framesPerSecond= arguments.at(++i).toInt(&argumentsOk);
+			argumentsOk= argumentsOk && (framesPerSecond > 0);
+		}
+		else if ((argument == "--thumbnail-size") && hasValue)
+		{
+			thumbnailSize= sizeFromString(arguments.at(++i));
+			argumentsOk= thumbnailSize.isValid();
+		}
+		else if ((argument == "--image-size") && hasValue)
+		{
+			imageSize= sizeFromString(arguments.at(++i));
+			argumentsOk= imageSize.isValid();
+		}
+		else if ((argument == "--background") && hasValue)
+		{
+			backgroundColor= QColor(arguments.at(++i));
+			argumentsOk= backgroundColor.isValid();
+		}
+		else if (argument.startsWith("--"))
+		{
+			argumentsOk= false;
+		}
+		else
+		{
+			fileNames << argument;
+		}
+	}
+
+	// The album conversion does not need OpenGL
+	if (argumentsOk && albumConvert && (fileNames.size() == 2))
+	{
+		QFile sourceFile(fileNames.at(0));
+		QFile targetFile(fileNames.at(1));
+		try
+		{
+			AlbumFile().convertAlbumFile(&sourceFile, &targetFile, albumFormat);
+		}
+		catch (GLC_Exception &e)
+		{
+			printError(QString(e.what()));
+			return 1;
+		}
+		return 0;
+	}
+
+	if (!argumentsOk || (fileNames.size() != 2))
+	{
+		QString usage(tr("Usage :") + QString(" glc_player --headless <album> <target folder>"));
+		usage+= QString(" [--thumbnail-size WxH] [--image-size WxH] [--background color]\n");
+		usage+= tr("A size of 0x0 disables the thumbnails or the images") + QString("\n");
+		usage+= tr("Usage :") + QString(" glc_player --headless --turntable <model> <video file|->");
+		usage+= QString(" [--frames N] [--fps N] [--raw] [--image-size WxH] [--background color]\n");
+		usage+= tr("The video is an MJPEG AVI file, or raw RGB frames with --raw or on the standard output (-)") + QString("\n");
+		usage+= tr("Usage :") + QString(" glc_player --headless --album-convert [--binary] <source album> <target album>\n");
+		usage+= tr("Convert an album to XML, or to the binary format with --binary");
+		printError(usage);
+		return 2;
+	}
+
+	HeadlessRenderer renderer;
+	if (!renderer.isValid())
+	{
+		printError(tr("Off screen capture not supported on this system"));
+		return 1;
+	}
+	renderer.setThumbnailSize(thumbnailSize);
+	renderer.setImageSize(imageSize);
+	renderer.setBackgroundColor(backgroundColor);
+
+	if (turntable)
+	{
+		if (fileNames.at(1) == "-") streamFormat= FrameStreamWriter::RawFrames;
+		if (!renderer.renderTurntable(fileNames.at(0), fileNames.at(1), streamFormat, frames, framesPerSecond))
+		{
+			printError(renderer.errorString());
+			return 1;
+		}
+		return 0;
+	}
+
+	const int failures= renderer.renderAlbum(fileNames.at(0), fileNames.at(1));
+	if (failures < 0)
+	{
+		printError(renderer.errorString());
+		return 1;
+	}
+	return (0 == failures) ? 0 : 1;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+
+// Return true if offscreen rendering is supported
+bool HeadlessRenderer::isValid()
+{
+	return m_OpenglView.isValid() && GLC_State::frameBufferSupported();
+}
+
+// Render the models of the given album file in the given directory, return the number of failed models
+int HeadlessRenderer::renderAlbum(const QString& albumFileName, const QString& targetPath)
+{
+	QFile albumFile(albumFileName);
+	if (!albumFile.exists())
+	{
+		m_ErrorString= tr("File not found :") + QString(" ") + albumFileName;
+		return -1;
+	}
+	AlbumFile albumFileReader;
+	QList<FileEntry> fileEntries;
+	try
+	{
+		fileEntries= albumFileReader.loadAlbumFile(&albumFile);
+	}
+	catch (GLC_Exception &e)
+	{
+		m_ErrorString= tr("Wrong album file format") + QString(" : ") + QString(e.what());
+		return -1;
+	}
+
+	// Create target sub directories
+	const QString thumbnailPathName(targetPath + QDir::separator() + QString("Thumbnails") + QDir::separator());
+	const QString imagePathName(targetPath + QDir::separator() + QString("Images") + QDir::separator());
+	QDir baseDir;
+	if ((!m_ThumbnailSize.isEmpty() && !baseDir.mkpath(thumbnailPathName)) || (!m_ImageSize.isEmpty() && !baseDir.mkpath(imagePathName)))
+	{
+		m_ErrorString= tr("Failed to create sub-folders in :") + QString(" ") + targetPath;
+		return -1;
+	}
+
+	m_OpenglView.makeCurrent();
+	CapturePipeline capturePipeline(m_OpenglView.frameBufferPoolHandle());
+
+	int failures= 0;
+	QSet<QString> imageNames;
+	const int size= fileEntries.size();
+	for (int i= 0; i < size; ++i)
+	{
+		// The model is only kept during its render
+		FileEntry entry(fileEntries.at(i));
+		if (!loadEntry(entry))
+		{
+			printError(entry.getFileName() + QString(" : ") + m_ErrorString);
+			++failures;
+			continue;
+		}
+
+		// Image file name from the model name
+		QString imageName(QFileInfo(entry.getFileName()).completeBaseName());
+		if (imageNames.contains(imageName))
+		{
+			imageName+= QString("_") + QString::number(i);
+		}
+		imageNames.insert(imageName);
+		imageName+= QString(".jpg");
+
+		// The thumbnail is derived from the image if there is one
+		if (!m_ImageSize.isEmpty())
+		{
+			const QImage image(render(entry, m_ImageSize, false));
+			capturePipeline.save(image, imagePathName + imageName);
+			if (!m_ThumbnailSize.isEmpty())
+			{
+				capturePipeline.saveScaled(image, thumbnailPathName + imageName, m_ThumbnailSize);
+			}
+		}
+		else if (!m_ThumbnailSize.isEmpty())
+		{
+			capturePipeline.save(render(entry, m_ThumbnailSize, true), thumbnailPathName + imageName);
+		}
+		m_OpenglView.clear();
+	}
+	m_OpenglView.normalMode();
+
+	if (!capturePipeline.finish())
+	{
+		m_ErrorString= tr("Failed to write images in :") + QString(" ") + targetPath;
+		printError(m_ErrorString);
+		++failures;
+	}
+
+	return failures;
+}
+
+// Render a turntable of the given model file in the given stream file with the given number of frames and frame rate
+bool HeadlessRenderer::renderTurntable(const QString& modelFileName, const QString& streamFileName, FrameStreamWriter::StreamFormat format, int frames, int framesPerSecond)
+{
+	if (m_ImageSize.isEmpty())
+	{
+		m_ErrorString= tr("Invalid image size");
+		return false;
+	}
+	FileEntry entry(modelFileName);
+	if (!loadEntry(entry))
+	{
+		m_ErrorString= modelFileName + QString(" : ") + m_ErrorString;
+		return false;
+	}
+
+	FrameStreamWriter frameStreamWriter;
+	if (!frameStreamWriter.open(streamFileName, format, m_ImageSize, framesPerSecond))
+	{
+		m_ErrorString= frameStreamWriter.errorString();
+		return false;
+	}
+
+	m_OpenglView.makeCurrent();
+	m_OpenglView.captureMode(m_ImageSize, false, m_BackgroundColor);
+	m_OpenglView.clear();
+	GLC_World world(entry.getWorld());
+	m_OpenglView.add(world);
+	m_OpenglView.setEntryCamera(entry);
+
+	// Turn around the camera up axis, like the turntable shots of the main window
+	GLC_Camera* pCamera= m_OpenglView.viewportHandle()->cameraHandle();
+	const GLC_Point3d target(pCamera->target());
+	const GLC_Matrix4x4 rotationMatrix(pCamera->defaultUpVector(), 2.0 * glc::PI / static_cast<double>(frames));
+
+	bool success= true;
+	int i= 0;
+	while (success && (i < frames))
+	{
+		// The frame is encoded while the next one is rendered
+		success= frameStreamWriter.writeFrame(m_OpenglView.takeScreenshot());
+
+		pCamera->translate(- target);
+		pCamera->move(rotationMatrix);
+		pCamera->translate(target);
+		++i;
+	}
+	m_OpenglView.clear();
+	m_OpenglView.normalMode();
+
+	success= frameStreamWriter.close() && success;
+	if (!success)
+	{
+		m_ErrorString= tr("Failed to write video :") + QString(" ") + frameStreamWriter.errorString();
+	}
+	return success;
+}
+
+//////////////////////////////////////////////////////////////////////
+// private services function
+//////////////////////////////////////////////////////////////////////
+
+// Load the world of the given entry, return false on error
+bool HeadlessRenderer::loadEntry(FileEntry& entry)
+{
+	QFile file(entry.getFileName());
+	OpenFileThread fileLoader;
+	fileLoader.setOpenFile(entry.id(), &file);
+
+	// Load in the current thread
+	fileLoader.run();
+
+	GLC_World world(fileLoader.getWorld());
+	if (world.isEmpty())
+	{
+		m_ErrorString= fileLoader.getErrorMsg();
+		if (m_ErrorString.isEmpty()) m_ErrorString= tr("File Not Loaded");
+		return false;
+	}
+	entry.setWorld(world);
+	entry.setAttachedFileNames(fileLoader.attachedFiles());
+
+	return true;
+}
+
+// Render the given loaded entry at the given size
+QImage HeadlessRenderer::render(const FileEntry& entry, const QSize& size, bool smooth)
+{
+	m_OpenglView.captureMode(size, smooth, m_BackgroundColor);
+
+	// Load entry world into the view
+	m_OpenglView.clear();
+	GLC_World world(entry.getWorld());
+	m_OpenglView.add(world);
+
+	// Same camera than the interactive snapshots
+	m_OpenglView.setEntryCamera(entry);
+
+	return m_OpenglView.takeScreenshot();
+}
+
+// Print the given message on the standard error
+void HeadlessRenderer::printError(const QString& message)
+{
+	QTextStream errorStream(stderr);
+	errorStream << message << endl;
+}
@@ -0,0 +1,130 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef HEADLESSRENDERER_H_
+#define HEADLESSRENDERER_H_
+
+#include "FileEntry.h"
+#include "opengl_view/OpenglView.h"
+#include "opengl_view/FrameStreamWriter.h"
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QSize>
+#include <QColor>
+#include <QImage>
+
+//////////////////////////////////////////////////////////////////////
+//! \class HeadlessRenderer
+/*! \brief HeadlessRenderer : Render the models of an album or a turntable without main window*/
+
+/*! The models are rendered in framebuffers by an OpenglView which is
+ *  never shown, with the camera logic of the interactive snapshots.
+ *  The OpenGL context is still created by the window system, on a
+ *  server without display it can be a software context of a virtual
+ *  X server (Xvfb and Mesa)*/
+//////////////////////////////////////////////////////////////////////
+class HeadlessRenderer : public QObject
+{
+	Q_OBJECT
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	HeadlessRenderer();
+	virtual ~HeadlessRenderer();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Public Static Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if the given command line arguments ask for headless rendering
+	static bool isRequested(const QStringList&);
+
+	//! Run the headless rendering of the given command line arguments and return the exit code
+	static int exec(const QStringList&);
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if offscreen rendering is supported
+	bool isValid();
+
+	//! Set Thumbnail size (No thumbnail if the size is empty)
+	inline void setThumbnailSize(const QSize& size) {m_ThumbnailSize= size;}
+
+	//! Set Image size (No image if the size is empty)
+	inline void setImageSize(const QSize& size) {m_ImageSize= size;}
+
+	//! Set background color (Default background if not valid)
+	inline void setBackgroundColor(const QColor& color) {m_BackgroundColor= color;}
+
+	//! Render the models of the given album file in the given directory, return the number of failed models
+	int renderAlbum(const QString&, const QString&);
+
+	//! Render a turntable of the given model file in the given stream file with the given number of frames and frame rate
+	/*! The stream file name "-" is the standard output, return false on error*/
+	bool renderTurntable(const QString&, const QString&, FrameStreamWriter::StreamFormat, int frames, int framesPerSecond);
+
+	//! Return the last error message
+	inline QString errorString() const {return m_ErrorString;}
+
+//////////////////////////////////////////////////////////////////////
+// private services function
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Load the world of the given entry, return false on error
+	bool loadEntry(FileEntry&);
+
+	//! Render the given loaded entry at the given size
+	QImage render(const FileEntry&, const QSize&, bool smooth);
+
+	//! Print the given message on the standard error
+	static void printError(const QString&);
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The Opengl View used to render, never shown
+	OpenglView m_OpenglView;
+
+	//! The Thumbnail size
+	QSize m_ThumbnailSize;
+
+	//! The Image Size
+	QSize m_ImageSize;
+
+	//! Background Color
+	QColor m_BackgroundColor;
+
+	//! The last error message
+	QString m_ErrorString;
+};
+
+#endif /* HEADLESSRENDERER_H_ */
@@ -0,0 +1,620 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include "ZipArchiveWriter.h"
+#include "FileCopyEngine.h"
+#include <QObject>
+#include <QDir>
+#include <QFileInfo>
+#include <QTime>
+#include <QTimer>
+#include <QEventLoop>
+#include <QDataStream>
+#include <QSet>
+#include <QProgressDialog>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include <zlib.h>
+
+// The files up to this size are deflated in memory by worker threads, the larger ones are deflated by chunks
+static const qint64 maxCompressedEntrySize= 32 * 1024 * 1024;
+
+// Size of the chunks of the streamed entries
+static const int streamChunkSize= 1024 * 1024;
+
+// Size of the deflate window : the end of a chunk is the preset dictionary of the next one
+static const int deflateWindowSize= 32 * 1024;
+
+// Interval between two progress updates in ms
+static const int progressInterval= 100;
+
+// Sizes and offsets from this value are written in ZIP64 records
+static const qint64 zip32Limit= Q_INT64_C(0xFFFFFFFF);
+
+// The streamed entries from this size use ZIP64 records, deflate may slightly expand incompressible data
+static const qint64 zip64StreamLimit= zip32Limit - zip32Limit / 64;
+
+// Zip general purpose flags
+static const quint16 dataDescriptorFlag= 0x0008;
+static const quint16 utf8NameFlag= 0x0800;
+
+// Zip compression methods
+static const quint16 storedMethod= 0;
+static const quint16 deflatedMethod= 8;
+
+ZipArchiveWriter::ZipArchiveWriter(int maxEntriesInFlight)
+: m_Entries()
+, m_TotalSize(0)
+, m_MaxEntriesInFlight(qMax(1, maxEntriesInFlight))
+, m_Compressions()
+, m_Archive()
+, m_CentralEntries()
+, m_StreamSource()
+, m_StreamEntry()
+, m_StreamChunks()
+, m_StreamReadSize(0)
+, m_StreamDictionary()
+, m_ProcessedSize(0)
+, m_Canceled(false)
+, m_WriteTime(0)
+, m_ArchiveSize(0)
+, m_ErrorString()
+{
+
+}
+
+ZipArchiveWriter::~ZipArchiveWriter()
+{
+	const int size= m_Compressions.size();
+	for (int i= 0; i < size; ++i)
+	{
+		m_Compressions[i].waitForFinished();
+	}
+	clearStreamChunks();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+
+// Add the given source file as the entry of the given relative name
+void ZipArchiveWriter::addFile(const QString& source, const QString& name)
+{
+	const QFileInfo sourceInfo(source);
+	ZipEntry entry;
+	entry.m_Source= source;
+	entry.m_Name= QDir::fromNativeSeparators(name);
+	entry.m_Size= sourceInfo.size();
+	entry.m_Time= sourceInfo.lastModified();
+	m_Entries.append(entry);
+	m_TotalSize+= entry.m_Size;
+}
+
+// Add the given data as the entry of the given relative name
+void ZipArchiveWriter::addData(const QString& name, const QByteArray& data)
+{
+	ZipEntry entry;
+	entry.m_Data= data;
+	entry.m_Name= QDir::fromNativeSeparators(name);
+	entry.m_Size= data.size();
+	entry.m_Time= QDateTime::currentDateTime();
+	m_Entries.append(entry);
+	m_TotalSize+= entry.m_Size;
+}
+
+// Write the archive of the given file name and update the given progress dialog from the given value in the given range
+bool ZipArchiveWriter::exec(const QString& fileName, QProgressDialog* pProgress, int firstValue, int valueRange)
+{
+	Q_ASSERT(m_Compressions.isEmpty());
+	m_CentralEntries.clear();
+	m_ProcessedSize= 0;
+	m_ArchiveSize= 0;
+	m_Canceled= false;
+	m_ErrorString.clear();
+
+	// The existing archive is kept if the entries are not valid
+	if (!checkEntryNames()) return false;
+
+	m_Archive.setFileName(fileName);
+	if (!m_Archive.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		m_ErrorString= QObject::tr("Failed to create archive :") + QString("\n") + fileName + QString("\n") + m_Archive.errorString();
+		return false;
+	}
+
+	QTime writeTime;
+	writeTime.start();
+
+	const int entryCount= m_Entries.size();
+	for (int i= 0; i < entryCount; ++i)
+	{
+		m_Compressions.append(QFuture<CompressedEntry>());
+	}
+
+	// The GUI thread waits for the workers by periods of progressInterval
+	QEventLoop eventLoop;
+	QTimer timer;
+	timer.setInterval(progressInterval);
+	QObject::connect(&timer, SIGNAL(timeout()), &eventLoop, SLOT(quit()));
+	timer.start();
+
+	const QString labelText(pProgress->labelText());
+	int nextToCompress= 0;
+	int nextToWrite= 0;
+	bool success= true;
+	while (success && !m_Canceled && (nextToWrite < entryCount))
+	{
+		// The next entries are compressed while the previous ones are written
+		while ((nextToCompress < entryCount) && ((nextToCompress - nextToWrite) < m_MaxEntriesInFlight))
+		{
+			if (isCompressed(m_Entries.at(nextToCompress)))
+			{
+				m_Compressions[nextToCompress]= QtConcurrent::run(&ZipArchiveWriter::compressEntry, m_Entries.at(nextToCompress));
+			}
+			++nextToCompress;
+		}
+
+		// Write the entries in order during a progress interval
+		QTime sliceTime;
+		sliceTime.start();
+		bool waiting= false;
+		while (success && !waiting && (nextToWrite < nextToCompress) && (sliceTime.elapsed() < progressInterval))
+		{
+			const ZipEntry& entry= m_Entries.at(nextToWrite);
+			if (!isCompressed(entry))
+			{
+				bool entryWritten= false;
+				success= streamEntry(entry, &entryWritten);
+				if (entryWritten) ++nextToWrite;
+			}
+			else if (m_Compressions.at(nextToWrite).isFinished())
+			{
+				success= writeCompressedEntry(entry, m_Compressions.at(nextToWrite).result());
+				// Release the compressed data
+				m_Compressions[nextToWrite]= QFuture<CompressedEntry>();
+				++nextToWrite;
+			}
+			else
+			{
+				waiting= true;
+			}
+		}
+
+		// Update Progress dialog and chek fo cancellation
+		const double elapsed= qMax(1, writeTime.elapsed()) / 1000.0;
+		QString progressText(labelText + QString("\n"));
+		progressText+= QObject::tr("%1 of %2 (%3/s)").arg(FileCopyEngine::sizeToString(m_ProcessedSize)).arg(FileCopyEngine::sizeToString(m_TotalSize)).arg(FileCopyEngine::sizeToString(static_cast<qint64>(m_ProcessedSize / elapsed)));
+		pProgress->setLabelText(progressText);
+		const double ratio= (m_TotalSize > 0) ? (static_cast<double>(m_ProcessedSize) / static_cast<double>(m_TotalSize)) : 1.0;
+		pProgress->setValue(firstValue + static_cast<int>(ratio * valueRange));
+		m_Canceled= pProgress->wasCanceled();
+
+		if (waiting && !m_Canceled) eventLoop.exec(QEventLoop::ExcludeUserInputEvents);
+	}
+
+	success= success && !m_Canceled && writeCentralDirectory();
+
+	// Wait for the compressions in progress
+	for (int i= 0; i < entryCount; ++i)
+	{
+		m_Compressions[i].waitForFinished();
+	}
+	m_Compressions.clear();
+	clearStreamChunks();
+	if (m_StreamSource.isOpen())
+	{
+		m_StreamSource.close();
+	}
+
+	m_ArchiveSize= m_Archive.size();
+	m_Archive.close();
+	if (success && (QFile::NoError != m_Archive.error()))
+	{
+		m_ErrorString= QObject::tr("Failed to write archive :") + QString("\n") + fileName + QString("\n") + m_Archive.errorString();
+		success= false;
+	}
+	if (!success)
+	{
+		// Remove the partial archive
+		m_Archive.remove();
+	}
+
+	m_WriteTime= writeTime.elapsed();
+	pProgress->setLabelText(labelText);
+	return success;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Return true if the given entry is compressed by a worker thread
+bool ZipArchiveWriter::isCompressed(const ZipEntry& entry)
+{
+	return entry.m_Source.isEmpty() || (entry.m_Size <= maxCompressedEntrySize);
+}
+
+// Write the given compressed entry
+bool ZipArchiveWriter::writeCompressedEntry(const ZipEntry& entry, const CompressedEntry& compressedEntry)
+{
+	if (!compressedEntry.m_ErrorString.isEmpty())
+	{
+		m_ErrorString= compressedEntry.m_ErrorString;
+		return false;
+	}
+
+	CentralEntry centralEntry;
+	centralEntry.m_Name= entry.m_Name.toUtf8();
+	centralEntry.m_Flags= utf8NameFlag;
+	centralEntry.m_Method= compressedEntry.m_Deflated ? deflatedMethod : storedMethod;
+	centralEntry.m_DosTime= dosTime(entry.m_Time);
+	centralEntry.m_Crc= compressedEntry.m_Crc;
+	centralEntry.m_CompressedSize= compressedEntry.m_Data.size();
+	centralEntry.m_Size= entry.m_Size;
+	centralEntry.m_Offset= m_Archive.pos();
+	centralEntry.m_Zip64= false;
+
+	if (!write(localHeader(centralEntry)) || !write(compressedEntry.m_Data)) return false;
+
+	m_CentralEntries.append(centralEntry);
+	m_ProcessedSize+= entry.m_Size;
+	return true;
+}
+
+// Write the next chunk of the given streamed entry, set to true the given flag if the entry is complete
+bool ZipArchiveWriter::streamEntry(const ZipEntry& entry, bool* pWritten)
+{
+	if (!m_StreamSource.isOpen())
+	{
+		// The crc is only known at the end, it is written in a data descriptor
+		m_StreamSource.setFileName(entry.m_Source);
+		if (!m_StreamSource.open(QIODevice::ReadOnly))
+		{
+			m_ErrorString= QObject::tr("Failed to read file :") + QString("\n") + entry.m_Source + QString("\n") + m_StreamSource.errorString();
+			return false;
+		}
+		m_StreamEntry.m_Name= entry.m_Name.toUtf8();
+		m_StreamEntry.m_Flags= utf8NameFlag | dataDescriptorFlag;
+		m_StreamEntry.m_Method= deflatedMethod;
+		m_StreamEntry.m_DosTime= dosTime(entry.m_Time);
+		m_StreamEntry.m_Crc= 0;
+		m_StreamEntry.m_CompressedSize= 0;
+		m_StreamEntry.m_Size= 0;
+		m_StreamEntry.m_Offset= m_Archive.pos();
+		// The local header, the data descriptor and the central header use the same ZIP64 choice
+		m_StreamEntry.m_Zip64= entry.m_Size >= zip64StreamLimit;
+		m_StreamReadSize= 0;
+		m_StreamDictionary.clear();
+		if (!write(localHeader(m_StreamEntry))) return false;
+	}
+
+	// The next chunks are deflated by worker threads while the first one is written
+	const int maxChunksInFlight= qMax(m_MaxEntriesInFlight, QThread::idealThreadCount());
+	while ((m_StreamReadSize < entry.m_Size) && (m_StreamChunks.size() < maxChunksInFlight))
+	{
+		const QByteArray chunk(m_StreamSource.read(qMin(static_cast<qint64>(streamChunkSize), entry.m_Size - m_StreamReadSize)));
+		if (chunk.isEmpty())
+		{
+			m_ErrorString= QObject::tr("Failed to read file :") + QString("\n") + entry.m_Source;
+			return false;
+		}
+		m_StreamReadSize+= chunk.size();
+		const bool last= (m_StreamReadSize == entry.m_Size);
+		m_StreamChunks.append(QtConcurrent::run(&ZipArchiveWriter::compressChunk, chunk, m_StreamDictionary, last));
+		m_StreamDictionary= chunk.right(deflateWindowSize);
+	}
+
+	const CompressedChunk compressedChunk(m_StreamChunks.takeFirst().result());
+	if (!compressedChunk.m_Success)
+	{
+		m_ErrorString= QObject::tr("Failed to compress file :") + QString("\n") + entry.m_Source;
+		return false;
+	}
+	m_StreamEntry.m_Crc= crc32_combine(m_StreamEntry.m_Crc, compressedChunk.m_Crc, compressedChunk.m_Size);
+	m_StreamEntry.m_Size+= compressedChunk.m_Size;
+	m_StreamEntry.m_CompressedSize+= compressedChunk.m_Data.size();
+	m_ProcessedSize+= compressedChunk.m_Size;
+	if (!write(compressedChunk.m_Data)) return false;
+
+	if (m_StreamEntry.m_Size < entry.m_Size) return true;
+
+	// The file must not have grown since it was added
+	const bool readAll= m_StreamSource.atEnd();
+	m_StreamSource.close();
+	m_StreamDictionary.clear();
+	if (!readAll || (QFile::NoError != m_StreamSource.error()))
+	{
+		m_ErrorString= QObject::tr("Failed to read file :") + QString("\n") + entry.m_Source;
+		return false;
+	}
+	if (!m_StreamEntry.m_Zip64 && (m_StreamEntry.m_CompressedSize >= zip32Limit))
+	{
+		m_ErrorString= QObject::tr("Failed to compress file :") + QString("\n") + entry.m_Source;
+		return false;
+	}
+
+	// Data descriptor
+	QByteArray descriptor;
+	QDataStream stream(&descriptor, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream << static_cast<quint32>(0x08074b50) << m_StreamEntry.m_Crc;
+	if (m_StreamEntry.m_Zip64)
+	{
+		stream << static_cast<quint64>(m_StreamEntry.m_CompressedSize) << static_cast<quint64>(m_StreamEntry.m_Size);
+	}
+	else
+	{
+		stream << static_cast<quint32>(m_StreamEntry.m_CompressedSize) << static_cast<quint32>(m_StreamEntry.m_Size);
+	}
+	if (!write(descriptor)) return false;
+
+	m_CentralEntries.append(m_StreamEntry);
+	*pWritten= true;
+	return true;
+}
+
+// Wait for the compressions of the streamed entry chunks
+void ZipArchiveWriter::clearStreamChunks()
+{
+	const int size= m_StreamChunks.size();
+	for (int i= 0; i < size; ++i)
+	{
+		m_StreamChunks[i].waitForFinished();
+	}
+	m_StreamChunks.clear();
+	m_StreamDictionary.clear();
+}
+
+// Return false and set the error message if two entries have the same name
+bool ZipArchiveWriter::checkEntryNames()
+{
+	QSet<QString> names;
+	const int size= m_Entries.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const QString& name= m_Entries.at(i).m_Name;
+		if (names.contains(name))
+		{
+			m_ErrorString= QObject::tr("Two files have the same name in the archive :") + QString("\n") + name;
+			return false;
+		}
+		names.insert(name);
+	}
+	return true;
+}
+
+// Write the central directory and the end of the archive
+bool ZipArchiveWriter::writeCentralDirectory()
+{
+	const qint64 directoryOffset= m_Archive.pos();
+	const int entryCount= m_CentralEntries.size();
+	for (int i= 0; i < entryCount; ++i)
+	{
+		if (!write(centralHeader(m_CentralEntries.at(i)))) return false;
+	}
+	const qint64 directorySize= m_Archive.pos() - directoryOffset;
+
+	QByteArray end;
+	QDataStream stream(&end, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	const bool zip64= (entryCount >= 0xFFFF) || (directoryOffset >= zip32Limit) || (directorySize >= zip32Limit);
+	if (zip64)
+	{
+		// ZIP64 end of central directory record and locator
+		const qint64 zip64EndOffset= m_Archive.pos();
+		stream << static_cast<quint32>(0x06064b50) << static_cast<quint64>(44);
+		stream << static_cast<quint16>(45) << static_cast<quint16>(45);				// Version made by and needed
+		stream << static_cast<quint32>(0) << static_cast<quint32>(0);					// Disk numbers
+		stream << static_cast<quint64>(entryCount) << static_cast<quint64>(entryCount);
+		stream << static_cast<quint64>(directorySize) << static_cast<quint64>(directoryOffset);
+
+		stream << static_cast<quint32>(0x07064b50) << static_cast<quint32>(0);
+		stream << static_cast<quint64>(zip64EndOffset) << static_cast<quint32>(1);
+	}
+
+	// End of central directory record
+	const quint16 shortCount= static_cast<quint16>(qMin(entryCount, 0xFFFF));
+	stream << static_cast<quint32>(0x06054b50) << static_cast<quint16>(0) << static_cast<quint16>(0);
+	stream << shortCount << shortCount;
+	stream << static_cast<quint32>(qMin(directorySize, zip32Limit));
+	stream << static_cast<quint32>(qMin(directoryOffset, zip32Limit));
+	stream << static_cast<quint16>(0);													// Comment length
+
+	return write(end);
+}
+
+// Write the given data in the archive
+bool ZipArchiveWriter::write(const QByteArray& data)
+{
+	if (m_Archive.write(data) != data.size())
+	{
+		m_ErrorString= QObject::tr("Failed to write archive :") + QString("\n") + m_Archive.fileName() + QString("\n") + m_Archive.errorString();
+		return false;
+	}
+	return true;
+}
+
+// Return the local header of the given entry, with a ZIP64 extra field if the entry has one
+QByteArray ZipArchiveWriter::localHeader(const CentralEntry& entry)
+{
+	const bool zip64= entry.m_Zip64;
+	QByteArray header;
+	QDataStream stream(&header, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream << static_cast<quint32>(0x04034b50);
+	stream << static_cast<quint16>(zip64 ? 45 : 20);										// Version needed
+	stream << entry.m_Flags << entry.m_Method << entry.m_DosTime << entry.m_Crc;
+	if (zip64)
+	{
+		// The sizes are in the extra field and in the data descriptor
+		stream << static_cast<quint32>(0xFFFFFFFF) << static_cast<quint32>(0xFFFFFFFF);
+	}
+	else
+	{
+		stream << static_cast<quint32>(entry.m_CompressedSize) << static_cast<quint32>(entry.m_Size);
+	}
+	stream << static_cast<quint16>(entry.m_Name.size()) << static_cast<quint16>(zip64 ? 20 : 0);
+	stream.writeRawData(entry.m_Name.constData(), entry.m_Name.size());
+	if (zip64)
+	{
+		stream << static_cast<quint16>(0x0001) << static_cast<quint16>(16);
+		stream << static_cast<quint64>(entry.m_Size) << static_cast<quint64>(entry.m_CompressedSize);
+	}
+	return header;
+}
+
+// Return the central directory header of the given entry
+QByteArray ZipArchiveWriter::centralHeader(const CentralEntry& entry)
+{
+	// The ZIP64 extra field holds the values which overflow, the sizes are in it as in the local header
+	const bool zip64Sizes= entry.m_Zip64 || (entry.m_Size >= zip32Limit) || (entry.m_CompressedSize >= zip32Limit);
+	QByteArray extra;
+	QDataStream extraStream(&extra, QIODevice::WriteOnly);
+	extraStream.setByteOrder(QDataStream::LittleEndian);
+	if (zip64Sizes) extraStream << static_cast<quint64>(entry.m_Size) << static_cast<quint64>(entry.m_CompressedSize);
+	if (entry.m_Offset >= zip32Limit) extraStream << static_cast<quint64>(entry.m_Offset);
+	const bool zip64= !extra.isEmpty();
+	if (zip64)
+	{
+		QByteArray extraHeader;
+		QDataStream extraHeaderStream(&extraHeader, QIODevice::WriteOnly);
+		extraHeaderStream.setByteOrder(QDataStream::LittleEndian);
+		extraHeaderStream << static_cast<quint16>(0x0001) << static_cast<quint16>(extra.size());
+		extra.prepend(extraHeader);
+	}
+
+	QByteArray header;
+	QDataStream stream(&header, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream << static_cast<quint32>(0x02014b50);
+	stream << static_cast<quint16>(zip64 ? 45 : 20) << static_cast<quint16>(zip64 ? 45 : 20);	// Version made by and needed
+	stream << entry.m_Flags << entry.m_Method << entry.m_DosTime << entry.m_Crc;
+	stream << static_cast<quint32>(zip64Sizes ? zip32Limit : entry.m_CompressedSize);
+	stream << static_cast<quint32>(zip64Sizes ? zip32Limit : entry.m_Size);
+	stream << static_cast<quint16>(entry.m_Name.size()) << static_cast<quint16>(extra.size());
+	stream << static_cast<quint16>(0) << static_cast<quint16>(0) << static_cast<quint16>(0);	// Comment length, disk and internal attributes
+	stream << static_cast<quint32>(0);														// External attributes
+	stream << static_cast<quint32>(qMin(entry.m_Offset, zip32Limit));
+	stream.writeRawData(entry.m_Name.constData(), entry.m_Name.size());
+	stream.writeRawData(extra.constData(), extra.size());
+	return header;
+}
+
+// Deflate the given entry (Run by worker threads)
+ZipArchiveWriter::CompressedEntry ZipArchiveWriter::compressEntry(ZipEntry entry)
+{
+	CompressedEntry compressedEntry;
+	compressedEntry.m_Crc= 0;
+	compressedEntry.m_Deflated= false;
+
+	QByteArray data(entry.m_Data);
+	if (!entry.m_Source.isEmpty())
+	{
+		QFile source(entry.m_Source);
+		if (source.open(QIODevice::ReadOnly))
+		{
+			data= source.readAll();
+		}
+		if ((QFile::NoError != source.error()) || (data.size() != entry.m_Size))
+		{
+			compressedEntry.m_ErrorString= QObject::tr("Failed to read file :") + QString("\n") + entry.m_Source;
+			return compressedEntry;
+		}
+	}
+	compressedEntry.m_Crc= crc32(0L, reinterpret_cast<const Bytef*>(data.constData()), static_cast<uInt>(data.size()));
+
+	// qCompress output is the data size followed by a zlib stream : 2 bytes header, deflate data and 4 bytes checksum
+	if (!data.isEmpty())
+	{
+		const QByteArray zlibData(qCompress(data));
+		const int deflateSize= zlibData.size() - 10;
+		if ((deflateSize > 0) && (deflateSize < data.size()))
+		{
+			compressedEntry.m_Data= zlibData.mid(6, deflateSize);
+			compressedEntry.m_Deflated= true;
+			return compressedEntry;
+		}
+	}
+	compressedEntry.m_Data= data;
+	return compressedEntry;
+}
+
+// Deflate the given chunk with the given preset dictionary, end the deflate stream if last (Run by worker threads)
+ZipArchiveWriter::CompressedChunk ZipArchiveWriter::compressChunk(QByteArray chunk, QByteArray dictionary, bool last)
+{
+	CompressedChunk compressedChunk;
+	compressedChunk.m_Crc= crc32(0L, reinterpret_cast<const Bytef*>(chunk.constData()), static_cast<uInt>(chunk.size()));
+	compressedChunk.m_Size= chunk.size();
+	compressedChunk.m_Success= false;
+
+	// Raw deflate stream, the zip headers replace the zlib ones
+	z_stream stream;
+	stream.zalloc= Z_NULL;
+	stream.zfree= Z_NULL;
+	stream.opaque= Z_NULL;
+	if (Z_OK != deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY))
+	{
+		return compressedChunk;
+	}
+	if (!dictionary.isEmpty())
+	{
+		deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dictionary.constData()), static_cast<uInt>(dictionary.size()));
+	}
+
+	// A chunk ends on a byte boundary with a sync flush, so the chunks are concatenated in one deflate stream
+	compressedChunk.m_Data.resize(static_cast<int>(deflateBound(&stream, chunk.size())) + 16);
+	stream.next_in= reinterpret_cast<Bytef*>(const_cast<char*>(chunk.constData()));
+	stream.avail_in= static_cast<uInt>(chunk.size());
+	stream.next_out= reinterpret_cast<Bytef*>(compressedChunk.m_Data.data());
+	stream.avail_out= static_cast<uInt>(compressedChunk.m_Data.size());
+	const int status= deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+	if (last)
+	{
+		compressedChunk.m_Success= (Z_STREAM_END == status);
+	}
+	else
+	{
+		compressedChunk.m_Success= (Z_OK == status) && (0 == stream.avail_in) && (0 != stream.avail_out);
+	}
+	compressedChunk.m_Data.resize(static_cast<int>(stream.total_out));
+	deflateEnd(&stream);
+
+	return compressedChunk;
+}
+
+// Return the given date time in MS-DOS format
+quint32 ZipArchiveWriter::dosTime(const QDateTime& dateTime)
+{
+	const QDate date(dateTime.date());
+	const QTime time(dateTime.time());
+	if (!dateTime.isValid() || (date.year() < 1980))
+	{
+		// 1980-01-01 00:00
+		return static_cast<quint32>(0x00210000);
+	}
+	const quint32 dosDate= ((date.year() - 1980) << 9) | (date.month() << 5) | date.day();
+	const quint32 dosClock= (time.hour() << 11) | (time.minute() << 5) | (time.second() / 2);
+	return (dosDate << 16) | dosClock;
+}
@@ -0,0 +1,240 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef ZIPARCHIVEWRITER_H_
+#define ZIPARCHIVEWRITER_H_
+
+#include <QList>
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QFuture>
+#include <QFile>
+
+class QProgressDialog;
+
+//////////////////////////////////////////////////////////////////////
+//! \class ZipArchiveWriter
+/*! \brief ZipArchiveWriter : Stream a list of files in a zip archive*/
+
+/*! The files are read once and written straight in the archive, no
+ *  temporary copy is made. The files up to a few mega bytes are deflated
+ *  in memory by worker threads, one entry per thread, while the GUI
+ *  thread writes the finished entries in order. The larger files are
+ *  split in chunks which are deflated by worker threads and written in
+ *  order as a single deflate stream. ZIP64 records are used when the
+ *  archive or an entry exceed 4 GB*/
+//////////////////////////////////////////////////////////////////////
+class ZipArchiveWriter
+{
+private:
+	//! An entry of the archive
+	struct ZipEntry
+	{
+		QString m_Source;
+		QByteArray m_Data;
+		QString m_Name;
+		qint64 m_Size;
+		QDateTime m_Time;
+	};
+
+	//! The result of the compression of an entry
+	struct CompressedEntry
+	{
+		QByteArray m_Data;
+		quint32 m_Crc;
+		bool m_Deflated;
+		QString m_ErrorString;
+	};
+
+	//! The result of the compression of a chunk of a streamed entry
+	struct CompressedChunk
+	{
+		QByteArray m_Data;
+		quint32 m_Crc;
+		qint64 m_Size;
+		bool m_Success;
+	};
+
+	//! An entry of the central directory
+	struct CentralEntry
+	{
+		QByteArray m_Name;
+		quint16 m_Flags;
+		quint16 m_Method;
+		quint32 m_DosTime;
+		quint32 m_Crc;
+		qint64 m_CompressedSize;
+		qint64 m_Size;
+		qint64 m_Offset;
+		//! True if the local header has a ZIP64 extra field
+		bool m_Zip64;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a writer which compresses at most the given number of entries at the same time
+	ZipArchiveWriter(int maxEntriesInFlight= 4);
+
+	//! Wait the end of the compressions
+	~ZipArchiveWriter();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Add the given source file as the entry of the given relative name
+	void addFile(const QString&, const QString&);
+
+	//! Add the given data as the entry of the given relative name
+	void addData(const QString&, const QByteArray&);
+
+	//! Return the number of entries
+	inline int numberOfEntries() const
+	{return m_Entries.size();}
+
+	//! Return the size of the entries
+	inline qint64 totalSize() const
+	{return m_TotalSize;}
+
+	//! Write the archive of the given file name and update the given progress dialog from the given value in the given range
+	/*! Return false on error or if the writing is canceled, the archive is then removed*/
+	bool exec(const QString&, QProgressDialog*, int firstValue, int valueRange);
+
+	//! Return true if the writing has been canceled by the user
+	inline bool wasCanceled() const
+	{return m_Canceled;}
+
+	//! Return the time spent to write the archive in ms
+	inline int writeTime() const
+	{return m_WriteTime;}
+
+	//! Return the size of the written archive
+	inline qint64 archiveSize() const
+	{return m_ArchiveSize;}
+
+	//! Return the last error message
+	inline QString errorString() const
+	{return m_ErrorString;}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Return true if the given entry is compressed by a worker thread
+	static bool isCompressed(const ZipEntry&);
+
+	//! Write the given compressed entry
+	bool writeCompressedEntry(const ZipEntry&, const CompressedEntry&);
+
+	//! Write the next chunk of the given streamed entry, set to true the given flag if the entry is complete
+	/*! The next chunks are read and given to worker threads, the GUI thread
+	 *  only waits for the first chunk which is at most one chunk compression*/
+	bool streamEntry(const ZipEntry&, bool*);
+
+	//! Wait for the compressions of the streamed entry chunks
+	void clearStreamChunks();
+
+	//! Return false and set the error message if two entries have the same name
+	bool checkEntryNames();
+
+	//! Write the central directory and the end of the archive
+	bool writeCentralDirectory();
+
+	//! Write the given data in the archive
+	bool write(const QByteArray&);
+
+	//! Return the local header of the given entry, with a ZIP64 extra field if the entry has one
+	static QByteArray localHeader(const CentralEntry&);
+
+	//! Return the central directory header of the given entry
+	static QByteArray centralHeader(const CentralEntry&);
+
+	//! Deflate the given entry (Run by worker threads)
+	static CompressedEntry compressEntry(ZipEntry);
+
+	//! Deflate the given chunk with the given preset dictionary, end the deflate stream if last (Run by worker threads)
+	static CompressedChunk compressChunk(QByteArray, QByteArray, bool last);
+
+	//! Return the given date time in MS-DOS format
+	static quint32 dosTime(const QDateTime&);
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The entries of the archive
+	QList<ZipEntry> m_Entries;
+
+	//! The size of the entries
+	qint64 m_TotalSize;
+
+	//! The maximum number of entries compressed at the same time
+	int m_MaxEntriesInFlight;
+
+	//! The compressions of the entries
+	QList<QFuture<CompressedEntry> > m_Compressions;
+
+	//! The archive file
+	QFile m_Archive;
+
+	//! The entries already written
+	QList<CentralEntry> m_CentralEntries;
+
+	//! The source file of the streamed entry being written
+	QFile m_StreamSource;
+
+	//! The streamed entry being written
+	CentralEntry m_StreamEntry;
+
+	//! The compressions of the read chunks of the streamed entry
+	QList<QFuture<CompressedChunk> > m_StreamChunks;
+
+	//! The size of the streamed entry already read
+	qint64 m_StreamReadSize;
+
+	//! The end of the last read chunk, preset dictionary of the next one
+	QByteArray m_StreamDictionary;
+
+	//! The size of the entries already read
+	qint64 m_ProcessedSize;
+
+	//! True if the writing has been canceled
+	bool m_Canceled;
+
+	//! The time spent to write the archive in ms
+	int m_WriteTime;
+
+	//! The size of the written archive
+	qint64 m_ArchiveSize;
+
+	//! The last error message
+	QString m_ErrorString;
+};
+
+#endif /* ZIPARCHIVEWRITER_H_ */
@@ -0,0 +1,218 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+#include "AlbumBenchmark.h"
+#include "../AlbumFile.h"
+#include <GLC_Exception>
+#include <QObject>
+#include <QStringList>
+#include <QDir>
+#include <QBuffer>
+#include <QTime>
+#include <QTextStream>
+#include <QXmlStreamWriter>
+#include <QCoreApplication>
+
+// Number of parsing of the synthetic album
+static const int benchmarkRuns= 3;
+
+// Print the given message on the standard error
+static void printError(const QString& message)
+{
+	QTextStream errorStream(stderr);
+	errorStream << message << endl;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Static Interface
+//////////////////////////////////////////////////////////////////////
+
+// Time the parsing of a synthetic album of the given number of entries in both formats, return the exit code
+int AlbumBenchmark::exec(int numberOfEntries)
+{
+	QList<QByteArray> albumsData;
+	albumsData.append(syntheticAlbum(numberOfEntries));
+	QStringList formatNames;
+	formatNames << QObject::tr("XML") << QObject::tr("Binary");
+
+	// The same album in the binary format
+	QByteArray binaryData;
+	try
+	{
+		QBuffer xmlBuffer(&albumsData.first());
+		xmlBuffer.open(QIODevice::ReadOnly);
+		QBuffer binaryBuffer(&binaryData);
+		binaryBuffer.open(QIODevice::WriteOnly);
+		AlbumFile().convertAlbumFile(&xmlBuffer, QDir::current(), &binaryBuffer, QDir::current(), AlbumFile::BinaryFormat);
+	}
+	catch (GLC_Exception &e)
+	{
+		printError(QObject::tr("Wrong album file format") + QString(" : ") + QString(e.what()));
+		return 1;
+	}
+	albumsData.append(binaryData);
+
+	QTextStream outputStream(stdout);
+	for (int format= 0; format < albumsData.size(); ++format)
+	{
+		outputStream << QObject::tr("Synthetic %1 album : %2 entries, %3 bytes").arg(formatNames.at(format)).arg(numberOfEntries).arg(albumsData.at(format).size()) << endl;
+
+		int bestTime= -1;
+		for (int run= 0; run < benchmarkRuns; ++run)
+		{
+			QBuffer albumBuffer(&albumsData[format]);
+			albumBuffer.open(QIODevice::ReadOnly);
+			AlbumFile albumFileReader;
+			QTime parseTime;
+			parseTime.start();
+			int parsedEntries= 0;
+			try
+			{
+				parsedEntries= albumFileReader.loadAlbumFile(&albumBuffer, QDir::current()).size();
+			}
+			catch (GLC_Exception &e)
+			{
+				printError(QObject::tr("Wrong album file format") + QString(" : ") + QString(e.what()));
+				return 1;
+			}
+			const int elapsed= parseTime.elapsed();
+			bestTime= (bestTime < 0) ? elapsed : qMin(bestTime, elapsed);
+			outputStream << QObject::tr("Run %1 : %2 entries parsed in %3 ms").arg(run + 1).arg(parsedEntries).arg(elapsed) << endl;
+		}
+		const double entriesPerSecond= numberOfEntries * 1000.0 / qMax(1, bestTime);
+		outputStream << QObject::tr("Best : %1 ms (%2 entries/s)").arg(bestTime).arg(entriesPerSecond, 0, 'f', 0) << endl;
+	}
+
+	// The binary album entries are listed from its index
+	QBuffer binaryBuffer(&binaryData);
+	binaryBuffer.open(QIODevice::ReadOnly);
+	QTime indexTime;
+	indexTime.start();
+	const int indexSize= AlbumFile::readAlbumIndex(&binaryBuffer).size();
+	outputStream << QObject::tr("Binary album index : %1 entries listed in %2 ms").arg(indexSize).arg(indexTime.elapsed()) << endl;
+
+	return 0;
+}
+
+// Return a synthetic album of the given number of entries
+QByteArray AlbumBenchmark::syntheticAlbum(int numberOfEntries)
+{
+	// Each model has a camera, materials, invisible instances and shaded instances
+	QByteArray albumData;
+	QXmlStreamWriter streamWriter(&albumData);
+	streamWriter.setAutoFormatting(true);
+	streamWriter.writeStartDocument();
+	streamWriter.writeStartElement("Album");
+	streamWriter.writeStartElement("Header");
+	streamWriter.writeStartElement("Application");
+	streamWriter.writeAttribute("Name", QCoreApplication::applicationName());
+	streamWriter.writeAttribute("Version", "2.1");
+	streamWriter.writeEndElement(); // Application
+	streamWriter.writeEndElement(); // Header
+	streamWriter.writeStartElement("Root");
+
+	QStringList vectorNames;
+	vectorNames << "Eye" << "Target" << "Up" << "DefaultUp";
+	QStringList colorNames;
+	colorNames << "Ambiant" << "Diffuse" << "Specular" << "LightEmission";
+	const int materialsByModel= 4;
+	const int instancesByList= 8;
+	for (int i= 0; i < numberOfEntries; ++i)
+	{
+		const QString modelName(QString("model_%1.3dxml").arg(i));
+		streamWriter.writeStartElement("Model");
+		streamWriter.writeAttribute("AFileName", QString("/synthetic/") + modelName);
+		streamWriter.writeAttribute("RFileName", modelName);
+
+		streamWriter.writeStartElement("Camera");
+		streamWriter.writeAttribute("Angle", "30");
+		for (int j= 0; j < vectorNames.size(); ++j)
+		{
+			streamWriter.writeStartElement(vectorNames.at(j));
+			streamWriter.writeAttribute("x", QString::number(j));
+			streamWriter.writeAttribute("y", QString::number(i % 100));
+			streamWriter.writeAttribute("z", QString::number(1.5));
+			streamWriter.writeEndElement();
+		}
+		streamWriter.writeEndElement(); // Camera
+
+		streamWriter.writeStartElement("Materials");
+		streamWriter.writeAttribute("size", QString::number(materialsByModel));
+		for (int j= 0; j < materialsByModel; ++j)
+		{
+			streamWriter.writeStartElement("Material");
+			streamWriter.writeAttribute("name", QString("Material_%1").arg(j));
+			for (int k= 0; k < colorNames.size(); ++k)
+			{
+				streamWriter.writeStartElement(colorNames.at(k));
+				streamWriter.writeAttribute("r", QString::number((i + k) % 256));
+				streamWriter.writeAttribute("g", QString::number((i * 3) % 256));
+				streamWriter.writeAttribute("b", QString::number(j * 50));
+				streamWriter.writeAttribute("a", "255");
+				streamWriter.writeEndElement();
+			}
+			streamWriter.writeStartElement("Shininess");
+			streamWriter.writeAttribute("value", "50");
+			streamWriter.writeEndElement(); // Shininess
+			streamWriter.writeStartElement("Texture");
+			streamWriter.writeAttribute("fileName", QString());
+			streamWriter.writeEndElement(); // Texture
+			streamWriter.writeEndElement(); // Material
+		}
+		streamWriter.writeEndElement(); // Materials
+
+		streamWriter.writeStartElement("InvisibleInstances");
+		streamWriter.writeAttribute("size", QString::number(instancesByList));
+		for (int j= 0; j < instancesByList; ++j)
+		{
+			streamWriter.writeStartElement("Instance");
+			streamWriter.writeAttribute("name", QString("Part_%1").arg(j));
+			streamWriter.writeEndElement(); // Instance
+		}
+		streamWriter.writeEndElement(); // InvisibleInstances
+
+		streamWriter.writeStartElement("Shaders");
+		streamWriter.writeAttribute("size", "1");
+		streamWriter.writeStartElement("Shader");
+		streamWriter.writeAttribute("name", "Shader");
+		streamWriter.writeAttribute("size", QString::number(instancesByList));
+		for (int j= 0; j < instancesByList; ++j)
+		{
+			streamWriter.writeStartElement("Instance");
+			streamWriter.writeAttribute("name", QString("Shaded_Part_%1").arg(j));
+			streamWriter.writeEndElement(); // Instance
+		}
+		streamWriter.writeEndElement(); // Shader
+		streamWriter.writeEndElement(); // Shaders
+
+		streamWriter.writeEndElement(); // Model
+	}
+
+	streamWriter.writeEndElement(); // Root
+	streamWriter.writeEndElement(); // Album
+	streamWriter.writeEndDocument();
+
+	return albumData;
+}
@@ -0,0 +1,52 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+#ifndef ALBUMBENCHMARK_H_
+#define ALBUMBENCHMARK_H_
+
+#include <QByteArray>
+
+//////////////////////////////////////////////////////////////////////
+//! \class AlbumBenchmark
+/*! \brief AlbumBenchmark : Time the parsing of a synthetic album*/
+
+/*! The synthetic album is parsed in the XML and in the binary format,
+ *  then the binary album is listed from its index. This tool is not
+ *  part of GLC_Player, it is built by benchmark/album_benchmark.pro*/
+//////////////////////////////////////////////////////////////////////
+class AlbumBenchmark
+{
+//////////////////////////////////////////////////////////////////////
+// Public Static Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Time the parsing of a synthetic album of the given number of entries in both formats, return the exit code
+	static int exec(int);
+
+	//! Return a synthetic album of the given number of entries
+	static QByteArray syntheticAlbum(int);
+};
+
+#endif /* ALBUMBENCHMARK_H_ */
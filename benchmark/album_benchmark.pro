@@ -0,0 +1,44 @@
+# Album parsing benchmark, not part of the GLC_Player binary
+TEMPLATE = app
+CONFIG += warn_on console
+CONFIG -= app_bundle
+TARGET = album_benchmark
+
+unix:OBJECTS_DIR = ./Build
+unix:MOC_DIR = ./Build
+
+QT += core \
+    gui \
+    opengl \
+    xml
+
+win32 { 
+    LIBS += -L"$$(GLC_LIB_DIR)/lib" \
+        -lGLC_lib2
+    DEPENDPATH+= "$$(GLC_LIB_DIR)/lib"
+    INCLUDEPATH += "$$(GLC_LIB_DIR)/include"
+}
+
+unix { 
+    LIBS += -lGLC_lib
+    INCLUDEPATH += "/usr/local/include/GLC_lib-2.5"
+}
+
+# The album reader and the view it depends on
+HEADERS +=	AlbumBenchmark.h \
+			../AlbumFile.h \
+			../AlbumRecord.h \
+			../FileEntry.h \
+			../opengl_view/OpenglView.h \
+			../opengl_view/PickingEngine.h \
+			../opengl_view/FrameBufferPool.h \
+			../opengl_view/TiffStripWriter.h
+
+SOURCES +=	main.cpp \
+			AlbumBenchmark.cpp \
+			../AlbumFile.cpp \
+			../FileEntry.cpp \
+			../opengl_view/OpenglView.cpp \
+			../opengl_view/PickingEngine.cpp \
+			../opengl_view/FrameBufferPool.cpp \
+			../opengl_view/TiffStripWriter.cpp
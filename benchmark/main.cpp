@@ -0,0 +1,60 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+
+#include "AlbumBenchmark.h"
+
+#include <QApplication>
+#include <QStringList>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+	QApplication app(argc, argv);
+	QCoreApplication::setApplicationName("GLC_Player");
+
+	// The number of entries of the synthetic album
+	int numberOfEntries= 10000;
+	bool argumentsOk= true;
+	const QStringList arguments(QCoreApplication::arguments());
+	if ((arguments.size() == 3) && (arguments.at(1) == "--entries"))
+	{
+		numberOfEntries= arguments.at(2).toInt(&argumentsOk);
+		argumentsOk= argumentsOk && (numberOfEntries > 0);
+	}
+	else if (arguments.size() != 1)
+	{
+		argumentsOk= false;
+	}
+
+	if (!argumentsOk)
+	{
+		QTextStream errorStream(stderr);
+		errorStream << QObject::tr("Usage :") << " album_benchmark [--entries N]" << endl;
+		errorStream << QObject::tr("Time the parsing of a synthetic album of N entries (10000 by default)") << endl;
+		return 2;
+	}
+
+	return AlbumBenchmark::exec(numberOfEntries);
+}
@@ -53,6 +53,12 @@
 #include <SaveFileThread.h>
 #include <GLC_WorldTo3ds>
 
+// The interval of the album autosave in milliseconds
+static const int autosaveInterval= 30000;
+
+// The growth of the album journal above which it is compacted
+static const qint64 journalCompactionSize= 4 * 1024 * 1024;
+
 glc_player::glc_player(QWidget *parent)
 : QMainWindow(parent)
 , m_OpenglView(this)
@@ -82,6 +88,7 @@ glc_player::glc_player(QWidget *parent)
 , m_pInstancePropertyVis(NULL)
 , m_pMaterialProperty(NULL)
 , m_pChooseShaderDialog(NULL)
+, m_ShaderPreviewOfSelection(false)
 , m_pListOfMaterial(NULL)
 , m_pOpenAlbumOption(NULL)
 , m_pSendFilesDialog(NULL)
@@ -99,6 +106,8 @@ glc_player::glc_player(QWidget *parent)
 , m_UseOctreeBoundingBox(false)
 , m_OctreeDepth(3)
 , m_ClipBoard(0, NULL)
+, m_AlbumJournal()
+, m_AutosaveTimer()
 {
 	setupUi(this);
 	actionShowHideSection->setVisible(false);
@@ -135,6 +144,10 @@ glc_player::glc_player(QWidget *parent)
 	m_OpenglView.setAcceptDrops(false);
 	setAcceptDrops(true);
 
+	// The changes of the current album are journaled periodically
+	connect(&m_AutosaveTimer, SIGNAL(timeout()), this, SLOT(autosaveAlbum()));
+	m_AutosaveTimer.start(autosaveInterval);
+
 	// Set the current file name
 	addToRecentFiles(m_CurrentFileName);
 
@@ -149,6 +162,7 @@ glc_player::glc_player(QWidget *parent)
 	connect(&m_OpenglView, SIGNAL(unselectAll()), this, SLOT(unselectAll()));
 	connect(&m_OpenglView, SIGNAL(hideInfoPanel()), this, SLOT(hideInfoPanel()));
 	connect(&m_OpenglView, SIGNAL(glInitialed()), this, SLOT(glInitialed()));
+	connect(&m_OpenglView, SIGNAL(visibilityModified()), this, SLOT(currentEntryModified()));
 	//Menu File
 	connect(actionNew_Model, SIGNAL(triggered()), this , SLOT(newModel()));
 	connect(action_NewAlbum, SIGNAL(triggered()), this , SLOT(newAlbum()));
@@ -201,6 +215,9 @@ glc_player::glc_player(QWidget *parent)
 	connect(action_Pan, SIGNAL(triggered()), this, SLOT(panMode()));
 	connect(action_Rotate, SIGNAL(triggered()), this, SLOT(rotateMode()));
 	connect(action_Zoom, SIGNAL(triggered()), this, SLOT(zoomMode()));
+	connect(actionRectangleSelect, SIGNAL(triggered()), this, SLOT(rectangleSelectMode()));
+	connect(actionLassoSelect, SIGNAL(triggered()), this, SLOT(lassoSelectMode()));
+	connect(actionTouchingSelection, SIGNAL(triggered(bool)), &m_OpenglView, SLOT(setTouchingAreaSelection(bool)));
 	connect(action_ZoomIn, SIGNAL(triggered()), &m_OpenglView, SLOT(zoomIn()));
 	connect(action_ZoomOut, SIGNAL(triggered()), &m_OpenglView, SLOT(zoomOut()));
 	connect(actionShow_Hide, SIGNAL(triggered()), this, SLOT(showOrHide()));
@@ -254,8 +271,8 @@ glc_player::glc_player(QWidget *parent)
 	connect(m_pAlbumManagerView, SIGNAL(newAlbum(bool)), this, SLOT(newAlbum(bool)));
 	connect(m_pAlbumManagerView, SIGNAL(deleteModel(GLC_uint)), this, SLOT(deleteItem(GLC_uint)));
 	connect(m_pAlbumManagerView, SIGNAL(reloadCurrentModelSignal(const GLC_uint)), this, SLOT(reloadModel(const GLC_uint)));
-	connect(m_pAlbumManagerView, SIGNAL(currentModelChanged(QListWidgetItem *, QListWidgetItem *))
-			, this , SLOT(currentFileItemChanged(QListWidgetItem *, QListWidgetItem *)));
+	connect(m_pAlbumManagerView, SIGNAL(currentModelChanged(GLC_uint, GLC_uint))
+			, this , SLOT(currentFileItemChanged(GLC_uint, GLC_uint)));
 	connect(m_pAlbumManagerView, SIGNAL(displayMessage(QString)), this , SLOT(displayMessageInStatusBar(QString)));
 
 	// Camera Property dock area
@@ -267,7 +284,7 @@ glc_player::glc_player(QWidget *parent)
 	// Current selection dock area
 	m_pSelectionProperty= new SelectionProperty(actionShow_Hide, actionAssign_Shader, action_Property, selectionDockWidget);
 	selectionDockWidget->setWidget(m_pSelectionProperty);
-	connect(m_pSelectionProperty, SIGNAL(updateView()), &m_OpenglView, SLOT(updateGL()));
+	connect(m_pSelectionProperty, SIGNAL(updateView()), &m_OpenglView, SLOT(requestUpdate()));
 
 	// Parse arguments command line
 	QStringList args= QCoreApplication::arguments ();
@@ -345,6 +362,9 @@ void glc_player::closeEvent(QCloseEvent* pEvent)
 		}
 		m_pAlbumManagerView->blockSignals(true);
 		writeSettings();
+		// The last changes are kept in the journal of the album
+		autosaveAlbum();
+		m_AlbumJournal.close();
 		pEvent->accept();
 		QCoreApplication::quit();
 	}
@@ -441,7 +461,7 @@ void glc_player::showOrHide()
 		if (0 != currentWorld.selectionSize())
 		{
 			currentWorld.showHideSelected3DViewInstance();
-			m_OpenglView.updateGL();
+			m_OpenglView.visibilityChanged();
 			m_pLeftSideDock->updateSelectedTreeShowNoShow();
 		}
 	}
@@ -459,7 +479,7 @@ void glc_player::hideUnselected()
 			currentWorld.rootOccurence()->setVisibility(false);
 			currentWorld.showSelected3DViewInstance();
 			m_OpenglView.setDistMinAndMax();
-			m_OpenglView.updateGL();
+			m_OpenglView.visibilityChanged();
 			m_pLeftSideDock->updateTreeShowNoShow();
 		}
 	}
@@ -474,7 +494,7 @@ void glc_player::showAll()
 		GLC_World currentWorld= m_FileEntryHash.value(modelId).getWorld();
 		currentWorld.rootOccurence()->setVisibility(true);
 		m_OpenglView.setDistMinAndMax();
-		m_OpenglView.updateGL();
+		m_OpenglView.visibilityChanged();
 		m_pLeftSideDock->updateTreeShowNoShow();
 	}
 }
@@ -486,7 +506,7 @@ void glc_player::swapVisibleSpace()
 	{
 		m_OpenglView.swapVisibleSpace();
 		m_OpenglView.setDistMinAndMax();
-		m_OpenglView.updateGL();
+		m_OpenglView.visibilityChanged();
 	}
 }
 
@@ -554,18 +574,13 @@ void glc_player::newModel()
 		}
 		else	// force the display of loaded file
 		{
-			currentFileItemChanged(m_pAlbumManagerView->currentItem(), NULL);
+			currentFileItemChanged(m_pAlbumManagerView->currentModelId(), 0);
 		}
 	}
-	else if (m_pAlbumManagerView->item(loadedItem) == m_pAlbumManagerView->currentItem())
+	else if (loadedItem == m_pAlbumManagerView->currentRow())
 	{
 		// force the display of loaded file
-		currentFileItemChanged(m_pAlbumManagerView->currentItem(), NULL);
-	}
-	// Create the icon of the loaded file
-	if (m_pAlbumManagerView->thumbnailsAreDisplay())
-	{
-		computeIconInBackBuffer(loadedItem);
+		currentFileItemChanged(m_pAlbumManagerView->currentModelId(), 0);
 	}
 
 	m_MakeFirstFileCurrent= (m_pAlbumManagerView->numberOfUnloadedModels() == 0);
@@ -586,6 +601,8 @@ bool glc_player::newAlbum(bool confirmation)
 		if (!confirmation || (ret == QMessageBox::Yes))
 		{
 			QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+			// The last changes are kept in the journal of the album
+			autosaveAlbum();
 			unselectAll();
 			//loadingList->blockSignals(true);
 			m_pAlbumManagerView->clear();
@@ -598,6 +615,8 @@ bool glc_player::newAlbum(bool confirmation)
 
 			// Update Continu list loading flag
 			m_ContinuListLoading= true;
+			// The journal is kept for the recovery of the unsaved changes
+			m_AlbumJournal.close();
 			m_CurrentAlbumName.clear();
 
 			// Update UI
@@ -702,7 +721,8 @@ void glc_player::saveAlbum()
 	}
 	else
 	{
-		applySavingAlbum(m_CurrentAlbumName);
+		// The album keeps its format
+		applySavingAlbum(m_CurrentAlbumName, AlbumFile::albumFormat(m_CurrentAlbumName));
 	}
 
 }
@@ -720,15 +740,17 @@ void glc_player::saveAlbumAs()
 		currentPath= m_CurrentAlbumPath;
 	}
 	const QString suffix(".album");
+	const QString binaryFilter(tr("GLC_Player Binary Album (*.album)"));
+	QString selectedFilter;
 	QString fileName = QFileDialog::getSaveFileName(this, tr("Save Album As ")
-	, currentPath, tr("GLC_Player Album (*.album)"));
+	, currentPath, tr("GLC_Player Album (*.album)") + QString(";;") + binaryFilter, &selectedFilter);
 	if (!fileName.isEmpty())
 	{
 		if (!fileName.endsWith(suffix))
 		{
 			fileName.append(suffix);
 		}
-		applySavingAlbum(fileName);
+		applySavingAlbum(fileName, (selectedFilter == binaryFilter) ? AlbumFile::BinaryFormat : AlbumFile::XmlFormat);
 
 	}
 }
@@ -774,6 +796,7 @@ void glc_player::sendToFolder()
 				m_CurrentAlbumName= m_pSendFilesDialog->newAlbumFileName();
 				saveAlbum();
 			}
+			displayMessageInStatusBar(m_pSendFilesDialog->copyReport());
 			QMessageBox::information(this, tr("Send To Folder"), tr("Files succesfuly send"));
 		}
 	}
@@ -787,6 +810,7 @@ void glc_player::exportToWeb()
 
 	iEntry.value().setCameraAndAngle(m_OpenglView.getCamera(), m_OpenglView.getViewAngle());
 	iEntry.value().setPolygonMode(m_OpenglView.getMode());
+	m_AlbumJournal.setModified(iEntry.key());
 
 	if (NULL == m_pExportWebDialog)
 	{
@@ -913,7 +937,7 @@ void glc_player::instanceProperty()
 	connect(m_pInstancePropertyVis, SIGNAL(triggered()), this, SLOT(instancePropertyVisibilityToggle()));
 	connect(m_pInstanceProperty, SIGNAL(visibilityChanged(bool)), this, SLOT(instancePropertyVisibilityChanged(bool)));
 	connect(m_pInstanceProperty, SIGNAL(doneSignal()), this, SLOT(returnToNormalMode()));
-	connect(m_pInstanceProperty, SIGNAL(updateView()), &m_OpenglView, SLOT(updateGL()));
+	connect(m_pInstanceProperty, SIGNAL(updateView()), &m_OpenglView, SLOT(requestUpdate()));
 	connect(m_pInstanceProperty, SIGNAL(viewSubMaterialList()), this, SLOT(viewListOfMaterial()));
 	m_pInstanceProperty->setInstance(pInstance);
 ////////////////////////////////////////////////////////////////////////////
@@ -967,47 +991,12 @@ void glc_player::assignShader()
 	if (NULL == m_pChooseShaderDialog)
 	{
 		m_pChooseShaderDialog= new ChooseShaderDialog(&m_OpenglView, this);
+		connect(m_pChooseShaderDialog, SIGNAL(previewModeChanged()), this, SLOT(updateShaderThumbnails()));
 	}
 
-// -------------Prepare world for the choose shader dialog----------------
-	GLC_World ThumbnailsWorld;
-	GLC_World CurrentWorld(m_OpenglView.getWorld());
-	ThumbnailsWorld.mergeWithAnotherWorld(CurrentWorld);
-	// Hide unselected object
-	if (UserInterfaceSate::globalState() != INSTANCE_STATE)
-	{
-		ThumbnailsWorld.collection()->hideAll();
-		PointerViewInstanceHash* pSelection= ThumbnailsWorld.collection()->selection();
-		PointerViewInstanceHash::iterator iEntry= pSelection->begin();
-	    while (iEntry != pSelection->constEnd())
-	    {
-	    	ThumbnailsWorld.collection()->setVisibility(iEntry.value()->id(), true);
-	    	ThumbnailsWorld.collection()->changeShadingGroup(iEntry.value()->id(), 0);
-			iEntry++;
-	    }
-	    ThumbnailsWorld.collection()->unselectAll();
-
-	}
-	else
-	{
-		const GLC_uint id= ThumbnailsWorld.visibleInstancesHandle().first()->id();
-		ThumbnailsWorld.collection()->changeShadingGroup(id, 0);
-	}
-    m_OpenglView.add(ThumbnailsWorld);
-    // Save previous global shader
-    const GLuint oldShaderId= m_OpenglView.globalShaderId();
-    m_OpenglView.setGlobalShaderId(0, QString());
-
-    // Update choose shader dialog thumbnails
-	m_pChooseShaderDialog->UpdateThumbnailsList();
-
-	// Restore the world
-	m_OpenglView.setGlobalShaderId(oldShaderId, QString());
-	m_OpenglView.add(CurrentWorld);
-
-// ------------------------------------------------------------------------
+	m_ShaderPreviewOfSelection= true;
+	updateShaderThumbnails();
 
-	CurrentWorld= m_FileEntryHash.value(m_pAlbumManagerView->currentModelId()).getWorld();
 	if (m_pChooseShaderDialog->exec() == QDialog::Accepted)
 	{
 		GLC_World CurrentWorld(m_FileEntryHash.value(m_pAlbumManagerView->currentModelId()).getWorld());
@@ -1039,8 +1028,11 @@ void glc_player::assignShader()
 	    	}
 	    	CurrentWorld.collection()->changeShadingGroup(id, shaderId);
 	    }
+		// The whole view previews show the shading groups
+		clearShaderThumbnails();
+		currentEntryModified();
 
-		m_OpenglView.updateGL();
+		m_OpenglView.requestUpdate(D_MATERIALS);
 
 	}
 
@@ -1062,6 +1054,8 @@ void glc_player::selectMode()
 	action_Pan->setChecked(false);
 	action_Rotate->setChecked(false);
 	action_Zoom->setChecked(false);
+	actionRectangleSelect->setChecked(false);
+	actionLassoSelect->setChecked(false);
 	m_OpenglView.changeEnterState(VE_NORMAL);
 }
 
@@ -1076,6 +1070,8 @@ void glc_player::viewCenterMode()
 	action_Pan->setChecked(false);
 	action_Rotate->setChecked(false);
 	action_Zoom->setChecked(false);
+	actionRectangleSelect->setChecked(false);
+	actionLassoSelect->setChecked(false);
 	m_OpenglView.changeEnterState(VE_POINTING);
 }
 
@@ -1090,6 +1086,8 @@ void glc_player::panMode()
 	action_ViewCenter->setChecked(false);
 	action_Rotate->setChecked(false);
 	action_Zoom->setChecked(false);
+	actionRectangleSelect->setChecked(false);
+	actionLassoSelect->setChecked(false);
 	m_OpenglView.changeEnterState(VE_PANNING);
 }
 
@@ -1104,6 +1102,8 @@ void glc_player::rotateMode()
 	action_ViewCenter->setChecked(false);
 	action_Pan->setChecked(false);
 	action_Zoom->setChecked(false);
+	actionRectangleSelect->setChecked(false);
+	actionLassoSelect->setChecked(false);
 	m_OpenglView.changeEnterState(VE_ORBITING);
 }
 
@@ -1118,9 +1118,43 @@ void glc_player::zoomMode()
 	action_ViewCenter->setChecked(false);
 	action_Pan->setChecked(false);
 	action_Rotate->setChecked(false);
+	actionRectangleSelect->setChecked(false);
+	actionLassoSelect->setChecked(false);
 	m_OpenglView.changeEnterState(VE_ZOOMING);
 }
 
+// Rectangle selection mode
+void glc_player::rectangleSelectMode()
+{
+	if (!actionRectangleSelect->isChecked())
+	{
+		actionRectangleSelect->setChecked(true);
+	}
+	action_Select->setChecked(false);
+	action_ViewCenter->setChecked(false);
+	action_Pan->setChecked(false);
+	action_Rotate->setChecked(false);
+	action_Zoom->setChecked(false);
+	actionLassoSelect->setChecked(false);
+	m_OpenglView.changeEnterState(VE_RECTANGLE_SELECTING);
+}
+
+// Lasso selection mode
+void glc_player::lassoSelectMode()
+{
+	if (!actionLassoSelect->isChecked())
+	{
+		actionLassoSelect->setChecked(true);
+	}
+	action_Select->setChecked(false);
+	action_ViewCenter->setChecked(false);
+	action_Pan->setChecked(false);
+	action_Rotate->setChecked(false);
+	action_Zoom->setChecked(false);
+	actionRectangleSelect->setChecked(false);
+	m_OpenglView.changeEnterState(VE_LASSO_SELECTING);
+}
+
 // Show application settings dialog
 void glc_player::showSettings()
 {
@@ -1263,7 +1297,7 @@ void glc_player::showSettings()
 
 		}
 		m_QuitConfirmation= settingsDialog.quitConfirmation();
-		m_OpenglView.updateGL();
+		m_OpenglView.requestUpdate();
 	}
 
 }
@@ -1285,6 +1319,17 @@ void glc_player::fileOpened()
 		m_FileEntryHash[modelId].setWorld(world);
 		m_FileEntryHash[modelId].setAttachedFileNames(m_OpenFileThread.attachedFiles());
 
+		// The model is shown without the album state which can not be read
+		const QString albumRecordError(m_FileEntryHash[modelId].albumRecordError());
+		if (!albumRecordError.isEmpty())
+		{
+			QString message(tr("The album state of %1 can not be read, the model is shown without its camera, materials, visibility and shading.").arg(QFileInfo(fileName).fileName()));
+			message+= QString("\n") + albumRecordError;
+			QMessageBox::warning(this, QCoreApplication::applicationName(), message);
+		}
+		// Only the changes made from now on are journaled
+		m_AlbumJournal.setReference(m_FileEntryHash.value(modelId));
+
 		// Update the foreground of the item Opened file
 		int loadedItem= m_pAlbumManagerView->modelLoaded(modelId);
 
@@ -1300,18 +1345,13 @@ void glc_player::fileOpened()
 			}
 			else	// force the display of loaded file
 			{
-				currentFileItemChanged(m_pAlbumManagerView->currentItem(), NULL);
+				currentFileItemChanged(m_pAlbumManagerView->currentModelId(), 0);
 			}
 		}
-		else if (m_pAlbumManagerView->item(loadedItem) == m_pAlbumManagerView->currentItem())
+		else if (loadedItem == m_pAlbumManagerView->currentRow())
 		{
 			// force the display of loaded file
-			currentFileItemChanged(m_pAlbumManagerView->currentItem(), NULL);
-		}
-		// Create the icon of the loaded file
-		if (m_pAlbumManagerView->thumbnailsAreDisplay())
-		{
-			computeIconInBackBuffer(loadedItem);
+			currentFileItemChanged(m_pAlbumManagerView->currentModelId(), 0);
 		}
 
 		addToRecentFiles(fileName);
@@ -1331,28 +1371,28 @@ void glc_player::loadFileFailed()
 	statusbar->showMessage(tr("File Not Loaded"));
 	m_pProgressBar->hide();
 
-	// Update the foreground of the item Opened file
-	const GLC_uint modelId= m_OpenFileThread.getModelId();
-	m_pAlbumManagerView->modelLoadFailed(modelId);
-
 	// Update the entry
+	const GLC_uint modelId= m_OpenFileThread.getModelId();
 	m_FileEntryHash[modelId].setLoadingStatus(false);
 	m_FileEntryHash[modelId].setError(m_OpenFileThread.getErrorMsg());
+
+	// Update the item of the Opened file
+	m_pAlbumManagerView->modelLoadFailed(modelId);
 	m_MakeFirstFileCurrent= (m_pAlbumManagerView->numberOfUnloadedModels() == 0);
 	m_FileLoadingInProgress= false;
 
 }
 // Current file Item Changed
-void glc_player::currentFileItemChanged(QListWidgetItem * current, QListWidgetItem * previous )
+void glc_player::currentFileItemChanged(GLC_uint current, GLC_uint previous)
 {
-	if ((previous != NULL) && (current != NULL))
+	if ((previous != 0) && (current != 0))
 	{
 		if (actionSectioning->isChecked())
 		{
 			actionSectioning->setChecked(false);
 			sectioning();
 		}
-		FileEntryHash::iterator iEntry= m_FileEntryHash.find(previous->data(Qt::UserRole).toUInt());
+		FileEntryHash::iterator iEntry= m_FileEntryHash.find(previous);
 		if (iEntry.value().getWorld().selectionSize() > 0)
 		{
 			unselectAll();
@@ -1363,15 +1403,16 @@ void glc_player::currentFileItemChanged(QListWidgetItem * current, QListWidgetIt
 		{
 			iEntry.value().setCameraAndAngle(m_OpenglView.getCamera(), m_OpenglView.getViewAngle());
 			iEntry.value().setPolygonMode(m_OpenglView.getMode());
+			m_AlbumJournal.setModified(previous);
 			if (m_pAlbumManagerView->thumbnailsAreDisplay())
 			{
 				computeIconInBackBuffer(m_pAlbumManagerView->row(previous), true);
 			}
 		}
 	}
-	if (current != NULL)
+	if (current != 0)
 	{
-		setCurrentFileItem(current->data(Qt::UserRole).toUInt());
+		setCurrentFileItem(current);
 	}
 	else
 	{
@@ -1380,7 +1421,7 @@ void glc_player::currentFileItemChanged(QListWidgetItem * current, QListWidgetIt
 			m_OpenglView.setToVisibleState();
 		}
 		m_OpenglView.clear();
-		m_OpenglView.updateGL();
+		m_OpenglView.requestUpdate();
 	}
 	// Update UI
 	if (m_OpenglView.isEmpty() && action_IsoView1->isEnabled())
@@ -1670,7 +1711,8 @@ void glc_player::pointsRenderingMode()
 		action_ShadingAndWire->setChecked(false);
 		m_OpenglView.setMode(GL_POINT);
 		m_OpenglView.setRenderFlag(glc::ShadingFlag);
-		m_OpenglView.updateGL();
+		clearShaderThumbnails();
+		m_OpenglView.requestUpdate(D_MATERIALS);
 	}
 }
 // Go to wireframe Rendering mode
@@ -1687,7 +1729,8 @@ void glc_player::wireframeRenderingMode()
 		action_ShadingAndWire->setChecked(false);
 		m_OpenglView.setMode(GL_LINE);
 		m_OpenglView.setRenderFlag(glc::ShadingFlag);
-		m_OpenglView.updateGL();
+		clearShaderThumbnails();
+		m_OpenglView.requestUpdate(D_MATERIALS);
 	}
 }
 // Go to shading Rendering Mode
@@ -1704,7 +1747,8 @@ void glc_player::shadingRenderingMode()
 		action_ShadingAndWire->setChecked(false);
 		m_OpenglView.setMode(GL_FILL);
 		m_OpenglView.setRenderFlag(glc::ShadingFlag);
-		m_OpenglView.updateGL();
+		clearShaderThumbnails();
+		m_OpenglView.requestUpdate(D_MATERIALS);
 	}
 }
 // Go to shading and wire render mode
@@ -1721,7 +1765,8 @@ void glc_player::shadingAndWireRenderingMode()
 		action_RenderShading->setChecked(false);
 		m_OpenglView.setMode(GL_FILL);
 		m_OpenglView.setRenderFlag(glc::WireRenderFlag);
-		m_OpenglView.updateGL();
+		clearShaderThumbnails();
+		m_OpenglView.requestUpdate(D_MATERIALS);
 	}
 }
 
@@ -1774,7 +1819,7 @@ void glc_player::help()
 void glc_player::updateView()
 {
 	m_OpenglView.setDistMinAndMax();
-	m_OpenglView.updateGL();
+	m_OpenglView.requestUpdate(D_CAMERA);
 }
 
 // Get information about failed loading
@@ -1795,7 +1840,7 @@ void glc_player::editLightDialog()
 	if (m_pEditLightDialog == NULL)
 	{
 		m_pEditLightDialog= new EditLightDialog(m_OpenglView.getLight(), m_OpenglView.getLights(), this);
-		connect(m_pEditLightDialog, SIGNAL(lightUpdated()), &m_OpenglView, SLOT(updateGL()));
+		connect(m_pEditLightDialog, SIGNAL(lightUpdated()), &m_OpenglView, SLOT(lightsUpdated()));
 		connect(m_pEditLightDialog, SIGNAL(currentLightChanged(int)), &m_OpenglView, SLOT(editLight(int)));
 		m_pEditLightDialog->setWindowFlags(Qt::Tool);
 		m_pEditLightDialog->move(30, 30);
@@ -1809,7 +1854,7 @@ void glc_player::editLightDialog()
 void glc_player::twoSidedLightning()
 {
 		m_OpenglView.setTwoSidedLightning(actionTwo_sided_Lightning->isChecked());
-		m_OpenglView.updateGL();
+		m_OpenglView.requestUpdate(D_LIGHTS);
 }
 
 // Compute the icon of a newly loaded file in back buffer
@@ -1863,7 +1908,7 @@ void glc_player::returnToNormalMode()
 	disconnect(m_pInstancePropertyVis, SIGNAL(triggered()), this, SLOT(instancePropertyVisibilityToggle()));
 	disconnect(m_pInstanceProperty, SIGNAL(visibilityChanged(bool)), this, SLOT(instancePropertyVisibilityChanged(bool)));
 	disconnect(m_pInstanceProperty, SIGNAL(doneSignal()), this, SLOT(returnToNormalMode()));
-	disconnect(m_pInstanceProperty, SIGNAL(updateView()), &m_OpenglView, SLOT(updateGL()));
+	disconnect(m_pInstanceProperty, SIGNAL(updateView()), &m_OpenglView, SLOT(requestUpdate()));
 	disconnect(m_pInstanceProperty, SIGNAL(viewSubMaterialList()), this, SLOT(viewListOfMaterial()));
 	// Hide Instance property dock window
 	m_pInstanceProperty->hide();
@@ -1893,6 +1938,7 @@ void glc_player::returnToNormalMode()
 	FileEntryHash::iterator iEntry= m_FileEntryHash.find(m_pAlbumManagerView->currentModelId());
 	iEntry.value().setCameraAndAngle(m_OpenglView.getCamera(), m_OpenglView.getViewAngle());
 	iEntry.value().setPolygonMode(m_OpenglView.getMode());
+	m_AlbumJournal.setModified(iEntry.key());
 
 	setCurrentFileItem(m_pAlbumManagerView->currentModelId());
 }
@@ -1903,17 +1949,91 @@ void glc_player::chooseShader()
 	if (NULL == m_pChooseShaderDialog)
 	{
 		m_pChooseShaderDialog= new ChooseShaderDialog(&m_OpenglView, this);
+		connect(m_pChooseShaderDialog, SIGNAL(previewModeChanged()), this, SLOT(updateShaderThumbnails()));
 	}
-	m_pChooseShaderDialog->UpdateThumbnailsList();
+	m_ShaderPreviewOfSelection= false;
+	updateShaderThumbnails();
 
 	if (m_pChooseShaderDialog->exec() == QDialog::Accepted)
 	{
 		m_OpenglView.setGlobalShaderId(m_pChooseShaderDialog->shaderId(), m_pChooseShaderDialog->shaderName());
-		m_OpenglView.updateGL();
+		m_OpenglView.requestUpdate(D_MATERIALS);
 	}
 
 }
 
+// Update the thumbnails of the choose shader dialog
+void glc_player::updateShaderThumbnails()
+{
+	GLC_World CurrentWorld(m_OpenglView.getWorld());
+
+	// The thumbnails key : the model, its position and visibility edits, the previewed instances and the preview mode
+	QList<GLC_uint> instanceIds;
+	QString key(QString::number(m_pAlbumManagerView->currentModelId()) + '/' + QString::number(m_OpenglView.sceneGeneration())
+				+ '/' + QString::number(m_OpenglView.visibilityGeneration()));
+	if (UserInterfaceSate::globalState() == INSTANCE_STATE)
+	{
+		key+= "/Instance";
+		instanceIds << CurrentWorld.visibleInstancesHandle().first()->id();
+	}
+	else if (m_ShaderPreviewOfSelection)
+	{
+		key+= "/Selection";
+		instanceIds= CurrentWorld.collection()->selection()->keys();
+		qSort(instanceIds);
+	}
+	const int size= instanceIds.size();
+	for (int i= 0; i < size; ++i)
+	{
+		key+= '/' + QString::number(instanceIds[i]);
+	}
+	m_pChooseShaderDialog->setSelectionKey(key);
+
+	// The whole view is previewed or the thumbnails don't need the model
+	if (!m_ShaderPreviewOfSelection || !m_pChooseShaderDialog->modelIsNeeded())
+	{
+		m_pChooseShaderDialog->UpdateThumbnailsList();
+		return;
+	}
+
+// -------------Prepare world for the choose shader dialog----------------
+	GLC_World ThumbnailsWorld;
+	ThumbnailsWorld.mergeWithAnotherWorld(CurrentWorld);
+	// Hide unselected object
+	if (UserInterfaceSate::globalState() != INSTANCE_STATE)
+	{
+		ThumbnailsWorld.collection()->hideAll();
+		PointerViewInstanceHash* pSelection= ThumbnailsWorld.collection()->selection();
+		PointerViewInstanceHash::iterator iEntry= pSelection->begin();
+	    while (iEntry != pSelection->constEnd())
+	    {
+	    	ThumbnailsWorld.collection()->setVisibility(iEntry.value()->id(), true);
+	    	ThumbnailsWorld.collection()->changeShadingGroup(iEntry.value()->id(), 0);
+			iEntry++;
+	    }
+	    ThumbnailsWorld.collection()->unselectAll();
+
+	}
+	else
+	{
+		const GLC_uint id= ThumbnailsWorld.visibleInstancesHandle().first()->id();
+		ThumbnailsWorld.collection()->changeShadingGroup(id, 0);
+	}
+    m_OpenglView.add(ThumbnailsWorld);
+    // Save previous global shader
+    const GLuint oldShaderId= m_OpenglView.globalShaderId();
+    m_OpenglView.setGlobalShaderId(0, QString());
+
+    // Update choose shader dialog thumbnails
+	m_pChooseShaderDialog->UpdateThumbnailsList();
+
+	// Restore the world
+	m_OpenglView.setGlobalShaderId(oldShaderId, QString());
+	m_OpenglView.add(CurrentWorld);
+
+// ------------------------------------------------------------------------
+}
+
 // reload model
 void glc_player::reloadModel(GLC_uint modelId)
 {
@@ -1926,8 +2046,9 @@ void glc_player::reloadModel(GLC_uint modelId)
 			m_pModelManagerView->clear();
 		}
 		m_FileEntryHash[modelId].reload();
+		clearShaderThumbnails();
 		m_OpenglView.clear();
-		m_OpenglView.updateGL();
+		m_OpenglView.requestUpdate();
 		if (modelId == m_ClipBoard.first)
 		{
 			m_ClipBoard.first= 0;
@@ -1943,6 +2064,24 @@ void glc_player::updateCurrentEntryMaterial(GLC_Material* pMaterial)
 	FileEntryHash::iterator iEntry= m_FileEntryHash.find(m_pAlbumManagerView->currentModelId());
 	Q_ASSERT(iEntry != m_FileEntryHash.constEnd());
 	iEntry.value().addModifiedMaterial(pMaterial);
+	m_AlbumJournal.setModified(iEntry.key());
+	// Shader thumbnails show the modified material
+	clearShaderThumbnails();
+}
+
+// Mark the current file Entry as modified, it is journaled on the next autosave
+void glc_player::currentEntryModified()
+{
+	m_AlbumJournal.setModified(m_pAlbumManagerView->currentModelId());
+}
+
+// Clear the thumbnails of the choose shader dialog (The model appearance changed)
+void glc_player::clearShaderThumbnails()
+{
+	if (NULL != m_pChooseShaderDialog)
+	{
+		m_pChooseShaderDialog->clearThumbnailsCache();
+	}
 }
 
 //! The Opengl as been initialised
@@ -2358,6 +2497,7 @@ void glc_player::setCurrentFileItem(const GLC_uint modelId)
 	{
 		// Set polygon mode of the entry
 		iEntry.value().setPolygonMode(m_OpenglView.getMode());
+		m_AlbumJournal.setModified(iEntry.key());
 		GLC_World world(iEntry.value().getWorld());
 		// Check the visible state of the view
 		if (m_OpenglView.getVisibleState() != world.collection()->showState())
@@ -2367,20 +2507,8 @@ void glc_player::setCurrentFileItem(const GLC_uint modelId)
 		}
 		m_OpenglView.clear();
 		m_OpenglView.add(world);
-		if (iEntry.value().cameraIsSet())
-		{
-			m_OpenglView.setCameraAndAngle(iEntry.value().getCamera(), iEntry.value().getViewAngle());
-			m_OpenglView.updateGL();
-		}
-		else
-		{
-			GLC_Camera defaultCam;
-			defaultCam.setDefaultUpVector(world.upVector());
-			defaultCam.setIsoView();
-			m_OpenglView.setCameraAndAngle(defaultCam, iEntry.value().getViewAngle());
-
-			m_OpenglView.reframe(GLC_BoundingBox(), false);
-		}
+		m_OpenglView.setEntryCamera(iEntry.value());
+		m_OpenglView.requestUpdate();
 		setWindowTitle(QString(QCoreApplication::applicationName() +" [") + QFileInfo(fileName).fileName() + QString("]"));
 		statusbar->showMessage(fileName);
 		//const int instances= iEntry.value().getNumberOfInstances();
@@ -2419,7 +2547,7 @@ void glc_player::setCurrentFileItem(const GLC_uint modelId)
 			m_OpenglView.setToVisibleState();
 		}
 		m_OpenglView.clear();
-		m_OpenglView.updateGL();
+		m_OpenglView.requestUpdate();
 	}
 }
 // Take a snapshot of the specifies item with the specifie ratio
@@ -2451,6 +2579,7 @@ QImage glc_player::takeSnapShoot(int itemRow, double ratio, bool forceCurrent)
 			savAngle= m_OpenglView.getViewAngle();
 			// Set polygon mode of the entry
 			iEntry.value().setPolygonMode(m_OpenglView.getMode());
+			m_AlbumJournal.setModified(iEntry.key());
 			GLC_World world(iEntry.value().getWorld());
 			m_OpenglView.setAutoBufferSwap(false);
 			if (m_OpenglView.getVisibleState() != world.collection()->showState())
@@ -2461,29 +2590,19 @@ QImage glc_player::takeSnapShoot(int itemRow, double ratio, bool forceCurrent)
 
 			m_OpenglView.clear();
 			m_OpenglView.add(world);
-			// Test if the current model's camera is already set
-			if (iEntry.value().cameraIsSet())
-			{
-				// The model's camera is set
-				m_OpenglView.setCameraAndAngle(iEntry.value().getCamera(), iEntry.value().getViewAngle());
-				// Change the view Aspect ratio
-				m_OpenglView.viewportHandle()->forceAspectRatio(ratio);
-				m_OpenglView.updateGL();
-				m_OpenglView.viewportHandle()->updateAspectRatio();
-			}
-			else
-			{
-				// The model's camera is not set
-				GLC_BoundingBox emptyBoundingBox;
-				m_OpenglView.initIsoView();
-				m_OpenglView.reframe(emptyBoundingBox, false); // an updateGL is done while reframing
-				// Change the view Aspect ratio
-				m_OpenglView.viewportHandle()->forceAspectRatio(ratio);
-				m_OpenglView.updateGL();
-				m_OpenglView.viewportHandle()->updateAspectRatio();
-				m_OpenglView.viewportHandle()->updateProjectionMat();
+			// The model's camera or the default camera if it is not set
+			const bool cameraIsSet= iEntry.value().cameraIsSet();
+			m_OpenglView.setEntryCamera(iEntry.value());
+			// Change the view Aspect ratio
+			m_OpenglView.viewportHandle()->forceAspectRatio(ratio);
+			m_OpenglView.updateGL();
+			m_OpenglView.viewportHandle()->updateAspectRatio();
+			m_OpenglView.viewportHandle()->updateProjectionMat();
 
+			if (!cameraIsSet)
+			{
 				iEntry.value().setCameraAndAngle(m_OpenglView.getCamera(), m_OpenglView.getViewAngle());
+				m_AlbumJournal.setModified(iEntry.key());
 			}
 		}
 
@@ -2521,6 +2640,7 @@ QImage glc_player::takeSnapShoot(int itemRow, double ratio, bool forceCurrent)
 			// The current model has been loaded
 			// Set polygon mode of the entry
 			iEntry.value().setPolygonMode(m_OpenglView.getMode());
+			m_AlbumJournal.setModified(iEntry.key());
 			GLC_World world(iEntry.value().getWorld());
 			if (m_OpenglView.getVisibleState() != world.collection()->showState())
 			{
@@ -2539,7 +2659,8 @@ QImage glc_player::takeSnapShoot(int itemRow, double ratio, bool forceCurrent)
 	}
 	m_OpenglView.setAutoBufferSwap(true);
 	m_OpenglView.setSnapShootMode(false);
-	m_OpenglView.updateGL();
+	// Successive snapshots restore the view only once
+	m_OpenglView.requestUpdate();
 
 	return snapShoot;
 }
@@ -2791,23 +2912,67 @@ bool glc_player::getOpenAlbumOptionDlg()
 	return m_pOpenAlbumOption->exec();
 
 }
-// Apply album saving
-void glc_player::applySavingAlbum(const QString& fileName)
+// Update the current entry camera and polygon mode from the view
+void glc_player::updateCurrentEntryView()
 {
-	// Update the current FileEntry camera position
 	FileEntryHash::iterator iEntry= m_FileEntryHash.find(m_pAlbumManagerView->currentModelId());
-	if (iEntry.value().isLoaded() && (!(iEntry.value().getCamera() == m_OpenglView.getCamera())
+	if ((iEntry != m_FileEntryHash.end()) && iEntry.value().isLoaded() && (!(iEntry.value().getCamera() == m_OpenglView.getCamera())
 						|| (iEntry.value().getPolygonMode() != m_OpenglView.getMode())
 						|| iEntry.value().getViewAngle() != m_OpenglView.getViewAngle()))
 	{
 		iEntry.value().setCameraAndAngle(m_OpenglView.getCamera(), m_OpenglView.getViewAngle());
 		iEntry.value().setPolygonMode(m_OpenglView.getMode());
+		m_AlbumJournal.setModified(iEntry.key());
+	}
+}
+
+// Return the names of the models whose album state can not be read
+QStringList glc_player::unreadAlbumStates() const
+{
+	QStringList modelNames;
+	FileEntryHash::const_iterator iEntry= m_FileEntryHash.constBegin();
+	while (iEntry != m_FileEntryHash.constEnd())
+	{
+		if (!iEntry.value().albumRecordError().isEmpty())
+		{
+			modelNames << QFileInfo(iEntry.value().getFileName()).fileName();
+		}
+		++iEntry;
+	}
+	return modelNames;
+}
+
+// Apply album saving
+void glc_player::applySavingAlbum(const QString& fileName, AlbumFile::AlbumFormat format)
+{
+	// The album state which can not be read is only lost with the agreement of the user
+	const QStringList unreadModels(unreadAlbumStates());
+	if (!unreadModels.isEmpty())
+	{
+		QString message(tr("The album state of these models can not be read, it will be lost :") + QString("\n"));
+		message+= unreadModels.join(QString("\n")) + QString("\n") + tr("Save the album anyway ?");
+		if (QMessageBox::No == QMessageBox::question(this, tr("Save Album"), message, QMessageBox::No | QMessageBox::Yes))
+		{
+			return;
+		}
 	}
 
+	// Update the current FileEntry camera position
+	updateCurrentEntryView();
+
 	// Save the album File
 	QFile albumFile(fileName);
 	AlbumFile albumFileWriter;
-	albumFileWriter.saveAlbumFile(m_FileEntryHash.values(), &albumFile);
+	albumFileWriter.saveAlbumFile(m_FileEntryHash.values(), &albumFile, format);
+
+	// The journaled changes are saved in the album, those of the previous album too
+	m_AlbumJournal.close();
+	if (!m_CurrentAlbumName.isEmpty() && (m_CurrentAlbumName != fileName))
+	{
+		AlbumJournal::remove(m_CurrentAlbumName);
+	}
+	m_AlbumJournal.open(fileName, true);
+	m_AlbumJournal.clear(m_FileEntryHash);
 	m_CurrentAlbumPath= QFileInfo(fileName).absolutePath();
 	m_CurrentAlbumName= fileName;
 	addToRecentAlbums(fileName);
@@ -2817,6 +2982,21 @@ void glc_player::applySavingAlbum(const QString& fileName)
 
 }
 
+// Append the changes of the current album to its journal
+void glc_player::autosaveAlbum()
+{
+	if (!m_AlbumJournal.isOpen() || m_FileEntryHash.isEmpty()) return;
+
+	updateCurrentEntryView();
+	m_AlbumJournal.append(m_FileEntryHash);
+
+	// The journal is compacted when it grows, the album file is only written when the user saves it
+	if (((m_AlbumJournal.size() - m_AlbumJournal.compactSize()) > journalCompactionSize) && !m_AlbumJournal.compact())
+	{
+		statusbar->showMessage(m_AlbumJournal.errorString());
+	}
+}
+
 // Open specified album
 void glc_player::openAlbum(const QString& fileName)
 {
@@ -2869,9 +3049,54 @@ void glc_player::openAlbum(const QString& fileName)
 	catch (GLC_Exception &e)
 	{
 		QString message(tr("Wrong album file format"));
+		message+= QString("\n") + QString(e.what());
 		QMessageBox::critical(this, QCoreApplication::applicationName(), message);
 		return;
 	}
+
+	// Recover the unsaved changes of the opened album if it becomes the current one
+	if (setFirstItemCurrent)
+	{
+		// The journal is only discarded once the user knows its changes are lost
+		bool discardJournal= false;
+		if (AlbumJournal::hasChanges(fileName))
+		{
+			const int ret= QMessageBox::question(this, QCoreApplication::applicationName(),
+					tr("This album has unsaved changes. Recover them?"), QMessageBox::Yes | QMessageBox::No);
+			if (ret == QMessageBox::Yes)
+			{
+				QString journalError;
+				const QHash<QString, AlbumEntryRecord> changes(AlbumJournal::readChanges(fileName, &journalError));
+				if (!journalError.isEmpty())
+				{
+					QString message(changes.isEmpty() ? tr("The unsaved changes can not be recovered.") : tr("The unsaved changes are only partly recovered."));
+					message+= QString("\n") + journalError;
+					QMessageBox::warning(this, QCoreApplication::applicationName(), message);
+					discardJournal= changes.isEmpty();
+				}
+				const int size= fileEntries.size();
+				for (int i= 0; i < size; ++i)
+				{
+					if (changes.contains(fileEntries[i].getFileName()))
+					{
+						fileEntries[i].setAlbumRecord(changes.value(fileEntries[i].getFileName()));
+					}
+				}
+			}
+			else
+			{
+				AlbumJournal::remove(fileName);
+			}
+		}
+		if (!m_AlbumJournal.open(fileName, discardJournal))
+		{
+			QString message(m_AlbumJournal.errorString());
+			message+= QString("\n") + tr("The changes of this album are not journaled.");
+			QMessageBox::warning(this, QCoreApplication::applicationName(), message);
+		}
+	}
+	// The entries are listed by name, their album state is applied when they are loaded
+	QList<GLC_uint> addedModelIds;
 	const int max= fileEntries.size();
 	for (int i= 0; i < max; ++i)
 	{
@@ -2881,10 +3106,11 @@ void glc_player::openAlbum(const QString& fileName)
 		{
 			m_modelName.insert(fileName);
 			m_FileEntryHash.insert(fileEntries[i].id(), fileEntries[i]);
-			// Add the model to the view
-			m_pAlbumManagerView->addModel(fileEntries[i].id());
+			addedModelIds.append(fileEntries[i].id());
 		}
 	}
+	// Add the models to the view
+	m_pAlbumManagerView->addModels(addedModelIds);
 
 	// Set the first item as current if the album is not addded to the current one
 	if (setFirstItemCurrent) m_pAlbumManagerView->setCurrent(0);
@@ -29,10 +29,13 @@
 #include "opengl_view/OpenglView.h"
 #include "OpenFileThread.h"
 #include "FileEntry.h"
+#include "AlbumFile.h"
+#include "AlbumJournal.h"
 
 #include <GLC_Global>
 
 #include <QMainWindow>
+#include <QTimer>
 
 class SelectionProperty;
 class EditLightDialog;
@@ -117,6 +120,8 @@ private slots:
 	void sendToFolder();
 	//! Export album to web
 	void exportToWeb();
+	//! Append the changes of the current album to its journal
+	void autosaveAlbum();
 	//! Export current model
 	void exportCurrentModel();
 	//! View and edit instance property
@@ -127,6 +132,8 @@ private slots:
 	void viewListOfMaterial();
 	//! Assign shader to the current selection
 	void assignShader();
+	//! Update the thumbnails of the choose shader dialog
+	void updateShaderThumbnails();
 	//! Reframe the view
 	void reframe();
 	//! Select mode
@@ -139,6 +146,10 @@ private slots:
 	void rotateMode();
 	//! Zoom the view mode
 	void zoomMode();
+	//! Rectangle selection mode
+	void rectangleSelectMode();
+	//! Lasso selection mode
+	void lassoSelectMode();
 	//! Menu Tools
 	//! Show application settings dialog
 	void showSettings();
@@ -147,7 +158,7 @@ private slots:
 	//! load of File failed
 	void loadFileFailed();
 	//! Current file Item Changed
-	void currentFileItemChanged(QListWidgetItem *, QListWidgetItem *);
+	void currentFileItemChanged(GLC_uint, GLC_uint);
 	//! Display a message in status bar
 	void displayMessageInStatusBar(QString);
 	//! Remove unload item
@@ -212,6 +223,8 @@ private slots:
 	void reloadModel(GLC_uint);
 	//! Update current file Entry Material
 	void updateCurrentEntryMaterial(GLC_Material*);
+	//! Mark the current file Entry as modified, it is journaled on the next autosave
+	void currentEntryModified();
 	//! The Opengl as been initialised
 	void glInitialed();
 	//! Change Current mover to track ball mover
@@ -272,8 +285,14 @@ private:
 	void writeSettings();
 	//! Ask for saving the current Session
 	bool getOpenAlbumOptionDlg();
-	//! Apply album saving
-	void applySavingAlbum(const QString&);
+	//! Update the current entry camera and polygon mode from the view
+	void updateCurrentEntryView();
+	//! Clear the thumbnails of the choose shader dialog (The model appearance changed)
+	void clearShaderThumbnails();
+	//! Return the names of the models whose album state can not be read
+	QStringList unreadAlbumStates() const;
+	//! Apply album saving in the given format
+	void applySavingAlbum(const QString&, AlbumFile::AlbumFormat);
 	//! Open specified album
 	void openAlbum(const QString&);
 	//! Return the list of file name within the given path
@@ -340,6 +359,8 @@ private:
 	MaterialProperty* m_pMaterialProperty;
 	//! The chose shader dialog
 	ChooseShaderDialog* m_pChooseShaderDialog;
+	//! True if the choose shader dialog previews the selection
+	bool m_ShaderPreviewOfSelection;
 	//! The material list
 	ListOfMaterial* m_pListOfMaterial;
 	//! Open Album Option dialog
@@ -374,6 +395,10 @@ private:
 	int m_OctreeDepth;
 	//! Clipboard
 	QPair<GLC_uint, GLC_StructOccurence* > m_ClipBoard;
+	//! The journal of the current album changes
+	AlbumJournal m_AlbumJournal;
+	//! The timer of the current album autosave
+	QTimer m_AutosaveTimer;
 
 };
 
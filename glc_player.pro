@@ -15,14 +15,18 @@ QT += core \
     
 win32 { 
     LIBS += -L"$$(GLC_LIB_DIR)/lib" \
-        -lGLC_lib2
+        -lGLC_lib2 \
+        -L"$$(ZLIB_DIR)/lib" \
+        -lzlib
     DEPENDPATH+= "$$(GLC_LIB_DIR)/lib"
-    INCLUDEPATH += "$$(GLC_LIB_DIR)/include"
+    INCLUDEPATH += "$$(GLC_LIB_DIR)/include" \
+        "$$(ZLIB_DIR)/include"
     RC_FILE = ./ressources/glc_player.rc
 }
 
 unix { 
-    LIBS += -lGLC_lib
+    LIBS += -lGLC_lib \
+        -lz
     INCLUDEPATH += "/usr/local/include/GLC_lib-2.5"
 }
 
@@ -33,9 +37,14 @@ HEADERS_GLCPLAYER += 	FileEntry.h \
 						SaveFileThread.h \
 						glc_player.h \
 						AlbumFile.h \
+						AlbumRecord.h \
+						AlbumJournal.h \
 						FileOpenFilter.h \
 						UserInterfaceSate.h \
-						ExportToWeb.h
+						ExportToWeb.h \
+						HeadlessRenderer.h \
+						FileCopyEngine.h \
+						ZipArchiveWriter.h
 						
 HEADERS_UICLASS +=		ui_class/AboutPlayer.h \		
 						ui_class/SettingsDialog.h \
@@ -43,6 +52,7 @@ HEADERS_UICLASS +=		ui_class/AboutPlayer.h \
 						ui_class/EditLightDialog.h \
 						ui_class/SelectionProperty.h \
 						ui_class/AlbumManagerView.h \
+						ui_class/AlbumListModel.h \
 						ui_class/InstanceProperty.h \
 						ui_class/MaterialProperty.h \
 						ui_class/ChooseShaderDialog.h \
@@ -62,7 +72,13 @@ HEADERS_UICLASS +=		ui_class/AboutPlayer.h \
 
 HEADERS_OPENGLVIEW +=	opengl_view/OpenglView.h \
 						opengl_view/MaterialOpenglView.h \
-						opengl_view/MultiShotsOpenglView.h
+						opengl_view/MultiShotsOpenglView.h \
+						opengl_view/PickingEngine.h \
+						opengl_view/CullingEngine.h \
+						opengl_view/FrameBufferPool.h \
+						opengl_view/CapturePipeline.h \
+						opengl_view/TiffStripWriter.h \
+						opengl_view/FrameStreamWriter.h
 							
 HEADERS += $${HEADERS_GLCPLAYER} $${HEADERS_UICLASS} $${HEADERS_OPENGLVIEW}
 
@@ -72,9 +88,13 @@ SOURCES_GLCPLAYER +=	main.cpp \
 						SaveFileThread.cpp \
 						glc_player.cpp \
 						AlbumFile.cpp \
+						AlbumJournal.cpp \
 						FileOpenFilter.cpp \
 						UserInterfaceSate.cpp \
-						ExportToWeb.cpp
+						ExportToWeb.cpp \
+						HeadlessRenderer.cpp \
+						FileCopyEngine.cpp \
+						ZipArchiveWriter.cpp
 						
 SOURCES_UICLASS +=		ui_class/AboutPlayer.cpp \		
 						ui_class/SettingsDialog.cpp \
@@ -82,6 +102,7 @@ SOURCES_UICLASS +=		ui_class/AboutPlayer.cpp \
 						ui_class/EditLightDialog.cpp \
 						ui_class/SelectionProperty.cpp \
 						ui_class/AlbumManagerView.cpp \
+						ui_class/AlbumListModel.cpp \
 						ui_class/InstanceProperty.cpp \
 						ui_class/MaterialProperty.cpp \
 						ui_class/ChooseShaderDialog.cpp \
@@ -101,7 +122,13 @@ SOURCES_UICLASS +=		ui_class/AboutPlayer.cpp \
 
 SOURCES_OPENGLVIEW +=	opengl_view/OpenglView.cpp \
 						opengl_view/MaterialOpenglView.cpp \
-						opengl_view/MultiShotsOpenglView.cpp
+						opengl_view/MultiShotsOpenglView.cpp \
+						opengl_view/PickingEngine.cpp \
+						opengl_view/CullingEngine.cpp \
+						opengl_view/FrameBufferPool.cpp \
+						opengl_view/CapturePipeline.cpp \
+						opengl_view/TiffStripWriter.cpp \
+						opengl_view/FrameStreamWriter.cpp
 												
 SOURCES += $${SOURCES_GLCPLAYER} $${SOURCES_UICLASS} $${SOURCES_OPENGLVIEW}
 
@@ -24,6 +24,7 @@
 
 #include "glc_player.h"
 #include "FileOpenFilter.h"
+#include "HeadlessRenderer.h"
 
 #include <QtGui>
 #include <QApplication>
@@ -48,6 +49,12 @@ int main(int argc, char *argv[])
 	QCoreApplication::setOrganizationDomain("ribon.com");
 	QCoreApplication::setApplicationName("GLC_Player");
 
+	// Render album models from the command line without main window
+	if (HeadlessRenderer::isRequested(QCoreApplication::arguments()))
+	{
+		return HeadlessRenderer::exec(QCoreApplication::arguments());
+	}
+
 	// The splash screen
 	#if !defined(Q_OS_MAC)
 	QSplashScreen *pSplash= new QSplashScreen;
@@ -0,0 +1,349 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include "CapturePipeline.h"
+#include "FrameBufferPool.h"
+#include "FrameStreamWriter.h"
+#include <QThread>
+#include <QTime>
+#include <QFile>
+#include <QBuffer>
+#include <QImageWriter>
+#include <QPainter>
+#include <QtConcurrentRun>
+#include <cstring>
+
+CapturePipeline::CapturePipeline(FrameBufferPool* pFrameBufferPool, const QByteArray& format, int quality)
+: m_pFrameBufferPool(pFrameBufferPool)
+, m_Format(format)
+, m_Quality(quality)
+, m_UsePixelBuffers(true)
+, m_CurrentPixelBuffer(0)
+, m_HasPendingReadBack(false)
+, m_PendingSize()
+, m_PendingFileName()
+, m_pPendingStream(NULL)
+, m_Writes()
+, m_MaxPendingWrites(2 * QThread::idealThreadCount())
+, m_Error(false)
+, m_EncodingTime(0)
+, m_WritingTime(0)
+, m_WaitingTime(0)
+{
+	for (int i= 0; i < 2; ++i)
+	{
+		m_pPixelBuffers[i]= new QGLBuffer(QGLBuffer::PixelPackBuffer);
+		m_pPixelBuffers[i]->setUsagePattern(QGLBuffer::StreamRead);
+		m_UsePixelBuffers= m_UsePixelBuffers && m_pPixelBuffers[i]->create();
+	}
+	if (m_MaxPendingWrites < 2) m_MaxPendingWrites= 2;
+}
+
+CapturePipeline::~CapturePipeline()
+{
+	finish();
+	delete m_pPixelBuffers[0];
+	delete m_pPixelBuffers[1];
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+
+// Read back the given rendered framebuffer and save it in the given file
+void CapturePipeline::readBack(QGLFramebufferObject* pFrameBuffer, const QString& fileName)
+{
+	readFrameBuffer(pFrameBuffer, fileName, NULL);
+}
+
+// Read back the given rendered framebuffer and append it to the given frame stream
+void CapturePipeline::readBack(QGLFramebufferObject* pFrameBuffer, FrameStreamWriter* pStream)
+{
+	readFrameBuffer(pFrameBuffer, QString(), pStream);
+}
+
+// Save the given image in the given file
+void CapturePipeline::save(const QImage& image, const QString& fileName)
+{
+	collectWrites(false);
+	WriteJob job;
+	job.m_Image= image;
+	job.m_FileName= fileName;
+	job.m_FromOpenGL= false;
+	queueWrite(job);
+}
+
+// Save the given image downscaled to the given size in the given file
+void CapturePipeline::saveScaled(const QImage& image, const QString& fileName, const QSize& size)
+{
+	collectWrites(false);
+	WriteJob job;
+	job.m_Image= image;
+	job.m_FileName= fileName;
+	job.m_ScaledSize= size;
+	job.m_FromOpenGL= false;
+	queueWrite(job);
+}
+
+// Return true if a write has failed
+bool CapturePipeline::hasError()
+{
+	collectWrites(false);
+	return m_Error;
+}
+
+// Wait the end of all pending read back and writes, return true on success
+bool CapturePipeline::finish()
+{
+	mapPendingReadBack();
+	collectWrites(true);
+	return !m_Error;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Read back the given framebuffer to the given file or frame stream
+void CapturePipeline::readFrameBuffer(QGLFramebufferObject* pFrameBuffer, const QString& fileName, FrameStreamWriter* pStream)
+{
+	collectWrites(false);
+
+	// A multisample framebuffer can't be read, resolve it
+	QGLFramebufferObject* pSource= pFrameBuffer;
+	QGLFramebufferObject* pResolveTarget= NULL;
+	if ((pFrameBuffer->format().samples() > 0) && QGLFramebufferObject::hasOpenGLFramebufferBlit())
+	{
+		pResolveTarget= m_pFrameBufferPool->take(pFrameBuffer->size(), 0, QGLFramebufferObject::NoAttachment);
+		const QRect rect(QPoint(0, 0), pFrameBuffer->size());
+		QGLFramebufferObject::blitFramebuffer(pResolveTarget, rect, pFrameBuffer, rect);
+		pSource= pResolveTarget;
+	}
+
+	const QSize size(pSource->size());
+	if (m_UsePixelBuffers)
+	{
+		// Asynchronous read in the current pixel buffer
+		QGLBuffer* pPixelBuffer= m_pPixelBuffers[m_CurrentPixelBuffer];
+		const int byteCount= size.width() * size.height() * 4;
+		pSource->bind();
+		pPixelBuffer->bind();
+		if (pPixelBuffer->size() != byteCount) pPixelBuffer->allocate(byteCount);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, 0);
+		pPixelBuffer->release();
+		pSource->release();
+
+		// The previous read back is mapped while this one is transferred
+		mapPendingReadBack();
+
+		m_HasPendingReadBack= true;
+		m_PendingSize= size;
+		m_PendingFileName= fileName;
+		m_pPendingStream= pStream;
+		m_CurrentPixelBuffer= 1 - m_CurrentPixelBuffer;
+	}
+	else
+	{
+		QImage image(size, QImage::Format_ARGB32);
+		pSource->bind();
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
+		pSource->release();
+		if (NULL != pStream)
+		{
+			appendFrame(image, pStream);
+		}
+		else
+		{
+			WriteJob job;
+			job.m_Image= image;
+			job.m_FileName= fileName;
+			job.m_FromOpenGL= true;
+			queueWrite(job);
+		}
+	}
+
+	if (NULL != pResolveTarget)
+	{
+		m_pFrameBufferPool->giveBack(pResolveTarget);
+	}
+}
+
+// Map the pending pixel buffer and queue its write
+void CapturePipeline::mapPendingReadBack()
+{
+	if (!m_HasPendingReadBack) return;
+	m_HasPendingReadBack= false;
+
+	QGLBuffer* pPixelBuffer= m_pPixelBuffers[1 - m_CurrentPixelBuffer];
+	pPixelBuffer->bind();
+	const void* pData= pPixelBuffer->map(QGLBuffer::ReadOnly);
+	if (NULL != pData)
+	{
+		QImage image(m_PendingSize, QImage::Format_ARGB32);
+		memcpy(image.bits(), pData, image.byteCount());
+		pPixelBuffer->unmap();
+		if (NULL != m_pPendingStream)
+		{
+			appendFrame(image, m_pPendingStream);
+		}
+		else
+		{
+			WriteJob job;
+			job.m_Image= image;
+			job.m_FileName= m_PendingFileName;
+			job.m_FromOpenGL= true;
+			queueWrite(job);
+		}
+	}
+	else
+	{
+		m_Error= true;
+	}
+	pPixelBuffer->release();
+}
+
+// Append the given image read from OpenGL to the given frame stream
+void CapturePipeline::appendFrame(const QImage& image, FrameStreamWriter* pStream)
+{
+	// The stream encodes the frame in a worker thread and keeps the capture order
+	if (!pStream->writeFrame(fromOpenGL(image)))
+	{
+		m_Error= true;
+	}
+}
+
+// Queue the write of the given image
+void CapturePipeline::queueWrite(const WriteJob& job)
+{
+	// Bound the memory used by images waiting to be written
+	if (m_Writes.size() >= m_MaxPendingWrites)
+	{
+		QTime waitingTime;
+		waitingTime.start();
+		while (m_Writes.size() >= m_MaxPendingWrites)
+		{
+			collectResult(m_Writes.takeFirst().result());
+		}
+		m_WaitingTime+= waitingTime.elapsed();
+	}
+	m_Writes.append(QtConcurrent::run(&CapturePipeline::saveImage, job, m_Format, m_Quality));
+}
+
+// Remove finished writes, wait for all pending writes if wait is true
+void CapturePipeline::collectWrites(bool wait)
+{
+	QTime waitingTime;
+	waitingTime.start();
+	QList<QFuture<WriteResult> >::iterator iWrite= m_Writes.begin();
+	while (m_Writes.end() != iWrite)
+	{
+		if (wait || iWrite->isFinished())
+		{
+			collectResult(iWrite->result());
+			iWrite= m_Writes.erase(iWrite);
+		}
+		else
+		{
+			++iWrite;
+		}
+	}
+	if (wait) m_WaitingTime+= waitingTime.elapsed();
+}
+
+// Account the result of the given finished write
+void CapturePipeline::collectResult(const WriteResult& result)
+{
+	m_Error= !result.m_Success || m_Error;
+	m_EncodingTime+= result.m_EncodingTime;
+	m_WritingTime+= result.m_WritingTime;
+}
+
+// Convert and scale the image of the given job and save it (Run by worker threads)
+CapturePipeline::WriteResult CapturePipeline::saveImage(WriteJob job, const QByteArray& format, int quality)
+{
+	WriteResult result;
+	result.m_Success= false;
+	result.m_WritingTime= 0;
+	QTime time;
+	time.start();
+
+	QImage image(job.m_Image);
+	if (job.m_FromOpenGL)
+	{
+		image= fromOpenGL(image);
+	}
+	if (job.m_ScaledSize.isValid() && (job.m_ScaledSize != image.size()))
+	{
+		// Letterbox : the model is never cut at the edges
+		const QImage scaledImage(image.scaled(job.m_ScaledSize, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+		image= QImage(job.m_ScaledSize, QImage::Format_ARGB32);
+		image.fill(scaledImage.pixel(0, 0));
+		const QPoint origin((job.m_ScaledSize.width() - scaledImage.width()) / 2, (job.m_ScaledSize.height() - scaledImage.height()) / 2);
+		QPainter painter(&image);
+		painter.drawImage(origin, scaledImage);
+		painter.end();
+	}
+
+	// Encode in memory, so encoding and writing times are separated
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+	QImageWriter imageWriter(&buffer, format);
+	imageWriter.setQuality(quality);
+	const bool encoded= imageWriter.write(image);
+	buffer.close();
+	result.m_EncodingTime= time.restart();
+
+	if (encoded)
+	{
+		QFile file(job.m_FileName);
+		result.m_Success= file.open(QIODevice::WriteOnly | QIODevice::Truncate) && (file.write(data) == data.size());
+		file.close();
+		result.m_Success= result.m_Success && (QFile::NoError == file.error());
+		result.m_WritingTime= time.elapsed();
+	}
+	return result;
+}
+
+// Return the given image of OpenGL RGBA bottom to top rows as a QImage
+QImage CapturePipeline::fromOpenGL(QImage image)
+{
+	// OpenGL RGBA bottom to top rows to QImage ARGB32 top to bottom rows
+	if (QSysInfo::ByteOrder == QSysInfo::BigEndian)
+	{
+		const int pixelCount= image.width() * image.height();
+		uint* pPixels= reinterpret_cast<uint*>(image.bits());
+		for (int i= 0; i < pixelCount; ++i)
+		{
+			pPixels[i]= (pPixels[i] << 24) | (pPixels[i] >> 8);
+		}
+		return image.mirrored();
+	}
+	else
+	{
+		return image.rgbSwapped().mirrored();
+	}
+}
@@ -0,0 +1,188 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef CAPTUREPIPELINE_H_
+#define CAPTUREPIPELINE_H_
+
+#include <QList>
+#include <QSize>
+#include <QString>
+#include <QByteArray>
+#include <QImage>
+#include <QFuture>
+#include <QGLBuffer>
+#include <QGLFramebufferObject>
+
+class FrameBufferPool;
+class FrameStreamWriter;
+
+//////////////////////////////////////////////////////////////////////
+//! \class CapturePipeline
+/*! \brief CapturePipeline : Read back and save a sequence of captures*/
+
+/*! The framebuffer content is read in one of two pixel buffers. The
+ *  previous capture is mapped while the current one is transferred.
+ *  Images are encoded and written by a pool of worker threads, so the
+ *  next capture can be rendered while the previous one is saved.
+ *  Captures appended to a frame stream are given to it in capture order.
+ *  The OpenGL context of the captured framebuffers must be current
+ *  when the pipeline is created, used and deleted*/
+//////////////////////////////////////////////////////////////////////
+class CapturePipeline
+{
+	//! An image waiting to be written
+	struct WriteJob
+	{
+		QImage m_Image;
+		QString m_FileName;
+		//! The size of the saved image (The image size if not valid)
+		QSize m_ScaledSize;
+		//! True if the image rows are read back from OpenGL
+		bool m_FromOpenGL;
+	};
+
+	//! The result of a write
+	struct WriteResult
+	{
+		bool m_Success;
+		//! Time spent to convert and encode the image in ms
+		int m_EncodingTime;
+		//! Time spent to write the file in ms
+		int m_WritingTime;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a pipeline which save images with the given format and quality
+	CapturePipeline(FrameBufferPool*, const QByteArray& format= "JPG", int quality= 100);
+
+	//! Wait the end of pending writes
+	~CapturePipeline();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Read back the given rendered framebuffer and save it in the given file
+	void readBack(QGLFramebufferObject*, const QString&);
+
+	//! Read back the given rendered framebuffer and append it to the given frame stream
+	void readBack(QGLFramebufferObject*, FrameStreamWriter*);
+
+	//! Save the given image in the given file
+	void save(const QImage&, const QString&);
+
+	//! Save the given image downscaled to the given size in the given file
+	/*! The whole image is fitted in the size, the remaining borders are
+	 *  filled with the color of the image top left pixel (the background)*/
+	void saveScaled(const QImage&, const QString&, const QSize&);
+
+	//! Return true if a write has failed
+	bool hasError();
+
+	//! Wait the end of all pending read back and writes, return true on success
+	bool finish();
+
+	//! Return the time spent by worker threads to encode the finished writes in ms
+	inline int encodingTime() const
+	{return m_EncodingTime;}
+
+	//! Return the time spent by worker threads to write the finished writes in ms
+	inline int writingTime() const
+	{return m_WritingTime;}
+
+	//! Return the time spent waiting for a free place in the write queue in ms
+	inline int waitingTime() const
+	{return m_WaitingTime;}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Read back the given framebuffer to the given file or frame stream
+	void readFrameBuffer(QGLFramebufferObject*, const QString&, FrameStreamWriter*);
+
+	//! Map the pending pixel buffer and queue its write
+	void mapPendingReadBack();
+
+	//! Append the given image read from OpenGL to the given frame stream
+	void appendFrame(const QImage&, FrameStreamWriter*);
+
+	//! Queue the write of the given image
+	void queueWrite(const WriteJob&);
+
+	//! Remove finished writes, wait for all pending writes if wait is true
+	void collectWrites(bool wait);
+
+	//! Account the result of the given finished write
+	void collectResult(const WriteResult&);
+
+	//! Convert and scale the image of the given job and save it (Run by worker threads)
+	static WriteResult saveImage(WriteJob, const QByteArray&, int);
+
+	//! Return the given image of OpenGL RGBA bottom to top rows as a QImage
+	static QImage fromOpenGL(QImage);
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The pool of the resolve framebuffers
+	FrameBufferPool* m_pFrameBufferPool;
+
+	//! The saved images format and quality
+	QByteArray m_Format;
+	int m_Quality;
+
+	//! The two pixel buffers used to read back framebuffers
+	QGLBuffer* m_pPixelBuffers[2];
+	bool m_UsePixelBuffers;
+	int m_CurrentPixelBuffer;
+
+	//! The read back which have not been mapped
+	bool m_HasPendingReadBack;
+	QSize m_PendingSize;
+	QString m_PendingFileName;
+	FrameStreamWriter* m_pPendingStream;
+
+	//! The writes done by worker threads
+	QList<QFuture<WriteResult> > m_Writes;
+
+	//! The maximum number of images waiting to be written
+	int m_MaxPendingWrites;
+
+	//! True if a read back or a write has failed
+	bool m_Error;
+
+	//! Times spent by the finished writes and waiting for the queue in ms
+	int m_EncodingTime;
+	int m_WritingTime;
+	int m_WaitingTime;
+};
+
+#endif /* CAPTUREPIPELINE_H_ */
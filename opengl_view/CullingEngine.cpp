@@ -0,0 +1,267 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include "CullingEngine.h"
+#include <GLC_3DViewInstance>
+#include <GLC_Matrix4x4>
+#include <GLC_Global>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <cmath>
+
+// Under this number of instances the viewable state is computed in the calling thread
+static const int minParallelViewableSize= 4096;
+
+// Instances which projected size is under this number of pixels are not drawn
+static const double minimumPixelSize= 1.0;
+
+CullingEngine::CullingEngine()
+: m_pCollection(NULL)
+, m_CollectionSize(0)
+, m_SceneGeneration(0)
+, m_ItemIds()
+, m_ItemBoxes()
+, m_FirstBodies()
+, m_BodyBoxes()
+, m_EmptyBoxIds()
+, m_ViewableFlags()
+, m_BodyFlags()
+{
+
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+
+// Clear the stored boxes and viewable state
+void CullingEngine::clear()
+{
+	m_pCollection= NULL;
+	m_CollectionSize= 0;
+	m_ItemIds.clear();
+	m_ItemBoxes.clear();
+	m_FirstBodies.clear();
+	m_BodyBoxes.clear();
+	m_EmptyBoxIds.clear();
+	m_ViewableFlags.clear();
+	m_BodyFlags.clear();
+}
+
+// Store the boxes of the given collection at the given scene generation
+void CullingEngine::build(GLC_3DViewCollection* pCollection, int sceneGeneration)
+{
+	clear();
+	m_pCollection= pCollection;
+	m_CollectionSize= pCollection->size();
+	m_SceneGeneration= sceneGeneration;
+
+	QList<GLC_3DViewInstance*> instances= m_pCollection->instancesHandle();
+	const int size= instances.size();
+	m_ItemIds.reserve(size);
+	m_ItemBoxes.reserve(size);
+	m_FirstBodies.reserve(size + 1);
+	for (int i= 0; i < size; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instances.at(i);
+		const GLC_BoundingBox instanceBox(pInstance->boundingBox());
+		if (!instanceBox.isEmpty())
+		{
+			m_ItemIds.append(pInstance->id());
+			m_ItemBoxes.append(instanceBox);
+			m_FirstBodies.append(m_BodyBoxes.size());
+			// The bodies are localized when the instance is partially viewable
+			const GLC_Matrix4x4 matrix(pInstance->matrix());
+			const int bodyCount= pInstance->numberOfBody();
+			for (int body= 0; body < bodyCount; ++body)
+			{
+				GLC_BoundingBox bodyBox(pInstance->geomAt(body)->boundingBox());
+				bodyBox.transform(matrix);
+				m_BodyBoxes.append(bodyBox);
+			}
+		}
+		else
+		{
+			m_EmptyBoxIds.append(pInstance->id());
+		}
+	}
+	m_FirstBodies.append(m_BodyBoxes.size());
+}
+
+// Update the viewable state of instances with the given frustum and view
+void CullingEngine::updateViewableState(const GLC_Frustum& frustum, const GLC_Camera& camera, double viewAngle, bool useOrtho, int viewHeight)
+{
+	if (NULL == m_pCollection) return;
+
+	CullingView view;
+	view.m_pFrustum= &frustum;
+	view.m_Eye= camera.eye();
+	view.m_Forward= camera.target() - camera.eye();
+	view.m_Forward.normalize();
+	view.m_UseOrtho= useOrtho;
+	// Number of pixels by unit : at unit depth or for the parallel projection height
+	if (useOrtho)
+	{
+		view.m_PixelFactor= viewHeight / (2.0 * camera.distEyeTarget() * tan(viewAngle * glc::PI / 180.0));
+	}
+	else
+	{
+		view.m_PixelFactor= viewHeight / (2.0 * tan(viewAngle * glc::PI / 360.0));
+	}
+
+	const int size= m_ItemBoxes.size();
+	QVector<char> flags(size);
+	QVector<char> bodyFlags(m_BodyBoxes.size());
+
+	// Each chunk writes in its own range of flags : the merge is deterministic
+	int chunkCount= 1;
+	if (size >= minParallelViewableSize)
+	{
+		chunkCount= QThread::idealThreadCount() * 4;
+	}
+	const int chunkSize= (size + chunkCount - 1) / chunkCount;
+	QList<ViewableChunk> chunks;
+	for (int begin= 0; begin < size; begin+= chunkSize)
+	{
+		ViewableChunk chunk;
+		chunk.m_pView= &view;
+		chunk.m_pBoxes= m_ItemBoxes.constData();
+		chunk.m_pBodyBoxes= m_BodyBoxes.constData();
+		chunk.m_pFirstBodies= m_FirstBodies.constData();
+		chunk.m_pFlags= flags.data();
+		chunk.m_pBodyFlags= bodyFlags.data();
+		chunk.m_Begin= begin;
+		chunk.m_End= qMin(begin + chunkSize, size);
+		chunks.append(chunk);
+	}
+	if (chunks.size() > 1)
+	{
+		QtConcurrent::blockingMap(chunks, updateChunkViewableState);
+	}
+	else if (!chunks.isEmpty())
+	{
+		updateChunkViewableState(chunks.first());
+	}
+
+	// Apply the changed states in the calling thread
+	const bool applyAll= (m_ViewableFlags.size() != size);
+	for (int i= 0; i < size; ++i)
+	{
+		const bool instanceChanged= applyAll || (flags.at(i) != m_ViewableFlags.at(i));
+		const GLC_3DViewInstance::Viewable viewable= static_cast<GLC_3DViewInstance::Viewable>(flags.at(i));
+		const bool isPartial= (GLC_3DViewInstance::PartialViewable == viewable);
+		if (!instanceChanged && !isPartial) continue;
+
+		const int firstBody= m_FirstBodies.at(i);
+		const int endBody= m_FirstBodies.at(i + 1);
+		bool bodiesChanged= false;
+		for (int body= firstBody; !instanceChanged && isPartial && (body < endBody); ++body)
+		{
+			bodiesChanged= (bodyFlags.at(body) != m_BodyFlags.at(body));
+			if (bodiesChanged) break;
+		}
+		if (!instanceChanged && !bodiesChanged) continue;
+
+		GLC_3DViewInstance* pInstance= m_pCollection->instanceHandle(m_ItemIds.at(i));
+		if (NULL != pInstance)
+		{
+			pInstance->setViewable(viewable);
+			if (isPartial)
+			{
+				for (int body= firstBody; body < endBody; ++body)
+				{
+					pInstance->setGeomViewable(body - firstBody, 0 != bodyFlags.at(body));
+				}
+			}
+		}
+	}
+	// Instances without extent can't be localized : they are never culled
+	if (applyAll)
+	{
+		const int emptyCount= m_EmptyBoxIds.size();
+		for (int i= 0; i < emptyCount; ++i)
+		{
+			GLC_3DViewInstance* pInstance= m_pCollection->instanceHandle(m_EmptyBoxIds.at(i));
+			if (NULL != pInstance)
+			{
+				pInstance->setViewable(GLC_3DViewInstance::FullViewable);
+			}
+		}
+	}
+	m_ViewableFlags= flags;
+	m_BodyFlags= bodyFlags;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Compute the viewable state of the given chunk of items and of their bodies
+void CullingEngine::updateChunkViewableState(ViewableChunk& chunk)
+{
+	const CullingView& view= *(chunk.m_pView);
+	for (int i= chunk.m_Begin; i < chunk.m_End; ++i)
+	{
+		GLC_3DViewInstance::Viewable viewable= GLC_3DViewInstance::PartialViewable;
+		const GLC_Frustum::Localisation localisation= view.m_pFrustum->localizeBoundingBox(chunk.m_pBoxes[i]);
+		if ((GLC_Frustum::OutFrustum == localisation) || isTooSmall(chunk.m_pBoxes[i], view))
+		{
+			viewable= GLC_3DViewInstance::NoViewable;
+		}
+		else if (GLC_Frustum::InFrustum == localisation)
+		{
+			viewable= GLC_3DViewInstance::FullViewable;
+		}
+		chunk.m_pFlags[i]= static_cast<char>(viewable);
+
+		// Only the bodies of a partially viewable instance are localized
+		const int endBody= chunk.m_pFirstBodies[i + 1];
+		for (int body= chunk.m_pFirstBodies[i]; body < endBody; ++body)
+		{
+			if (GLC_3DViewInstance::PartialViewable == viewable)
+			{
+				chunk.m_pBodyFlags[body]= (GLC_Frustum::OutFrustum != view.m_pFrustum->localizeBoundingBox(chunk.m_pBodyBoxes[body]));
+			}
+			else
+			{
+				chunk.m_pBodyFlags[body]= (GLC_3DViewInstance::FullViewable == viewable);
+			}
+		}
+	}
+}
+
+// Return true if the projected size of the given box is under one pixel
+bool CullingEngine::isTooSmall(const GLC_BoundingBox& box, const CullingView& view)
+{
+	const double radius= (box.upperCorner() - box.lowerCorner()).length() / 2.0;
+	double pixelSize= 2.0 * radius * view.m_PixelFactor;
+	if (!view.m_UseOrtho)
+	{
+		// The eye is in or near the box : the box is never too small
+		const double depth= (box.center() - view.m_Eye) * view.m_Forward;
+		if (depth <= radius) return false;
+		pixelSize/= depth;
+	}
+	return pixelSize < minimumPixelSize;
+}
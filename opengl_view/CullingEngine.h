@@ -0,0 +1,149 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef CULLINGENGINE_H_
+#define CULLINGENGINE_H_
+
+#include <QVector>
+#include <GLC_BoundingBox>
+#include <GLC_Vector3d>
+#include <GLC_3DViewCollection>
+#include <GLC_Camera>
+#include <GLC_Frustum>
+
+//////////////////////////////////////////////////////////////////////
+//! \class CullingEngine
+/*! \brief CullingEngine : Update the viewable state of the instances of a collection*/
+
+/*! The world bounding boxes of instances and of their bodies are stored
+ *  when the engine is build. On each view change, the frustum and pixel
+ *  size tests are shared between the available cores and the changed
+ *  states are applied in the calling thread*/
+//////////////////////////////////////////////////////////////////////
+class CullingEngine
+{
+	//! The view used by the workers to compute the projected size of a box
+	struct CullingView
+	{
+		const GLC_Frustum* m_pFrustum;
+		GLC_Point3d m_Eye;
+		GLC_Vector3d m_Forward;
+		//! Number of pixels by unit at unit depth (or at any depth for parallel projection)
+		double m_PixelFactor;
+		bool m_UseOrtho;
+	};
+
+	//! Range of items which viewable state is computed by one worker
+	struct ViewableChunk
+	{
+		const CullingView* m_pView;
+		const GLC_BoundingBox* m_pBoxes;
+		const GLC_BoundingBox* m_pBodyBoxes;
+		const int* m_pFirstBodies;
+		char* m_pFlags;
+		char* m_pBodyFlags;
+		int m_Begin;
+		int m_End;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	CullingEngine();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if the stored boxes are up to date with the given collection and scene generation
+	inline bool isUpToDate(GLC_3DViewCollection* pCollection, int sceneGeneration) const
+	{
+		return (NULL != m_pCollection) && (m_pCollection == pCollection) && (m_CollectionSize == pCollection->size())
+				&& (m_SceneGeneration == sceneGeneration);
+	}
+
+	//! Return true if the viewable state have been computed since the engine was build
+	inline bool hasViewableState() const
+	{return (NULL != m_pCollection) && (m_ViewableFlags.size() == m_ItemIds.size());}
+
+	//! Clear the stored boxes and viewable state
+	void clear();
+
+	//! Store the boxes of the given collection at the given scene generation
+	void build(GLC_3DViewCollection*, int);
+
+	//! Update the viewable state of instances with the given frustum and view
+	/*! Camera, view angle, parallel projection and window height.
+	 *  Only the instances and bodies which state changed are updated*/
+	void updateViewableState(const GLC_Frustum&, const GLC_Camera&, double, bool, int);
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Compute the viewable state of the given chunk of items and of their bodies
+	static void updateChunkViewableState(ViewableChunk&);
+
+	//! Return true if the projected size of the given box is under one pixel
+	static bool isTooSmall(const GLC_BoundingBox&, const CullingView&);
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The collection associated to the stored boxes
+	GLC_3DViewCollection* m_pCollection;
+
+	//! The number of instances of the collection when the engine was build
+	int m_CollectionSize;
+
+	//! The scene generation when the engine was build
+	int m_SceneGeneration;
+
+	//! The id of instances with a bounding box
+	QVector<GLC_uint> m_ItemIds;
+
+	//! The world bounding box of instances
+	QVector<GLC_BoundingBox> m_ItemBoxes;
+
+	//! The index of the first body of each instance in m_BodyBoxes (one more for the end)
+	QVector<int> m_FirstBodies;
+
+	//! The world bounding box of instances bodies
+	QVector<GLC_BoundingBox> m_BodyBoxes;
+
+	//! The id of instances with an empty bounding box
+	QVector<GLC_uint> m_EmptyBoxIds;
+
+	//! The last viewable state applied to instances
+	QVector<char> m_ViewableFlags;
+
+	//! The last viewable state applied to bodies
+	QVector<char> m_BodyFlags;
+};
+
+#endif /* CULLINGENGINE_H_ */
@@ -0,0 +1,168 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include "FrameBufferPool.h"
+
+// Free framebuffers unused since this time in ms are deleted
+static const int maxFreeAge= 60000;
+
+FrameBufferPool::FrameBufferPool()
+: m_FreeEntries()
+, m_UsedEntries()
+{
+
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+	clear();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+
+// Take a framebuffer of the given size, samples count and attachment
+QGLFramebufferObject* FrameBufferPool::take(const QSize& size, int samples, QGLFramebufferObject::Attachment attachment)
+{
+	trim(maxFreeAge);
+
+	// Multisample framebuffer needs the blit extension to be resolved
+	if (!QGLFramebufferObject::hasOpenGLFramebufferBlit()) samples= 0;
+
+	PoolEntry entry;
+	entry.m_pFrameBuffer= NULL;
+	const int freeCount= m_FreeEntries.size();
+	for (int i= 0; (i < freeCount) && (NULL == entry.m_pFrameBuffer); ++i)
+	{
+		const PoolEntry& current= m_FreeEntries.at(i);
+		if ((current.m_Size == size) && (current.m_Samples == samples) && (current.m_Attachment == attachment))
+		{
+			entry= m_FreeEntries.takeAt(i);
+		}
+	}
+
+	if (NULL == entry.m_pFrameBuffer)
+	{
+		QGLFramebufferObjectFormat frameBufferFormat;
+		frameBufferFormat.setSamples(samples);
+		frameBufferFormat.setAttachment(attachment);
+		entry.m_pFrameBuffer= new QGLFramebufferObject(size, frameBufferFormat);
+		entry.m_Size= size;
+		entry.m_Samples= samples;
+		entry.m_Attachment= attachment;
+	}
+	entry.m_LastUse.start();
+	m_UsedEntries.append(entry);
+
+	return entry.m_pFrameBuffer;
+}
+
+// Give back the given framebuffer to the pool
+void FrameBufferPool::giveBack(QGLFramebufferObject* pFrameBuffer)
+{
+	const int usedCount= m_UsedEntries.size();
+	int index= 0;
+	while ((index < usedCount) && (m_UsedEntries.at(index).m_pFrameBuffer != pFrameBuffer))
+	{
+		++index;
+	}
+	// The framebuffer must have been taken from the pool
+	Q_ASSERT(index < usedCount);
+	if (index == usedCount) return;
+
+	PoolEntry entry= m_UsedEntries.takeAt(index);
+	if (pFrameBuffer->isBound()) pFrameBuffer->release();
+	entry.m_LastUse.start();
+	// An invalid framebuffer is not reused
+	if (pFrameBuffer->isValid())
+	{
+		m_FreeEntries.prepend(entry);
+	}
+	else
+	{
+		delete pFrameBuffer;
+	}
+	trim(maxFreeAge);
+}
+
+// Return the content of the given framebuffer
+QImage FrameBufferPool::toImage(QGLFramebufferObject* pFrameBuffer)
+{
+	if ((pFrameBuffer->format().samples() == 0) || !QGLFramebufferObject::hasOpenGLFramebufferBlit())
+	{
+		return pFrameBuffer->toImage();
+	}
+
+	// Resolve the multisample framebuffer
+	QGLFramebufferObject* pResolveTarget= take(pFrameBuffer->size(), 0, QGLFramebufferObject::NoAttachment);
+	const QRect rect(QPoint(0, 0), pFrameBuffer->size());
+	QGLFramebufferObject::blitFramebuffer(pResolveTarget, rect, pFrameBuffer, rect);
+	QImage image(pResolveTarget->toImage());
+	giveBack(pResolveTarget);
+
+	return image;
+}
+
+// Delete free framebuffers which have not been used since the given time in ms
+void FrameBufferPool::trim(int maxAge)
+{
+	QList<PoolEntry>::iterator iEntry= m_FreeEntries.begin();
+	while (m_FreeEntries.end() != iEntry)
+	{
+		if (iEntry->m_LastUse.elapsed() > maxAge)
+		{
+			delete iEntry->m_pFrameBuffer;
+			iEntry= m_FreeEntries.erase(iEntry);
+		}
+		else
+		{
+			++iEntry;
+		}
+	}
+}
+
+// Delete free framebuffers which have not been used for a while
+void FrameBufferPool::trim()
+{
+	trim(maxFreeAge);
+}
+
+// Delete all framebuffers, the OpenGL context must be current
+void FrameBufferPool::clear()
+{
+	const int freeCount= m_FreeEntries.size();
+	for (int i= 0; i < freeCount; ++i)
+	{
+		delete m_FreeEntries.at(i).m_pFrameBuffer;
+	}
+	m_FreeEntries.clear();
+
+	const int usedCount= m_UsedEntries.size();
+	for (int i= 0; i < usedCount; ++i)
+	{
+		delete m_UsedEntries.at(i).m_pFrameBuffer;
+	}
+	m_UsedEntries.clear();
+}
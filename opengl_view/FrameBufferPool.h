@@ -0,0 +1,109 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef FRAMEBUFFERPOOL_H_
+#define FRAMEBUFFERPOOL_H_
+
+#include <QList>
+#include <QSize>
+#include <QTime>
+#include <QImage>
+#include <QGLFramebufferObject>
+
+//////////////////////////////////////////////////////////////////////
+//! \class FrameBufferPool
+/*! \brief FrameBufferPool : Pool of framebuffers shared by all captures*/
+
+/*! Framebuffers are keyed by size, samples count and attachment.
+ *  A framebuffer given back to the pool is reused by the next capture
+ *  of the same kind and deleted when it has not been used for a while.
+ *  All framebuffers belong to the OpenGL context which is current when
+ *  the pool is used*/
+//////////////////////////////////////////////////////////////////////
+class FrameBufferPool
+{
+	//! A framebuffer of the pool
+	struct PoolEntry
+	{
+		QGLFramebufferObject* m_pFrameBuffer;
+		QSize m_Size;
+		int m_Samples;
+		QGLFramebufferObject::Attachment m_Attachment;
+		QTime m_LastUse;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	FrameBufferPool();
+	~FrameBufferPool();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Take a framebuffer of the given size, samples count and attachment
+	/*! The framebuffer is created if there is no free framebuffer of this kind.
+	 *  It must be given back with giveBack()*/
+	QGLFramebufferObject* take(const QSize&, int samples= 0, QGLFramebufferObject::Attachment attachment= QGLFramebufferObject::Depth);
+
+	//! Give back the given framebuffer to the pool
+	void giveBack(QGLFramebufferObject*);
+
+	//! Return the content of the given framebuffer
+	/*! A multisample framebuffer is resolved in a pooled framebuffer*/
+	QImage toImage(QGLFramebufferObject*);
+
+	//! Delete free framebuffers which have not been used since the given time in ms
+	void trim(int maxAge);
+
+	//! Delete free framebuffers which have not been used for a while
+	void trim();
+
+	//! Delete all framebuffers, the OpenGL context must be current
+	void clear();
+
+	//! Return the number of framebuffers owned by the pool
+	inline int size() const
+	{return m_FreeEntries.size() + m_UsedEntries.size();}
+
+	//! Return the number of framebuffers ready to be used
+	inline int freeCount() const
+	{return m_FreeEntries.size();}
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Framebuffers ready to be used
+	QList<PoolEntry> m_FreeEntries;
+
+	//! Framebuffers taken by a capture
+	QList<PoolEntry> m_UsedEntries;
+};
+
+#endif /* FRAMEBUFFERPOOL_H_ */
@@ -0,0 +1,358 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include "FrameStreamWriter.h"
+#include <QObject>
+#include <QBuffer>
+#include <QDataStream>
+#include <QImageWriter>
+#include <QtConcurrentRun>
+#include <cstdio>
+#include <cstring>
+
+// Size of the AVI headers before the first frame
+static const int aviHeaderSize= 224;
+
+// Size of an AVI index entry
+static const int aviIndexEntrySize= 16;
+
+// AVI flags
+static const quint32 aviHasIndex= 0x10;
+static const quint32 aviKeyFrame= 0x10;
+
+// Return the given chunk size padded to an even size
+static inline quint32 paddedSize(quint32 size)
+{
+	return size + (size & 1);
+}
+
+FrameStreamWriter::FrameStreamWriter()
+: m_File()
+, m_Format(MjpegAvi)
+, m_Size()
+, m_FramesPerSecond(25)
+, m_Quality(90)
+, m_PendingFrame()
+, m_HasPendingFrame(false)
+, m_FrameSizes()
+, m_MaxFrameSize(0)
+, m_StreamSize(0)
+, m_ErrorString()
+{
+
+}
+
+FrameStreamWriter::~FrameStreamWriter()
+{
+	if (m_File.isOpen()) close();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+
+// Create the given file for a stream of the given format, frame size and frame rate
+bool FrameStreamWriter::open(const QString& fileName, StreamFormat format, const QSize& size, int framesPerSecond, int quality)
+{
+	Q_ASSERT(!m_File.isOpen());
+	m_Format= format;
+	m_Size= size;
+	m_FramesPerSecond= qMax(1, framesPerSecond);
+	m_Quality= quality;
+	m_HasPendingFrame= false;
+	m_FrameSizes.clear();
+	m_MaxFrameSize= 0;
+	m_StreamSize= 0;
+	m_ErrorString.clear();
+
+	bool isOpen= false;
+	if (fileName == "-")
+	{
+		if (MjpegAvi == m_Format)
+		{
+			m_ErrorString= QObject::tr("AVI files can not be written on the standard output");
+			return false;
+		}
+		isOpen= m_File.open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered);
+	}
+	else
+	{
+		m_File.setFileName(fileName);
+		isOpen= m_File.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	}
+	if (!isOpen)
+	{
+		m_ErrorString= m_File.errorString();
+		return false;
+	}
+
+	// The AVI headers are written again when the frames are known
+	if ((MjpegAvi == m_Format) && !write(aviHeader()))
+	{
+		m_File.close();
+		m_File.remove();
+		return false;
+	}
+	return true;
+}
+
+// Append the given frame to the stream, it is scaled to the frame size if needed
+bool FrameStreamWriter::writeFrame(const QImage& image)
+{
+	if (!m_File.isOpen()) return false;
+
+	// The previous frame is written while this one is encoded
+	if (!writePendingFrame()) return false;
+	m_PendingFrame= QtConcurrent::run(&FrameStreamWriter::encodeFrame, image, m_Size, m_Format, m_Quality);
+	m_HasPendingFrame= true;
+	return true;
+}
+
+// Write the pending frame and close the stream, return true on success
+bool FrameStreamWriter::close()
+{
+	if (!m_File.isOpen()) return false;
+
+	bool success= writePendingFrame();
+	if (success && (MjpegAvi == m_Format))
+	{
+		success= write(aviIndex()) && m_File.seek(0) && write(aviHeader());
+	}
+	success= m_File.flush() && success;
+	if (!m_File.fileName().isEmpty())
+	{
+		m_File.close();
+		success= success && (QFile::NoError == m_File.error());
+		if (!success)
+		{
+			// Don't leave an unreadable file
+			m_File.remove();
+		}
+	}
+	else
+	{
+		m_File.close();
+	}
+	return success;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Wait for the frame being encoded and write it
+bool FrameStreamWriter::writePendingFrame()
+{
+	if (!m_HasPendingFrame) return m_ErrorString.isEmpty();
+	m_HasPendingFrame= false;
+
+	const QByteArray data(m_PendingFrame.result());
+	m_PendingFrame= QFuture<QByteArray>();
+	if (data.isEmpty())
+	{
+		m_ErrorString= QObject::tr("Failed to encode frame");
+		return false;
+	}
+
+	const quint32 dataSize= static_cast<quint32>(data.size());
+	if (MjpegAvi == m_Format)
+	{
+		// The chunk and its index entry must fit in the RIFF file
+		const quint64 frameSize= 8 + paddedSize(dataSize) + aviIndexEntrySize;
+		const quint64 indexSize= 8 + static_cast<quint64>(m_FrameSizes.size()) * aviIndexEntrySize;
+		if ((m_StreamSize + indexSize + frameSize) > Q_UINT64_C(0xFFFFFFFF))
+		{
+			m_ErrorString= QObject::tr("Video too large : AVI files are limited to 4 GB");
+			return false;
+		}
+
+		QByteArray chunkHeader;
+		QDataStream stream(&chunkHeader, QIODevice::WriteOnly);
+		stream.setByteOrder(QDataStream::LittleEndian);
+		stream.writeRawData("00dc", 4);
+		stream << dataSize;
+		if (!write(chunkHeader) || !write(data)) return false;
+		if ((dataSize & 1) && !write(QByteArray(1, '\0'))) return false;
+	}
+	else if (!write(data))
+	{
+		return false;
+	}
+
+	m_FrameSizes.append(dataSize);
+	m_MaxFrameSize= qMax(m_MaxFrameSize, dataSize);
+	return true;
+}
+
+// Write the given data in the stream
+bool FrameStreamWriter::write(const QByteArray& data)
+{
+	if (m_File.write(data) != data.size())
+	{
+		m_ErrorString= m_File.errorString();
+		return false;
+	}
+	m_StreamSize+= data.size();
+	return true;
+}
+
+// Return the AVI headers of the written frames
+QByteArray FrameStreamWriter::aviHeader() const
+{
+	const quint32 frameCount= static_cast<quint32>(m_FrameSizes.size());
+	const quint32 width= static_cast<quint32>(m_Size.width());
+	const quint32 height= static_cast<quint32>(m_Size.height());
+	const quint32 bufferSize= paddedSize(m_MaxFrameSize) + 8;
+
+	quint32 moviSize= 4;
+	for (quint32 i= 0; i < frameCount; ++i)
+	{
+		moviSize+= 8 + paddedSize(m_FrameSizes.at(i));
+	}
+	const quint32 riffSize= 4 + (8 + 192) + (8 + moviSize) + (8 + frameCount * aviIndexEntrySize);
+
+	QByteArray header;
+	QDataStream stream(&header, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+
+	stream.writeRawData("RIFF", 4);
+	stream << riffSize;
+	stream.writeRawData("AVI ", 4);
+
+	// Main header
+	stream.writeRawData("LIST", 4);
+	stream << static_cast<quint32>(192);
+	stream.writeRawData("hdrl", 4);
+	stream.writeRawData("avih", 4);
+	stream << static_cast<quint32>(56);
+	stream << static_cast<quint32>(1000000 / m_FramesPerSecond);		// MicroSecPerFrame
+	stream << m_MaxFrameSize * m_FramesPerSecond;						// MaxBytesPerSec
+	stream << static_cast<quint32>(0);									// PaddingGranularity
+	stream << aviHasIndex;												// Flags
+	stream << frameCount;												// TotalFrames
+	stream << static_cast<quint32>(0);									// InitialFrames
+	stream << static_cast<quint32>(1);									// Streams
+	stream << bufferSize;												// SuggestedBufferSize
+	stream << width << height;
+	for (int i= 0; i < 4; ++i)
+	{
+		stream << static_cast<quint32>(0);								// Reserved
+	}
+
+	// Video stream header
+	stream.writeRawData("LIST", 4);
+	stream << static_cast<quint32>(116);
+	stream.writeRawData("strl", 4);
+	stream.writeRawData("strh", 4);
+	stream << static_cast<quint32>(56);
+	stream.writeRawData("vids", 4);
+	stream.writeRawData("MJPG", 4);
+	stream << static_cast<quint32>(0);									// Flags
+	stream << static_cast<quint16>(0) << static_cast<quint16>(0);		// Priority and Language
+	stream << static_cast<quint32>(0);									// InitialFrames
+	stream << static_cast<quint32>(1);									// Scale
+	stream << static_cast<quint32>(m_FramesPerSecond);					// Rate
+	stream << static_cast<quint32>(0);									// Start
+	stream << frameCount;												// Length
+	stream << bufferSize;												// SuggestedBufferSize
+	stream << static_cast<quint32>(0xFFFFFFFF);						// Quality : default
+	stream << static_cast<quint32>(0);									// SampleSize
+	stream << static_cast<quint16>(0) << static_cast<quint16>(0);		// Frame rectangle
+	stream << static_cast<quint16>(width) << static_cast<quint16>(height);
+
+	// Video stream format
+	stream.writeRawData("strf", 4);
+	stream << static_cast<quint32>(40);
+	stream << static_cast<quint32>(40);									// Size
+	stream << width << height;
+	stream << static_cast<quint16>(1) << static_cast<quint16>(24);		// Planes and BitCount
+	stream.writeRawData("MJPG", 4);										// Compression
+	stream << width * height * 3;										// SizeImage
+	for (int i= 0; i < 4; ++i)
+	{
+		stream << static_cast<quint32>(0);								// Resolution and colors
+	}
+
+	// The frames list
+	stream.writeRawData("LIST", 4);
+	stream << moviSize;
+	stream.writeRawData("movi", 4);
+
+	Q_ASSERT(header.size() == aviHeaderSize);
+	return header;
+}
+
+// Return the AVI index of the written frames
+QByteArray FrameStreamWriter::aviIndex() const
+{
+	const int frameCount= m_FrameSizes.size();
+
+	QByteArray index;
+	QDataStream stream(&index, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.writeRawData("idx1", 4);
+	stream << static_cast<quint32>(frameCount * aviIndexEntrySize);
+
+	// Chunk offsets are relative to the "movi" list type
+	quint32 offset= 4;
+	for (int i= 0; i < frameCount; ++i)
+	{
+		stream.writeRawData("00dc", 4);
+		stream << aviKeyFrame << offset << m_FrameSizes.at(i);
+		offset+= 8 + paddedSize(m_FrameSizes.at(i));
+	}
+	return index;
+}
+
+// Encode the given frame in the given format (Run by a worker thread)
+QByteArray FrameStreamWriter::encodeFrame(QImage image, QSize size, StreamFormat format, int quality)
+{
+	if (image.size() != size)
+	{
+		image= image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+	}
+
+	QByteArray data;
+	if (MjpegAvi == format)
+	{
+		QBuffer buffer(&data);
+		buffer.open(QIODevice::WriteOnly);
+		QImageWriter imageWriter(&buffer, "JPG");
+		imageWriter.setQuality(quality);
+		if (!imageWriter.write(image)) data.clear();
+	}
+	else
+	{
+		// Top to bottom rows of RGB pixels without padding
+		image= image.convertToFormat(QImage::Format_RGB888);
+		const int rowBytes= image.width() * 3;
+		data.resize(rowBytes * image.height());
+		char* pData= data.data();
+		for (int y= 0; y < image.height(); ++y)
+		{
+			memcpy(pData + y * rowBytes, image.constScanLine(y), rowBytes);
+		}
+	}
+	return data;
+}
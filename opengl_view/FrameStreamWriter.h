@@ -0,0 +1,147 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef FRAMESTREAMWRITER_H_
+#define FRAMESTREAMWRITER_H_
+
+#include <QFile>
+#include <QSize>
+#include <QString>
+#include <QImage>
+#include <QByteArray>
+#include <QVector>
+#include <QFuture>
+
+//////////////////////////////////////////////////////////////////////
+//! \class FrameStreamWriter
+/*! \brief FrameStreamWriter : Write a sequence of frames in a single stream*/
+
+/*! The frames are stored in an MJPEG AVI file or as raw RGB24 frames,
+ *  which can be written on the standard output to be piped into an
+ *  encoder. A frame is encoded by a worker thread while the next one is
+ *  rendered, and written when the next frame is given : at most one
+ *  image and one encoded frame are held in memory. The AVI index
+ *  only keeps the offset and the size of each frame. AVI files are
+ *  limited to 4 GB (RIFF)*/
+//////////////////////////////////////////////////////////////////////
+class FrameStreamWriter
+{
+public:
+	//! The stream formats
+	enum StreamFormat
+	{
+		MjpegAvi,
+		RawFrames
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	FrameStreamWriter();
+
+	//! Close the stream
+	~FrameStreamWriter();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Create the given file for a stream of the given format, frame size and frame rate
+	/*! The file name "-" is the standard output, only for raw frames*/
+	bool open(const QString&, StreamFormat, const QSize&, int framesPerSecond, int quality= 90);
+
+	//! Append the given frame to the stream, it is scaled to the frame size if needed
+	bool writeFrame(const QImage&);
+
+	//! Write the pending frame and close the stream, return true on success
+	/*! The AVI index and header are written when the stream is closed*/
+	bool close();
+
+	//! Return the number of frames already written
+	inline int writtenFrames() const
+	{return m_FrameSizes.size();}
+
+	//! Return the last error message
+	inline QString errorString() const
+	{return m_ErrorString;}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Wait for the frame being encoded and write it
+	bool writePendingFrame();
+
+	//! Write the given data in the stream
+	bool write(const QByteArray&);
+
+	//! Return the AVI headers of the written frames
+	QByteArray aviHeader() const;
+
+	//! Return the AVI index of the written frames
+	QByteArray aviIndex() const;
+
+	//! Encode the given frame in the given format (Run by a worker thread)
+	static QByteArray encodeFrame(QImage, QSize, StreamFormat, int);
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The stream file
+	QFile m_File;
+
+	//! The stream format
+	StreamFormat m_Format;
+
+	//! The frame size
+	QSize m_Size;
+
+	//! The frame rate
+	int m_FramesPerSecond;
+
+	//! The JPEG quality
+	int m_Quality;
+
+	//! The frame being encoded
+	QFuture<QByteArray> m_PendingFrame;
+	bool m_HasPendingFrame;
+
+	//! The size of each written frame data
+	QVector<quint32> m_FrameSizes;
+
+	//! The size of the largest written frame
+	quint32 m_MaxFrameSize;
+
+	//! The number of bytes written in the stream
+	quint64 m_StreamSize;
+
+	//! The last error message
+	QString m_ErrorString;
+};
+
+#endif /* FRAMESTREAMWRITER_H_ */
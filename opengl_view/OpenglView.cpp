@@ -37,12 +37,21 @@
 #include <GLC_RenderStatistics>
 #include <GLC_UserInput>
 #include <GLC_Context>
+#include <QPainter>
+#include "TiffStripWriter.h"
+#include "../FileEntry.h"
 
 // For VSYNC problem under Mac OS X
 #if defined(Q_OS_MAC)
 #include <OpenGL.h>
 #endif
 
+// Maximum size of the tiles of a poster render
+static const int posterTileSize= 2048;
+
+// Interval in ms between two trims of the framebuffer pool
+static const int frameBufferTrimInterval= 10000;
+
 // List of usable shader
 ShaderList OpenglView::m_ShaderList;
 
@@ -65,8 +74,17 @@ OpenglView::OpenglView(QWidget *pParent)
 , m_GlobalShaderId(0)
 , m_GlobalShaderName(tr("No Shader"))
 , m_pQGLFramebufferObject(NULL)
+, m_FrameBufferPool()
+, m_FrameBufferTrimTimer()
 , m_CaptureSize()
 , m_SmoothCaptures(false)
+, m_CaptureBackgroundImageName()
+, m_CaptureTile()
+, m_CaptureTileTargetSize()
+, m_CaptureTileSize()
+, m_TileBackgroundTextureId(0)
+, m_TiledRenderAutoBufferSwap(true)
+, m_PosterCanceled(false)
 , m_UiCollection()
 , m_CurrentMoverType(GLC_MoverController::TrackBall)
 , m_RenderFlag(glc::ShadingFlag)
@@ -78,9 +96,32 @@ OpenglView::OpenglView(QWidget *pParent)
 , m_CuttingPLaneID(0)
 , m_UserLights()
 , m_CurrentLightIndex(-1)
+, m_PickingEngine()
+, m_CullingEngine()
+, m_SelectionArea()
+, m_TouchingAreaSelection(false)
+, m_ViewableStateCamera()
+, m_ViewableStateAngle(0.0)
+, m_ViewableStateAspectRatio(0.0)
+, m_ViewableStateOrtho(false)
+, m_ViewableStateHeight(0)
+, m_SceneGeneration(0)
+, m_VisibilityGeneration(0)
+, m_DirtyFlags(D_ALL)
+, m_IsInPaintEvent(false)
+, m_SceneFrameTextureId(0)
+, m_SceneFrameTextureSize()
+, m_SceneFrameSize()
+, m_InfoPanelTextureId(0)
+, m_InfoPanelContent()
+, m_DisplayedFps()
+, m_FpsDisplayTime()
 {
 
-	connect(&m_GlView, SIGNAL(updateOpenGL()), this, SLOT(updateGL()));
+	connect(&m_GlView, SIGNAL(updateOpenGL()), this, SLOT(requestUpdate()));
+	// Idle framebuffers are released even if there is no more capture
+	connect(&m_FrameBufferTrimTimer, SIGNAL(timeout()), this, SLOT(trimFrameBufferPool()));
+	m_FrameBufferTrimTimer.start(frameBufferTrimInterval);
 	//setMouseTracking(true);
 	m_Light.setPosition(1.0, 1.0, 1.0);
 	m_Light.setName(tr("Master Light"));
@@ -93,7 +134,7 @@ OpenglView::OpenglView(QWidget *pParent)
 	repColor.setRgbF(1.0, 0.11372, 0.11372, 0.8);
 	m_MoverController= GLC_Factory::instance()->createDefaultMoverController(repColor, &m_GlView);
 
-	connect(&m_MoverController, SIGNAL(repaintNeeded()), this, SLOT(updateGL()));
+	connect(&m_MoverController, SIGNAL(repaintNeeded()), this, SLOT(requestUpdate()));
 	// Create other UI element
 	GLC_3DViewInstance line= GLC_Factory::instance()->createLine(GLC_Point3d(), glc::X_AXIS);
 	line.geomAt(0)->setWireColor(Qt::red);
@@ -109,6 +150,16 @@ OpenglView::OpenglView(QWidget *pParent)
 OpenglView::~OpenglView()
 {
 	GLC_SelectionMaterial::deleteShader(context());
+	makeCurrent();
+	if (0 != m_SceneFrameTextureId)
+	{
+		glDeleteTextures(1, &m_SceneFrameTextureId);
+	}
+	m_FrameBufferPool.clear();
+	if (0 != m_InfoPanelTextureId)
+	{
+		deleteTexture(m_InfoPanelTextureId);
+	}
 	if (!m_ShaderList.isEmpty())
 	{
 		const int size= m_ShaderList.size();
@@ -165,7 +216,7 @@ void OpenglView::reframe(const GLC_BoundingBox& boundingBox, bool motion)
 			}
 			else
 			{
-				updateGL();
+				requestUpdate(D_CAMERA);
 				emit viewChanged();
 			}
 		}
@@ -186,7 +237,7 @@ void OpenglView::reframe(const GLC_BoundingBox& boundingBox, bool motion)
 		}
 		else
 		{
-			updateGL();
+			requestUpdate(D_CAMERA);
 		}
 	}
 }
@@ -209,11 +260,29 @@ void OpenglView::setCameraAndAngle(const GLC_Camera& cam, const double& angle)
 	emit viewChanged();
 }
 
+// Set the camera of the given entry, the iso view reframed on the world if the entry camera is not set
+void OpenglView::setEntryCamera(const FileEntry& entry)
+{
+	if (entry.cameraIsSet())
+	{
+		setCameraAndAngle(entry.getCamera(), entry.getViewAngle());
+	}
+	else
+	{
+		GLC_Camera defaultCam;
+		defaultCam.setDefaultUpVector(m_World.upVector());
+		defaultCam.setIsoView();
+		setCameraAndAngle(defaultCam, entry.getViewAngle());
+
+		reframe(GLC_BoundingBox(), false);
+	}
+}
+
 // Init Iso view
 void OpenglView::initIsoView()
 {
 	m_GlView.cameraHandle()->setIsoView();
-	updateGL();
+	requestUpdate(D_CAMERA);
 	emit viewChanged();
 }
 
@@ -329,7 +398,7 @@ void OpenglView::zoomOut()
 void OpenglView::selectAll()
 {
 	m_World.selectAllWith3DViewInstanceInCurrentShowState();
-	updateGL();
+	requestUpdate(D_MATERIALS);
 	emit updateSelection(m_World.collection()->selection());
 }
 
@@ -338,7 +407,7 @@ void OpenglView::unselectAllSlot()
 {
 	// if a geometry is selected, unselect it
 	m_World.unselectAll();
-	updateGL();
+	requestUpdate(D_MATERIALS);
 	emit unselectAll();
 }
 
@@ -363,7 +432,7 @@ void OpenglView::selectInstance(const GLC_uint SelectionID)
 	{
 		m_World.select(SelectionID);
 	}
-	updateGL();
+	requestUpdate(D_MATERIALS);
 	emit updateSelection(m_World.collection()->selection());
 }
 
@@ -405,7 +474,7 @@ void OpenglView::toggleOctreeDisplay(bool display)
 	{
 		m_3dWidgetCollection.clear();
 	}
-	updateGL();
+	requestUpdate(D_WIDGETS);
 }
 void OpenglView::sectioning(bool isActive)
 {
@@ -424,15 +493,17 @@ void OpenglView::sectioning(bool isActive)
 		// Test clipping plane
 		m_pClipPlane= new GLC_Plane(normal, center);
 		m_GlView.addClipPlane(GL_CLIP_PLANE0, m_pClipPlane);
+		m_PickingEngine.setClipPlane(m_pClipPlane);
 	}
 	else if (0 != m_CuttingPLaneID)
 	{
 		m_3DWidgetManager.remove3DWidget(m_CuttingPLaneID);
 		m_GlView.removeClipPlane(GL_CLIP_PLANE0);
+		m_PickingEngine.setClipPlane(NULL);
 		m_CuttingPLaneID= 0;
 	}
 
-	updateGL();
+	requestUpdate(D_WIDGETS | D_VISIBILITY);
 }
 
 void  OpenglView::showHideSectionPlane()
@@ -446,7 +517,7 @@ void  OpenglView::showHideSectionPlane()
 	{
 		m_3DWidgetManager.setWidgetVisible(m_CuttingPLaneID, false);
 	}
-	updateGL();
+	requestUpdate(D_WIDGETS);
 }
 
 void OpenglView::sectionUpdated()
@@ -461,13 +532,13 @@ void OpenglView::sectionUpdated()
 void OpenglView::toPerpective()
 {
 	m_GlView.setToOrtho(false);
-	updateGL();
+	requestUpdate(D_CAMERA);
 }
 
 void OpenglView::toParallel()
 {
 	m_GlView.setToOrtho(true);
-	updateGL();
+	requestUpdate(D_CAMERA);
 }
 
 void OpenglView::updateLightPosition()
@@ -476,7 +547,7 @@ void OpenglView::updateLightPosition()
 	if ((NULL != pAxis) && (-1 != m_CurrentLightIndex))
 	{
 		m_UserLights[m_CurrentLightIndex]->setPosition(pAxis->center());
-		updateGL();
+		requestUpdate(D_LIGHTS | D_WIDGETS);
 	}
 }
 
@@ -495,24 +566,73 @@ void OpenglView::editLight(int index)
 		m_3DWidgetManager.add3DWidget(pAxis);
 		connect(pAxis, SIGNAL(asChanged()), this, SLOT(updateLightPosition()));
 	}
-	updateGL();
+	requestUpdate(D_WIDGETS);
+}
+
+// Mark the given flags and render once in the next event loop pass
+void OpenglView::requestUpdate(int flags)
+{
+	m_DirtyFlags|= flags;
+	// Paint events are compressed by Qt : one render per event loop pass
+	update();
+}
+
+// Instances have moved or have been added : render once and rebuild the picking and culling boxes
+void OpenglView::sceneChanged()
+{
+	++m_SceneGeneration;
+	requestUpdate(D_VISIBILITY);
+}
+
+// Instances have been shown or hidden : render once, the picking and culling boxes are kept
+void OpenglView::visibilityChanged()
+{
+	++m_VisibilityGeneration;
+	requestUpdate(D_VISIBILITY);
+	emit visibilityModified();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private slots Functions
+//////////////////////////////////////////////////////////////////////
+
+// Delete the framebuffers of the pool which have not been used for a while
+void OpenglView::trimFrameBufferPool()
+{
+	if (m_FrameBufferPool.freeCount() > 0)
+	{
+		// Framebuffers belong to the view context
+		makeCurrent();
+		m_FrameBufferPool.trim();
+	}
 }
 
 //////////////////////////////////////////////////////////////////////
 // Private services Functions
 //////////////////////////////////////////////////////////////////////
-void OpenglView::paintGL()
+void OpenglView::renderScene(bool cacheFrame)
 {
 	GLC_RenderStatistics::reset();
 	QTime time;
 	time.start();
 	setDistMinAndMax();
+	if (!m_CaptureTile.isNull()) applyCaptureTile();
 
-	m_World.collection()->updateInstanceViewableState();
+	updateViewableState();
 
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	GLC_Context::current()->glcLoadIdentity();
 	if (!m_SnapShootMode) glEnable(GL_MULTISAMPLE);
+
+	// Display the part of the background image under the capture tile
+	if (!m_CaptureTile.isNull() && (0 != m_TileBackgroundTextureId))
+	{
+		const double targetWidth= static_cast<double>(m_CaptureTileTargetSize.width());
+		const double targetHeight= static_cast<double>(m_CaptureTileTargetSize.height());
+		const QRectF textureRect(m_CaptureTile.x() / targetWidth, 1.0 - (m_CaptureTile.y() + m_CaptureTile.height()) / targetHeight
+				, m_CaptureTile.width() / targetWidth, m_CaptureTile.height() / targetHeight);
+		displayTexture(m_TileBackgroundTextureId, textureRect);
+	}
 	try
 	{
 		// Enable and execute lighting
@@ -608,6 +728,34 @@ void OpenglView::paintGL()
 
 
 	updateFps(time.elapsed());
+	if (cacheFrame)
+	{
+		cacheSceneFrame();
+	}
+	else
+	{
+		m_SceneFrameSize= QSize();
+	}
+}
+
+void OpenglView::paintGL()
+{
+	// Direct updateGL calls always render the 3D scene
+	const bool overlayOnly= m_IsInPaintEvent && (0 == (m_DirtyFlags & D_SCENE));
+	m_DirtyFlags= D_NONE;
+	if (overlayOnly && sceneFrameIsValid())
+	{
+		// Only overlays have changed
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		GLC_Context::current()->glcLoadIdentity();
+		displaySceneFrame();
+	}
+	else
+	{
+		// The scene frame is only copied when overlay only renders are expected in the on screen normal mode
+		const bool cacheFrame= (overlayOnly || (V_AREA_SELECTING == m_ViewState)) && !m_SnapShootMode && !m_SelectionMode && autoBufferSwap();
+		renderScene(cacheFrame);
+	}
 	if (!m_SelectionMode && m_dislayInfoPanel && !m_SnapShootMode)
 	{
 		// Display info area
@@ -634,6 +782,10 @@ void OpenglView::paintGL()
 		GLC_Context::current()->glcPopMatrix();
 		GLC_Context::current()->glcMatrixMode(GL_MODELVIEW);
 	}
+	if (V_AREA_SELECTING == m_ViewState)
+	{
+		displaySelectionArea();
+	}
 	if (!m_SnapShootMode) glEnable(GL_MULTISAMPLE);
 }
 
@@ -641,6 +793,15 @@ void OpenglView::paintGL()
 void OpenglView::resizeGL(int width, int height)
 {
 	m_GlView.setWinGLSize(width, height);
+	m_DirtyFlags|= D_CAMERA;
+}
+
+void OpenglView::paintEvent(QPaintEvent* pEvent)
+{
+	// Expose and requested updates could reuse the scene frame
+	m_IsInPaintEvent= true;
+	QGLWidget::paintEvent(pEvent);
+	m_IsInPaintEvent= false;
 }
 
 void OpenglView::mousePressEvent(QMouseEvent * e)
@@ -721,7 +882,7 @@ void OpenglView::mousePressEvent(QMouseEvent * e)
 			case VE_POINTING:
 			m_MoverController.setActiveMover(GLC_MoverController::Target, userInput);
 			m_MoverController.setNoMover();
-			updateGL();
+			requestUpdate(D_CAMERA);
 			break;
 
 			case VE_ZOOMING:
@@ -730,6 +891,20 @@ void OpenglView::mousePressEvent(QMouseEvent * e)
 			m_ViewState= V_ZOOMING;
 			m_World.collection()->setLodUsage(true, &m_GlView);
 			break;
+
+			case VE_RECTANGLE_SELECTING:
+			case VE_LASSO_SELECTING:
+			if (!m_BlockSelection)
+			{
+				m_SelectionArea.clear();
+				m_SelectionArea << e->pos();
+				setCursor(Qt::CrossCursor);
+				m_ViewState= V_AREA_SELECTING;
+			}
+			break;
+
+			default:
+			break;
 		}
 	}
 
@@ -753,27 +928,49 @@ void OpenglView::mouseReleaseEvent(QMouseEvent * e)
 			m_MoverController.setNoMover();
 			unsetCursor();
 			m_ViewState= V_NORMAL;
-			updateGL();
+			requestUpdate(D_WIDGETS);
 
 		}
 	}
+	else if ((e->button() == Qt::LeftButton) && (m_ViewState == V_AREA_SELECTING))
+	{
+		const bool multiSelection= ((e->modifiers() == Qt::ControlModifier) || (e->modifiers() == Qt::ShiftModifier));
+		selectArea(multiSelection);
+		unsetCursor();
+		m_ViewState= V_NORMAL;
+		requestUpdate(D_MATERIALS | D_OVERLAY);
+	}
 	else if((e->button() == Qt::LeftButton)
 			&& ((m_ViewEnterState == VE_PANNING) || (m_ViewEnterState == VE_ORBITING) || (m_ViewEnterState == VE_ZOOMING)))
 	{
 		m_MoverController.setNoMover();
 		unsetCursor();
 		m_ViewState= V_NORMAL;
-		updateGL();
+		requestUpdate(D_WIDGETS);
 	}
 }
 void OpenglView::mouseMoveEvent(QMouseEvent * e)
 {
-	if ((m_ViewState == V_ORBITING) || (m_ViewState == V_ZOOMING) || (m_ViewState == V_PANNING))
+	if (m_ViewState == V_AREA_SELECTING)
+	{
+		if (m_ViewEnterState == VE_RECTANGLE_SELECTING)
+		{
+			const QPoint start(m_SelectionArea.first());
+			m_SelectionArea.clear();
+			m_SelectionArea << start << QPoint(e->x(), start.y()) << e->pos() << QPoint(start.x(), e->y());
+		}
+		else if ((m_SelectionArea.last() - e->pos()).manhattanLength() > 2)
+		{
+			m_SelectionArea << e->pos();
+		}
+		requestUpdate(D_OVERLAY);
+	}
+	else if ((m_ViewState == V_ORBITING) || (m_ViewState == V_ZOOMING) || (m_ViewState == V_PANNING))
 	{
 		const bool needUpdate= m_MoverController.move(GLC_UserInput(e->x(), e->y()));
 		if (needUpdate)
 		{
-			updateGL();
+			requestUpdate(D_CAMERA | D_WIDGETS);
 			emit viewChanged();
 		}
 	}
@@ -949,48 +1146,32 @@ void OpenglView::updateFps(int elapsed)
 // Display info panel
 void OpenglView::displayInfo()
 {
-	QSize textPosition(76,5);
 	QSize screenSize(size());
 	int screenHeight= screenSize.height();
-	float panelRatio= static_cast<float>(screenHeight - 42) / screenHeight;
+	const int panelHeight= 21;
+	float panelRatio= static_cast<float>(screenHeight - 2 * panelHeight) / screenHeight;
 	double displayRatio= static_cast<double>(screenSize.height()) / static_cast<double>(screenSize.width());
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glBlendFunc(GL_ONE,GL_SRC_ALPHA);
-	QColor areaColor(5, 5, 50, 128);
-	qglColor(areaColor);
-
-	glBegin(GL_QUADS);
-		glVertex2f(-1.f,-panelRatio); glVertex2f( 1.f,-panelRatio);
-		glVertex2f( 1.f,-1.f); glVertex2f(-1.f,-1.f);
-	glEnd();
 
-	// Display the frame rate
-	qglColor(Qt::white);
-	m_infoFont.setPixelSize(12);
-	screenSize-= textPosition;
-	QString fps(QString::number(m_CurrentFps, 'f', 2) + QString(" Fps"));
-	renderText(screenSize.width(), screenSize.height(), fps, m_infoFont);
-	// If there is one selected object, display its name
-	if(m_World.selectionSize() == 1)
-	{
-		QString selectionName(m_World.selectedOccurenceList().first()->name());
-		// truncate the string to 50 characters
-		selectionName= selectionName.left(50);
-		renderText(10, screenSize.height(), selectionName, m_infoFont);
-	}
-	else if (GLC_State::glslUsed())
-	{
-		QString currentShaderName(tr("Global Shader : ") + m_GlobalShaderName);
-		currentShaderName= currentShaderName.left(50);
-		renderText(10, screenSize.height(), currentShaderName, m_infoFont);
+	// The panel and its texts are rendered in a texture only when they change
+	updateInfoPanelTexture(QSize(screenSize.width(), panelHeight));
+	if (0 != m_InfoPanelTextureId)
+	{
+		glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+		glEnable(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, m_InfoPanelTextureId);
+		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		glBegin(GL_QUADS);
+			glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.f,-panelRatio);
+			glTexCoord2f(1.0f, 1.0f); glVertex2f( 1.f,-panelRatio);
+			glTexCoord2f(1.0f, 0.0f); glVertex2f( 1.f,-1.f);
+			glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.f,-1.f);
+		glEnd();
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glPopAttrib();
 	}
-
-	// Display render statistics
-	QString bodyCount= tr("Body Count : ") + QString::number(GLC_RenderStatistics::bodyCount());
-	renderText(screenSize.width() / 2 - 100, screenSize.height(), bodyCount, m_infoFont);
-	QString triangleCount = tr("Triangle Count : ") + QString::number(GLC_RenderStatistics::triangleCount());
-	renderText(screenSize.width() / 2 + 100, screenSize.height(), triangleCount, m_infoFont);
-
+	glBlendFunc(GL_ONE,GL_SRC_ALPHA);
 
 	GLC_Matrix4x4 uiMatrix(m_GlView.cameraHandle()->viewMatrix());
 	// Change matrix to follow camera orientation
@@ -1019,41 +1200,83 @@ void OpenglView::displayInfo()
 	}
 }
 
-// Select
-void OpenglView::select(int x, int y, bool multiSelection, QMouseEvent* pMouseEvent)
+// Regenerate the info panel texture if its content changed
+void OpenglView::updateInfoPanelTexture(const QSize& panelSize)
 {
+	// The frame rate is refreshed twice per second
+	if (m_DisplayedFps.isEmpty() || (m_FpsDisplayTime.elapsed() > 500))
+	{
+		m_DisplayedFps= QString::number(m_CurrentFps, 'f', 2) + QString(" Fps");
+		m_FpsDisplayTime.start();
+	}
 
-	const bool spacePartitioningIsUsed= m_World.collection()->spacePartitioningIsUsed();
-	// Selection frustum
-	if (spacePartitioningIsUsed)
+	// If there is one selected object, display its name
+	QString leftText;
+	if(m_World.selectionSize() == 1)
 	{
-		GLC_Frustum selectionFrustum(m_GlView.selectionFrustum(x, y));
-		m_World.collection()->updateInstanceViewableState(selectionFrustum);
-		m_World.collection()->setSpacePartitionningUsage(false);
+		// truncate the string to 50 characters
+		leftText= m_World.selectedOccurenceList().first()->name().left(50);
+	}
+	else if (GLC_State::glslUsed())
+	{
+		leftText= QString(tr("Global Shader : ") + m_GlobalShaderName).left(50);
 	}
 
-	m_SelectionMode= true;
-	setAutoBufferSwap(false);
+	// Render statistics
+	const QString bodyCount= tr("Body Count : ") + QString::number(GLC_RenderStatistics::bodyCount());
+	const QString triangleCount = tr("Triangle Count : ") + QString::number(GLC_RenderStatistics::triangleCount());
 
-	m_World.collection()->setLodUsage(true, &m_GlView);
-	GLC_uint SelectionID= m_GlView.renderAndSelect(x, y);
-	m_World.collection()->setLodUsage(false, &m_GlView);
+	QStringList content;
+	content << QString::number(panelSize.width()) << m_DisplayedFps << leftText << bodyCount << triangleCount;
+	const QString panelContent(content.join(QString('\n')));
+	if ((0 != m_InfoPanelTextureId) && (panelContent == m_InfoPanelContent)) return;
+	m_InfoPanelContent= panelContent;
+
+	QImage panelImage(panelSize, QImage::Format_ARGB32_Premultiplied);
+	panelImage.fill(QColor(5, 5, 50, 128).rgba());
+	const int baseLine= panelSize.height() - 5;
+	m_infoFont.setPixelSize(12);
+	QPainter painter(&panelImage);
+	painter.setFont(m_infoFont);
+	painter.setPen(Qt::white);
+	painter.drawText(panelSize.width() - 76, baseLine, m_DisplayedFps);
+	painter.drawText(10, baseLine, leftText);
+	painter.drawText(panelSize.width() / 2 - 100, baseLine, bodyCount);
+	painter.drawText(panelSize.width() / 2 + 100, baseLine, triangleCount);
+	painter.end();
 
-	if (spacePartitioningIsUsed)
+	if (0 != m_InfoPanelTextureId)
 	{
-		m_World.collection()->updateInstanceViewableState(m_GlView.frustum());
-		m_World.collection()->setSpacePartitionningUsage(true);
+		deleteTexture(m_InfoPanelTextureId);
 	}
+	m_InfoPanelTextureId= bindTexture(panelImage, GL_TEXTURE_2D, GL_RGBA, QGLContext::InvertedYBindOption | QGLContext::PremultipliedAlphaBindOption);
+}
 
-	// 3DWidget manager test
-	glc::WidgetEventFlag eventFlag= m_3DWidgetManager.mousePressEvent(pMouseEvent);
+// Select
+void OpenglView::select(int x, int y, bool multiSelection, QMouseEvent* pMouseEvent)
+{
+	// CPU picking : the cost doesn't depend of the scene drawing cost
+	const GLC_uint SelectionID= pick(x, y);
 
-	m_SelectionMode= false;
-	setAutoBufferSwap(true);
+	// The 3D widgets are picked from a selection render, only done when there is a widget
+	glc::WidgetEventFlag eventFlag= glc::IgnoreEvent;
+	if ((0 != m_CuttingPLaneID) || (0 != m_LightAxisWidgetId))
+	{
+		m_SelectionMode= true;
+		setAutoBufferSwap(false);
+
+		m_GlView.renderAndSelect(x, y);
+
+		// 3DWidget manager test
+		eventFlag= m_3DWidgetManager.mousePressEvent(pMouseEvent);
+
+		m_SelectionMode= false;
+		setAutoBufferSwap(true);
+	}
 
 	if (eventFlag == glc::BlockedEvent)
 	{
-		updateGL();
+		requestUpdate(D_WIDGETS);
 		return;
 	}
 	else if (m_World.containsOccurence(SelectionID))
@@ -1067,20 +1290,20 @@ void OpenglView::select(int x, int y, bool multiSelection, QMouseEvent* pMouseEv
 		if (!m_World.isSelected(SelectionID))
 		{
 			m_World.select(SelectionID);
-			updateGL();
+			requestUpdate(D_MATERIALS);
 			emit updateSelection(m_World.collection()->selection());
 		}
 		else if (m_World.isSelected(SelectionID) && multiSelection)
 		{
 			m_World.unselect(SelectionID);
-			updateGL();
+			requestUpdate(D_MATERIALS);
 			emit updateSelection(m_World.collection()->selection());
 		}
 		else
 		{
 			m_World.unselectAll();
 			m_World.select(SelectionID);
-			updateGL();
+			requestUpdate(D_MATERIALS);
 			emit updateSelection(m_World.collection()->selection());
 		}
 	}
@@ -1088,13 +1311,354 @@ void OpenglView::select(int x, int y, bool multiSelection, QMouseEvent* pMouseEv
 	{
 		// if a geometry is selected, unselect it
 		m_World.unselectAll();
-		updateGL();
+		requestUpdate(D_MATERIALS);
 		emit unselectAll();
 	}
 	else if (eventFlag == glc::AcceptEvent)
 	{
-		updateGL();
+		requestUpdate(D_WIDGETS);
+	}
+}
+
+// Select instances in the current selection area
+void OpenglView::selectArea(bool multiSelection)
+{
+	const QRect areaRect(m_SelectionArea.boundingRect());
+	QList<GLC_uint> pickedIds;
+	if ((areaRect.width() < 3) && (areaRect.height() < 3))
+	{
+		// No drag, pick the instance under the cursor
+		const GLC_uint pickedId= pick(m_SelectionArea.first().x(), m_SelectionArea.first().y());
+		if (0 != pickedId) pickedIds.append(pickedId);
+	}
+	else
+	{
+		updatePickingEngine();
+		pickedIds= m_PickingEngine.areaPick(QPolygonF(m_SelectionArea), m_TouchingAreaSelection);
+	}
+	m_SelectionArea.clear();
+
+	if (!multiSelection && (m_World.selectionSize() > 0))
+	{
+		m_World.unselectAll();
+	}
+	const int size= pickedIds.size();
+	for (int i= 0; i < size; ++i)
+	{
+		if (!m_World.isSelected(pickedIds.at(i)))
+		{
+			m_World.select(pickedIds.at(i));
+		}
+	}
+
+	// Only one signal for the whole selection
+	if (m_World.selectionSize() > 0)
+	{
+		emit updateSelection(m_World.collection()->selection());
+	}
+	else
+	{
+		emit unselectAll();
+	}
+}
+
+// Display the current selection area
+void OpenglView::displaySelectionArea()
+{
+	GLC_Context::current()->glcMatrixMode(GL_PROJECTION);
+	GLC_Context::current()->glcPushMatrix();
+	GLC_Context::current()->glcLoadIdentity();
+	GLC_Context::current()->glcOrtho(0, width(), height(), 0, -1, 1);
+	GLC_Context::current()->glcMatrixMode(GL_MODELVIEW);
+	GLC_Context::current()->glcPushMatrix();
+	GLC_Context::current()->glcLoadIdentity();
+	glPushAttrib(GL_ENABLE_BIT | GL_LINE_BIT | GL_CURRENT_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_TEXTURE_2D);
+	glEnable(GL_LINE_STIPPLE);
+	glLineStipple(1, 0x0F0F);
+
+	if (m_TouchingAreaSelection) glColor3f(0.0f, 0.6f, 0.0f);
+	else glColor3f(0.0f, 0.0f, 0.8f);
+
+	glBegin(GL_LINE_LOOP);
+	const int size= m_SelectionArea.size();
+	for (int i= 0; i < size; ++i)
+	{
+		glVertex2i(m_SelectionArea.at(i).x(), m_SelectionArea.at(i).y());
+	}
+	glEnd();
+
+	// Restore 3DState
+	glPopAttrib();
+	GLC_Context::current()->glcPopMatrix(); // restore modelview
+
+	GLC_Context::current()->glcMatrixMode(GL_PROJECTION);
+	GLC_Context::current()->glcPopMatrix();
+	GLC_Context::current()->glcMatrixMode(GL_MODELVIEW);
+}
+
+// Return the id of the visible instance under the given position (0 if none)
+GLC_uint OpenglView::pick(int x, int y, GLC_Point3d* pHitPoint)
+{
+	updatePickingEngine();
+	return m_PickingEngine.pick(x, y, pHitPoint);
+}
+
+// Update the instances viewable state if the camera or the scene changed
+void OpenglView::updateViewableState()
+{
+	GLC_3DViewCollection* pCollection= m_World.collection();
+	if (!pCollection->spacePartitioningIsUsed())
+	{
+		pCollection->updateInstanceViewableState();
+		return;
+	}
+
+	// The viewable state is cleared when instances moved, not when their visibility changed
+	if (!m_CullingEngine.isUpToDate(pCollection, m_SceneGeneration))
+	{
+		m_CullingEngine.build(pCollection, m_SceneGeneration);
+	}
+	bool needUpdate= !m_CullingEngine.hasViewableState();
+
+	const GLC_Camera& camera= *(m_GlView.cameraHandle());
+	const int viewHeight= m_GlView.viewVSize();
+	needUpdate= needUpdate || !(camera == m_ViewableStateCamera) || (m_GlView.viewAngle() != m_ViewableStateAngle)
+				|| (m_GlView.aspectRatio() != m_ViewableStateAspectRatio) || (m_GlView.useOrtho() != m_ViewableStateOrtho)
+				|| (viewHeight != m_ViewableStateHeight);
+
+	// Nothing changed since the last frame
+	if (!needUpdate) return;
+
+	m_ViewableStateCamera= camera;
+	m_ViewableStateAngle= m_GlView.viewAngle();
+	m_ViewableStateAspectRatio= m_GlView.aspectRatio();
+	m_ViewableStateOrtho= m_GlView.useOrtho();
+	m_ViewableStateHeight= viewHeight;
+
+	m_GlView.updateFrustum();
+	m_CullingEngine.updateViewableState(m_GlView.frustum(), camera, m_GlView.viewAngle(), m_GlView.useOrtho(), viewHeight);
+}
+
+// Build the picking spatial index if needed and set the picking view
+void OpenglView::updatePickingEngine()
+{
+	// Meshes data could be stored in VBO
+	makeCurrent();
+	if (!m_PickingEngine.isUpToDate(m_World.collection(), m_SceneGeneration))
+	{
+		m_PickingEngine.build(m_World.collection(), m_SceneGeneration);
+	}
+	m_PickingEngine.setView(*(m_GlView.cameraHandle()), m_GlView.viewAngle(), m_GlView.aspectRatio(), m_GlView.useOrtho(), size());
+}
+
+// Return true if the cached 3D scene frame can be used for the current render
+bool OpenglView::sceneFrameIsValid() const
+{
+	return (0 != m_SceneFrameTextureId) && !m_SceneFrameSize.isEmpty() && (m_SceneFrameSize == size())
+			&& !m_SnapShootMode && !m_SelectionMode && autoBufferSwap();
+}
+
+// Copy the rendered 3D scene into the scene frame texture
+void OpenglView::cacheSceneFrame()
+{
+	const QSize frameSize(size());
+	if (0 == m_SceneFrameTextureId)
+	{
+		glGenTextures(1, &m_SceneFrameTextureId);
+	}
+	glBindTexture(GL_TEXTURE_2D, m_SceneFrameTextureId);
+
+	// Power of two texture : Doesn't need NPOT texture support
+	if ((m_SceneFrameTextureSize.width() < frameSize.width()) || (m_SceneFrameTextureSize.height() < frameSize.height()))
+	{
+		int textureWidth= 1;
+		while (textureWidth < frameSize.width()) textureWidth*= 2;
+		int textureHeight= 1;
+		while (textureHeight < frameSize.height()) textureHeight*= 2;
+		m_SceneFrameTextureSize= QSize(textureWidth, textureHeight);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, textureWidth, textureHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+	// GPU side copy of the back buffer
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, frameSize.width(), frameSize.height());
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	if (glGetError() == GL_NO_ERROR)
+	{
+		m_SceneFrameSize= frameSize;
+	}
+	else
+	{
+		m_SceneFrameSize= QSize();
+	}
+}
+
+// Display the cached 3D scene frame
+void OpenglView::displaySceneFrame()
+{
+	const double maxS= static_cast<double>(m_SceneFrameSize.width()) / static_cast<double>(m_SceneFrameTextureSize.width());
+	const double maxT= static_cast<double>(m_SceneFrameSize.height()) / static_cast<double>(m_SceneFrameTextureSize.height());
+	displayTexture(m_SceneFrameTextureId, QRectF(0.0, 0.0, maxS, maxT));
+}
+
+// Display the given part of the given texture on the whole view
+void OpenglView::displayTexture(GLuint textureId, const QRectF& textureRect)
+{
+	const GLfloat minS= static_cast<GLfloat>(textureRect.left());
+	const GLfloat maxS= static_cast<GLfloat>(textureRect.right());
+	const GLfloat minT= static_cast<GLfloat>(textureRect.top());
+	const GLfloat maxT= static_cast<GLfloat>(textureRect.bottom());
+
+	GLC_Context::current()->glcMatrixMode(GL_PROJECTION);
+	GLC_Context::current()->glcPushMatrix();
+	GLC_Context::current()->glcLoadIdentity();
+	GLC_Context::current()->glcOrtho(0, 1, 0, 1, -1, 1);
+	GLC_Context::current()->glcMatrixMode(GL_MODELVIEW);
+	GLC_Context::current()->glcPushMatrix();
+	GLC_Context::current()->glcLoadIdentity();
+	glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_POLYGON_BIT | GL_CURRENT_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_BLEND);
+	glDisable(GL_MULTISAMPLE);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, textureId);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+	glBegin(GL_QUADS);
+		glTexCoord2f(minS, minT); glVertex2f(0.0f, 0.0f);
+		glTexCoord2f(maxS, minT); glVertex2f(1.0f, 0.0f);
+		glTexCoord2f(maxS, maxT); glVertex2f(1.0f, 1.0f);
+		glTexCoord2f(minS, maxT); glVertex2f(0.0f, 1.0f);
+	glEnd();
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// Restore 3DState
+	glPopAttrib();
+	GLC_Context::current()->glcPopMatrix(); // restore modelview
+
+	GLC_Context::current()->glcMatrixMode(GL_PROJECTION);
+	GLC_Context::current()->glcPopMatrix();
+	GLC_Context::current()->glcMatrixMode(GL_MODELVIEW);
+}
+
+// Prepare the tiled render of an image of the given size with tiles of the given size
+void OpenglView::beginTiledRender(const QSize& targetSize, const QSize& tileSize, const QString& backgroundImageName)
+{
+	makeCurrent();
+	m_TiledRenderAutoBufferSwap= autoBufferSwap();
+	setAutoBufferSwap(false);
+
+	// The background image is split between the tiles
+	m_GlView.deleteBackGroundImage();
+	if (!backgroundImageName.isEmpty())
+	{
+		const QImage backgroundImage(backgroundImageName);
+		if (!backgroundImage.isNull())
+		{
+			m_TileBackgroundTextureId= bindTexture(backgroundImage, GL_TEXTURE_2D, GL_RGBA
+					, QGLContext::InvertedYBindOption | QGLContext::LinearFilteringBindOption);
+		}
+	}
+	m_CaptureTileTargetSize= targetSize;
+	m_CaptureTileSize= tileSize;
+}
+
+// Render the band of tiles starting at the given row in the given framebuffer or in the window if NULL
+QImage OpenglView::renderTiledBand(int y, QGLFramebufferObject* pFrameBuffer)
+{
+	// An other view may have been rendered since the previous band
+	makeCurrent();
+
+	const QSize targetSize(m_CaptureTileTargetSize);
+	const double aspectRatio= static_cast<double>(targetSize.width()) / static_cast<double>(targetSize.height());
+	const int bandHeight= qMin(m_CaptureTileSize.height(), targetSize.height() - y);
+
+	QImage band(targetSize.width(), bandHeight, QImage::Format_ARGB32_Premultiplied);
+	band.fill(0);
+	QPainter painter(&band);
+	painter.setCompositionMode(QPainter::CompositionMode_Source);
+	for (int x= 0; x < targetSize.width(); x+= m_CaptureTileSize.width())
+	{
+		m_CaptureTile= QRect(x, y, qMin(m_CaptureTileSize.width(), targetSize.width() - x), bandHeight);
+
+		QImage tileImage;
+		if (NULL != pFrameBuffer)
+		{
+			pFrameBuffer->bind();
+			m_GlView.setWinGLSize(m_CaptureTile.width(), m_CaptureTile.height());
+			m_GlView.forceAspectRatio(aspectRatio);
+			updateGL();
+			tileImage= m_FrameBufferPool.toImage(pFrameBuffer);
+			pFrameBuffer->release();
+		}
+		else
+		{
+			m_GlView.setWinGLSize(m_CaptureTile.width(), m_CaptureTile.height());
+			m_GlView.forceAspectRatio(aspectRatio);
+			updateGL();
+			tileImage= grabFrameBuffer();
+		}
+
+		// The tile is rendered in the lower left corner of the buffer
+		painter.drawImage(x, 0, tileImage, 0, tileImage.height() - m_CaptureTile.height(), m_CaptureTile.width(), m_CaptureTile.height());
 	}
+	painter.end();
+	m_CaptureTile= QRect();
+
+	return band;
+}
+
+// Restore the view after a tiled render
+void OpenglView::endTiledRender(const QString& backgroundImageName)
+{
+	m_CaptureTile= QRect();
+	if (0 != m_TileBackgroundTextureId)
+	{
+		deleteTexture(m_TileBackgroundTextureId);
+		m_TileBackgroundTextureId= 0;
+	}
+	if (!backgroundImageName.isEmpty())
+	{
+		m_GlView.loadBackGroundImage(backgroundImageName);
+	}
+	m_GlView.setWinGLSize(size().width(), size().height());
+	m_GlView.updateAspectRatio();
+	m_GlView.updateProjectionMat();
+	setAutoBufferSwap(m_TiledRenderAutoBufferSwap);
+}
+
+// Restrict the projection to the current capture tile
+void OpenglView::applyCaptureTile()
+{
+	// The projection of the whole image
+	m_GlView.updateProjectionMat();
+
+	// Tile bounds in the whole image normalized device coordinate
+	const double targetWidth= static_cast<double>(m_CaptureTileTargetSize.width());
+	const double targetHeight= static_cast<double>(m_CaptureTileTargetSize.height());
+	const double left= 2.0 * m_CaptureTile.x() / targetWidth - 1.0;
+	const double right= 2.0 * (m_CaptureTile.x() + m_CaptureTile.width()) / targetWidth - 1.0;
+	const double top= 1.0 - 2.0 * m_CaptureTile.y() / targetHeight;
+	const double bottom= 1.0 - 2.0 * (m_CaptureTile.y() + m_CaptureTile.height()) / targetHeight;
+
+	// Map the tile bounds on the whole viewport
+	GLC_Matrix4x4 tileMatrix;
+	tileMatrix.setMatScaling(2.0 / (right - left), 2.0 / (top - bottom), 1.0);
+	const GLC_Matrix4x4 translation(- (right + left) / (right - left), - (top + bottom) / (top - bottom), 0.0);
+	tileMatrix= translation * tileMatrix;
+
+	const GLC_Matrix4x4 projection(GLC_Context::current()->projectionMatrix());
+	GLC_Context::current()->glcMatrixMode(GL_PROJECTION);
+	GLC_Context::current()->glcLoadMatrix(tileMatrix * projection);
+	GLC_Context::current()->glcMatrixMode(GL_MODELVIEW);
 }
 
 // Change the current view
@@ -1171,6 +1735,15 @@ QImage OpenglView::takeScreenshot(const bool tryToUseFrameBuffer, const QSize& t
 	}
 	QImage imageToSave;
 
+	// Render at the given aspect ratio, directly at the target size if they match
+	QSize renderSize(targetSize);
+	const double targetRatio= static_cast<double>(targetSize.width()) / static_cast<double>(targetSize.height());
+	if (qAbs(targetRatio - aspectRatio) > glc::EPSILON)
+	{
+		renderSize= QSize(static_cast<int>(targetSize.height() * aspectRatio), targetSize.height());
+		renderSize.scale(targetSize, Qt::KeepAspectRatio);
+	}
+
 	setAutoBufferSwap(false);
 	setSnapShootMode(true);
 
@@ -1190,31 +1763,26 @@ QImage OpenglView::takeScreenshot(const bool tryToUseFrameBuffer, const QSize& t
 
 	if (useFrameBuffer)
 	{
-		QGLFramebufferObjectFormat frameBufferFormat;
-		frameBufferFormat.setSamples(this->format().samples());
-		frameBufferFormat.setAttachment(QGLFramebufferObject::Depth);
-		// Create the framebuffer
-		QGLFramebufferObject framebufferObject(targetSize, frameBufferFormat);
-		framebufferObject.bind();
-		m_GlView.setWinGLSize(framebufferObject.width(), framebufferObject.height());
+		// Get the framebuffer from the pool
+		QGLFramebufferObject* pFrameBuffer= m_FrameBufferPool.take(renderSize, this->format().samples());
+		pFrameBuffer->bind();
+		m_GlView.setWinGLSize(pFrameBuffer->width(), pFrameBuffer->height());
 		updateGL();
-		imageToSave= framebufferObject.toImage();
-		framebufferObject.release();
+		imageToSave= m_FrameBufferPool.toImage(pFrameBuffer);
+		pFrameBuffer->release();
+		m_FrameBufferPool.giveBack(pFrameBuffer);
 		m_GlView.setWinGLSize(size().width(), size().height());
 	}
 	if (imageToSave.isNull())
 	{
-		// Change view aspect ratio and
-		m_GlView.forceAspectRatio(aspectRatio);
-		updateGL();
-		m_GlView.updateAspectRatio();
-		imageToSave=  grabFrameBuffer();
-		QSize shotSize= imageToSave.size();
-		imageToSave= imageToSave.scaled(static_cast<int>(shotSize.height() * aspectRatio), shotSize.height(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		QString backgroundImageName(backImageName);
+		if (backImageName.isEmpty() && !backColor.isValid())
+		{
+			backgroundImageName= defaultBackgroundImageName();
+		}
 
-		imageToSave= imageToSave.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-		// To match the exact size of image
-		imageToSave= imageToSave.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		// The tiles projection is forced to the aspect ratio of the render size
+		imageToSave= renderTiles(renderSize, backgroundImageName);
 	}
 
 	// Retore the view
@@ -1230,7 +1798,7 @@ QImage OpenglView::takeScreenshot(const bool tryToUseFrameBuffer, const QSize& t
 	setAutoBufferSwap(true);
 	setSnapShootMode(false);
 	m_GlView.updateProjectionMat();
-	updateGL();
+	requestUpdate();
 
 	return imageToSave;
 }
@@ -1245,10 +1813,12 @@ void OpenglView::captureMode(const QSize& captureSize, bool smooth, const QColor
 	{
 		m_GlView.setBackgroundColor(color);
 		m_GlView.deleteBackGroundImage();
+		m_CaptureBackgroundImageName.clear();
 	}
 	else
 	{
 		setToVisibleState();
+		m_CaptureBackgroundImageName= defaultBackgroundImageName();
 	}
 	setAutoBufferSwap(false);
 	setSnapShootMode(true);
@@ -1261,14 +1831,13 @@ void OpenglView::captureMode(const QSize& captureSize, bool smooth, const QColor
 			realSize.setWidth(m_CaptureSize.width() * 4);
 			realSize.setHeight(m_CaptureSize.height() * 4);
 		}
-		delete m_pQGLFramebufferObject;
-
-		QGLFramebufferObjectFormat frameBufferFormat;
-		frameBufferFormat.setSamples(this->format().samples());
-		frameBufferFormat.setAttachment(QGLFramebufferObject::Depth);
+		if (NULL != m_pQGLFramebufferObject)
+		{
+			m_FrameBufferPool.giveBack(m_pQGLFramebufferObject);
+		}
 
-		// Create the framebuffer
-		m_pQGLFramebufferObject= new QGLFramebufferObject(realSize, frameBufferFormat);
+		// Get the framebuffer from the pool
+		m_pQGLFramebufferObject= m_FrameBufferPool.take(realSize, this->format().samples());
 	}
 }
 
@@ -1282,26 +1851,17 @@ QImage OpenglView::takeScreenshot()
 		m_pQGLFramebufferObject->bind();
 		m_GlView.setWinGLSize(m_pQGLFramebufferObject->size().width(), m_pQGLFramebufferObject->size().height());
 		updateGL();
-		imageToSave= m_pQGLFramebufferObject->toImage();
+		imageToSave= m_FrameBufferPool.toImage(m_pQGLFramebufferObject);
 		if (m_SmoothCaptures)
 		{
-			imageToSave= imageToSave.scaled(m_CaptureSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+			// The framebuffer is four times the capture size : the aspect ratio is kept
+			imageToSave= imageToSave.scaled(m_CaptureSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
 		}
 		m_pQGLFramebufferObject->release();
 	}
 	else
 	{
-		const double aspectRatio= static_cast<double>(m_CaptureSize.width()) / static_cast<double>(m_CaptureSize.height());
-		m_GlView.forceAspectRatio(aspectRatio);
-		updateGL();
-		m_GlView.updateAspectRatio();
-		imageToSave=  grabFrameBuffer();
-		QSize shotSize= imageToSave.size();
-		imageToSave= imageToSave.scaled(static_cast<int>(shotSize.height() * aspectRatio), shotSize.height(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-
-		imageToSave= imageToSave.scaled(m_CaptureSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-		// To match the exact size of image
-		imageToSave= imageToSave.scaled(m_CaptureSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		imageToSave= renderTiles(m_CaptureSize, m_CaptureBackgroundImageName);
 	}
 
 	return imageToSave;
@@ -1313,8 +1873,11 @@ void OpenglView::normalMode()
 	if (GLC_State::frameBufferSupported())
 	{
 		m_GlView.setWinGLSize(size().width(), size().height());
-		delete m_pQGLFramebufferObject;
-		m_pQGLFramebufferObject= NULL;
+		if (NULL != m_pQGLFramebufferObject)
+		{
+			m_FrameBufferPool.giveBack(m_pQGLFramebufferObject);
+			m_pQGLFramebufferObject= NULL;
+		}
 	}
 
 	if (isInShowState())
@@ -1332,6 +1895,100 @@ void OpenglView::normalMode()
 	updateGL();
 }
 
+// Render the view at the given size in window sized tiles and return the image
+QImage OpenglView::renderTiles(const QSize& targetSize, const QString& backgroundImageName)
+{
+	beginTiledRender(targetSize, size(), backgroundImageName);
+
+	QImage image(targetSize, QImage::Format_RGB32);
+	QPainter painter(&image);
+	for (int y= 0; y < targetSize.height(); y+= m_CaptureTileSize.height())
+	{
+		painter.drawImage(0, y, renderTiledBand(y, NULL));
+	}
+	painter.end();
+
+	endTiledRender(backgroundImageName);
+
+	return image;
+}
+
+// Render the view at the given size in tiles and write it band by band in the given writer
+bool OpenglView::renderPoster(const QSize& targetSize, const QString& backImageName, const QColor& backColor, TiffStripWriter* pWriter)
+{
+	makeCurrent();
+	setSnapShootMode(true);
+
+	QString backgroundImageName(backImageName);
+	if (backImageName.isEmpty())
+	{
+		if (backColor.isValid())
+		{
+			m_GlView.setBackgroundColor(backColor);
+		}
+		else
+		{
+			backgroundImageName= defaultBackgroundImageName();
+		}
+	}
+
+	// Use the largest tiles which fit in a framebuffer
+	QSize tileSize(size());
+	QGLFramebufferObject* pFrameBuffer= NULL;
+	if (GLC_State::frameBufferSupported())
+	{
+		GLint maxBufferSize= 0;
+		glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE_EXT, &maxBufferSize);
+		const int tileLength= qMin(static_cast<int>(maxBufferSize), posterTileSize);
+		tileSize= QSize(qMin(tileLength, targetSize.width()), qMin(tileLength, targetSize.height()));
+		pFrameBuffer= m_FrameBufferPool.take(tileSize, this->format().samples());
+	}
+
+	beginTiledRender(targetSize, tileSize, backgroundImageName);
+
+	m_PosterCanceled= false;
+	bool success= true;
+	for (int y= 0; success && (y < targetSize.height()); y+= tileSize.height())
+	{
+		success= pWriter->writeBand(renderTiledBand(y, pFrameBuffer));
+		emit posterProgress(100 * pWriter->writtenRows() / targetSize.height());
+		success= success && !m_PosterCanceled;
+	}
+
+	endTiledRender(backgroundImageName);
+	if (NULL != pFrameBuffer)
+	{
+		m_FrameBufferPool.giveBack(pFrameBuffer);
+	}
+
+	// Retore the view
+	if (isInShowState())
+	{
+		setToVisibleState();
+	}
+	else
+	{
+		setToInVisibleState();
+	}
+	setSnapShootMode(false);
+	requestUpdate();
+
+	return success;
+}
+
+// Return the background image name of the current show state
+QString OpenglView::defaultBackgroundImageName()
+{
+	if (m_World.collection()->showState())
+	{
+		return QString(":images/default_background.png");
+	}
+	else
+	{
+		return QString(":images/NoShow_background.png");
+	}
+}
+
 // Initialize shader list
 void OpenglView::initShaderList()
 {
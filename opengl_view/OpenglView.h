@@ -34,16 +34,40 @@
 #include <GLC_3DWidgetManager>
 #include <QGLWidget>
 #include <QFile>
+#include <QPolygon>
+#include <QTime>
+#include <QTimer>
+
+#include "PickingEngine.h"
+#include "CullingEngine.h"
+#include "FrameBufferPool.h"
+
+class TiffStripWriter;
+class FileEntry;
 
 // The State of OpenGL view
 enum ViewState_enum
 {
-	V_NORMAL= 1, V_ORBITING, V_PANNING, V_ZOOMING
+	V_NORMAL= 1, V_ORBITING, V_PANNING, V_ZOOMING, V_AREA_SELECTING
 };
 
 enum ViewEnterState_enum
 {
-	VE_NORMAL= 10, VE_PANNING, VE_ORBITING, VE_POINTING, VE_ZOOMING
+	VE_NORMAL= 10, VE_PANNING, VE_ORBITING, VE_POINTING, VE_ZOOMING, VE_RECTANGLE_SELECTING, VE_LASSO_SELECTING
+};
+
+// What changed since the last OpenGL view render
+enum ViewDirtyFlag_enum
+{
+	D_NONE= 0x00,
+	D_CAMERA= 0x01,
+	D_VISIBILITY= 0x02,
+	D_MATERIALS= 0x04,	// Materials, shaders, render mode and selection
+	D_LIGHTS= 0x08,
+	D_WIDGETS= 0x10,	// Movers representation and 3D widgets
+	D_OVERLAY= 0x20,	// Info panel and selection area
+	D_SCENE= 0x1F,		// Every flag which invalidate the 3D scene frame
+	D_ALL= 0x3F
 };
 typedef QList<GLC_Shader*> ShaderList;
 
@@ -84,12 +108,18 @@ public:
 	void changeEnterState(ViewEnterState_enum);
 	//! Clear the view
 	inline void clear()
-	{m_World= GLC_World();}
+	{
+		m_World= GLC_World();
+		m_PickingEngine.clear();
+		m_CullingEngine.clear();
+	}
 	//! Add World in the view
 	inline void add(GLC_World& world)
 	{
 		m_World= world;
 		m_World.setAttachedViewport(&m_GlView);
+		m_PickingEngine.clear();
+		m_CullingEngine.clear();
 	}
 	//! Retrieve the view world
 	inline GLC_World getWorld()
@@ -116,6 +146,9 @@ public:
 	inline double getViewAngle() const {return m_GlView.viewAngle();}
 	//! Set the view Camera
 	void setCameraAndAngle(const GLC_Camera&, const double&);
+	//! Set the camera of the given entry, the iso view reframed on the world if the entry camera is not set
+	/*! The entry world must be in the view*/
+	void setEntryCamera(const FileEntry&);
 	//! Set AutoBufferSwap
 	inline void setAutoBufferSwap(bool on) {QGLWidget::setAutoBufferSwap(on);}
 	//! set Info Panel visibility
@@ -158,6 +191,8 @@ public:
 	inline bool isInShowState() {return m_World.collection()->showState();}
 
 	//! Take a Screenshot of the current view
+	/*! The image is rendered at the given aspect ratio, in the largest size
+	 *  which fits in the given target size*/
 	QImage takeScreenshot(const bool, const QSize&, const QString&, const QColor&, double);
 
 	//! Change the view state to capture mode
@@ -169,6 +204,21 @@ public:
 	//! Change the state to normal mode
 	void normalMode();
 
+	//! Render the view at the given size in window sized tiles and return the image
+	/*! Used when framebuffers are not supported. The given background image
+	 *  is split between the tiles (No background image if empty)*/
+	QImage renderTiles(const QSize&, const QString&);
+
+	//! Render the view at the given size in tiles and write it band by band in the given writer
+	/*! The background is the given image, or the given color if the image name
+	 *  is empty, or the default background if both are invalid. Tiles are rendered
+	 *  in framebuffers if supported. Return false on write error or if the
+	 *  render has been canceled*/
+	bool renderPoster(const QSize&, const QString&, const QColor&, TiffStripWriter*);
+
+	//! Return the background image name of the current show state
+	QString defaultBackgroundImageName();
+
 	//! Get the view State
 	inline ViewState_enum viewState() const {return  m_ViewState;}
 
@@ -178,6 +228,19 @@ public:
 	//! Init Iso view
 	void initIsoView();
 
+	//! Return the id of the visible instance under the given position (0 if none)
+	GLC_uint pick(int, int, GLC_Point3d* pHitPoint= NULL);
+
+	//! Get the framebuffer pool used by captures of this view
+	inline FrameBufferPool* frameBufferPoolHandle()
+	{return &m_FrameBufferPool;}
+	//! Return the generation of the scene, incremented by sceneChanged()
+	inline int sceneGeneration() const
+	{return m_SceneGeneration;}
+	//! Return the generation of the instances visibility, incremented by visibilityChanged()
+	inline int visibilityGeneration() const
+	{return m_VisibilityGeneration;}
+
 
 public slots:
 	// Change the default camera Up axis
@@ -230,6 +293,21 @@ public slots:
 	void updateLightPosition();
 	//! Edit the light
 	void editLight(int index);
+	//! Area selection select instances which touch the area or only instances inside the area
+	inline void setTouchingAreaSelection(bool touching)
+	{m_TouchingAreaSelection= touching;}
+	//! Mark the given ViewDirtyFlag_enum flags and render once in the next event loop pass
+	void requestUpdate(int flags= D_ALL);
+	//! Instances have moved or have been added : render once and rebuild the picking and culling boxes
+	void sceneChanged();
+	//! Instances have been shown or hidden : render once, the picking and culling boxes are kept
+	void visibilityChanged();
+	//! The lights have been edited
+	inline void lightsUpdated()
+	{requestUpdate(D_LIGHTS);}
+	//! Cancel the poster render in progress
+	inline void cancelPoster()
+	{m_PosterCanceled= true;}
 
 //////////////////////////////////////////////////////////////////////
 // Signals
@@ -242,6 +320,17 @@ signals:
 	void hideInfoPanel();
 	void viewChanged();
 	void glInitialed();
+	//! Progression of the poster render in percent
+	void posterProgress(int);
+	//! Instances have been shown or hidden
+	void visibilityModified();
+
+//////////////////////////////////////////////////////////////////////
+// Private slots Functions
+//////////////////////////////////////////////////////////////////////
+private slots:
+	//! Delete the framebuffers of the pool which have not been used for a while
+	void trimFrameBufferPool();
 
 //////////////////////////////////////////////////////////////////////
 // Private services Functions
@@ -249,6 +338,7 @@ signals:
 private:
 	void paintGL();
 	void resizeGL(int width, int height);
+	void paintEvent(QPaintEvent *);
 	//Mouse events
 	void mousePressEvent(QMouseEvent *);
 	void mouseReleaseEvent(QMouseEvent *);
@@ -263,8 +353,36 @@ private:
 	void updateFps(int);
 	//! Display info panel
 	void displayInfo();
+	//! Regenerate the info panel texture if its content changed
+	void updateInfoPanelTexture(const QSize&);
 	//! Select
 	void select(int, int, bool, QMouseEvent*);
+	//! Select instances in the current selection area
+	void selectArea(bool);
+	//! Display the current selection area
+	void displaySelectionArea();
+	//! Build the picking spatial index if needed and set the picking view
+	void updatePickingEngine();
+	//! Update the instances viewable state if the camera or the scene changed
+	void updateViewableState();
+	//! Return true if the cached 3D scene frame can be used for the current render
+	bool sceneFrameIsValid() const;
+	//! Render the 3D scene and copy it into the scene frame texture if cacheFrame is true
+	void renderScene(bool cacheFrame);
+	//! Copy the rendered 3D scene into the scene frame texture
+	void cacheSceneFrame();
+	//! Display the cached 3D scene frame
+	void displaySceneFrame();
+	//! Display the given part of the given texture on the whole view
+	void displayTexture(GLuint, const QRectF&);
+	//! Restrict the projection to the current capture tile
+	void applyCaptureTile();
+	//! Prepare the tiled render of an image of the given size with tiles of the given size
+	void beginTiledRender(const QSize&, const QSize&, const QString&);
+	//! Render the band of tiles starting at the given row in the given framebuffer or in the window if NULL
+	QImage renderTiledBand(int, QGLFramebufferObject*);
+	//! Restore the view after a tiled render
+	void endTiledRender(const QString&);
 	//! Change the current view
 	void changeView(GLC_Camera, bool motion= true);
 	//! Update and return the global bounding box
@@ -306,12 +424,31 @@ private:
 	//! The framebuffer associated to the view
 	QGLFramebufferObject* m_pQGLFramebufferObject;
 
+	//! The framebuffers shared by all captures
+	FrameBufferPool m_FrameBufferPool;
+
+	//! Release the framebuffers left idle after the last capture
+	QTimer m_FrameBufferTrimTimer;
+
 	//! The current capture size
 	QSize m_CaptureSize;
 
 	//! Smoth capture
 	bool m_SmoothCaptures;
 
+	//! The capture mode background image name (Empty for background color)
+	QString m_CaptureBackgroundImageName;
+
+	//! The tile of the image rendered in tiles (Null if none)
+	QRect m_CaptureTile;
+	QSize m_CaptureTileTargetSize;
+	QSize m_CaptureTileSize;
+	GLuint m_TileBackgroundTextureId;
+	bool m_TiledRenderAutoBufferSwap;
+
+	//! True if the poster render in progress must be canceled
+	bool m_PosterCanceled;
+
 	//! The collection of other User interface object
 	GLC_3DViewCollection m_UiCollection;
 
@@ -343,6 +480,50 @@ private:
 
 	//! The current light index
 	int m_CurrentLightIndex;
+
+	//! The CPU picking engine
+	PickingEngine m_PickingEngine;
+
+	//! The viewable state engine
+	CullingEngine m_CullingEngine;
+
+	//! The current selection area (Rectangle or lasso)
+	QPolygon m_SelectionArea;
+
+	//! Area selection mode (touching or inside)
+	bool m_TouchingAreaSelection;
+
+	//! The view used by the last viewable state update
+	GLC_Camera m_ViewableStateCamera;
+	double m_ViewableStateAngle;
+	double m_ViewableStateAspectRatio;
+	bool m_ViewableStateOrtho;
+	int m_ViewableStateHeight;
+
+	//! Incremented by each instance transformation
+	int m_SceneGeneration;
+
+	//! Incremented by each instance visibility edit
+	int m_VisibilityGeneration;
+
+	//! The ViewDirtyFlag_enum flags which have been requested since the last render
+	int m_DirtyFlags;
+
+	//! True while the view is rendered from a paint event
+	bool m_IsInPaintEvent;
+
+	//! The cached 3D scene frame (Without overlays)
+	GLuint m_SceneFrameTextureId;
+	QSize m_SceneFrameTextureSize;
+	QSize m_SceneFrameSize;
+
+	//! The info panel texture and the content used to generate it
+	GLuint m_InfoPanelTextureId;
+	QString m_InfoPanelContent;
+
+	//! The displayed frame rate and the time of its last refresh
+	QString m_DisplayedFps;
+	QTime m_FpsDisplayTime;
 };
 
 #endif /*OPENGLVIEW_H_*/
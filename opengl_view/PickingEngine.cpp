@@ -0,0 +1,680 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include "PickingEngine.h"
+#include <GLC_3DViewInstance>
+#include <GLC_Mesh>
+#include <GLC_Matrix4x4>
+#include <GLC_Global>
+#include <QtAlgorithms>
+#include <QRectF>
+#include <limits>
+#include <cmath>
+
+// The maximum depth of the octree
+static const int maxOctreeDepth= 6;
+
+// The maximum number of float stored in the triangles cache
+static const int maxCacheSize= 16 * 1024 * 1024;
+
+PickingEngine::PickingEngine()
+: m_pCollection(NULL)
+, m_CollectionSize(0)
+, m_SceneGeneration(0)
+, m_pRootNode(NULL)
+, m_ItemIds()
+, m_ItemBoxes()
+, m_TrianglesCache()
+, m_CacheSize(0)
+, m_pClipPlane(NULL)
+, m_Eye()
+, m_Side()
+, m_Up()
+, m_Forward()
+, m_Top(1.0)
+, m_AspectRatio(1.0)
+, m_UseOrtho(false)
+, m_ViewSize()
+{
+
+}
+
+PickingEngine::~PickingEngine()
+{
+	clear();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+
+// Clear the spatial index and the triangles cache
+void PickingEngine::clear()
+{
+	clearIndex();
+	m_TrianglesCache.clear();
+	m_CacheSize= 0;
+}
+
+// Build the spatial index of the given collection at the given scene generation
+void PickingEngine::build(GLC_3DViewCollection* pCollection, int sceneGeneration)
+{
+	clearIndex();
+	m_pCollection= pCollection;
+	m_CollectionSize= pCollection->size();
+	m_SceneGeneration= sceneGeneration;
+
+	GLC_BoundingBox rootBox;
+	QList<GLC_3DViewInstance*> instances= m_pCollection->instancesHandle();
+	const int size= instances.size();
+	m_ItemIds.reserve(size);
+	m_ItemBoxes.reserve(size);
+	for (int i= 0; i < size; ++i)
+	{
+		const GLC_BoundingBox instanceBox(instances.at(i)->boundingBox());
+		if (!instanceBox.isEmpty())
+		{
+			m_ItemIds.append(instances.at(i)->id());
+			m_ItemBoxes.append(instanceBox);
+			rootBox.combine(instanceBox);
+		}
+	}
+
+	m_pRootNode= new OctreeNode;
+	m_pRootNode->m_Box= rootBox;
+	for (int i= 0; i < 8; ++i) m_pRootNode->m_pChildren[i]= NULL;
+
+	const int itemCount= m_ItemIds.size();
+	for (int i= 0; i < itemCount; ++i)
+	{
+		insert(m_pRootNode, i, 0);
+	}
+}
+
+// Set the view used to pick from screen coordinate
+void PickingEngine::setView(const GLC_Camera& camera, double viewAngle, double aspectRatio, bool useOrtho, const QSize& viewSize)
+{
+	m_Eye= camera.eye();
+	m_Forward= camera.target() - camera.eye();
+	m_Forward.normalize();
+	m_Side= m_Forward ^ camera.upVector();
+	m_Side.normalize();
+	m_Up= m_Side ^ m_Forward;
+	m_AspectRatio= aspectRatio;
+	m_UseOrtho= useOrtho;
+	m_ViewSize= viewSize;
+	if (m_UseOrtho)
+	{
+		m_Top= camera.distEyeTarget() * tan(viewAngle * glc::PI / 180.0);
+	}
+	else
+	{
+		m_Top= tan(viewAngle * glc::PI / 360.0);
+	}
+}
+
+// Return the id of the nearest visible instance hit by the given ray
+GLC_uint PickingEngine::pick(const GLC_Point3d& origin, const GLC_Vector3d& direction, GLC_Point3d* pHitPoint)
+{
+	if ((NULL == m_pRootNode) || (NULL == m_pCollection)) return 0;
+
+	// Candidates sorted by bounding box entry distance
+	QList<QPair<double, int> > candidates;
+	collectRayCandidates(m_pRootNode, origin, direction, &candidates);
+	qSort(candidates);
+
+	const bool showState= m_pCollection->showState();
+	GLC_uint pickedId= 0;
+	double nearest= -1.0;
+	const int size= candidates.size();
+	for (int i= 0; i < size; ++i)
+	{
+		// The next candidates are behind the nearest hit
+		if ((nearest >= 0.0) && (candidates.at(i).first > nearest)) break;
+
+		const GLC_uint id= m_ItemIds.at(candidates.at(i).second);
+		GLC_3DViewInstance* pInstance= m_pCollection->instanceHandle(id);
+		if ((NULL == pInstance) || (pInstance->isVisible() != showState)) continue;
+
+		const double distance= hitDistance(pInstance, origin, direction);
+		if ((distance >= 0.0) && ((nearest < 0.0) || (distance < nearest)))
+		{
+			nearest= distance;
+			pickedId= id;
+		}
+	}
+
+	if ((0 != pickedId) && (NULL != pHitPoint))
+	{
+		*pHitPoint= origin + (direction * nearest);
+	}
+	return pickedId;
+}
+
+// Return the id of the nearest visible instance under the given screen position
+GLC_uint PickingEngine::pick(int x, int y, GLC_Point3d* pHitPoint)
+{
+	if (m_ViewSize.isEmpty()) return 0;
+
+	const double xNorm= (2.0 * static_cast<double>(x) / static_cast<double>(m_ViewSize.width())) - 1.0;
+	const double yNorm= 1.0 - (2.0 * static_cast<double>(y) / static_cast<double>(m_ViewSize.height()));
+
+	GLC_Point3d origin;
+	GLC_Vector3d direction;
+	if (m_UseOrtho)
+	{
+		origin= m_Eye + (m_Side * (xNorm * m_Top * m_AspectRatio)) + (m_Up * (yNorm * m_Top));
+		direction= m_Forward;
+	}
+	else
+	{
+		origin= m_Eye;
+		direction= m_Forward + (m_Side * (xNorm * m_Top * m_AspectRatio)) + (m_Up * (yNorm * m_Top));
+		direction.normalize();
+	}
+
+	return pick(origin, direction, pHitPoint);
+}
+
+// Return the id of visible instances in the given screen area
+QList<GLC_uint> PickingEngine::areaPick(const QPolygonF& area, bool touching)
+{
+	QList<GLC_uint> pickedIds;
+	if ((NULL == m_pRootNode) || (NULL == m_pCollection) || (area.size() < 3) || m_ViewSize.isEmpty()) return pickedIds;
+
+	QList<int> candidates;
+	collectAreaCandidates(m_pRootNode, area.boundingRect(), &candidates);
+
+	const bool showState= m_pCollection->showState();
+	const int size= candidates.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const int index= candidates.at(i);
+		GLC_3DViewInstance* pInstance= m_pCollection->instanceHandle(m_ItemIds.at(index));
+		if ((NULL == pInstance) || (pInstance->isVisible() != showState)) continue;
+
+		// Bounding box fully inside the area : no need to test the geometries
+		QRectF instanceRect;
+		int insideCount= 0;
+		QPointF corners[8];
+		const bool isInFront= projectBox(m_ItemBoxes.at(index), &instanceRect, &area, &insideCount, corners);
+		if (isInFront && (8 == insideCount) && !areaCrossBox(corners, area))
+		{
+			pickedIds.append(m_ItemIds.at(index));
+		}
+		else if ((isInFront || touching) && instanceInArea(pInstance, area, touching))
+		{
+			pickedIds.append(m_ItemIds.at(index));
+		}
+	}
+	return pickedIds;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Insert the item of the given index in the given node
+void PickingEngine::insert(OctreeNode* pNode, int index, int depth)
+{
+	if (depth < maxOctreeDepth)
+	{
+		const GLC_BoundingBox& itemBox= m_ItemBoxes.at(index);
+		const GLC_Point3d& lower= pNode->m_Box.lowerCorner();
+		const GLC_Point3d& upper= pNode->m_Box.upperCorner();
+		const GLC_Point3d center(pNode->m_Box.center());
+
+		// Find the octant which contains the item
+		for (int i= 0; i < 8; ++i)
+		{
+			const GLC_Point3d childLower((i & 1) ? center.x() : lower.x(), (i & 2) ? center.y() : lower.y(), (i & 4) ? center.z() : lower.z());
+			const GLC_Point3d childUpper((i & 1) ? upper.x() : center.x(), (i & 2) ? upper.y() : center.y(), (i & 4) ? upper.z() : center.z());
+
+			const GLC_Point3d& itemLower= itemBox.lowerCorner();
+			const GLC_Point3d& itemUpper= itemBox.upperCorner();
+			const bool isInside= (itemLower.x() >= childLower.x()) && (itemLower.y() >= childLower.y()) && (itemLower.z() >= childLower.z())
+								&& (itemUpper.x() <= childUpper.x()) && (itemUpper.y() <= childUpper.y()) && (itemUpper.z() <= childUpper.z());
+			if (isInside)
+			{
+				if (NULL == pNode->m_pChildren[i])
+				{
+					OctreeNode* pChild= new OctreeNode;
+					pChild->m_Box= GLC_BoundingBox(childLower, childUpper);
+					for (int j= 0; j < 8; ++j) pChild->m_pChildren[j]= NULL;
+					pNode->m_pChildren[i]= pChild;
+				}
+				insert(pNode->m_pChildren[i], index, depth + 1);
+				return;
+			}
+		}
+	}
+	// The item overlaps several octants or the maximum depth is reached
+	pNode->m_Items.append(index);
+}
+
+// Delete the spatial index
+void PickingEngine::clearIndex()
+{
+	if (NULL != m_pRootNode)
+	{
+		deleteNode(m_pRootNode);
+		m_pRootNode= NULL;
+	}
+	m_pCollection= NULL;
+	m_CollectionSize= 0;
+	m_ItemIds.clear();
+	m_ItemBoxes.clear();
+}
+
+// Delete the given node and its children
+void PickingEngine::deleteNode(OctreeNode* pNode)
+{
+	for (int i= 0; i < 8; ++i)
+	{
+		if (NULL != pNode->m_pChildren[i]) deleteNode(pNode->m_pChildren[i]);
+	}
+	delete pNode;
+}
+
+// Collect the items which bounding box is hit by the ray
+void PickingEngine::collectRayCandidates(OctreeNode* pNode, const GLC_Point3d& origin, const GLC_Vector3d& direction, QList<QPair<double, int> >* pCandidates) const
+{
+	if (rayBoxEntry(pNode->m_Box, origin, direction) < 0.0) return;
+
+	const int size= pNode->m_Items.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const int index= pNode->m_Items.at(i);
+		const double entry= rayBoxEntry(m_ItemBoxes.at(index), origin, direction);
+		if (entry >= 0.0)
+		{
+			pCandidates->append(qMakePair(entry, index));
+		}
+	}
+
+	for (int i= 0; i < 8; ++i)
+	{
+		if (NULL != pNode->m_pChildren[i]) collectRayCandidates(pNode->m_pChildren[i], origin, direction, pCandidates);
+	}
+}
+
+// Collect the items which screen bounding rectangle intersect the given rectangle
+void PickingEngine::collectAreaCandidates(OctreeNode* pNode, const QRectF& areaRect, QList<int>* pCandidates) const
+{
+	// A box partially behind the eye is kept
+	QRectF nodeRect;
+	if (projectBox(pNode->m_Box, &nodeRect) && !nodeRect.intersects(areaRect)) return;
+
+	const int size= pNode->m_Items.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const int index= pNode->m_Items.at(i);
+		QRectF itemRect;
+		if (!projectBox(m_ItemBoxes.at(index), &itemRect) || itemRect.intersects(areaRect))
+		{
+			pCandidates->append(index);
+		}
+	}
+
+	for (int i= 0; i < 8; ++i)
+	{
+		if (NULL != pNode->m_pChildren[i]) collectAreaCandidates(pNode->m_pChildren[i], areaRect, pCandidates);
+	}
+}
+
+// Return true if the given instance is in the area
+bool PickingEngine::instanceInArea(GLC_3DViewInstance* pInstance, const QPolygonF& area, bool touching)
+{
+	const QRectF areaRect(area.boundingRect());
+	const GLC_Matrix4x4 matrix(pInstance->matrix());
+	const int bodyCount= pInstance->numberOfBody();
+	for (int body= 0; body < bodyCount; ++body)
+	{
+		GLC_Geometry* pGeom= pInstance->geomAt(body);
+		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pGeom);
+		if ((NULL != pMesh) && !meshTriangles(pMesh).m_Indexes.isEmpty())
+		{
+			const MeshTriangles& triangles= meshTriangles(pMesh);
+			const GLfloat* pPositions= triangles.m_Positions.constData();
+			const int vertexCount= triangles.m_Positions.size() / 3;
+
+			// Project the vertices, clipped vertices are ignored
+			QVector<QPointF> screenPoints(vertexCount);
+			QVector<bool> isValid(vertexCount);
+			bool bodyInside= true;
+			for (int i= 0; i < vertexCount; ++i)
+			{
+				const GLfloat* pVertex= pPositions + 3 * i;
+				const GLC_Point3d point(matrix * GLC_Point3d(pVertex[0], pVertex[1], pVertex[2]));
+				if (isClipped(point))
+				{
+					isValid[i]= false;
+				}
+				else if (!project(point, &screenPoints[i]))
+				{
+					isValid[i]= false;
+					bodyInside= false;
+				}
+				else
+				{
+					isValid[i]= true;
+					const bool isInside= area.containsPoint(screenPoints.at(i), Qt::OddEvenFill);
+					if (touching && isInside) return true;
+					bodyInside= bodyInside && isInside;
+				}
+			}
+			if (!touching && !bodyInside) return false;
+
+			if (touching)
+			{
+				// No vertex inside the area, test triangles
+				const int size= triangles.m_Indexes.size() - 2;
+				for (int i= 0; i < size; i+= 3)
+				{
+					const GLuint i0= triangles.m_Indexes.at(i);
+					const GLuint i1= triangles.m_Indexes.at(i + 1);
+					const GLuint i2= triangles.m_Indexes.at(i + 2);
+					if (isValid.at(i0) && isValid.at(i1) && isValid.at(i2))
+					{
+						const QPointF& p0= screenPoints.at(i0);
+						const QPointF& p1= screenPoints.at(i1);
+						const QPointF& p2= screenPoints.at(i2);
+						const QRectF triangleRect(QPointF(qMin(p0.x(), qMin(p1.x(), p2.x())), qMin(p0.y(), qMin(p1.y(), p2.y())))
+												, QPointF(qMax(p0.x(), qMax(p1.x(), p2.x())), qMax(p0.y(), qMax(p1.y(), p2.y()))));
+						if (triangleRect.adjusted(-1.0, -1.0, 1.0, 1.0).intersects(areaRect) && triangleTouchArea(p0, p1, p2, area))
+						{
+							return true;
+						}
+					}
+				}
+			}
+		}
+		else
+		{
+			// Not a triangles geometry : use its bounding box
+			GLC_BoundingBox geomBox(pGeom->boundingBox());
+			geomBox.transform(matrix);
+			QRectF geomRect;
+			int insideCount= 0;
+			QPointF corners[8];
+			const bool isInFront= projectBox(geomBox, &geomRect, &area, &insideCount, corners);
+			if (touching && (insideCount > 0)) return true;
+			if (!touching && (!isInFront || (insideCount < 8) || areaCrossBox(corners, area))) return false;
+		}
+	}
+	// In touching mode nothing touch the area, else every body is inside
+	return !touching;
+}
+
+// Project the given point on the screen, return false if the point is behind the eye
+bool PickingEngine::project(const GLC_Point3d& point, QPointF* pScreenPoint) const
+{
+	const GLC_Vector3d eyeToPoint(point - m_Eye);
+	double xNorm= (eyeToPoint * m_Side) / (m_Top * m_AspectRatio);
+	double yNorm= (eyeToPoint * m_Up) / m_Top;
+	if (!m_UseOrtho)
+	{
+		const double depth= eyeToPoint * m_Forward;
+		if (depth < glc::EPSILON) return false;
+		xNorm/= depth;
+		yNorm/= depth;
+	}
+	pScreenPoint->setX((xNorm + 1.0) * 0.5 * static_cast<double>(m_ViewSize.width()));
+	pScreenPoint->setY((1.0 - yNorm) * 0.5 * static_cast<double>(m_ViewSize.height()));
+	return true;
+}
+
+// Project the given box on the screen, return false if the box is behind the eye
+bool PickingEngine::projectBox(const GLC_BoundingBox& box, QRectF* pRect, const QPolygonF* pArea, int* pInsideCount, QPointF* pCorners) const
+{
+	if (box.isEmpty()) return false;
+
+	const GLC_Point3d& lower= box.lowerCorner();
+	const GLC_Point3d& upper= box.upperCorner();
+	double left= std::numeric_limits<double>::max();
+	double right= -left;
+	double top= left;
+	double bottom= -left;
+	for (int i= 0; i < 8; ++i)
+	{
+		const GLC_Point3d corner((i & 1) ? upper.x() : lower.x(), (i & 2) ? upper.y() : lower.y(), (i & 4) ? upper.z() : lower.z());
+		QPointF screenPoint;
+		if (!project(corner, &screenPoint)) return false;
+		if (NULL != pCorners) pCorners[i]= screenPoint;
+
+		left= qMin(left, screenPoint.x());
+		right= qMax(right, screenPoint.x());
+		top= qMin(top, screenPoint.y());
+		bottom= qMax(bottom, screenPoint.y());
+		if ((NULL != pArea) && pArea->containsPoint(screenPoint, Qt::OddEvenFill))
+		{
+			++(*pInsideCount);
+		}
+	}
+	// One pixel margin : flat boxes must intersect
+	*pRect= QRectF(QPointF(left - 1.0, top - 1.0), QPointF(right + 1.0, bottom + 1.0));
+	return true;
+}
+
+// Return the nearest hit distance on the given instance (-1.0 if no hit)
+double PickingEngine::hitDistance(GLC_3DViewInstance* pInstance, const GLC_Point3d& origin, const GLC_Vector3d& direction)
+{
+	// The ray in instance local coordinate
+	// The distance along the ray is unchanged by the affine transformation
+	GLC_Matrix4x4 inverse(pInstance->matrix());
+	inverse.invert();
+	const GLC_Point3d localOrigin(inverse * origin);
+	const GLC_Vector3d localDirection((inverse * (origin + direction)) - localOrigin);
+
+	double nearest= -1.0;
+	const int bodyCount= pInstance->numberOfBody();
+	for (int body= 0; body < bodyCount; ++body)
+	{
+		GLC_Geometry* pGeom= pInstance->geomAt(body);
+		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pGeom);
+		if ((NULL != pMesh) && !meshTriangles(pMesh).m_Indexes.isEmpty())
+		{
+			const MeshTriangles& triangles= meshTriangles(pMesh);
+			const GLfloat* pPositions= triangles.m_Positions.constData();
+			const int size= triangles.m_Indexes.size() - 2;
+			for (int i= 0; i < size; i+= 3)
+			{
+				const GLfloat* p0= pPositions + 3 * triangles.m_Indexes.at(i);
+				const GLfloat* p1= pPositions + 3 * triangles.m_Indexes.at(i + 1);
+				const GLfloat* p2= pPositions + 3 * triangles.m_Indexes.at(i + 2);
+				const double distance= rayTriangle(localOrigin, localDirection, GLC_Point3d(p0[0], p0[1], p0[2])
+								, GLC_Point3d(p1[0], p1[1], p1[2]), GLC_Point3d(p2[0], p2[1], p2[2]));
+				if ((distance >= 0.0) && ((nearest < 0.0) || (distance < nearest)) && !isClipped(origin + (direction * distance)))
+				{
+					nearest= distance;
+				}
+			}
+		}
+		else
+		{
+			// Not a triangles geometry : use its bounding box
+			const double distance= rayBoxEntry(pGeom->boundingBox(), localOrigin, localDirection);
+			if ((distance >= 0.0) && ((nearest < 0.0) || (distance < nearest)) && !isClipped(origin + (direction * distance)))
+			{
+				nearest= distance;
+			}
+		}
+	}
+	return nearest;
+}
+
+// Return the triangles of the given mesh from the cache
+const PickingEngine::MeshTriangles& PickingEngine::meshTriangles(GLC_Mesh* pMesh)
+{
+	const GLC_uint meshId= pMesh->id();
+	if (!m_TrianglesCache.contains(meshId))
+	{
+		MeshTriangles triangles;
+		triangles.m_Positions= pMesh->positionVector();
+		// Use the best level of detail
+		QList<GLC_uint> materialIds= pMesh->materialIds();
+		const int size= materialIds.size();
+		for (int i= 0; i < size; ++i)
+		{
+			if (pMesh->lodContainsMaterial(0, materialIds.at(i)))
+			{
+				triangles.m_Indexes+= pMesh->getEquivalentTrianglesStripsFansIndex(0, materialIds.at(i));
+			}
+		}
+
+		const int trianglesSize= triangles.m_Positions.size() + triangles.m_Indexes.size();
+		if ((m_CacheSize + trianglesSize) > maxCacheSize)
+		{
+			m_TrianglesCache.clear();
+			m_CacheSize= 0;
+		}
+		m_CacheSize+= trianglesSize;
+		m_TrianglesCache.insert(meshId, triangles);
+	}
+	return m_TrianglesCache[meshId];
+}
+
+// Return true if the given point is removed by the clipping plane
+bool PickingEngine::isClipped(const GLC_Point3d& point) const
+{
+	if (NULL == m_pClipPlane) return false;
+
+	const double value= m_pClipPlane->coefA() * point.x() + m_pClipPlane->coefB() * point.y()
+						+ m_pClipPlane->coefC() * point.z() + m_pClipPlane->coefD();
+	return value < 0.0;
+}
+
+// Return the ray entry distance in the given box (-1.0 if no hit)
+double PickingEngine::rayBoxEntry(const GLC_BoundingBox& box, const GLC_Point3d& origin, const GLC_Vector3d& direction)
+{
+	if (box.isEmpty()) return -1.0;
+
+	double tMin= 0.0;
+	double tMax= std::numeric_limits<double>::max();
+	const GLC_Point3d& lower= box.lowerCorner();
+	const GLC_Point3d& upper= box.upperCorner();
+	for (int axis= 0; axis < 3; ++axis)
+	{
+		const double o= (0 == axis) ? origin.x() : ((1 == axis) ? origin.y() : origin.z());
+		const double d= (0 == axis) ? direction.x() : ((1 == axis) ? direction.y() : direction.z());
+		const double low= (0 == axis) ? lower.x() : ((1 == axis) ? lower.y() : lower.z());
+		const double up= (0 == axis) ? upper.x() : ((1 == axis) ? upper.y() : upper.z());
+		if (qAbs(d) < glc::EPSILON)
+		{
+			// The ray is parallel to the slab
+			if ((o < low) || (o > up)) return -1.0;
+		}
+		else
+		{
+			double t1= (low - o) / d;
+			double t2= (up - o) / d;
+			if (t1 > t2) qSwap(t1, t2);
+			tMin= qMax(tMin, t1);
+			tMax= qMin(tMax, t2);
+			if (tMin > tMax) return -1.0;
+		}
+	}
+	return tMin;
+}
+
+// Return the ray triangle hit distance (-1.0 if no hit)
+double PickingEngine::rayTriangle(const GLC_Point3d& origin, const GLC_Vector3d& direction, const GLC_Point3d& v0, const GLC_Point3d& v1, const GLC_Point3d& v2)
+{
+	// Moller Trumbore algorithm, both faces are tested
+	const GLC_Vector3d edge1(v1 - v0);
+	const GLC_Vector3d edge2(v2 - v0);
+	const GLC_Vector3d p(direction ^ edge2);
+	const double det= edge1 * p;
+	if (qAbs(det) < glc::EPSILON) return -1.0;
+
+	const double invDet= 1.0 / det;
+	const GLC_Vector3d s(origin - v0);
+	const double u= (s * p) * invDet;
+	if ((u < 0.0) || (u > 1.0)) return -1.0;
+
+	const GLC_Vector3d q(s ^ edge1);
+	const double v= (direction * q) * invDet;
+	if ((v < 0.0) || ((u + v) > 1.0)) return -1.0;
+
+	const double t= (edge2 * q) * invDet;
+	if (t < 0.0) return -1.0;
+
+	return t;
+}
+
+// Return true if the given screen triangle intersect the given area
+bool PickingEngine::triangleTouchArea(const QPointF& p0, const QPointF& p1, const QPointF& p2, const QPolygonF& area)
+{
+	// The area is inside the triangle
+	QPolygonF triangle;
+	triangle << p0 << p1 << p2;
+	if (triangle.containsPoint(area.first(), Qt::OddEvenFill)) return true;
+
+	// An edge of the triangle cross an edge of the area
+	const int size= area.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const QPointF& a= area.at(i);
+		const QPointF& b= area.at((i + 1) % size);
+		if (segmentsIntersect(p0, p1, a, b) || segmentsIntersect(p1, p2, a, b) || segmentsIntersect(p2, p0, a, b))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Return true if an edge of the given area cross an edge of the given projected box
+bool PickingEngine::areaCrossBox(const QPointF* pCorners, const QPolygonF& area)
+{
+	// A non convex area can cut the box while its corners are inside
+	const int size= area.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const QPointF& a= area.at(i);
+		const QPointF& b= area.at((i + 1) % size);
+		for (int corner= 0; corner < 8; ++corner)
+		{
+			for (int axis= 1; axis < 8; axis<<= 1)
+			{
+				if (!(corner & axis) && segmentsIntersect(pCorners[corner], pCorners[corner | axis], a, b))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// Return true if the given screen segments intersect
+bool PickingEngine::segmentsIntersect(const QPointF& p1, const QPointF& p2, const QPointF& p3, const QPointF& p4)
+{
+	const double d1= (p4.x() - p3.x()) * (p1.y() - p3.y()) - (p4.y() - p3.y()) * (p1.x() - p3.x());
+	const double d2= (p4.x() - p3.x()) * (p2.y() - p3.y()) - (p4.y() - p3.y()) * (p2.x() - p3.x());
+	const double d3= (p2.x() - p1.x()) * (p3.y() - p1.y()) - (p2.y() - p1.y()) * (p3.x() - p1.x());
+	const double d4= (p2.x() - p1.x()) * (p4.y() - p1.y()) - (p2.y() - p1.y()) * (p4.x() - p1.x());
+
+	return ((d1 > 0.0) != (d2 > 0.0)) && ((d3 > 0.0) != (d4 > 0.0));
+}
@@ -0,0 +1,223 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef PICKINGENGINE_H_
+#define PICKINGENGINE_H_
+
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QSize>
+#include <QPolygonF>
+#include <GLC_BoundingBox>
+#include <GLC_Vector3d>
+#include <GLC_Plane>
+#include <GLC_3DViewCollection>
+#include <GLC_Camera>
+
+class GLC_Mesh;
+
+//////////////////////////////////////////////////////////////////////
+//! \class PickingEngine
+/*! \brief PickingEngine : CPU picking of the instances of a collection*/
+
+/*! The instances bounding boxes are stored in an octree which is
+ *  build on the first request. A ray is casted through the octree and
+ *  only the triangles of the candidate meshes are tested.
+ *  The cost of a picking doesn't depend of the scene drawing cost*/
+//////////////////////////////////////////////////////////////////////
+class PickingEngine
+{
+	//! Node of the picking octree
+	struct OctreeNode
+	{
+		GLC_BoundingBox m_Box;
+		QList<int> m_Items;
+		OctreeNode* m_pChildren[8];
+	};
+
+	//! Triangles of a mesh in local coordinate
+	struct MeshTriangles
+	{
+		QVector<GLfloat> m_Positions;
+		QVector<GLuint> m_Indexes;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	PickingEngine();
+	~PickingEngine();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if the spatial index is up to date with the given collection and scene generation
+	inline bool isUpToDate(GLC_3DViewCollection* pCollection, int sceneGeneration) const
+	{
+		return (NULL != m_pRootNode) && (m_pCollection == pCollection) && (m_CollectionSize == pCollection->size())
+				&& (m_SceneGeneration == sceneGeneration);
+	}
+
+	//! Clear the spatial index and the triangles cache
+	void clear();
+
+	//! Build the spatial index of the given collection at the given scene generation
+	/*! The triangles cache is kept : triangles are stored in mesh coordinate*/
+	void build(GLC_3DViewCollection*, int);
+
+	//! Set the clipping plane (NULL if there is no clipping plane)
+	inline void setClipPlane(GLC_Plane* pPlane)
+	{m_pClipPlane= pPlane;}
+
+	//! Set the view used to pick from screen coordinate
+	/*! Camera, view angle, aspect ratio, parallel projection and window size*/
+	void setView(const GLC_Camera&, double, double, bool, const QSize&);
+
+	//! Return the id of the nearest visible instance hit by the given ray
+	/*! The ray direction must be normalized. Return 0 if there is no hit
+	 *  else the hit point is set to pHitPoint if not NULL*/
+	GLC_uint pick(const GLC_Point3d& origin, const GLC_Vector3d& direction, GLC_Point3d* pHitPoint= NULL);
+
+	//! Return the id of the nearest visible instance under the given screen position
+	GLC_uint pick(int x, int y, GLC_Point3d* pHitPoint= NULL);
+
+	//! Return the id of visible instances in the given screen area
+	/*! If touching is true, instances which touch the area are returned
+	 *  else only instances fully inside the area are returned*/
+	QList<GLC_uint> areaPick(const QPolygonF&, bool touching);
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Insert the item of the given index in the given node
+	void insert(OctreeNode*, int, int);
+
+	//! Delete the spatial index
+	void clearIndex();
+
+	//! Delete the given node and its children
+	void deleteNode(OctreeNode*);
+
+	//! Collect the items which bounding box is hit by the ray
+	void collectRayCandidates(OctreeNode*, const GLC_Point3d&, const GLC_Vector3d&, QList<QPair<double, int> >*) const;
+
+	//! Collect the items which screen bounding rectangle intersect the given rectangle
+	void collectAreaCandidates(OctreeNode*, const QRectF&, QList<int>*) const;
+
+	//! Return true if the given instance is in the area
+	bool instanceInArea(GLC_3DViewInstance*, const QPolygonF&, bool);
+
+	//! Project the given point on the screen, return false if the point is behind the eye
+	bool project(const GLC_Point3d&, QPointF*) const;
+
+	//! Project the given box on the screen, return false if the box is behind the eye
+	/*! The screen bounding rectangle is set to the given rectangle and
+	 *  insideCount to the number of box corners inside the given area
+	 *  and the 8 projected corners are set to the given corners array*/
+	bool projectBox(const GLC_BoundingBox&, QRectF*, const QPolygonF* pArea= NULL, int* pInsideCount= NULL, QPointF* pCorners= NULL) const;
+
+	//! Return the nearest hit distance on the given instance (-1.0 if no hit)
+	double hitDistance(GLC_3DViewInstance*, const GLC_Point3d&, const GLC_Vector3d&);
+
+	//! Return the triangles of the given mesh from the cache
+	const MeshTriangles& meshTriangles(GLC_Mesh*);
+
+	//! Return true if the given point is removed by the clipping plane
+	bool isClipped(const GLC_Point3d&) const;
+
+	//! Return the ray entry distance in the given box (-1.0 if no hit)
+	static double rayBoxEntry(const GLC_BoundingBox&, const GLC_Point3d&, const GLC_Vector3d&);
+
+	//! Return the ray triangle hit distance (-1.0 if no hit)
+	static double rayTriangle(const GLC_Point3d&, const GLC_Vector3d&, const GLC_Point3d&, const GLC_Point3d&, const GLC_Point3d&);
+
+	//! Return true if the given screen triangle intersect the given area
+	static bool triangleTouchArea(const QPointF&, const QPointF&, const QPointF&, const QPolygonF&);
+
+	//! Return true if an edge of the given area cross an edge of the given projected box
+	static bool areaCrossBox(const QPointF*, const QPolygonF&);
+
+	//! Return true if the given screen segments intersect
+	static bool segmentsIntersect(const QPointF&, const QPointF&, const QPointF&, const QPointF&);
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The collection associated to the spatial index
+	GLC_3DViewCollection* m_pCollection;
+
+	//! The number of instances of the collection when the index was build
+	int m_CollectionSize;
+
+	//! The scene generation when the index was build
+	int m_SceneGeneration;
+
+	//! The root node of the octree
+	OctreeNode* m_pRootNode;
+
+	//! The id of indexed instances
+	QVector<GLC_uint> m_ItemIds;
+
+	//! The bounding box of indexed instances
+	QVector<GLC_BoundingBox> m_ItemBoxes;
+
+	//! Cache of meshes triangles
+	QHash<GLC_uint, MeshTriangles> m_TrianglesCache;
+
+	//! Number of float stored in the cache
+	int m_CacheSize;
+
+	//! The clipping plane
+	GLC_Plane* m_pClipPlane;
+
+	//! The view eye
+	GLC_Point3d m_Eye;
+
+	//! The view frame (side, up and forward normalized vectors)
+	GLC_Vector3d m_Side;
+	GLC_Vector3d m_Up;
+	GLC_Vector3d m_Forward;
+
+	//! Tangent of the half view angle or half height of parallel projection
+	double m_Top;
+
+	//! The view aspect ratio
+	double m_AspectRatio;
+
+	//! Parallel projection
+	bool m_UseOrtho;
+
+	//! The view window size
+	QSize m_ViewSize;
+};
+
+#endif /* PICKINGENGINE_H_ */
@@ -0,0 +1,237 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include "TiffStripWriter.h"
+#include <QObject>
+#include <QByteArray>
+#include <QDataStream>
+
+// Recommended strip size of baseline TIFF
+static const int stripSize= 8192;
+
+// TIFF field types
+static const quint16 tiffShort= 3;
+static const quint16 tiffLong= 4;
+static const quint16 tiffRational= 5;
+
+// Write a TIFF image directory entry
+static void writeEntry(QDataStream& stream, quint16 tag, quint16 type, quint32 count, quint32 value)
+{
+	stream << tag << type << count;
+	if ((tiffShort == type) && (1 == count))
+	{
+		// The value is left justified
+		stream << static_cast<quint16>(value) << static_cast<quint16>(0);
+	}
+	else
+	{
+		stream << value;
+	}
+}
+
+TiffStripWriter::TiffStripWriter()
+: m_File()
+, m_Size()
+, m_SamplesPerPixel(3)
+, m_RowsPerStrip(1)
+, m_WrittenRows(0)
+, m_ErrorString()
+{
+
+}
+
+TiffStripWriter::~TiffStripWriter()
+{
+	if (m_File.isOpen()) close();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+
+// Create the given file for an image of the given size, with alpha channel if withAlpha
+bool TiffStripWriter::open(const QString& fileName, const QSize& size, bool withAlpha)
+{
+	Q_ASSERT(!m_File.isOpen());
+	m_Size= size;
+	m_SamplesPerPixel= withAlpha ? 4 : 3;
+	m_WrittenRows= 0;
+	m_ErrorString.clear();
+
+	const int rowBytes= m_Size.width() * m_SamplesPerPixel;
+	m_RowsPerStrip= qMax(1, stripSize / rowBytes);
+
+	m_File.setFileName(fileName);
+	if (!m_File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		m_ErrorString= m_File.errorString();
+		return false;
+	}
+	if (!writeHeader())
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+// Append the given band of rows to the image
+bool TiffStripWriter::writeBand(const QImage& band)
+{
+	if (!m_File.isOpen()) return false;
+	if ((band.width() != m_Size.width()) || ((m_WrittenRows + band.height()) > m_Size.height()))
+	{
+		m_ErrorString= QObject::tr("Image band does not fit the image size");
+		return false;
+	}
+
+	const QImage image(band.convertToFormat(4 == m_SamplesPerPixel ? QImage::Format_ARGB32 : QImage::Format_RGB32));
+	const int width= image.width();
+	const int height= image.height();
+	QByteArray row(width * m_SamplesPerPixel, 0);
+	for (int y= 0; y < height; ++y)
+	{
+		const QRgb* pPixels= reinterpret_cast<const QRgb*>(image.constScanLine(y));
+		char* pRow= row.data();
+		for (int x= 0; x < width; ++x)
+		{
+			*pRow++= static_cast<char>(qRed(pPixels[x]));
+			*pRow++= static_cast<char>(qGreen(pPixels[x]));
+			*pRow++= static_cast<char>(qBlue(pPixels[x]));
+			if (4 == m_SamplesPerPixel) *pRow++= static_cast<char>(qAlpha(pPixels[x]));
+		}
+		if (m_File.write(row) != row.size())
+		{
+			m_ErrorString= m_File.errorString();
+			return false;
+		}
+		++m_WrittenRows;
+	}
+	return true;
+}
+
+// Close the file, return true if the whole image has been written
+bool TiffStripWriter::close()
+{
+	const bool complete= m_File.isOpen() && (m_WrittenRows == m_Size.height());
+	m_File.close();
+	if (!complete)
+	{
+		m_File.remove();
+	}
+	else if (QFile::NoError != m_File.error())
+	{
+		m_ErrorString= m_File.errorString();
+		m_File.remove();
+		return false;
+	}
+	return complete;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Write the TIFF header, image directory and strip table
+bool TiffStripWriter::writeHeader()
+{
+	const bool withAlpha= (4 == m_SamplesPerPixel);
+	const quint32 rowBytes= static_cast<quint32>(m_Size.width() * m_SamplesPerPixel);
+	const quint32 stripCount= static_cast<quint32>((m_Size.height() + m_RowsPerStrip - 1) / m_RowsPerStrip);
+	const quint16 entryCount= withAlpha ? 14 : 13;
+
+	// Offsets of the values which don't fit in the directory entries
+	const quint32 bitsPerSampleOffset= 8 + 2 + entryCount * 12 + 4;
+	const quint32 xResolutionOffset= bitsPerSampleOffset + m_SamplesPerPixel * 2;
+	const quint32 yResolutionOffset= xResolutionOffset + 8;
+	const quint32 stripOffsetsOffset= yResolutionOffset + 8;
+	const quint32 stripByteCountsOffset= stripOffsetsOffset + stripCount * 4;
+	const quint32 imageOffset= (1 == stripCount) ? stripOffsetsOffset : stripByteCountsOffset + stripCount * 4;
+
+	const quint64 fileSize= static_cast<quint64>(imageOffset) + static_cast<quint64>(rowBytes) * m_Size.height();
+	if (fileSize > Q_UINT64_C(0xFFFFFFFF))
+	{
+		m_ErrorString= QObject::tr("Image too large : TIFF files are limited to 4 GB");
+		return false;
+	}
+
+	QByteArray header;
+	QDataStream stream(&header, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+
+	// Little endian TIFF with the image directory right after the header
+	stream << static_cast<quint8>('I') << static_cast<quint8>('I') << static_cast<quint16>(42) << static_cast<quint32>(8);
+
+	const quint32 stripBytes= rowBytes * m_RowsPerStrip;
+	const quint32 lastStripBytes= rowBytes * (m_Size.height() - (stripCount - 1) * m_RowsPerStrip);
+
+	// Image directory, entries sorted by tag
+	stream << entryCount;
+	writeEntry(stream, 256, tiffLong, 1, m_Size.width());				// ImageWidth
+	writeEntry(stream, 257, tiffLong, 1, m_Size.height());				// ImageLength
+	writeEntry(stream, 258, tiffShort, m_SamplesPerPixel, bitsPerSampleOffset);	// BitsPerSample
+	writeEntry(stream, 259, tiffShort, 1, 1);							// Compression : none
+	writeEntry(stream, 262, tiffShort, 1, 2);							// PhotometricInterpretation : RGB
+	writeEntry(stream, 273, tiffLong, stripCount, (1 == stripCount) ? imageOffset : stripOffsetsOffset);	// StripOffsets
+	writeEntry(stream, 277, tiffShort, 1, m_SamplesPerPixel);			// SamplesPerPixel
+	writeEntry(stream, 278, tiffLong, 1, m_RowsPerStrip);				// RowsPerStrip
+	writeEntry(stream, 279, tiffLong, stripCount, (1 == stripCount) ? lastStripBytes : stripByteCountsOffset);	// StripByteCounts
+	writeEntry(stream, 282, tiffRational, 1, xResolutionOffset);		// XResolution
+	writeEntry(stream, 283, tiffRational, 1, yResolutionOffset);		// YResolution
+	writeEntry(stream, 284, tiffShort, 1, 1);							// PlanarConfiguration : chunky
+	writeEntry(stream, 296, tiffShort, 1, 2);							// ResolutionUnit : inch
+	if (withAlpha)
+	{
+		writeEntry(stream, 338, tiffShort, 1, 2);						// ExtraSamples : unassociated alpha
+	}
+	stream << static_cast<quint32>(0);
+
+	for (int i= 0; i < m_SamplesPerPixel; ++i)
+	{
+		stream << static_cast<quint16>(8);
+	}
+	stream << static_cast<quint32>(72) << static_cast<quint32>(1);
+	stream << static_cast<quint32>(72) << static_cast<quint32>(1);
+
+	// Strip table
+	if (stripCount > 1)
+	{
+		for (quint32 i= 0; i < stripCount; ++i)
+		{
+			stream << imageOffset + i * stripBytes;
+		}
+		for (quint32 i= 0; i < stripCount; ++i)
+		{
+			stream << ((i == (stripCount - 1)) ? lastStripBytes : stripBytes);
+		}
+	}
+	Q_ASSERT(static_cast<quint32>(header.size()) == imageOffset);
+
+	if (m_File.write(header) != header.size())
+	{
+		m_ErrorString= m_File.errorString();
+		return false;
+	}
+	return true;
+}
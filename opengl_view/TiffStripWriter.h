@@ -0,0 +1,107 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef TIFFSTRIPWRITER_H_
+#define TIFFSTRIPWRITER_H_
+
+#include <QFile>
+#include <QSize>
+#include <QString>
+#include <QImage>
+
+//////////////////////////////////////////////////////////////////////
+//! \class TiffStripWriter
+/*! \brief TiffStripWriter : Write an uncompressed TIFF image band by band*/
+
+/*! The image size is known when the file is opened, so the TIFF
+ *  header and strip table are written first and the pixels are
+ *  appended as the bands are rendered. Only the current band is
+ *  held in memory. The file is limited to 4 GB (Classic TIFF)*/
+//////////////////////////////////////////////////////////////////////
+class TiffStripWriter
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	TiffStripWriter();
+
+	//! Close the file, an incomplete image is removed
+	~TiffStripWriter();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Public Interface
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Create the given file for an image of the given size, with alpha channel if withAlpha
+	bool open(const QString&, const QSize&, bool withAlpha);
+
+	//! Append the given band of rows to the image
+	/*! The band width must be the image width*/
+	bool writeBand(const QImage&);
+
+	//! Close the file, return true if the whole image has been written
+	bool close();
+
+	//! Return the number of rows already written
+	inline int writtenRows() const
+	{return m_WrittenRows;}
+
+	//! Return the last error message
+	inline QString errorString() const
+	{return m_ErrorString;}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Write the TIFF header, image directory and strip table
+	bool writeHeader();
+
+//////////////////////////////////////////////////////////////////////
+// private member
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The image file
+	QFile m_File;
+
+	//! The image size
+	QSize m_Size;
+
+	//! Number of bytes per pixel (3 or 4 with alpha)
+	int m_SamplesPerPixel;
+
+	//! Number of rows in each strip
+	int m_RowsPerStrip;
+
+	//! Number of rows already written
+	int m_WrittenRows;
+
+	//! The last error message
+	QString m_ErrorString;
+};
+
+#endif /* TIFFSTRIPWRITER_H_ */
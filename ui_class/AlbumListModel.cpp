@@ -0,0 +1,310 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+ *****************************************************************************/
+
+#include "AlbumListModel.h"
+
+#include <QBrush>
+
+// Maximum number of thumbnails kept in the album list
+static const int maxCachedThumbnails= 2048;
+
+AlbumListModel::AlbumListModel(FileEntryHash* pAlbumModel, QObject *parent)
+: QAbstractListModel(parent)
+, m_pAlbumModel(pAlbumModel)
+, m_ModelIds()
+, m_ModelNames()
+, m_RowOfModelId()
+, m_ThumbnailCache(maxCachedThumbnails)
+, m_UnloadedIcon()
+, m_ErrorIcon()
+, m_DisplayThumbnails(true)
+, m_FirstUnloadedRow(0)
+{
+
+}
+
+AlbumListModel::~AlbumListModel()
+{
+
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+// Return the number of rows under the given parent
+int AlbumListModel::rowCount(const QModelIndex& parent) const
+{
+	if (parent.isValid()) return 0;
+	else return m_ModelIds.size();
+}
+
+// Return the data of the given index and role
+QVariant AlbumListModel::data(const QModelIndex& index, int role) const
+{
+	QVariant result;
+	if (!index.isValid() || (index.row() >= m_ModelIds.size())) return result;
+
+	const int row= index.row();
+	const GLC_uint modelId= m_ModelIds.at(row);
+	if (Qt::DisplayRole == role)
+	{
+		result= m_ModelNames.at(row);
+	}
+	else if (Qt::UserRole == role)
+	{
+		result= QVariant(modelId);
+	}
+	else if (Qt::ForegroundRole == role)
+	{
+		if (isOnError(row))
+		{
+			result= QBrush(Qt::red);
+		}
+		else if (isUnloaded(row))
+		{
+			result= QBrush(Qt::gray);
+		}
+		else
+		{
+			result= QBrush(Qt::black);
+		}
+	}
+	else if ((Qt::DecorationRole == role) && m_DisplayThumbnails)
+	{
+		const QPixmap* pThumbnail= m_ThumbnailCache.object(modelId);
+		if (isOnError(row))
+		{
+			result= m_ErrorIcon;
+		}
+		else if (NULL != pThumbnail)
+		{
+			result= *pThumbnail;
+		}
+		else
+		{
+			result= m_UnloadedIcon;
+		}
+	}
+	return result;
+}
+
+// Return the row of the given model id or -1
+int AlbumListModel::row(GLC_uint modelId) const
+{
+	const int row= m_RowOfModelId.value(modelId, -1);
+	if ((row >= 0) && (row < m_ModelIds.size()) && (m_ModelIds.at(row) == modelId))
+	{
+		return row;
+	}
+	else
+	{
+		// The hash table is rebuilt after the removal of rows
+		return m_ModelIds.indexOf(modelId);
+	}
+}
+
+// Return the id of the first model which is not loaded and not on error or 0
+GLC_uint AlbumListModel::firstUnloadedModelId() const
+{
+	GLC_uint modelId= 0;
+	const int size= m_ModelIds.size();
+	while ((m_FirstUnloadedRow < size) && (0 == modelId))
+	{
+		if (isUnloaded(m_FirstUnloadedRow))
+		{
+			modelId= m_ModelIds.at(m_FirstUnloadedRow);
+		}
+		else ++m_FirstUnloadedRow;
+	}
+	return modelId;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+// Append the given models
+void AlbumListModel::addModels(const QList<GLC_uint>& modelIds)
+{
+	if (modelIds.isEmpty()) return;
+
+	const int first= m_ModelIds.size();
+	const int size= modelIds.size();
+	beginInsertRows(QModelIndex(), first, first + size - 1);
+	for (int i= 0; i < size; ++i)
+	{
+		const GLC_uint modelId= modelIds.at(i);
+		m_ModelIds.append(modelId);
+		m_ModelNames.append(m_pAlbumModel->value(modelId).name());
+		m_RowOfModelId.insert(modelId, first + i);
+	}
+	endInsertRows();
+}
+
+// Remove the given row
+void AlbumListModel::removeModel(int row)
+{
+	Q_ASSERT((row >= 0) && (row < m_ModelIds.size()));
+	beginRemoveRows(QModelIndex(), row, row);
+	m_ThumbnailCache.remove(m_ModelIds.at(row));
+	m_ModelIds.removeAt(row);
+	m_ModelNames.removeAt(row);
+	endRemoveRows();
+
+	updateRowHash();
+	m_FirstUnloadedRow= qMin(m_FirstUnloadedRow, row);
+}
+
+// Remove the rows whose FileEntry is unloaded if true or on error if false
+void AlbumListModel::removeModels(bool unloaded)
+{
+	// Remove each range of consecutive rows from the end of the list
+	int last= m_ModelIds.size() - 1;
+	while (last >= 0)
+	{
+		if ((unloaded && isUnloaded(last)) || (!unloaded && isOnError(last)))
+		{
+			int first= last;
+			while ((first > 0) && ((unloaded && isUnloaded(first - 1)) || (!unloaded && isOnError(first - 1))))
+			{
+				--first;
+			}
+			beginRemoveRows(QModelIndex(), first, last);
+			for (int i= first; i <= last; ++i)
+			{
+				m_ThumbnailCache.remove(m_ModelIds.at(i));
+			}
+			m_ModelIds.erase(m_ModelIds.begin() + first, m_ModelIds.begin() + last + 1);
+			m_ModelNames.erase(m_ModelNames.begin() + first, m_ModelNames.begin() + last + 1);
+			endRemoveRows();
+			last= first - 1;
+		}
+		else --last;
+	}
+
+	updateRowHash();
+	m_FirstUnloadedRow= 0;
+}
+
+// Remove all rows
+void AlbumListModel::clear()
+{
+	beginResetModel();
+	m_ModelIds.clear();
+	m_ModelNames.clear();
+	m_RowOfModelId.clear();
+	m_ThumbnailCache.clear();
+	m_FirstUnloadedRow= 0;
+	endResetModel();
+}
+
+// Notify that the state of the FileEntry of the given row changed
+void AlbumListModel::updateModel(int row)
+{
+	Q_ASSERT((row >= 0) && (row < m_ModelIds.size()));
+	m_FirstUnloadedRow= qMin(m_FirstUnloadedRow, row);
+	emit dataChanged(index(row), index(row));
+}
+
+// Set the thumbnail of the given row
+void AlbumListModel::setThumbnail(int row, const QPixmap& thumbnail)
+{
+	Q_ASSERT((row >= 0) && (row < m_ModelIds.size()));
+	m_ThumbnailCache.insert(m_ModelIds.at(row), new QPixmap(thumbnail));
+	emit dataChanged(index(row), index(row));
+}
+
+// Remove the thumbnail of the given model id
+void AlbumListModel::removeThumbnail(GLC_uint modelId)
+{
+	if (m_ThumbnailCache.remove(modelId))
+	{
+		const int modelRow= row(modelId);
+		emit dataChanged(index(modelRow), index(modelRow));
+	}
+}
+
+// Remove all thumbnails
+void AlbumListModel::clearThumbnails()
+{
+	m_ThumbnailCache.clear();
+	updateAllModels();
+}
+
+// Set the icons of unloaded and on error models
+void AlbumListModel::setIcons(const QPixmap& unloaded, const QPixmap& onError)
+{
+	m_UnloadedIcon= unloaded;
+	m_ErrorIcon= onError;
+	updateAllModels();
+}
+
+// Set the thumbnails display
+void AlbumListModel::setThumbnailsDisplay(bool display)
+{
+	if (display != m_DisplayThumbnails)
+	{
+		m_DisplayThumbnails= display;
+		updateAllModels();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Return true if the FileEntry of the given row is not loaded and not on error
+bool AlbumListModel::isUnloaded(int row) const
+{
+	FileEntryHash::const_iterator iEntry= m_pAlbumModel->constFind(m_ModelIds.at(row));
+	return (iEntry != m_pAlbumModel->constEnd()) && !iEntry.value().isLoaded() && !iEntry.value().isOnError();
+}
+
+// Return true if the FileEntry of the given row is on error
+bool AlbumListModel::isOnError(int row) const
+{
+	FileEntryHash::const_iterator iEntry= m_pAlbumModel->constFind(m_ModelIds.at(row));
+	return (iEntry != m_pAlbumModel->constEnd()) && iEntry.value().isOnError();
+}
+
+// Rebuild the row of model id hash table
+void AlbumListModel::updateRowHash()
+{
+	m_RowOfModelId.clear();
+	const int size= m_ModelIds.size();
+	for (int i= 0; i < size; ++i)
+	{
+		m_RowOfModelId.insert(m_ModelIds.at(i), i);
+	}
+}
+
+// Notify that all rows changed
+void AlbumListModel::updateAllModels()
+{
+	if (!m_ModelIds.isEmpty())
+	{
+		emit dataChanged(index(0), index(m_ModelIds.size() - 1));
+	}
+}
@@ -0,0 +1,174 @@
+/****************************************************************************
+
+ This file is part of GLC-Player.
+ Copyright (C) 2007-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ Version 2.2.0, packaged on July 2010.
+
+ http://www.glc-player.net
+
+ GLC-Player is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-Player is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-Player; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+ *****************************************************************************/
+
+#ifndef ALBUMLISTMODEL_H_
+#define ALBUMLISTMODEL_H_
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QHash>
+#include <QCache>
+#include <QPixmap>
+#include <QStringList>
+#include "FileEntry.h"
+
+//////////////////////////////////////////////////////////////////////
+//! \class AlbumListModel
+/*! \brief AlbumListModel : The item model of the album models list*/
+
+/*! A row only holds the model id and its name : the loading state of
+ *  the row is the state of its FileEntry, so it is never duplicated in
+ *  the view. Thumbnails are kept in a bounded cache and the view asks
+ *  for the thumbnails of its visible rows only.*/
+//////////////////////////////////////////////////////////////////////
+class AlbumListModel : public QAbstractListModel
+{
+	Q_OBJECT
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Default constructor
+	AlbumListModel(FileEntryHash*, QObject *parent= 0);
+
+	virtual ~AlbumListModel();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*!\name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the number of rows under the given parent
+	virtual int rowCount(const QModelIndex& parent= QModelIndex()) const;
+
+	//! Return the data of the given index and role
+	virtual QVariant data(const QModelIndex&, int role= Qt::DisplayRole) const;
+
+	//! Return the model id of the given row or 0
+	inline GLC_uint modelId(int row) const
+	{return ((row >= 0) && (row < m_ModelIds.size())) ? m_ModelIds.at(row) : 0;}
+
+	//! Return the row of the given model id or -1
+	int row(GLC_uint) const;
+
+	//! Return the list of model id in the album order
+	inline QList<GLC_uint> modelIds() const
+	{return m_ModelIds;}
+
+	//! Return true if the thumbnail of the given model id is cached
+	inline bool hasThumbnail(GLC_uint modelId) const
+	{return m_ThumbnailCache.contains(modelId);}
+
+	//! Return the id of the first model which is not loaded and not on error or 0
+	GLC_uint firstUnloadedModelId() const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*!\name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Append the given models
+	void addModels(const QList<GLC_uint>&);
+
+	//! Remove the given row
+	void removeModel(int);
+
+	//! Remove the rows whose FileEntry is unloaded if true or on error if false
+	void removeModels(bool unloaded);
+
+	//! Remove all rows
+	void clear();
+
+	//! Notify that the state of the FileEntry of the given row changed
+	void updateModel(int);
+
+	//! Set the thumbnail of the given row
+	void setThumbnail(int, const QPixmap&);
+
+	//! Remove the thumbnail of the given model id
+	void removeThumbnail(GLC_uint);
+
+	//! Remove all thumbnails
+	void clearThumbnails();
+
+	//! Set the icons of unloaded and on error models
+	void setIcons(const QPixmap& unloaded, const QPixmap& onError);
+
+	//! Set the thumbnails display
+	void setThumbnailsDisplay(bool);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Return true if the FileEntry of the given row is not loaded and not on error
+	bool isUnloaded(int) const;
+
+	//! Return true if the FileEntry of the given row is on error
+	bool isOnError(int) const;
+
+	//! Rebuild the row of model id hash table
+	void updateRowHash();
+
+	//! Notify that all rows changed
+	void updateAllModels();
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The Album Model
+	FileEntryHash* m_pAlbumModel;
+
+	//! The model id of each row
+	QList<GLC_uint> m_ModelIds;
+
+	//! The displayed name of each row
+	QStringList m_ModelNames;
+
+	//! The row of each model id
+	QHash<GLC_uint, int> m_RowOfModelId;
+
+	//! Thumbnails keyed by model id
+	QCache<GLC_uint, QPixmap> m_ThumbnailCache;
+
+	//! Icon of unloaded models
+	QPixmap m_UnloadedIcon;
+
+	//! Icon of models on error
+	QPixmap m_ErrorIcon;
+
+	//! Thumbnail visibility
+	bool m_DisplayThumbnails;
+
+	//! The rows before this one are loaded or on error
+	mutable int m_FirstUnloadedRow;
+
+};
+
+#endif /* ALBUMLISTMODEL_H_ */
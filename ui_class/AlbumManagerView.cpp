@@ -27,12 +27,21 @@
 #include "../opengl_view/OpenglView.h"
 
 #include <QFileInfo>
+#include <QScrollBar>
+#include <QSortFilterProxyModel>
 #include <QtDebug>
 
+// Delay before computing the thumbnails of the visible models
+static const int thumbnailDelay= 50;
+
 AlbumManagerView::AlbumManagerView(OpenglView* pOpenglView, FileEntryHash* pAlbumModel, QWidget *parent)
 : QWidget(parent)
 , m_pOpenglView(pOpenglView)
 , m_pAlbumModel(pAlbumModel)
+, m_pListModel(new AlbumListModel(pAlbumModel, this))
+, m_pProxyModel(new QSortFilterProxyModel(this))
+, m_ThumbnailTimer()
+, m_ComputingThumbnails(false)
 , m_IconSize()
 , m_DisplayThumbnails(true)
 , m_NumberOfErrorModel(0)
@@ -43,9 +52,18 @@ AlbumManagerView::AlbumManagerView(OpenglView* pOpenglView, FileEntryHash* pAlbu
 , m_pActionGetErrorInfo(new QAction(tr("Get Error Information"), this))
 , m_pActionModelProperties(new QAction(QIcon(":images/ModelProperties.png"), tr("Model Properties"), this))
 , m_pActionReloadCurrentModel(new QAction(QIcon(":images/Refresh.png"), tr("Reload"), this))
+, m_pActionSortByName(new QAction(tr("Sort By Name"), this))
 , m_pModelProperties(NULL)
 {
 	setupUi(this);
+
+	// The models list
+	m_pProxyModel->setSourceModel(m_pListModel);
+	m_pProxyModel->setDynamicSortFilter(true);
+	m_pProxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+	m_pProxyModel->setSortCaseSensitivity(Qt::CaseInsensitive);
+	modelList->setModel(m_pProxyModel);
+
 	// Signals relay
 	// Refresh the models thumbnails
 	connect(refreshThumbnailsButton, SIGNAL(clicked()), this , SLOT(refreshModelsIcons()));
@@ -58,10 +76,20 @@ AlbumManagerView::AlbumManagerView(OpenglView* pOpenglView, FileEntryHash* pAlbu
 	// Stop loading
 	connect(stopLoadingButton, SIGNAL(clicked()), this , SLOT(beforeStopLoading()));
 	// Current Model change
-	connect(modelList, SIGNAL(currentItemChanged(QListWidgetItem *, QListWidgetItem *))
-				, this , SLOT(currentModelChangedSlot(QListWidgetItem *, QListWidgetItem *)));
+	connect(modelList->selectionModel(), SIGNAL(currentChanged(const QModelIndex&, const QModelIndex&))
+				, this , SLOT(currentModelChangedSlot(const QModelIndex&, const QModelIndex&)));
 	// model clicked
-	connect(modelList, SIGNAL(itemClicked(QListWidgetItem *)), this , SLOT(modelItemClicked(QListWidgetItem *)));
+	connect(modelList, SIGNAL(clicked(const QModelIndex&)), this , SLOT(modelItemClicked(const QModelIndex&)));
+	// Filter models
+	connect(filterLineEdit, SIGNAL(textChanged(const QString&)), this , SLOT(filterModels(const QString&)));
+
+	// Thumbnails of the visible models
+	m_ThumbnailTimer.setSingleShot(true);
+	m_ThumbnailTimer.setInterval(thumbnailDelay);
+	connect(&m_ThumbnailTimer, SIGNAL(timeout()), this, SLOT(computeVisibleThumbnails()));
+	connect(modelList->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(requestVisibleThumbnails()));
+	connect(modelList->verticalScrollBar(), SIGNAL(rangeChanged(int, int)), this, SLOT(requestVisibleThumbnails()));
+	connect(m_pProxyModel, SIGNAL(layoutChanged()), this, SLOT(requestVisibleThumbnails()));
 
 	// Model list Icons
 	modelList->setIconSize(m_IconSize);
@@ -85,6 +113,11 @@ AlbumManagerView::AlbumManagerView(OpenglView* pOpenglView, FileEntryHash* pAlbu
 	modelList->addAction(m_pActionReloadCurrentModel);
 	connect(m_pActionReloadCurrentModel, SIGNAL(triggered()), this, SLOT(reloadCurrentModel()));
 
+	// Sort models by name
+	m_pActionSortByName->setCheckable(true);
+	modelList->addAction(m_pActionSortByName);
+	connect(m_pActionSortByName, SIGNAL(toggled(bool)), this, SLOT(sortModels(bool)));
+
 	// Album name
 	setAlbumName(tr("New Album"));
 
@@ -97,23 +130,13 @@ AlbumManagerView::~AlbumManagerView()
 // Return the ID of the current model if there is no current model NULL is return
 GLC_uint AlbumManagerView::currentModelId() const
 {
-	GLC_uint modelId= 0;
-	if (NULL != modelList->currentItem())
-	{
-		modelId= modelList->currentItem()->data(Qt::UserRole).toUInt();
-	}
-	return modelId;
+	return m_pListModel->modelId(currentRow());
 }
-// Return the specified model id
-GLC_uint AlbumManagerView::modelId(int index) const
-{
-	GLC_uint modelId= 0;
-	if (NULL != modelList->item(index))
-	{
-		modelId= modelList->item(index)->data(Qt::UserRole).toUInt();
-	}
-	return modelId;
 
+// return the current row
+int AlbumManagerView::currentRow() const
+{
+	return m_pProxyModel->mapToSource(modelList->currentIndex()).row();
 }
 
 // Return icon name with a size
@@ -157,36 +180,16 @@ QString AlbumManagerView::getIconName(bool WithError) const
 	return iconName;
 }
 
-// return the first unload model name
-GLC_uint AlbumManagerView::firstUnloadModelId() const
-{
-	GLC_uint modelId= 0;
-	// The number of item in the list
-	const int max= modelList->count();
-
-	// Get the icon name
-	int i= 0;
-	while ((i < max) && (0 == modelId))
-	{
-		if (modelList->item(i)->foreground() == QBrush(Qt::gray))
-		{
-			modelId= modelList->item(i)->data(Qt::UserRole).toUInt();
-		}
-		else ++i;
-	}
-	return modelId;
-}
-
 // Return the sorted list of fileEntry
 QList<FileEntry> AlbumManagerView::sortedFileEntryList() const
 {
-	// The number of item in the list
-	const int max= modelList->count();
+	const QList<GLC_uint> modelIds(m_pListModel->modelIds());
+	const int max= modelIds.size();
 
 	QList<FileEntry> sortedList;
 	for (int i= 0; i < max; ++i)
 	{
-		sortedList << m_pAlbumModel->value(modelId(i));
+		sortedList << m_pAlbumModel->value(modelIds.at(i));
 	}
 
 	return sortedList;
@@ -196,19 +199,17 @@ QList<FileEntry> AlbumManagerView::sortedFileEntryList() const
 // Add a model to the list
 void AlbumManagerView::addModel(const GLC_uint modelId)
 {
-	const QFileInfo model(m_pAlbumModel->value(modelId).getFileName());
-	++m_NumberOfUnloadedModel;
-	QListWidgetItem* pItem= new QListWidgetItem(model.fileName());
-	pItem->setData(Qt::UserRole, QVariant(modelId));
-	pItem->setForeground(QBrush(Qt::gray));
-	if (m_DisplayThumbnails)
-	{
-		pItem->setIcon(QPixmap(getIconName(false)));
-	}
-	modelList->addItem(pItem);
+	addModels(QList<GLC_uint>() << modelId);
+}
+
+// Add the given models to the list
+void AlbumManagerView::addModels(const QList<GLC_uint>& modelIds)
+{
+	m_pListModel->addModels(modelIds);
+	m_NumberOfUnloadedModel+= modelIds.size();
 
 	// Update UI buttons
-	if (((modelList->count() == 1) || (m_StopLoading == false)) && !stopLoadingButton->isEnabled())
+	if (((m_pListModel->rowCount() == 1) || (m_StopLoading == false)) && !stopLoadingButton->isEnabled())
 	{
 		startLoadingButton->setEnabled(true);
 		startLoadingButton->setChecked(true);
@@ -217,14 +218,14 @@ void AlbumManagerView::addModel(const GLC_uint modelId)
 
 
 	// Update UI Info
-	numberOfModels->setText(QString::number(modelList->count()));
+	numberOfModels->setText(QString::number(m_pListModel->rowCount()));
 }
 
 // Set the model list icon size
 void AlbumManagerView::setIconSize(const QSize& size)
 {
 	m_IconSize= size;
-	modelList->setIconSize(m_IconSize);
+	updateIcons();
 
 	refreshModelsIcons();
 }
@@ -232,7 +233,8 @@ void AlbumManagerView::setIconSize(const QSize& size)
 // Clear the album
 void AlbumManagerView::clear()
 {
-	modelList->clear();
+	m_pListModel->clear();
+	filterLineEdit->clear();
 	m_NumberOfErrorModel= 0;
 	m_NumberOfUnloadedModel= 0;
 	// Update UI Button
@@ -263,19 +265,18 @@ void AlbumManagerView::resetButton()
 void AlbumManagerView::setThumbnailsDisplay(const bool display)
 {
 	m_DisplayThumbnails= display;
-	refreshThumbnailsButton->setEnabled(m_DisplayThumbnails && (modelList->count() > 0));
+	m_pListModel->setThumbnailsDisplay(m_DisplayThumbnails);
+	refreshThumbnailsButton->setEnabled(m_DisplayThumbnails && (m_pListModel->rowCount() > 0));
 }
 
 // Change widget color and return his index
 int AlbumManagerView::modelLoaded(const GLC_uint modelId)
 {
-	int curItem= 0;
-	while (modelList->item(curItem)->data(Qt::UserRole).toUInt() != modelId)
-	{
-		++curItem;
-	}
-	modelList->item(curItem)->setForeground(QBrush(Qt::black));
+	const int curItem= m_pListModel->row(modelId);
+	m_pListModel->updateModel(curItem);
 	--m_NumberOfUnloadedModel;
+	// The thumbnail is computed if the model is visible
+	requestVisibleThumbnails();
 
 	// Update UI buttons
 	if (m_NumberOfUnloadedModel == 0)
@@ -306,7 +307,7 @@ int AlbumManagerView::modelLoaded(const GLC_uint modelId)
 	}
 
 	// Update UI info
-	numberOfLoadedModels->setText(QString::number(modelList->count() - m_NumberOfUnloadedModel));
+	numberOfLoadedModels->setText(QString::number(m_pListModel->rowCount() - m_NumberOfUnloadedModel));
 
 	return curItem;
 }
@@ -314,18 +315,9 @@ int AlbumManagerView::modelLoaded(const GLC_uint modelId)
 // Change widget color and return his index
 int AlbumManagerView::modelLoadFailed(const GLC_uint modelId)
 {
-	int curItem= 0;
-	while (modelList->item(curItem)->data(Qt::UserRole).toUInt() != modelId)
-	{
-		++curItem;
-	}
-	modelList->item(curItem)->setForeground(QBrush(Qt::red));
+	const int curItem= m_pListModel->row(modelId);
+	m_pListModel->updateModel(curItem);
 	--m_NumberOfUnloadedModel;
-
-	if (m_DisplayThumbnails)
-	{
-		modelList->item(curItem)->setIcon(QPixmap(getIconName(true)).scaled(m_IconSize, Qt::IgnoreAspectRatio));
-	}
 	++m_NumberOfErrorModel;
 
 	//Update UI buttons
@@ -353,7 +345,7 @@ int AlbumManagerView::modelLoadFailed(const GLC_uint modelId)
 	}
 
 	//Update UI info
-	numberOfLoadedModels->setText(QString::number(modelList->count() - m_NumberOfUnloadedModel));
+	numberOfLoadedModels->setText(QString::number(m_pListModel->rowCount() - m_NumberOfUnloadedModel));
 
 	return curItem;
 }
@@ -375,7 +367,20 @@ void AlbumManagerView::clearCurrentModelInfo()
 // Set a snapshoot
 void AlbumManagerView::setSnapShoot(int i, const QImage &image)
 {
-	modelList->item(i)->setIcon(QPixmap::fromImage(image).scaled(m_IconSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+	m_pListModel->setThumbnail(i, QPixmap::fromImage(image).scaled(m_IconSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+}
+
+// Set the current model
+void AlbumManagerView::setCurrent(int index)
+{
+	QModelIndex proxyIndex= m_pProxyModel->mapFromSource(m_pListModel->index(index));
+	// A filtered model can't be current
+	if (!proxyIndex.isValid() && !filterLineEdit->text().isEmpty())
+	{
+		filterLineEdit->clear();
+		proxyIndex= m_pProxyModel->mapFromSource(m_pListModel->index(index));
+	}
+	modelList->setCurrentIndex(proxyIndex);
 }
 
 // Set enabled status of QAction
@@ -389,82 +394,42 @@ void AlbumManagerView::setEnabledStatus(bool status)
 // Go to the next item
 void AlbumManagerView::nextItem()
 {
-	int row= modelList->currentRow() + 1;
-	if (row < modelList->count())
-		modelList->setCurrentRow(row);
+	int row= modelList->currentIndex().row() + 1;
+	if (row < m_pProxyModel->rowCount())
+		modelList->setCurrentIndex(m_pProxyModel->index(row, 0));
 }
 
 // Go to the previous item
 void AlbumManagerView::previousItem()
 {
-	int row= modelList->currentRow() - 1;
-	if ((row < modelList->count()) && row >= 0)
-		modelList->setCurrentRow(row);
+	int row= modelList->currentIndex().row() - 1;
+	if ((row < m_pProxyModel->rowCount()) && row >= 0)
+		modelList->setCurrentIndex(m_pProxyModel->index(row, 0));
 }
 
 // Refresh the models icon
 void AlbumManagerView::refreshModelsIcons()
 {
-	// The number of item in the list
-	const int max= modelList->count();
-
-
 	if (m_DisplayThumbnails)
 	{
-		// Create progress dialog
-		QProgressDialog progress(tr("Updating thumbnails... Please wait."), tr("Cancel"), 0, max, this);
-		progress.setModal(true);
-		progress.setMinimumDuration(500);
-
 		// refresh model list icon size
 		modelList->setIconSize(m_IconSize);
 
-		// Get the icon name
-		for (int i= 0; i < max; ++i)
-		{
-			if (modelList->item(i)->foreground() == QBrush(Qt::black))
-			{
-				emit computeIconInBackBuffer(i);
-			}
-			else if (modelList->item(i)->foreground() == QBrush(Qt::gray))
-			{
-				modelList->item(i)->setIcon(QPixmap(getIconName(false)));
-			}
-			else
-			{
-				modelList->item(i)->setIcon(QPixmap(getIconName(true)));
-			}
-
-			// Update Progress dialog and chek fo cancellation
-			progress.setValue(i);
-			QCoreApplication::processEvents(); //QEventLoop::ExcludeUserInputEvents
-
-			if (progress.wasCanceled())
-			{
-				modelList->setSpacing(1);
-				return;
-			}
-
-		}
-
+		// Thumbnails are computed again when their models are visible
+		m_pListModel->clearThumbnails();
+		requestVisibleThumbnails();
 	}
 	else
 	{
 		// Thumbnail haven't to be displayed use the default one
 		modelList->setIconSize(QSize());
-		for (int i= 0; i < max; ++i)
-		{
-			modelList->item(i)->setIcon(QIcon());
-		}
 	}
-	// Force items to be laid out again
-	modelList->setSpacing(1);
 }
 
 // Details model properties
 void AlbumManagerView::modelProperties()
 {
-	if (NULL != modelList->currentItem())
+	if (haveCurrentModel())
 	{
 		GLC_uint idOfModelToDelete= currentModelId();
 		FileEntryHash::iterator iEntry= m_pAlbumModel->find(idOfModelToDelete);
@@ -485,11 +450,11 @@ void AlbumManagerView::modelProperties()
 }
 
 // Model Item as been clicked
-void AlbumManagerView::modelItemClicked(QListWidgetItem *pClickedItem)
+void AlbumManagerView::modelItemClicked(const QModelIndex& clickedIndex)
 {
-	if (pClickedItem == modelList->currentItem())
+	if (clickedIndex == modelList->currentIndex())
 	{
-		QString modelName(m_pAlbumModel->value(pClickedItem->data(Qt::UserRole).toUInt()).getFileName());
+		QString modelName(m_pAlbumModel->value(clickedIndex.data(Qt::UserRole).toUInt()).getFileName());
 		emit displayMessage(modelName);
 	}
 }
@@ -497,24 +462,11 @@ void AlbumManagerView::modelItemClicked(QListWidgetItem *pClickedItem)
 // Remove unload models
 void AlbumManagerView::removeUnloadModels()
 {
-	if (modelList->count() > m_NumberOfUnloadedModel )
+	if (m_pListModel->rowCount() > m_NumberOfUnloadedModel )
 	{
-		int i= 0;
-		while ((i < modelList->count()) && (m_NumberOfUnloadedModel > 0))
-		{
-			// Test if the model is unload
-			if (modelList->item(i)->foreground() == QBrush(Qt::gray))
-			{
-				delete modelList->takeItem(i);
-				--m_NumberOfUnloadedModel;
-			}
-			else
-			{
-				++i;
-			}
-		}
-		// Check if the number of unload model is equal to 0
-		Q_ASSERT(0 == m_NumberOfUnloadedModel);
+		// Remove the unload models
+		m_pListModel->removeModels(true);
+		m_NumberOfUnloadedModel= 0;
 
 		//Update UI buttons
 		startLoadingButton->setEnabled(false);
@@ -525,7 +477,7 @@ void AlbumManagerView::removeUnloadModels()
 
 		removeUnloadModelsButton->setEnabled(false);
 		//Update UI info
-		numberOfModels->setText(QString::number(modelList->count()));
+		numberOfModels->setText(QString::number(m_pListModel->rowCount()));
 
 		m_StopLoading= false;
 		emit removeUnloadFileItem();
@@ -540,31 +492,18 @@ void AlbumManagerView::removeUnloadModels()
 // Remove models on error
 void AlbumManagerView::removeModelsOnError()
 {
-	if (modelList->count() > m_NumberOfErrorModel )
+	if (m_pListModel->rowCount() > m_NumberOfErrorModel )
 	{
-		int i= 0;
-		while ((i < modelList->count()) && (m_NumberOfErrorModel > 0))
-		{
-			// Test if the model is on error
-			if (modelList->item(i)->foreground() == QBrush(Qt::red))
-			{
-				delete modelList->takeItem(i);
-				--m_NumberOfErrorModel;
-			}
-			else
-			{
-				++i;
-			}
-		}
-		// Check if the number of error model is equal to 0
-		Q_ASSERT(0 == m_NumberOfErrorModel);
+		// Remove the models on error
+		m_pListModel->removeModels(false);
+		m_NumberOfErrorModel= 0;
 		//modelList->removeAction(m_pActionGetErrorInfo);
 
 		//Update UI buttons
 		removeOnErrorModelsButton->setEnabled(false);
 		//Update UI info
-		numberOfModels->setText(QString::number(modelList->count()));
-		numberOfLoadedModels->setText(QString::number(modelList->count() - m_NumberOfUnloadedModel));
+		numberOfModels->setText(QString::number(m_pListModel->rowCount()));
+		numberOfLoadedModels->setText(QString::number(m_pListModel->rowCount() - m_NumberOfUnloadedModel));
 		emit removeOnErrorModels();
 	}
 	else
@@ -609,17 +548,16 @@ void AlbumManagerView::beforeStopLoading()
 // Delete the current model
 void AlbumManagerView::deleteCurrentModel()
 {
-	if (NULL != modelList->currentItem())
+	if (haveCurrentModel())
 	{
 		GLC_uint idOfModelToDelete= currentModelId();
 		FileEntryHash::iterator iEntry= m_pAlbumModel->find(idOfModelToDelete);
 		if (!iEntry.value().isLoading())
 		{
-			if (modelList->count() > 1)
+			if (m_pListModel->rowCount() > 1)
 			{
-				int currentRow= modelList->currentRow();
 				// Get the model loading status and name before removing
-				delete modelList->takeItem(currentRow);
+				m_pListModel->removeModel(currentRow());
 				// Test entry status
 				if (iEntry.value().isOnError())
 				{
@@ -632,8 +570,8 @@ void AlbumManagerView::deleteCurrentModel()
 					--m_NumberOfUnloadedModel;
 				}
 				// Update UI Buttons
-				numberOfModels->setText(QString::number(modelList->count()));
-				numberOfLoadedModels->setText(QString::number(modelList->count() - m_NumberOfUnloadedModel));
+				numberOfModels->setText(QString::number(m_pListModel->rowCount()));
+				numberOfLoadedModels->setText(QString::number(m_pListModel->rowCount() - m_NumberOfUnloadedModel));
 
 				if (m_NumberOfUnloadedModel == 0)
 				{
@@ -659,21 +597,19 @@ void AlbumManagerView::deleteCurrentModel()
 // Reload current model
 void AlbumManagerView::reloadCurrentModel()
 {
-	if (NULL != modelList->currentItem())
+	if (haveCurrentModel())
 	{
 		// Get the current model id
 		GLC_uint modelId= currentModelId();
 
 		if (m_pAlbumModel->value(modelId).isLoaded())
 		{
-			modelList->currentItem()->setForeground(QBrush(Qt::gray));
-			if (m_DisplayThumbnails)
-			{
-				modelList->currentItem()->setIcon(QPixmap(getIconName(false)));
-			}
+			// The model is unloaded by the reload
+			m_pListModel->removeThumbnail(modelId);
+			m_pListModel->updateModel(currentRow());
 			++m_NumberOfUnloadedModel;
 			// Update UI info
-			numberOfLoadedModels->setText(QString::number(modelList->count() - m_NumberOfUnloadedModel));
+			numberOfLoadedModels->setText(QString::number(m_pListModel->rowCount() - m_NumberOfUnloadedModel));
 
 			emit reloadCurrentModelSignal(modelId);
 		}
@@ -681,13 +617,11 @@ void AlbumManagerView::reloadCurrentModel()
 }
 
 // The current model changed
-void AlbumManagerView::currentModelChangedSlot(QListWidgetItem *pCurrent, QListWidgetItem *pPrevious)
+void AlbumManagerView::currentModelChangedSlot(const QModelIndex& current, const QModelIndex& previous)
 {
-
-	if (NULL != pCurrent)
+	const GLC_uint modelId= current.data(Qt::UserRole).toUInt();
+	if (0 != modelId)
 	{
-		// Get the current model id
-		GLC_uint modelId= currentModelId();
 		QList<QAction*> actionList(modelList->actions());
 		const bool containsErrorAction= actionList.contains(m_pActionGetErrorInfo);
 		FileEntryHash::const_iterator iEntry= m_pAlbumModel->find(modelId);
@@ -709,7 +643,7 @@ void AlbumManagerView::currentModelChangedSlot(QListWidgetItem *pCurrent, QListW
 		}
 	}
 
-	emit currentModelChanged(pCurrent, pPrevious);
+	emit currentModelChanged(modelId, previous.data(Qt::UserRole).toUInt());
 }
 
 // Get error information
@@ -719,7 +653,86 @@ void AlbumManagerView::getErrorInformation()
 	QMessageBox::information(this->parentWidget(), tr("Error Information"), message);
 }
 
+// Filter the models list with the given name
+void AlbumManagerView::filterModels(const QString& name)
+{
+	m_pProxyModel->setFilterFixedString(name);
+	requestVisibleThumbnails();
+}
+
+// Sort the models list by name if true
+void AlbumManagerView::sortModels(bool sortByName)
+{
+	if (sortByName)
+	{
+		m_pProxyModel->sort(0, Qt::AscendingOrder);
+	}
+	else
+	{
+		// Back to the album order
+		m_pProxyModel->sort(-1);
+	}
+}
+
+// Compute the thumbnails of the visible models after a delay
+void AlbumManagerView::requestVisibleThumbnails()
+{
+	if (m_DisplayThumbnails)
+	{
+		m_ThumbnailTimer.start();
+	}
+}
+
+// Compute the missing thumbnails of the visible models
+void AlbumManagerView::computeVisibleThumbnails()
+{
+	// Snapshots process events : avoid reentrance
+	if (!m_DisplayThumbnails || m_ComputingThumbnails || !modelList->isVisible()) return;
+
+	const int rowCount= m_pProxyModel->rowCount();
+	if (0 == rowCount) return;
+
+	// The range of visible rows
+	const int margin= modelList->spacing() + 1;
+	const QModelIndex firstIndex(modelList->indexAt(QPoint(margin, margin)));
+	const QModelIndex lastIndex(modelList->indexAt(QPoint(margin, modelList->viewport()->height() - margin)));
+	const int firstRow= firstIndex.isValid() ? firstIndex.row() : 0;
+	const int lastRow= lastIndex.isValid() ? lastIndex.row() : (rowCount - 1);
+
+	m_ComputingThumbnails= true;
+	int i= firstRow;
+	while ((i <= lastRow) && (i < m_pProxyModel->rowCount()))
+	{
+		const int row= m_pProxyModel->mapToSource(m_pProxyModel->index(i, 0)).row();
+		const GLC_uint modelId= m_pListModel->modelId(row);
+		FileEntryHash::const_iterator iEntry= m_pAlbumModel->constFind(modelId);
+		if ((iEntry != m_pAlbumModel->constEnd()) && iEntry.value().isLoaded() && !m_pListModel->hasThumbnail(modelId))
+		{
+			emit computeIconInBackBuffer(row);
+		}
+		++i;
+	}
+	m_ComputingThumbnails= false;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Protected services Functions
+//////////////////////////////////////////////////////////////////////
+
+// The thumbnails of the visible models are computed when shown
+void AlbumManagerView::showEvent(QShowEvent* pEvent)
+{
+	QWidget::showEvent(pEvent);
+	requestVisibleThumbnails();
+}
+
 //////////////////////////////////////////////////////////////////////
 // Private services Functions
 //////////////////////////////////////////////////////////////////////
 
+// Update the icons of unloaded and on error models
+void AlbumManagerView::updateIcons()
+{
+	m_pListModel->setIcons(QPixmap(getIconName(false)), QPixmap(getIconName(true)).scaled(m_IconSize, Qt::IgnoreAspectRatio));
+}
+
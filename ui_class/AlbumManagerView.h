@@ -28,10 +28,13 @@
 #include "ui_AlbumManagerView.h"
 #include <QWidget>
 #include <QHash>
+#include <QTimer>
 #include "FileEntry.h"
+#include "AlbumListModel.h"
 
 class ModelProperties;
 class OpenglView;
+class QSortFilterProxyModel;
 
 class AlbumManagerView : public QWidget, private Ui::AlbumManagerView
 {
@@ -56,22 +59,16 @@ public:
 	inline QSize iconSize() const {return m_IconSize;}
 
 	//! Return true if there is a current model
-	inline bool haveCurrentModel() const {return (NULL != modelList->currentItem());}
+	inline bool haveCurrentModel() const {return modelList->currentIndex().isValid();}
 
 	//! Return true if the index is current
-	inline bool isCurrent(int index) const {return modelList->item(index) != modelList->currentItem();}
+	inline bool isCurrent(int index) const {return index != currentRow();}
 
 	//! Return the ID of the current model if there is no current model NULL is return
 	GLC_uint currentModelId() const;
 
 	//! Return the specified model id
-	GLC_uint modelId(int) const;
-
-	//! Return the current item
-	inline QListWidgetItem * currentItem() {return modelList->currentItem();}
-
-	//! Return specidied item
-	inline QListWidgetItem * item(int index) {return modelList->item(index);}
+	inline GLC_uint modelId(int index) const {return m_pListModel->modelId(index);}
 
 	//! return true if thumbnails are displayed
 	inline bool thumbnailsAreDisplay() const {return m_DisplayThumbnails;}
@@ -79,8 +76,8 @@ public:
 	//! Return icon name with a size
 	QString getIconName(bool) const;
 
-	//! return the row of specified QListWidgetItem
-	inline int row(QListWidgetItem* pItem) const {return modelList->row(pItem);}
+	//! return the row of specified model id
+	inline int row(GLC_uint modelId) const {return m_pListModel->row(modelId);}
 
 	//! return the number of unload model in the view
 	inline int numberOfUnloadedModels() const {return m_NumberOfUnloadedModel;}
@@ -89,10 +86,10 @@ public:
 	inline int numberOfErrorModels() const {return m_NumberOfErrorModel;}
 
 	//! return the first unload model name
-	GLC_uint firstUnloadModelId() const;
+	inline GLC_uint firstUnloadModelId() const {return m_pListModel->firstUnloadedModelId();}
 
 	//! return the current row
-	inline int currentRow() const {return modelList->currentRow();}
+	int currentRow() const;
 
 	//! Return the sorted list of fileEntry
 	QList<FileEntry> sortedFileEntryList() const;
@@ -107,6 +104,9 @@ public:
 	//! Add a model to the list
 	void addModel(const GLC_uint);
 
+	//! Add the given models to the list
+	void addModels(const QList<GLC_uint>&);
+
 	//! Set the model list icon size
 	void setIconSize(const QSize&);
 
@@ -126,8 +126,7 @@ public:
 	int modelLoadFailed(const GLC_uint);
 
 	//! Set the current model
-	inline void setCurrent(int index)
-	{modelList->setCurrentItem(modelList->item(index));}
+	void setCurrent(int);
 
 	//! Update Current model info
 	void updateCurrentModelInfo(int, int);
@@ -167,7 +166,7 @@ signals:
 	void stopLoading();
 
 	//! The current model changed
-	void currentModelChanged(QListWidgetItem *, QListWidgetItem *);
+	void currentModelChanged(GLC_uint, GLC_uint);
 
 	//! Display Message
 	void displayMessage(QString);
@@ -206,7 +205,7 @@ public slots:
 //////////////////////////////////////////////////////////////////////
 private slots:
 	//! Model Item as been clicked
-	void modelItemClicked(QListWidgetItem *);
+	void modelItemClicked(const QModelIndex&);
 
 	//! Remove unload models
 	void removeUnloadModels();
@@ -227,11 +226,32 @@ private slots:
 	void reloadCurrentModel();
 
 	//! The current model changed
-	void currentModelChangedSlot(QListWidgetItem *, QListWidgetItem *);
+	void currentModelChangedSlot(const QModelIndex&, const QModelIndex&);
 
 	//! Get error information
 	void getErrorInformation();
 
+	//! Filter the models list with the given name
+	void filterModels(const QString&);
+
+	//! Sort the models list by name if true
+	void sortModels(bool);
+
+	//! Compute the thumbnails of the visible models after a delay
+	void requestVisibleThumbnails();
+
+	//! Compute the missing thumbnails of the visible models
+	void computeVisibleThumbnails();
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Protected services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+protected:
+	//! The thumbnails of the visible models are computed when shown
+	virtual void showEvent(QShowEvent*);
 
 //@}
 
@@ -240,6 +260,8 @@ private slots:
 //@{
 //////////////////////////////////////////////////////////////////////
 private:
+	//! Update the icons of unloaded and on error models
+	void updateIcons();
 
 //@}
 
@@ -253,6 +275,18 @@ private:
 	//! The Album Model
 	FileEntryHash* m_pAlbumModel;
 
+	//! The item model of the models list
+	AlbumListModel* m_pListModel;
+
+	//! The sorted and filtered models list
+	QSortFilterProxyModel* m_pProxyModel;
+
+	//! Delay the thumbnails computing while scrolling
+	QTimer m_ThumbnailTimer;
+
+	//! Thumbnails computing in progress
+	bool m_ComputingThumbnails;
+
 	//! Size of the icon in model list
 	QSize m_IconSize;
 
@@ -283,6 +317,9 @@ private:
 	//! Reload current model
 	QAction* m_pActionReloadCurrentModel;
 
+	//! Sort the models by name
+	QAction* m_pActionSortByName;
+
 	//! Model Properties dialog
 	ModelProperties* m_pModelProperties;
 
@@ -23,15 +23,27 @@
 *****************************************************************************/
 
 #include "ChooseShaderDialog.h"
+#include <QGLFramebufferObject>
+
+// Maximum number of thumbnails kept between openings
+static const int maxCachedThumbnails= 256;
 
 ChooseShaderDialog::ChooseShaderDialog(OpenglView* pOpenglView, QWidget *parent)
 : QDialog(parent)
 , m_pOpenglView(pOpenglView)
 , m_pShaderList(pOpenglView->getShaderListHandle())
 , m_IconSize(200, 200)
+, m_SelectionKey()
+, m_ThumbnailCache(maxCachedThumbnails)
+, m_ProxyWorld()
 {
 	setupUi(this);
 
+	// The proxy mesh
+	GLC_3DRep cylinder= GLC_Factory::instance()->createCylinder(1.0, 3.0);
+	m_ProxyWorld.rootOccurence()->addChild(new GLC_StructOccurence(new GLC_3DRep(cylinder)));
+
+	connect(proxyMeshCheckBox, SIGNAL(toggled(bool)), this, SIGNAL(previewModeChanged()));
 }
 
 ChooseShaderDialog::~ChooseShaderDialog()
@@ -42,12 +54,7 @@ ChooseShaderDialog::~ChooseShaderDialog()
 // get the shader Id
 GLuint ChooseShaderDialog::shaderId() const
 {
-	const int currentRow= shaderListWidget->currentRow();
-	if (currentRow == 0) return 0;
-	else
-	{
-		return (*m_pShaderList)[currentRow - 1]->id();
-	}
+	return rowShaderId(shaderListWidget->currentRow());
 }
 
 // Get the shader Name
@@ -61,6 +68,22 @@ QString ChooseShaderDialog::shaderName() const
 	}
 }
 
+// Return true if the thumbnails list needs the model to be displayed in the view
+bool ChooseShaderDialog::modelIsNeeded() const
+{
+	if (proxyMeshCheckBox->isChecked()) return false;
+
+	bool isNeeded= false;
+	const int size= m_pShaderList->size() + 1;
+	int row= 0;
+	while (!isNeeded && (row < size))
+	{
+		isNeeded= !m_ThumbnailCache.contains(thumbnailKey(row));
+		++row;
+	}
+	return isNeeded;
+}
+
 // Update list thumbnails
 void ChooseShaderDialog::UpdateThumbnailsList()
 {
@@ -69,11 +92,8 @@ void ChooseShaderDialog::UpdateThumbnailsList()
 	shaderListWidget->clear();
 	// Initialize the list of shader
 	shaderListWidget->setIconSize(m_IconSize);
-	// Add the default shader to the view
-	QListWidgetItem* pItem= new QListWidgetItem(tr("No Shader (Phong)"));
-	m_pOpenglView->setGlobalShaderId(0, QString());
-	pItem->setIcon(QPixmap::fromImage(takeSnapShoot()).scaled(m_IconSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-	shaderListWidget->addItem(pItem);
+	// Add the default shader to the list
+	shaderListWidget->addItem(new QListWidgetItem(tr("No Shader (Phong)")));
 	// Update the list of shader
 	const int size= m_pShaderList->size();
 	for (int i= 0; i < size; ++i)
@@ -83,28 +103,137 @@ void ChooseShaderDialog::UpdateThumbnailsList()
 		{
 			currentRow= i + 1;
 		}
-		pItem= new QListWidgetItem(pShader->name());
-		m_pOpenglView->setGlobalShaderId(pShader->id(), QString());
-		pItem->setIcon(QPixmap::fromImage(takeSnapShoot()).scaled(m_IconSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-		shaderListWidget->addItem(pItem);
+		shaderListWidget->addItem(new QListWidgetItem(pShader->name()));
+	}
+
+	// Use cached thumbnails
+	QList<int> rowsToRender;
+	for (int row= 0; row <= size; ++row)
+	{
+		const QPixmap* pThumbnail= m_ThumbnailCache.object(thumbnailKey(row));
+		if (NULL != pThumbnail)
+		{
+			shaderListWidget->item(row)->setIcon(*pThumbnail);
+		}
+		else
+		{
+			rowsToRender << row;
+		}
+	}
+	if (!rowsToRender.isEmpty())
+	{
+		renderThumbnails(rowsToRender);
 	}
+
 	shaderListWidget->setCurrentRow(currentRow);
-	m_pOpenglView->setGlobalShaderId(previous, QString());
 }
 
-// Take a snapshoot
-QImage ChooseShaderDialog::takeSnapShoot()
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Render the thumbnails of the given rows
+void ChooseShaderDialog::renderThumbnails(const QList<int>& rows)
 {
+	const bool useProxyMesh= proxyMeshCheckBox->isChecked();
+	m_pOpenglView->makeCurrent();
+
+	// Save the view
+	const GLuint previous= m_pOpenglView->globalShaderId();
+	const double masterAngle= m_pOpenglView->getViewAngle();
+	GLC_World masterWorld(m_pOpenglView->getWorld());
+	GLC_Camera masterCam(m_pOpenglView->getCamera());
+
+	if (useProxyMesh)
+	{
+		m_pOpenglView->add(m_ProxyWorld);
+	}
+
+	// Thumbnails are independent of the current point of view
+	GLC_Camera previewCam;
+	previewCam.setDefaultUpVector(m_pOpenglView->getWorld().upVector());
+	previewCam.setIsoView();
+	m_pOpenglView->setCameraAndAngle(previewCam, masterAngle);
+	m_pOpenglView->reframe(GLC_BoundingBox(), false);
+
 	m_pOpenglView->setSnapShootMode(true);
 	m_pOpenglView->setAutoBufferSwap(false);
 	m_pOpenglView->viewportHandle()->forceAspectRatio(1.0);
-	m_pOpenglView->updateGL();
+
+	// Render offscreen if possible
+	QGLFramebufferObject* pFrameBuffer= NULL;
+	if (GLC_State::frameBufferSupported())
+	{
+		pFrameBuffer= m_pOpenglView->frameBufferPoolHandle()->take(m_IconSize);
+	}
+
+	const int size= rows.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const int row= rows[i];
+		m_pOpenglView->setGlobalShaderId(rowShaderId(row), QString());
+
+		QImage snapShoot;
+		if ((NULL != pFrameBuffer) && pFrameBuffer->bind())
+		{
+			glViewport(0, 0, m_IconSize.width(), m_IconSize.height());
+			m_pOpenglView->updateGL();
+			snapShoot= m_pOpenglView->frameBufferPoolHandle()->toImage(pFrameBuffer);
+			pFrameBuffer->release();
+		}
+		else
+		{
+			m_pOpenglView->updateGL();
+			snapShoot= m_pOpenglView->grabFrameBuffer();
+		}
+
+		const QPixmap thumbnail(QPixmap::fromImage(snapShoot).scaled(m_IconSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+		shaderListWidget->item(row)->setIcon(thumbnail);
+		m_ThumbnailCache.insert(thumbnailKey(row), new QPixmap(thumbnail));
+	}
+
+	// Restore the view
+	if (NULL != pFrameBuffer)
+	{
+		m_pOpenglView->frameBufferPoolHandle()->giveBack(pFrameBuffer);
+		glViewport(0, 0, m_pOpenglView->size().width(), m_pOpenglView->size().height());
+	}
 	m_pOpenglView->viewportHandle()->updateAspectRatio();
 	m_pOpenglView->viewportHandle()->updateProjectionMat();
-	QImage snapShoot= m_pOpenglView->grabFrameBuffer();
+	if (useProxyMesh)
+	{
+		m_pOpenglView->clear();
+		m_pOpenglView->add(masterWorld);
+		m_pOpenglView->setToVisibleState();
+	}
+	m_pOpenglView->setCameraAndAngle(masterCam, masterAngle);
+	m_pOpenglView->setGlobalShaderId(previous, QString());
 	m_pOpenglView->setSnapShootMode(false);
-	m_pOpenglView->updateGL();
 	m_pOpenglView->setAutoBufferSwap(true);
-	return snapShoot;
+	m_pOpenglView->requestUpdate();
+}
+
+// Return the shader id of the given row
+GLuint ChooseShaderDialog::rowShaderId(int row) const
+{
+	if (row <= 0) return 0;
+	else
+	{
+		return (*m_pShaderList)[row - 1]->id();
+	}
 }
 
+// Return the cache key of the thumbnail of the given row
+QString ChooseShaderDialog::thumbnailKey(int row) const
+{
+	QString key;
+	if (proxyMeshCheckBox->isChecked())
+	{
+		key= "Proxy";
+	}
+	else
+	{
+		key= m_SelectionKey;
+	}
+	return key + '/' + QString::number(rowShaderId(row));
+}
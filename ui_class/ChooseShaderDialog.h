@@ -29,6 +29,9 @@
 #include "../opengl_view/OpenglView.h"
 
 #include <QDialog>
+#include <QCache>
+#include <QPixmap>
+#include <GLC_World>
 
 class ChooseShaderDialog : public QDialog, private Ui::ChooseShaderDialog
 {
@@ -45,20 +48,46 @@ public:
 
 	//! Get the shader Name
 	QString shaderName() const;
+
+	//! Return true if the thumbnails list needs the model to be displayed in the view
+	/*! False if the proxy mesh is used or if all thumbnails of the selection are cached*/
+	bool modelIsNeeded() const;
 //////////////////////////////////////////////////////////////////////
 // Public Set Functions
 //////////////////////////////////////////////////////////////////////
 public:
+	//! Set the key of the selection previewed by the thumbnails
+	inline void setSelectionKey(const QString& key)
+	{m_SelectionKey= key;}
+
 	//! Update list thumbnails
+	/*! Only thumbnails which are not cached are rendered*/
 	void UpdateThumbnailsList();
 
+	//! Clear the cached thumbnails
+	inline void clearThumbnailsCache()
+	{m_ThumbnailCache.clear();}
+
+//////////////////////////////////////////////////////////////////////
+// Signals
+//////////////////////////////////////////////////////////////////////
+signals:
+	//! The preview mode as been changed
+	void previewModeChanged();
+
 //////////////////////////////////////////////////////////////////////
 // Private services Functions
 //////////////////////////////////////////////////////////////////////
 private:
 
-	//! Take a snapshoot
-	QImage takeSnapShoot();
+	//! Render the thumbnails of the given rows
+	void renderThumbnails(const QList<int>&);
+
+	//! Return the shader id of the given row
+	GLuint rowShaderId(int) const;
+
+	//! Return the cache key of the thumbnail of the given row
+	QString thumbnailKey(int) const;
 //////////////////////////////////////////////////////////////////////
 // private member
 //////////////////////////////////////////////////////////////////////
@@ -72,6 +101,14 @@ private:
 	//! Size of the icon in shader list
 	QSize m_IconSize;
 
+	//! The key of the previewed selection
+	QString m_SelectionKey;
+
+	//! Thumbnails keyed by selection and shader
+	QCache<QString, QPixmap> m_ThumbnailCache;
+
+	//! The proxy mesh world
+	GLC_World m_ProxyWorld;
 
 };
 
@@ -115,11 +115,13 @@ void ExportWebDialog::initDialog(const QString& albumName, QList<FileEntry> file
 	m_pExportToWeb->linkThumbnailToModel(thumbnailModelLink->checkState() == Qt::Checked);
 	m_pExportToWeb->viewImageModelInformations(imageModelInformation->checkState() == Qt::Checked);
 	m_pExportToWeb->linkImageToModel(imageModelLink->checkState() == Qt::Checked);
+	m_pExportToWeb->incrementalExport(incrementalExport->checkState() == Qt::Checked);
 
 
 	// Signals and slot connection
 	// General
 	connect(exportAlbumAndModels, SIGNAL(clicked(bool)), m_pExportToWeb, SLOT(exportAlbumAndModel(bool)));
+	connect(incrementalExport, SIGNAL(clicked(bool)), m_pExportToWeb, SLOT(incrementalExport(bool)));
 	// Thumbnail
 	connect(thumbnailModelName, SIGNAL(clicked(bool)), m_pExportToWeb, SLOT(viewThumbnailModelName(bool)));
 	connect(thumbnailModelLink, SIGNAL(clicked(bool)), m_pExportToWeb, SLOT(linkThumbnailToModel(bool)));
@@ -172,6 +174,7 @@ void ExportWebDialog::accept()
 	hide();
 	m_pExportToWeb->setThumbnailSize(m_ThumbnailSize);
 	m_pExportToWeb->setImageSize(m_ImageSize);
+	m_pExportToWeb->setImageQuality(imageQuality->value());
 
 	if (editColorButton->isChecked())
 	{
@@ -181,7 +184,10 @@ void ExportWebDialog::accept()
 	if (m_pExportToWeb->exportToWeb(pathName, webTitle->text()))
 	{
 		QMessageBox::StandardButton returnButton;
-		returnButton= QMessageBox::question(this, tr("Export To Web"), tr("Export succesfull. Open Result?"), QMessageBox::No | QMessageBox::Yes);
+		QString message(tr("Export succesfull."));
+		message+= QString("\n\n") + m_pExportToWeb->summary() + QString("\n\n");
+		message+= tr("Open Result?");
+		returnButton= QMessageBox::question(this, tr("Export To Web"), message, QMessageBox::No | QMessageBox::Yes);
 		if (QMessageBox::Yes == returnButton)
 		{
 			QDesktopServices::openUrl(QUrl::fromLocalFile(m_pExportToWeb->indexPathName()));
@@ -26,6 +26,11 @@
 #include "../opengl_view/OpenglView.h"
 #include <QGLFramebufferObject>
 
+// Maximum size of the material previews atlas
+static const int maxAtlasSize= 2048;
+
+// Maximum number of previews kept between openings
+static const int maxCachedPreviews= 4096;
 
 ListOfMaterial::ListOfMaterial(OpenglView* pOpenglView, QWidget *parent)
 : QWidget(parent)
@@ -35,8 +40,8 @@ ListOfMaterial::ListOfMaterial(OpenglView* pOpenglView, QWidget *parent)
 , m_Camera()
 , m_pGeom(NULL)
 , m_IconSize(40, 40)
-, m_pFrameBuffer(NULL)
 , m_FrameBufferSize(128, 128)
+, m_PreviewCache(maxCachedPreviews)
 {
 	setupUi(this);
 
@@ -55,7 +60,7 @@ ListOfMaterial::ListOfMaterial(OpenglView* pOpenglView, QWidget *parent)
 
 ListOfMaterial::~ListOfMaterial()
 {
-	delete m_pFrameBuffer;
+
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -64,18 +69,95 @@ ListOfMaterial::~ListOfMaterial()
 // Create or Update the list
 void ListOfMaterial::CreateOrUpdate(QList<GLC_Material*>& materialsList)
 {
-	// Create frame buffer if supported
-	if ((NULL == m_pFrameBuffer) && GLC_State::frameBufferSupported())
+	m_MaterialList.clear();
+	m_MaterialList= materialsList;
+
+	// Clear the QListWidget
+	materialList->clear();
+
+	// Add materials in QListWidget, with their cached preview if they have not changed
+	QList<int> rowsToRender;
+	const int size= m_MaterialList.size();
+	for (int i= 0; i < size; ++i)
 	{
-		qDebug() << "ListOfMaterial::ListOfMaterial Use Frame buffer";
-		m_pFrameBuffer= new QGLFramebufferObject(m_FrameBufferSize, QGLFramebufferObject::Depth);
+		GLC_Material* pCurrentMaterial= m_MaterialList[i];
+		QListWidgetItem* pItem= new QListWidgetItem(pCurrentMaterial->name());
+		const QPixmap* pPreview= m_PreviewCache.object(previewKey(pCurrentMaterial));
+		if (NULL != pPreview)
+		{
+			pItem->setIcon(*pPreview);
+		}
+		else
+		{
+			rowsToRender << i;
+		}
+		materialList->addItem(pItem);
 	}
 
-	m_MaterialList.clear();
-	m_MaterialList= materialsList;
+	renderPreviews(rowsToRender);
+
+	materialList->setEnabled(true);
+	materialList->setCurrentRow(0);
+	numberOfSubMaterial->setText(QString::number(size));
+}
+
+// Show only item list
+void ListOfMaterial::showOnlyItemList(bool onlyItemList)
+{
+	numberOfSubMaterial->setVisible(!onlyItemList);
+	labelNbrSubMaterial->setVisible(!onlyItemList);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Public Slot function
+//////////////////////////////////////////////////////////////////////
+
+// Update the current row
+void ListOfMaterial::updateRow()
+{
+	const int row= materialList->currentRow();
+	if (-1 != row)
+	{
+		renderPreviews(QList<int>() << row);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private Slot function
+//////////////////////////////////////////////////////////////////////
+
+// The current item as been changed
+void ListOfMaterial::updateMaterialProperty(int index)
+{
+	if (-1 != index)
+	{
+		emit updateMaterialSignal(m_MaterialList[index]);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services function
+//////////////////////////////////////////////////////////////////////
+
+// init material representation world
+void ListOfMaterial::initWorld()
+{
+	GLC_Factory* pFactory= GLC_Factory::instance();
+	GLC_3DRep cylinder= pFactory->createCylinder(1.0, 3.0);
+	m_pGeom= cylinder.geomAt(0);
+	m_World.rootOccurence()->addChild(new GLC_StructOccurence(new GLC_3DRep(cylinder)));
+}
+
+// Render the previews of the materials of the given rows
+void ListOfMaterial::renderPreviews(const QList<int>& rows)
+{
+	const int count= rows.size();
+	if (0 == count) return;
+
+	m_pOpenglView->makeCurrent();
 
 	// Save the view
-	const double masterAngle= m_pOpenglView->getViewAngle();;
+	const double masterAngle= m_pOpenglView->getViewAngle();
 	GLC_World masterWorld(m_pOpenglView->getWorld());
 	GLC_Camera masterCam(m_pOpenglView->getCamera());
 
@@ -95,7 +177,7 @@ void ListOfMaterial::CreateOrUpdate(QList<GLC_Material*>& materialsList)
 		m_pOpenglView->setCameraAndAngle(m_Camera, 35.0);
 	}
 
-	// Set background to dark gray
+	// Set background to white
 	m_pOpenglView->viewportHandle()->setBackgroundColor(Qt::white);
 	m_pOpenglView->viewportHandle()->deleteBackGroundImage();
 
@@ -106,82 +188,80 @@ void ListOfMaterial::CreateOrUpdate(QList<GLC_Material*>& materialsList)
 		m_pOpenglView->getLight()->setTwoSided(false);
 	}
 	m_pOpenglView->setSnapShootMode(true);
-	const int width= m_IconSize.width();
-	const int height= m_IconSize.height();
 
-	const double aspectRatio= static_cast<double>(width) / static_cast<double>(height);
+	const double aspectRatio= static_cast<double>(m_IconSize.width()) / static_cast<double>(m_IconSize.height());
 	m_pOpenglView->viewportHandle()->forceAspectRatio(aspectRatio);
 
-	// Clear the QListWidget
-	materialList->clear();
-	// Add materials in in QListWidget
-	const int size= m_MaterialList.size();
-
-	bool frameBufferIsUsed= false;
-	if (NULL != m_pFrameBuffer)
+	// All previews of a page are rendered in the cells of one atlas framebuffer
+	const int cellWidth= m_FrameBufferSize.width();
+	const int cellHeight= m_FrameBufferSize.height();
+	QGLFramebufferObject* pAtlas= NULL;
+	int columns= 1;
+	int cellsPerPage= 1;
+	if (GLC_State::frameBufferSupported())
 	{
-		frameBufferIsUsed= m_pFrameBuffer->bind();
-		if (frameBufferIsUsed)
-		{
-			glViewport(0, 0, m_FrameBufferSize.width(), m_FrameBufferSize.height());
-		}
+		GLint maxBufferSize= 0;
+		glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE_EXT, &maxBufferSize);
+		const int atlasSize= qMin(static_cast<int>(maxBufferSize), maxAtlasSize);
+		columns= qMin(qMax(1, atlasSize / cellWidth), count);
+		const int lines= qMin(qMax(1, atlasSize / cellHeight), (count + columns - 1) / columns);
+		cellsPerPage= columns * lines;
+		pAtlas= m_pOpenglView->frameBufferPoolHandle()->take(QSize(columns * cellWidth, lines * cellHeight));
 	}
 
 	// Create progress dialog
-	QProgressDialog progress(tr("Creating Material previews... Please wait."), tr("Cancel"), 0, size, this);
+	QProgressDialog progress(tr("Creating Material previews... Please wait."), tr("Cancel"), 0, count, this);
 	progress.setModal(true);
 	progress.setMinimumDuration(1000);
 	int i= 0;
-	while ((i < size) && !progress.wasCanceled())
+	while ((i < count) && !progress.wasCanceled())
 	{
-		// Update Progress dialog
-		progress.setValue(i);
-		QCoreApplication::processEvents();
-
-		GLC_Material* pCurrentMaterial= m_MaterialList[i];
-		// Make material Opaque
-		const float matAlpha= pCurrentMaterial->diffuseColor().alphaF();
-		pCurrentMaterial->setOpacity(1.0);
-		m_pGeom->replaceMasterMaterial(pCurrentMaterial);
-
-
-		QListWidgetItem* pItem= new QListWidgetItem(pCurrentMaterial->name());
-
-
-		// Choose between Color buffer or frame buffer
-		if (frameBufferIsUsed)
+		const int pageCount= qMin(cellsPerPage, count - i);
+		if (NULL != pAtlas)
 		{
-			m_pFrameBuffer->bind();
-			m_pOpenglView->updateGL();
-			Q_ASSERT(m_pFrameBuffer->isValid());
-			// Make the screenShoot
-			QImage snapShoot= m_pFrameBuffer->toImage();
-			pItem->setIcon(QPixmap::fromImage(snapShoot).scaled(m_IconSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-			m_pFrameBuffer->release();
+			// The progress dialog may have made an other context current
+			m_pOpenglView->makeCurrent();
+			pAtlas->bind();
+			glEnable(GL_SCISSOR_TEST);
+			for (int cell= 0; cell < pageCount; ++cell)
+			{
+				// The scissor restricts the clear of the view to the cell
+				const int x= (cell % columns) * cellWidth;
+				const int y= (cell / columns) * cellHeight;
+				glViewport(x, y, cellWidth, cellHeight);
+				glScissor(x, y, cellWidth, cellHeight);
+				renderMaterial(m_MaterialList[rows[i + cell]]);
+			}
+			glDisable(GL_SCISSOR_TEST);
+
+			// One read back by page
+			const QImage atlasImage(m_pOpenglView->frameBufferPoolHandle()->toImage(pAtlas));
+			pAtlas->release();
+			for (int cell= 0; cell < pageCount; ++cell)
+			{
+				const int x= (cell % columns) * cellWidth;
+				const int y= atlasImage.height() - (cell / columns + 1) * cellHeight;
+				setPreview(rows[i + cell], atlasImage.copy(x, y, cellWidth, cellHeight));
+			}
 		}
 		else
 		{
-			m_pOpenglView->updateGL();
-			// Make the screenShoot
-			QImage snapShoot= m_pOpenglView->grabFrameBuffer();
-			pItem->setIcon(QPixmap::fromImage(snapShoot).scaled(m_IconSize, Qt::IgnoreAspectRatio)); //, Qt::SmoothTransformation
+			renderMaterial(m_MaterialList[rows[i]]);
+			setPreview(rows[i], m_pOpenglView->grabFrameBuffer());
 		}
+		i+= pageCount;
 
-		// Add item to the list
-		materialList->addItem(pItem);
-
-		// Restore material Alpha
-		pCurrentMaterial->setOpacity(matAlpha);
-
-		++i;
+		// Update Progress dialog
+		progress.setValue(i);
 	}
+
 	// Restore normal windowing buffer if needed
-	if (frameBufferIsUsed)
+	m_pOpenglView->makeCurrent();
+	if (NULL != pAtlas)
 	{
-		m_pFrameBuffer->release();
+		m_pOpenglView->frameBufferPoolHandle()->giveBack(pAtlas);
 		glViewport(0, 0, m_pOpenglView->size().width(), m_pOpenglView->size().height());
 	}
-	materialList->setEnabled(true);
 	m_pOpenglView->viewportHandle()->updateAspectRatio();
 	m_pOpenglView->viewportHandle()->updateProjectionMat();
 	// Restore the view
@@ -197,106 +277,41 @@ void ListOfMaterial::CreateOrUpdate(QList<GLC_Material*>& materialsList)
 		m_pOpenglView->getLight()->setTwoSided(true);
 	}
 
-	m_pOpenglView->updateGL();
-	materialList->setCurrentRow(0);
-	numberOfSubMaterial->setText(QString::number(size));
-}
-
-// Show only item list
-void ListOfMaterial::showOnlyItemList(bool onlyItemList)
-{
-	numberOfSubMaterial->setVisible(!onlyItemList);
-	labelNbrSubMaterial->setVisible(!onlyItemList);
+	m_pOpenglView->requestUpdate();
 }
 
-//////////////////////////////////////////////////////////////////////
-// Public Slot function
-//////////////////////////////////////////////////////////////////////
-
-// Update the current row
-void ListOfMaterial::updateRow()
+// Render the preview of the given material in the current viewport
+void ListOfMaterial::renderMaterial(GLC_Material* pMaterial)
 {
-	const int row= materialList->currentRow();
-	// Save the view
-	const double masterAngle= m_pOpenglView->getViewAngle();;
-	GLC_World masterWorld(m_pOpenglView->getWorld());
-	GLC_Camera masterCam(m_pOpenglView->getCamera());
-	// Prepare the view to make list snapShoot
-	m_pOpenglView->setAutoBufferSwap(false);
-	// Setup the view for preview
-	m_pOpenglView->add(m_World);
-
-	m_pOpenglView->setCameraAndAngle(m_Camera, 35.0);
-
-	// Set background to dark gray
-	m_pOpenglView->viewportHandle()->setBackgroundColor(Qt::white);
-	m_pOpenglView->viewportHandle()->deleteBackGroundImage();
-
-	// Desactivate two sided lighting
-	const bool isTwosided= m_pOpenglView->getLight()->isTwoSided();
-	if (isTwosided)
-	{
-		m_pOpenglView->getLight()->setTwoSided(false);
-	}
-	m_pOpenglView->setSnapShootMode(true);
-	const int width= m_IconSize.width();
-	const int height= m_IconSize.height();
-
-	const double aspectRatio= static_cast<double>(width) / static_cast<double>(height);
-	m_pOpenglView->viewportHandle()->forceAspectRatio(aspectRatio);
-
-	// Refresh icon of an item of QListWidget
-	GLC_Material* pCurrentMaterial= m_MaterialList[row];
-	m_pGeom->replaceMasterMaterial(pCurrentMaterial);
+	// Make material Opaque
+	const float matAlpha= pMaterial->diffuseColor().alphaF();
+	pMaterial->setOpacity(1.0);
+	m_pGeom->replaceMasterMaterial(pMaterial);
 
 	m_pOpenglView->updateGL();
-	// Make the screenShoot
-	QImage snapShoot= m_pOpenglView->grabFrameBuffer();
-
-	materialList->item(row)->setIcon(QPixmap::fromImage(snapShoot).scaled(m_IconSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-
-	// Restore the view
-	m_pOpenglView->clear();
-	m_pOpenglView->add(masterWorld);
-	m_pOpenglView->setToVisibleState();
-	m_pOpenglView->setCameraAndAngle(masterCam, masterAngle);
-	m_pOpenglView->setAutoBufferSwap(true);
-	m_pOpenglView->setSnapShootMode(false);
-	m_pOpenglView->viewportHandle()->updateAspectRatio();
-	m_pOpenglView->viewportHandle()->updateProjectionMat();
 
-	if (isTwosided)
-	{
-		m_pOpenglView->getLight()->setTwoSided(true);
-	}
-
-	m_pOpenglView->updateGL();
+	// Restore material Alpha
+	pMaterial->setOpacity(matAlpha);
 }
 
-//////////////////////////////////////////////////////////////////////
-// Private Slot function
-//////////////////////////////////////////////////////////////////////
-
-// The current item as been changed
-void ListOfMaterial::updateMaterialProperty(int index)
+// Set and cache the preview of the given row
+void ListOfMaterial::setPreview(int row, const QImage& image)
 {
-	if (-1 != index)
-	{
-		emit updateMaterialSignal(m_MaterialList[index]);
-	}
+	const QPixmap preview(QPixmap::fromImage(image).scaled(m_IconSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+	materialList->item(row)->setIcon(preview);
+	m_PreviewCache.insert(previewKey(m_MaterialList[row]), new QPixmap(preview));
 }
 
-//////////////////////////////////////////////////////////////////////
-// Private services function
-//////////////////////////////////////////////////////////////////////
-
-// init material representation world
-void ListOfMaterial::initWorld()
+// Return the preview cache key of the given material
+QString ListOfMaterial::previewKey(GLC_Material* pMaterial)
 {
-	GLC_Factory* pFactory= GLC_Factory::instance();
-	GLC_3DRep cylinder= pFactory->createCylinder(1.0, 3.0);
-	m_pGeom= cylinder.geomAt(0);
-	m_World.rootOccurence()->addChild(new GLC_StructOccurence(new GLC_3DRep(cylinder)));
+	QString key(QString::number(pMaterial->id()));
+	key+= pMaterial->ambientColor().name() + pMaterial->diffuseColor().name();
+	key+= pMaterial->specularColor().name() + pMaterial->emissiveColor().name();
+	key+= QString::number(pMaterial->shininess());
+	if (pMaterial->hasTexture())
+	{
+		key+= pMaterial->textureFileName();
+	}
+	return key;
 }
-
-
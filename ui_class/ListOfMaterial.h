@@ -29,13 +29,14 @@
 #include <QWidget>
 #include <QList>
 #include <QSize>
+#include <QCache>
+#include <QPixmap>
 #include <GLC_World>
 #include <GLC_Camera>
 
 class GLC_Material;
 class OpenglView;
 class GLC_Geometry;
-class QGLFramebufferObject;
 
 class ListOfMaterial : public QWidget, private Ui::ListOfMaterial
 {
@@ -86,6 +87,18 @@ private:
 	//! init material representatio world
 	void initWorld();
 
+	//! Render the previews of the materials of the given rows
+	void renderPreviews(const QList<int>&);
+
+	//! Render the preview of the given material in the current viewport
+	void renderMaterial(GLC_Material*);
+
+	//! Set and cache the preview of the given row
+	void setPreview(int, const QImage&);
+
+	//! Return the preview cache key of the given material
+	static QString previewKey(GLC_Material*);
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
@@ -104,12 +117,12 @@ private:
 	//! Item size
 	QSize m_IconSize;
 
-	//! The Frame buffer
-	QGLFramebufferObject* m_pFrameBuffer;
-
-	//! The frame buffer Size
+	//! The size of a preview in the atlas framebuffer
 	QSize m_FrameBufferSize;
 
+	//! Previews of the materials keyed by material id and properties
+	QCache<QString, QPixmap> m_PreviewCache;
+
 };
 
 #endif /* LISTOFMATERIAL_H_ */
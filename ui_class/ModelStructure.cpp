@@ -358,7 +358,7 @@ void ModelStructure::itemDoubleClicked()
 void ModelStructure::showSelectedInstances()
 {
 	m_World.showSelected3DViewInstance();
-	m_pOpenglView->updateGL();
+	m_pOpenglView->visibilityChanged();
 	updateSelectedTreeShowNoShow();
 }
 
@@ -366,7 +366,7 @@ void ModelStructure::showSelectedInstances()
 void ModelStructure::hideSelectedInstances()
 {
 	m_World.hideSelected3DViewInstance();
-	m_pOpenglView->updateGL();
+	m_pOpenglView->visibilityChanged();
 	updateSelectedTreeShowNoShow();
 }
 
@@ -398,7 +398,7 @@ void ModelStructure::pasteOnSelectedOccurence()
 	QTreeWidgetItem* pNewItem= createStructureItem(pOccurence);
 	selectedTreeWidgetItem.first()->addChild(pNewItem);
 	//updateTreeShowNoShow();
-	m_pOpenglView->updateGL();
+	m_pOpenglView->sceneChanged();
 
 }
 
@@ -411,9 +411,10 @@ void ModelStructure::editPosition()
 	Q_ASSERT(m_World.containsOccurence(occurenceId));
 
 	EditPositionDialog editPosition(m_World.occurence(occurenceId), this);
-	connect(&editPosition, SIGNAL(positionUpdated()), m_pOpenglView, SLOT(updateGL()));
+	// The instance bounding box changes with its position
+	connect(&editPosition, SIGNAL(positionUpdated()), m_pOpenglView, SLOT(sceneChanged()));
 	editPosition.exec();
-	m_pOpenglView->updateGL();
+	m_pOpenglView->sceneChanged();
 }
 //////////////////////////////////////////////////////////////////////
 // Private services functions
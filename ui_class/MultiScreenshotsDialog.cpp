@@ -25,6 +25,8 @@
 #include "MultiScreenshotsDialog.h"
 #include "../opengl_view/MultiShotsOpenglView.h"
 #include "../opengl_view/OpenglView.h"
+#include "../opengl_view/CapturePipeline.h"
+#include "../opengl_view/FrameStreamWriter.h"
 #include <QGLFramebufferObject>
 
 MultiScreenshotsDialog::MultiScreenshotsDialog(OpenglView* pOpenglView, QWidget* pParent)
@@ -104,6 +106,9 @@ MultiScreenshotsDialog::MultiScreenshotsDialog(OpenglView* pOpenglView, QWidget*
 	connect(gravityY, SIGNAL(clicked()), this, SLOT(gravityAxisChange()));
 	connect(gravityZ, SIGNAL(clicked()), this, SLOT(gravityAxisChange()));
 	connect(gravityCam, SIGNAL(clicked()), this, SLOT(gravityAxisChange()));
+
+	// Output format change
+	connect(outputFormat, SIGNAL(currentIndexChanged(int)), this, SLOT(outputFormatChanged(int)));
 }
 
 MultiScreenshotsDialog::~MultiScreenshotsDialog()
@@ -195,14 +200,52 @@ void MultiScreenshotsDialog::initScreenshotDialog(FileEntry fileEntry)
 //! Screenshot have to be saved
 void MultiScreenshotsDialog::accept()
 {
-	// Get the folder in which image file must be saved
-	QString pathName= QFileDialog::getExistingDirectory(this, tr("Select Destination directory"));
-	if (pathName.isEmpty())
+	// The shots are saved as images or in a single video file
+	const bool toStream= (0 != outputFormat->currentIndex());
+	const FrameStreamWriter::StreamFormat streamFormat= (1 == outputFormat->currentIndex()) ? FrameStreamWriter::MjpegAvi : FrameStreamWriter::RawFrames;
+	QString pathName;
+	QString streamFileName;
+	if (toStream)
+	{
+		// Get the video file name
+		QString defaultFileName(QDir(m_PreviousFilePath).filePath(baseShotName->text()));
+		QString filter;
+		if (FrameStreamWriter::MjpegAvi == streamFormat)
+		{
+			defaultFileName+= QString(".avi");
+			filter= tr("MJPEG video (*.avi)");
+		}
+		else
+		{
+			defaultFileName+= QString(".rgb");
+			filter= tr("Raw RGB frames (*.rgb)");
+		}
+		streamFileName= QFileDialog::getSaveFileName(this, tr("Save Video"), defaultFileName, filter);
+		if (streamFileName.isEmpty())
+		{
+			return;
+		}
+		m_PreviousFilePath= QFileInfo(streamFileName).absolutePath();
+	}
+	else
 	{
-		return;
+		// Get the folder in which image file must be saved
+		pathName= QFileDialog::getExistingDirectory(this, tr("Select Destination directory"));
+		if (pathName.isEmpty())
+		{
+			return;
+		}
+		else if(!QDir(pathName).exists())
+		{
+			return;
+		}
 	}
-	else if(!QDir(pathName).exists())
+
+	// Frames are encoded while the next shot is rendered
+	FrameStreamWriter frameStreamWriter;
+	if (toStream && !frameStreamWriter.open(streamFileName, streamFormat, m_TargetImageSize, framesPerSecond->value()))
 	{
+		QMessageBox::critical(this, QCoreApplication::applicationName(), frameStreamWriter.errorString());
 		return;
 	}
 	hide();
@@ -249,40 +292,43 @@ void MultiScreenshotsDialog::accept()
 
 	bool saveSucces= true;
 	bool continu= true;
+	bool shotsDone= false;
+
+	// Read back and images writing are done while the next shot is rendered
+	CapturePipeline capturePipeline(m_pOpenglView->frameBufferPoolHandle());
 	if (useFrameBuffer)
 	{
-		// Create the framebuffer
-		QGLFramebufferObjectFormat frameBufferFormat;
-		frameBufferFormat.setSamples(m_pOpenglView->format().samples());
-		frameBufferFormat.setAttachment(QGLFramebufferObject::Depth);
-		// Create the framebuffer
-		QGLFramebufferObject framebufferObject(m_TargetImageSize, frameBufferFormat);
+		// Get the framebuffer from the view pool
+		FrameBufferPool* pFrameBufferPool= m_pOpenglView->frameBufferPoolHandle();
+		QGLFramebufferObject* pFrameBuffer= pFrameBufferPool->take(m_TargetImageSize, m_pOpenglView->format().samples());
+		shotsDone= pFrameBuffer->isValid();
 
-		m_pOpenglView->viewportHandle()->setWinGLSize(framebufferObject.width(), framebufferObject.height());
+		m_pOpenglView->viewportHandle()->setWinGLSize(pFrameBuffer->width(), pFrameBuffer->height());
 		int i= 0;
-		while( (i < numberOfShots) && saveSucces && continu)
+		while( shotsDone && (i < numberOfShots) && saveSucces && continu)
 		{
 
-			framebufferObject.bind();
+			pFrameBuffer->bind();
 			m_pOpenglView->updateGL();
-			//imageToSave= framebufferObject.toImage();
-			if (imageToSave.isNull())
+			pFrameBuffer->release();
+			// Save the image
+			if (toStream)
 			{
-				framebufferObject.release();
-				break;
+				capturePipeline.readBack(pFrameBuffer, &frameStreamWriter);
+				saveSucces= !capturePipeline.hasError();
+			}
+			else
+			{
+				const QString nameSuffix((QString("0000") + QString::number(i)).right(4));
+				const QString nameOfImageToSave(baseImageName + nameSuffix + QString(".jpg"));
+				capturePipeline.readBack(pFrameBuffer, nameOfImageToSave);
+				saveSucces= !capturePipeline.hasError();
 			}
-			// Save the image
-			const QString nameSuffix((QString("0000") + QString::number(i)).right(4));
-			const QString nameOfImageToSave(baseImageName + nameSuffix + QString(".jpg"));
-			saveSucces= imageToSave.save(nameOfImageToSave, "JPG", 100);
 			// Move view camera
 			m_pOpenglView->viewportHandle()->cameraHandle()->translate(- savCamera.target());
 			m_pOpenglView->viewportHandle()->cameraHandle()->move(RotationMatrix);
 			m_pOpenglView->viewportHandle()->cameraHandle()->translate(savCamera.target());
 
-			// Release Frame buffer
-			framebufferObject.release();
-
 			// Update Progress dialog and chek fo cancellation
 			progress.setValue(i);
 			QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
@@ -293,29 +339,40 @@ void MultiScreenshotsDialog::accept()
 
 			++i;
 		}
+		pFrameBufferPool->giveBack(pFrameBuffer);
 		m_pOpenglView->viewportHandle()->setWinGLSize(m_pOpenglView->size().width(), m_pOpenglView->size().height());
 	}
-	if (imageToSave.isNull())
+	if (!shotsDone)
 	{
-		// Change view aspect ratio and
-		m_pOpenglView->viewportHandle()->forceAspectRatio(m_ImageAspectRatio);
+		// The background image is drawn by the tiled rendering
+		QString backgroundImageName;
+		if ((m_BackGroundMode == BackGroundImage) && !m_CurrentBackgroundImageName.isEmpty())
+		{
+			backgroundImageName= m_CurrentBackgroundImageName;
+		}
+		else if (m_BackGroundMode != BackGroundColor)
+		{
+			backgroundImageName= m_pOpenglView->defaultBackgroundImageName();
+		}
 
 		int i= 0;
 		while( (i < numberOfShots) && saveSucces && continu)
 		{
-			m_pOpenglView->updateGL();
-			imageToSave=  m_pOpenglView->grabFrameBuffer();
-			QSize shotSize= imageToSave.size();
-			imageToSave= imageToSave.scaled(shotSize.height() * m_ImageAspectRatio, shotSize.height(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-
-			imageToSave= imageToSave.scaled(m_TargetImageSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-			// To match the exact size of image
-			imageToSave= imageToSave.scaled(m_TargetImageSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+			// Render directly at the target size
+			imageToSave= m_pOpenglView->renderTiles(m_TargetImageSize, backgroundImageName);
 
 			// Save The Image
-			const QString nameSuffix((QString("0000") + QString::number(i)).right(4));
-			const QString nameOfImageToSave(baseImageName + nameSuffix + QString(".jpg"));
-			saveSucces= imageToSave.save(nameOfImageToSave, "JPG", 100);
+			if (toStream)
+			{
+				saveSucces= frameStreamWriter.writeFrame(imageToSave);
+			}
+			else
+			{
+				const QString nameSuffix((QString("0000") + QString::number(i)).right(4));
+				const QString nameOfImageToSave(baseImageName + nameSuffix + QString(".jpg"));
+				capturePipeline.save(imageToSave, nameOfImageToSave);
+				saveSucces= !capturePipeline.hasError();
+			}
 
 			//Move View Camera
 			m_pOpenglView->viewportHandle()->cameraHandle()->translate(- savCamera.target());
@@ -333,6 +390,12 @@ void MultiScreenshotsDialog::accept()
 			++i;
 		}
 	}
+	// Wait for the last images
+	saveSucces= capturePipeline.finish() && saveSucces;
+	if (toStream)
+	{
+		saveSucces= frameStreamWriter.close() && saveSucces;
+	}
 
 	// Retore the view
 	*(m_pOpenglView->viewportHandle()->cameraHandle())= savCamera;
@@ -350,7 +413,13 @@ void MultiScreenshotsDialog::accept()
 	m_pOpenglView->viewportHandle()->updateProjectionMat();
 	m_pOpenglView->updateGL();
 
-	if (!saveSucces)
+	if (!saveSucces && toStream)
+	{
+		QString message(tr("An error occur while trying to save video file"));
+		message+= QString("\n") + frameStreamWriter.errorString();
+		QMessageBox::critical(this, QCoreApplication::applicationName(), message);
+	}
+	else if (!saveSucces)
 	{
 		QMessageBox::critical(this, QCoreApplication::applicationName(), tr("An error occur while trying to save image file"));
 	}
@@ -565,6 +634,13 @@ void MultiScreenshotsDialog::reverseRotation()
 	m_pMultiShotsOpenglView->updateGravityAxis(m_RotationAxis);
 }
 
+// The output format changed
+void MultiScreenshotsDialog::outputFormatChanged(int index)
+{
+	// The frame rate is only stored in video files
+	framesPerSecond->setEnabled(1 == index);
+}
+
 //////////////////////////////////////////////////////////////////////
 // Private services function
 //////////////////////////////////////////////////////////////////////
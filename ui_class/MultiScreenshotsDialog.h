@@ -102,6 +102,9 @@ private slots:
 	//! Reverse rotation
 	void reverseRotation();
 
+	//! The output format changed
+	void outputFormatChanged(int);
+
 
 //////////////////////////////////////////////////////////////////////
 // Private services function
@@ -24,6 +24,11 @@
 
 #include "ScreenshotDialog.h"
 #include "../opengl_view/OpenglView.h"
+#include "../opengl_view/TiffStripWriter.h"
+#include <QProgressDialog>
+
+// Maximum size of poster rendered in tiles
+static const int maxPosterSize= 32000;
 
 ScreenshotDialog::ScreenshotDialog(OpenglView* pOpenglView, QWidget* pParent)
 :QDialog(pParent)
@@ -42,6 +47,7 @@ ScreenshotDialog::ScreenshotDialog(OpenglView* pOpenglView, QWidget* pParent)
 , m_DefaultImageName()
 , m_PreviousFilePath()
 , m_MaxBufferSize(2000)
+, m_ImageInfos()
 {
 	setupUi(this);
 
@@ -65,10 +71,14 @@ ScreenshotDialog::ScreenshotDialog(OpenglView* pOpenglView, QWidget* pParent)
 		imageInfos->setText(message);
 	}
 
-	spinBoxWidth->setMaximum(m_MaxBufferSize);
-	spinBoxHeight->setMaximum(m_MaxBufferSize);
+	m_ImageInfos= imageInfos->text();
+
+	// Larger images are rendered in tiles
+	spinBoxWidth->setMaximum(maxPosterSize);
+	spinBoxHeight->setMaximum(maxPosterSize);
 
 	createPredefinedSizeList();
+	updatePosterMode();
 
 	// Set default target size
 	spinBoxWidth->setValue(m_TargetImageSize.width());
@@ -130,29 +140,6 @@ void ScreenshotDialog::initScreenshotDialog(const QString& fileName)
 //! Screenshot have to be saved
 void ScreenshotDialog::accept()
 {
-	QImage imageToSave;
-
-	// Choose right background
-	// Choose right background
-	if (BackGroundTransparent == m_BackGroundMode)
-	{
-		QColor background(Qt::white);
-		background.setAlpha(0);
-		imageToSave= m_pOpenglView->takeScreenshot(true, m_TargetImageSize, QString(), background, m_ImageAspectRatio);
-	}
-	else if (BackGroundColor == m_BackGroundMode)
-	{
-		imageToSave= m_pOpenglView->takeScreenshot(true, m_TargetImageSize, QString(), m_CurrentBackgroundColor, m_ImageAspectRatio);
-	}
-	else if ((BackGroundImage == m_BackGroundMode) && !m_CurrentBackgroundImageName.isEmpty())
-	{
-		imageToSave= m_pOpenglView->takeScreenshot(true, m_TargetImageSize, m_CurrentBackgroundImageName, QColor(), m_ImageAspectRatio);
-	}
-	else
-	{
-		imageToSave= m_pOpenglView->takeScreenshot(true, m_TargetImageSize, QString(), QColor(), m_ImageAspectRatio);
-	}
-
 	const QString imageFormat= formatComboBox->currentText();
 	QString extension('.');
 
@@ -181,6 +168,33 @@ void ScreenshotDialog::accept()
 	{
 		m_PreviousFilePath= QFileInfo(fileName).absolutePath();
 		fileName= m_PreviousFilePath + QDir::separator() + QFileInfo(fileName).completeBaseName() + extension;
+		if (isPoster())
+		{
+			if (savePoster(fileName)) QDialog::accept();
+			return;
+		}
+
+		QImage imageToSave;
+
+		// Choose right background
+		if (BackGroundTransparent == m_BackGroundMode)
+		{
+			QColor background(Qt::white);
+			background.setAlpha(0);
+			imageToSave= m_pOpenglView->takeScreenshot(true, m_TargetImageSize, QString(), background, m_ImageAspectRatio);
+		}
+		else if (BackGroundColor == m_BackGroundMode)
+		{
+			imageToSave= m_pOpenglView->takeScreenshot(true, m_TargetImageSize, QString(), m_CurrentBackgroundColor, m_ImageAspectRatio);
+		}
+		else if ((BackGroundImage == m_BackGroundMode) && !m_CurrentBackgroundImageName.isEmpty())
+		{
+			imageToSave= m_pOpenglView->takeScreenshot(true, m_TargetImageSize, m_CurrentBackgroundImageName, QColor(), m_ImageAspectRatio);
+		}
+		else
+		{
+			imageToSave= m_pOpenglView->takeScreenshot(true, m_TargetImageSize, QString(), QColor(), m_ImageAspectRatio);
+		}
 		imageToSave.save(fileName, imageFormat.toLatin1().data(), 100);
 		QDialog::accept();
 	}
@@ -199,6 +213,8 @@ void ScreenshotDialog::targetImageSizeChanged()
 	m_TargetImageSize.setHeight(spinBoxHeight->value());
 	m_ImageAspectRatio= static_cast<double>(m_TargetImageSize.width()) / static_cast<double>(m_TargetImageSize.height());
 
+	updatePosterMode();
+
 	// Take the ScreenShot
 	takeScreenshot();
 
@@ -474,8 +490,91 @@ void ScreenshotDialog::createPredefinedSizeList()
 	listOfPredefinedSize << "HD 1920x1080"; //15
 	m_PredefinedSizes.append(QSize(1920, 1080));
 
+	listOfPredefinedSize << tr("Poster") + " 8192x8192"; //16
+	m_PredefinedSizes.append(QSize(8192, 8192));
+
+	listOfPredefinedSize << tr("Poster") + " 16384x16384"; //17
+	m_PredefinedSizes.append(QSize(16384, 16384));
+
 	comboBoxPredifinedSize->addItems(listOfPredefinedSize);
 	comboBoxPredifinedSize->setCurrentIndex(4);
 
 	m_TargetImageSize= m_PredefinedSizes[4];
 }
+
+// Return true if the target image is too large for one framebuffer
+bool ScreenshotDialog::isPoster() const
+{
+	return (m_TargetImageSize.width() > m_MaxBufferSize) || (m_TargetImageSize.height() > m_MaxBufferSize);
+}
+
+// Update the image format and informations of the poster mode
+void ScreenshotDialog::updatePosterMode()
+{
+	if (isPoster())
+	{
+		// Posters are streamed in an uncompressed TIFF file
+		formatComboBox->setCurrentIndex(formatComboBox->findText("TIFF"));
+		formatComboBox->setEnabled(false);
+		QString message(tr("Image larger than %1 pixels").arg(m_MaxBufferSize));
+		message+= QString("\n") + tr("Image will be rendered in tiles and saved in TIFF");
+		imageInfos->setText(message);
+	}
+	else
+	{
+		formatComboBox->setEnabled(true);
+		imageInfos->setText(m_ImageInfos);
+	}
+}
+
+// Render the poster in tiles and save it in the given file
+bool ScreenshotDialog::savePoster(const QString& fileName)
+{
+	TiffStripWriter writer;
+	const bool withAlpha= (BackGroundTransparent == m_BackGroundMode);
+	if (!writer.open(fileName, m_TargetImageSize, withAlpha))
+	{
+		QString message(tr("Unable to save image :") + QString("\n"));
+		message+= writer.errorString();
+		QMessageBox::critical(this, tr("Save Image"), message);
+		return false;
+	}
+
+	QProgressDialog progress(tr("Rendering poster..."), tr("Cancel"), 0, 100, this);
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(0);
+	connect(m_pOpenglView, SIGNAL(posterProgress(int)), &progress, SLOT(setValue(int)));
+	connect(&progress, SIGNAL(canceled()), m_pOpenglView, SLOT(cancelPoster()));
+
+	// Choose right background
+	bool success;
+	if (BackGroundTransparent == m_BackGroundMode)
+	{
+		QColor background(Qt::white);
+		background.setAlpha(0);
+		success= m_pOpenglView->renderPoster(m_TargetImageSize, QString(), background, &writer);
+	}
+	else if (BackGroundColor == m_BackGroundMode)
+	{
+		success= m_pOpenglView->renderPoster(m_TargetImageSize, QString(), m_CurrentBackgroundColor, &writer);
+	}
+	else if ((BackGroundImage == m_BackGroundMode) && !m_CurrentBackgroundImageName.isEmpty())
+	{
+		success= m_pOpenglView->renderPoster(m_TargetImageSize, m_CurrentBackgroundImageName, QColor(), &writer);
+	}
+	else
+	{
+		success= m_pOpenglView->renderPoster(m_TargetImageSize, QString(), QColor(), &writer);
+	}
+	disconnect(m_pOpenglView, SIGNAL(posterProgress(int)), &progress, SLOT(setValue(int)));
+
+	const bool canceled= progress.wasCanceled();
+	success= writer.close() && success;
+	if (!success && !canceled)
+	{
+		QString message(tr("Unable to save image :") + QString("\n"));
+		message+= fileName + QString("\n") + writer.errorString();
+		QMessageBox::critical(this, tr("Save Image"), message);
+	}
+	return success;
+}
@@ -113,6 +113,15 @@ private:
 	//! Create predefined size list
 	void createPredefinedSizeList();
 
+	//! Return true if the target image is too large for one framebuffer
+	bool isPoster() const;
+
+	//! Update the image format and informations of the poster mode
+	void updatePosterMode();
+
+	//! Render the poster in tiles and save it in the given file
+	bool savePoster(const QString&);
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
@@ -161,6 +170,9 @@ private:
 
 	//! the Maximum buffer Size
 	int m_MaxBufferSize;
+
+	//! The default image informations
+	QString m_ImageInfos;
 };
 
 #endif /* SCREENSHOTDIALOG_H_ */
@@ -24,10 +24,16 @@
 
 #include "SendFilesDialog.h"
 #include "AlbumFile.h"
+#include "FileCopyEngine.h"
+#include "ZipArchiveWriter.h"
+#include <QBuffer>
 #include <QFileInfo>
 #include <QFileDialog>
 #include <QProgressDialog>
 
+// Range of the copy progress dialog
+static const int progressRange= 1000;
+
 SendFilesDialog::SendFilesDialog(FileEntryHash* pFileEntryHash, QWidget *parent)
 : QDialog(parent)
 , m_pFileEntryHash(pFileEntryHash)
@@ -37,6 +43,7 @@ SendFilesDialog::SendFilesDialog(FileEntryHash* pFileEntryHash, QWidget *parent)
 , m_AlbumFileName()
 , m_copyAlbumFile(true)
 , m_NewAlbumFileName()
+, m_CopyReport()
 {
 	 setupUi(this);
 	 // Setup Origin file list
@@ -65,6 +72,7 @@ SendFilesDialog::SendFilesDialog(FileEntryHash* pFileEntryHash, QWidget *parent)
 		void createFolderStateChanged(int);
 
 	 connect(createSubFolder, SIGNAL(stateChanged(int)), this, SLOT(createFolderStateChanged(int)));
+	 connect(zipArchive, SIGNAL(stateChanged(int)), this, SLOT(zipArchiveStateChanged(int)));
 
 }
 
@@ -159,6 +167,8 @@ void SendFilesDialog::updateView(const QString& albumFileName)
 		createSubFolder->setCheckState(Qt::Unchecked);
 	}
 
+	zipArchiveStateChanged(zipArchive->checkState());
+
 	// Update UI
 	totalDestinationSize->setText(sizeFromDoubleToString(m_SentFilesSize));
 
@@ -174,6 +184,7 @@ bool SendFilesDialog::sendFiles()
 {
 	// Check if the state permit to send files
 	if (!buttonBox->button(QDialogButtonBox::Ok)->isEnabled()) return false;
+	m_CopyReport.clear();
 	// The list of entry Id to update
 	QList<GLC_uint> listOfEntryId;
 	// The List of source files to send
@@ -201,10 +212,12 @@ bool SendFilesDialog::sendFiles()
 		if (size > 0)
 		{
 			// Create sub directory
-			if (m_createSubFolder)
+			if (m_createSubFolder && !zipArchive->isChecked())
 			{
+				// The sub directory of a previous copy is reused
 				QDir entryDir(m_TargetPath);
-				if (!entryDir.mkdir(QFileInfo(targetFileName).baseName()))
+				const QString subDirName(QFileInfo(targetFileName).baseName());
+				if (!entryDir.exists(subDirName) && !entryDir.mkdir(subDirName))
 				{
 					QString message(tr("Unable to create directory :") + QString("\n"));
 					message+= m_TargetPath;
@@ -225,7 +238,7 @@ bool SendFilesDialog::sendFiles()
 				// Create attached file sub directory if necessary
 				QDir entryBasePath(QFileInfo(targetFileName).absolutePath());
 				QString AttachedFileRelativePath= entryBasePath.relativeFilePath(QFileInfo(targetChildFileName).absolutePath());
-				if (!AttachedFileRelativePath.isEmpty())
+				if (!AttachedFileRelativePath.isEmpty() && !zipArchive->isChecked())
 				{
 					entryBasePath.mkpath(AttachedFileRelativePath);
 				}
@@ -233,55 +246,76 @@ bool SendFilesDialog::sendFiles()
 		}
 	}
 	const int numberOfFileToCopy= listOfFilesToSend.size();
+	Q_ASSERT(listOfFilesToSend.size() == listOfDestinationFile.size());
 
-	// Create progress dialog
-	QProgressDialog progress(tr("Copying files..."), tr("Abort Copy"), 0, numberOfFileToCopy, this->parentWidget());
-	progress.setModal(true);
-	progress.setMinimumDuration(1000);
+	// The files and the album are streamed in a single archive
+	if (zipArchive->isChecked())
+	{
+		return sendToArchive(listOfFilesToSend, listOfDestinationFile);
+	}
 
-	Q_ASSERT(listOfFilesToSend.size() == listOfDestinationFile.size());
-	// Check if source files exist
-	for (int i= 0; i < numberOfFileToCopy; ++i)
+	// The files are copied by worker threads
+	FileCopyEngine fileCopyEngine;
+	fileCopyEngine.setHardLinkAllowed(useHardLinks->isChecked());
+	fileCopyEngine.setDeduplicate(shareIdenticalFiles->isChecked());
+	if (incrementalCopy->isChecked())
 	{
-		if (!QFile::exists(listOfFilesToSend[i]))
+		// Only the new and changed files are copied, the manifest speeds up the next comparison
+		fileCopyEngine.setIncremental(true);
+		fileCopyEngine.setContentHash(compareContents->isChecked());
+		fileCopyEngine.setRemoveOrphans(removeOrphans->isChecked());
+		if (!fileCopyEngine.setManifest(m_TargetPath))
 		{
-			progress.cancel();
-			QString message(tr("Source file not found :") + QString("\n"));
-			message+= listOfFilesToSend[i];
-			QMessageBox::critical(this->parentWidget(), tr("Send Files"), message);
+			QMessageBox::critical(this->parentWidget(), tr("Send Files"), fileCopyEngine.errorString());
 			return false;
 		}
 	}
-	// All source files exists
-	// Copying the Files
 	for (int i= 0; i < numberOfFileToCopy; ++i)
 	{
-		// Update Progress dialog and chek fo cancellation
-		progress.setValue(i);
-		QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-		if (progress.wasCanceled())
-		{
-			return false;
-		}
+		fileCopyEngine.addFile(listOfFilesToSend[i], listOfDestinationFile[i]);
+	}
 
-		const QString targetFile= listOfDestinationFile[i];
-		// Test if the destination file already exist
-		if (QFile::exists(listOfDestinationFile[i]))
-		{
-			// The destination file exists, delete it
-			QFile::remove(listOfDestinationFile[i]);
-		}
-		if (!QFile::copy(listOfFilesToSend[i], listOfDestinationFile[i]))
+	// Check if source files exist and if there is enough free space
+	if (!fileCopyEngine.check(m_TargetPath))
+	{
+		QMessageBox::critical(this->parentWidget(), tr("Send Files"), fileCopyEngine.errorString());
+		return false;
+	}
+
+	// Create progress dialog
+	QProgressDialog progress(tr("Copying files..."), tr("Abort Copy"), 0, progressRange, this->parentWidget());
+	progress.setModal(true);
+	progress.setMinimumDuration(1000);
+
+	// Copying the Files
+	if (!fileCopyEngine.exec(&progress, 0, progressRange))
+	{
+		progress.cancel();
+		if (!fileCopyEngine.wasCanceled())
 		{
-			progress.cancel();
-			QString message(tr("Failed to copy file :") + QString("\n"));
-			message+= listOfFilesToSend[i];
-			message+= QString("\n") + QString("To") + QString("\n");
-			message+= listOfDestinationFile[i];
-			QMessageBox::critical(this->parentWidget(), tr("Send Files"), message);
-			return false;
+			QMessageBox::critical(this->parentWidget(), tr("Send Files"), fileCopyEngine.errorString());
 		}
+		return false;
+	}
+	progress.setValue(progressRange);
+
+	// Keep the copy summary for the status bar
+	m_CopyReport= tr("%1 files copied in %2 s").arg(numberOfFileToCopy - fileCopyEngine.unchangedFiles() - fileCopyEngine.deduplicatedFiles()).arg(fileCopyEngine.copyTime() / 1000.0, 0, 'f', 1);
+	m_CopyReport+= QString(" - ") + fileCopyEngine.methodsSummary().replace(QChar('\n'), QString(", "));
+	if (fileCopyEngine.removedOrphans() > 0)
+	{
+		m_CopyReport+= QString(" - ") + tr("%1 orphan files removed").arg(fileCopyEngine.removedOrphans());
+	}
+
+	// The copy methods are only detailed when the fast methods were not available
+	if (fileCopyEngine.bufferedCopies() > 0)
+	{
+		const QString message(tr("%1 files could not be cloned, linked or copied by the system and were copied with a buffer").arg(fileCopyEngine.bufferedCopies()));
+		QMessageBox messageBox(QMessageBox::Information, tr("Send Files"), message, QMessageBox::Ok, this->parentWidget());
+		messageBox.setDetailedText(fileCopyEngine.methodsReport());
+		messageBox.exec();
 	}
+
 	// OK All files have been copied
 	if (updateAlbum() || copyAlbum())
 	{
@@ -298,17 +332,7 @@ bool SendFilesDialog::sendFiles()
 		FileEntryHash::iterator iEntry= pNewFileEntryHash->begin();
 		while (iEntry != pNewFileEntryHash->constEnd())
 		{
-			QString newFilePath;
-			if (m_createSubFolder && (iEntry.value().numberOfAttachedFiles() > 0))
-			{
-				newFilePath= m_TargetPath + QDir::separator() + QFileInfo(iEntry.value().getFileName()).completeBaseName();
-			}
-			else
-			{
-				newFilePath= m_TargetPath;
-			}
-			QString newFileName= newFilePath + QDir::separator() + QFileInfo(iEntry.value().getFileName()).fileName();
-			iEntry.value().updateFile(newFileName);
+			iEntry.value().updateFile(sentFileName(iEntry.value()));
 			++iEntry;
 		}
 		if (!updateAlbum())
@@ -569,6 +593,23 @@ void SendFilesDialog::albumNameTextChanged()
 	updateTargetFilePath();
 }
 
+// Zip archive state changed
+void SendFilesDialog::zipArchiveStateChanged(int state)
+{
+	// The archive is a new copy : links, incremental copy and album update are not available
+	const bool toFolder= (state != Qt::Checked);
+	useHardLinks->setEnabled(toFolder);
+	shareIdenticalFiles->setEnabled(toFolder);
+	incrementalCopy->setEnabled(toFolder);
+	compareContents->setEnabled(toFolder && incrementalCopy->isChecked());
+	removeOrphans->setEnabled(toFolder && incrementalCopy->isChecked());
+	if (!toFolder)
+	{
+		updateCurrentAlbum->setCheckState(Qt::Unchecked);
+	}
+	updateCurrentAlbum->setEnabled(toFolder && !m_AlbumFileName.isEmpty());
+}
+
 //////////////////////////////////////////////////////////////////////
 // private services function
 //////////////////////////////////////////////////////////////////////
@@ -637,3 +678,93 @@ void SendFilesDialog::changeLocation(QTreeWidgetItem* pWidget, QString newPath)
 	}
 	pWidget->setText(1, newPath);
 }
+
+// Return the file name of the given entry once sent
+QString SendFilesDialog::sentFileName(const FileEntry& fileEntry) const
+{
+	QString newFilePath;
+	if (m_createSubFolder && (fileEntry.numberOfAttachedFiles() > 0))
+	{
+		newFilePath= m_TargetPath + QDir::separator() + QFileInfo(fileEntry.getFileName()).completeBaseName();
+	}
+	else
+	{
+		newFilePath= m_TargetPath;
+	}
+	return newFilePath + QDir::separator() + QFileInfo(fileEntry.getFileName()).fileName();
+}
+
+// Send the given source files to the given destination files in a zip archive
+bool SendFilesDialog::sendToArchive(const QList<QString>& listOfFilesToSend, const QList<QString>& listOfDestinationFile)
+{
+	QString archiveName(QFileInfo(albumName->text()).completeBaseName());
+	if (archiveName.isEmpty())
+	{
+		archiveName= tr("Album");
+	}
+	const QString archiveFileName(m_TargetPath + QDir::separator() + archiveName + QString(".zip"));
+	if (QFile::exists(archiveFileName))
+	{
+		QString message(tr("The archive already exists, replace it ?") + QString("\n") + archiveFileName);
+		if (QMessageBox::No == QMessageBox::question(this->parentWidget(), tr("Send Files"), message, QMessageBox::No | QMessageBox::Yes))
+		{
+			return false;
+		}
+	}
+
+	// The entries keep the layout of the destination files
+	ZipArchiveWriter zipArchiveWriter;
+	const QDir targetDir(m_TargetPath);
+	const int numberOfFileToSend= listOfFilesToSend.size();
+	for (int i= 0; i < numberOfFileToSend; ++i)
+	{
+		if (!QFile::exists(listOfFilesToSend[i]))
+		{
+			QString message(tr("Source file not found :") + QString("\n"));
+			message+= listOfFilesToSend[i];
+			QMessageBox::critical(this->parentWidget(), tr("Send Files"), message);
+			return false;
+		}
+		zipArchiveWriter.addFile(listOfFilesToSend[i], targetDir.relativeFilePath(listOfDestinationFile[i]));
+	}
+
+	// The album is written in memory with the sent file names
+	if (copyAlbum())
+	{
+		QList<FileEntry> sentFileEntries= m_pFileEntryHash->values();
+		const int size= sentFileEntries.size();
+		for (int i= 0; i < size; ++i)
+		{
+			sentFileEntries[i].updateFile(sentFileName(sentFileEntries.at(i)));
+		}
+		QByteArray albumData;
+		QBuffer albumBuffer(&albumData);
+		albumBuffer.open(QIODevice::WriteOnly);
+		AlbumFile newAlbum;
+		newAlbum.saveAlbumFile(sentFileEntries, &albumBuffer, QFileInfo(m_NewAlbumFileName).absoluteDir());
+		albumBuffer.close();
+		zipArchiveWriter.addData(targetDir.relativeFilePath(m_NewAlbumFileName), albumData);
+	}
+
+	// Create progress dialog
+	QProgressDialog progress(tr("Writing archive..."), tr("Abort"), 0, progressRange, this->parentWidget());
+	progress.setModal(true);
+	progress.setMinimumDuration(1000);
+
+	if (!zipArchiveWriter.exec(archiveFileName, &progress, 0, progressRange))
+	{
+		progress.cancel();
+		if (!zipArchiveWriter.wasCanceled())
+		{
+			QMessageBox::critical(this->parentWidget(), tr("Send Files"), zipArchiveWriter.errorString());
+		}
+		return false;
+	}
+	progress.setValue(progressRange);
+
+	QString summary(tr("%1 files written in %2 s").arg(zipArchiveWriter.numberOfEntries()).arg(zipArchiveWriter.writeTime() / 1000.0, 0, 'f', 1));
+	summary+= QString("\n") + tr("Archive : %1 (%2 of %3)").arg(archiveFileName).arg(FileCopyEngine::sizeToString(zipArchiveWriter.archiveSize())).arg(FileCopyEngine::sizeToString(zipArchiveWriter.totalSize()));
+	QMessageBox::information(this->parentWidget(), tr("Send Files"), summary);
+
+	return true;
+}
@@ -54,6 +54,9 @@ public:
 	//! Return the new album file name
 	inline QString newAlbumFileName() const {return m_NewAlbumFileName;}
 
+	//! Return the summary of the last copy
+	inline QString copyReport() const {return m_CopyReport;}
+
 private slots:
 	//! Browse for destination directory
 	void browse();
@@ -88,6 +91,9 @@ private slots:
 	//! The album name as changed
 	void albumNameTextChanged();
 
+	//! Zip archive state changed
+	void zipArchiveStateChanged(int);
+
 //////////////////////////////////////////////////////////////////////
 // private services function
 //////////////////////////////////////////////////////////////////////
@@ -98,6 +104,12 @@ private:
 	//! Change the location of an QTreeWidgetItem
 	void changeLocation(QTreeWidgetItem*, QString);
 
+	//! Return the file name of the given entry once sent
+	QString sentFileName(const FileEntry&) const;
+
+	//! Send the given source files to the given destination files in a zip archive
+	bool sendToArchive(const QList<QString>&, const QList<QString>&);
+
 //////////////////////////////////////////////////////////////////////
 // private member
 //////////////////////////////////////////////////////////////////////
@@ -123,6 +135,9 @@ private:
 	//! The new Album File name
 	QString m_NewAlbumFileName;
 
+	//! The summary of the last copy
+	QString m_CopyReport;
+
 };
 
 #endif /* SENDFILESDIALOG_H_ */